@@ -39,6 +39,7 @@ bool CCmdLineParser::parse(int argc,
                            std::string& quantilesState,
                            bool& deleteStateFiles,
                            std::size_t& bucketPersistInterval,
+                           std::size_t& numberThreads,
                            core_t::TTime& namedPipeConnectTimeout,
                            std::string& inputFileName,
                            bool& isInputFileNamedPipe,
@@ -51,6 +52,7 @@ bool CCmdLineParser::parse(int argc,
                            bool& isPersistInForeground,
                            std::size_t& maxAnomalyRecords,
                            bool& memoryUsage,
+                           bool& isHost,
                            bool& validElasticLicenseKeyConfirmed) {
     try {
         boost::program_options::options_description desc(DESCRIPTION);
@@ -80,6 +82,8 @@ bool CCmdLineParser::parse(int argc,
                     "Optional file to quantiles for normalization")
             ("deleteStateFiles",
                     "If the 'quantilesState' option is used and this flag is set then delete the model state files once they have been read")
+            ("numberThreads", boost::program_options::value<std::size_t>(),
+                    "Optional number of threads to use for work which can be parallelised, such as restoring model state - default is 1")
             ("namedPipeConnectTimeout", boost::program_options::value<core_t::TTime>(),
                     "Optional timeout (in seconds) for connecting named pipes on startup - default is 300 seconds")
             ("input", boost::program_options::value<std::string>(),
@@ -101,6 +105,8 @@ bool CCmdLineParser::parse(int argc,
                     "The maximum number of records to be outputted for each bucket. Defaults to 100, a value 0 removes the limit.")
             ("memoryUsage",
                     "Log the model memory usage at the end of the job")
+            ("host",
+                    "Run many jobs in this process, reading a JSON command to start each one from each line of input")
             ("validElasticLicenseKeyConfirmed", boost::program_options::value<bool>(),
                     "Confirmation that a valid Elastic license key is in use.")
             ;
@@ -122,12 +128,17 @@ bool CCmdLineParser::parse(int argc,
                       << ver::CBuildInfo::fullInfo() << std::endl;
             return false;
         }
-        if (vm.count("config") == 0) {
+        if (vm.count("host") > 0) {
+            isHost = true;
+        }
+        if (vm.count("config") == 0 && isHost == false) {
             std::cerr << "Error processing command line: the option '--config' is required but missing";
             return false;
         }
 
-        configFile = vm["config"].as<std::string>();
+        if (vm.count("config") > 0) {
+            configFile = vm["config"].as<std::string>();
+        }
         if (vm.count("filtersconfig") > 0) {
             filtersConfigFile = vm["filtersconfig"].as<std::string>();
         }
@@ -161,6 +172,9 @@ bool CCmdLineParser::parse(int argc,
         if (vm.count("bucketPersistInterval") > 0) {
             bucketPersistInterval = vm["bucketPersistInterval"].as<std::size_t>();
         }
+        if (vm.count("numberThreads") > 0) {
+            numberThreads = vm["numberThreads"].as<std::size_t>();
+        }
         if (vm.count("namedPipeConnectTimeout") > 0) {
             namedPipeConnectTimeout = vm["namedPipeConnectTimeout"].as<core_t::TTime>();
         }
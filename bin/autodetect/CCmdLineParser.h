@@ -51,6 +51,7 @@ public:
                       std::string& quantilesState,
                       bool& deleteStateFiles,
                       std::size_t& bucketPersistInterval,
+                      std::size_t& numberThreads,
                       core_t::TTime& namedPipeConnectTimeout,
                       std::string& inputFileName,
                       bool& isInputFileNamedPipe,
@@ -63,6 +64,7 @@ public:
                       bool& isPersistInForeground,
                       std::size_t& maxAnomalyRecords,
                       bool& memoryUsage,
+                      bool& isHost,
                       bool& validElasticLicenseKeyConfirmed);
 
 private:
@@ -15,51 +15,41 @@
 //! Expects to be streamed CSV or length encoded data on STDIN or a named pipe,
 //! and sends its JSON results to STDOUT or another named pipe.
 //!
+//! With the --host option it instead reads a command to start a job from each
+//! line of its input and runs all these jobs in the one process, each with its
+//! own named pipes.
+//!
 //! IMPLEMENTATION DECISIONS:\n
 //! Standalone program.
 //!
 #include <core/CBlockingCallCancellingTimer.h>
-#include <core/CDataAdder.h>
-#include <core/CDataSearcher.h>
-#include <core/CJsonOutputStreamWrapper.h>
 #include <core/CLogger.h>
 #include <core/CProcessPriority.h>
 #include <core/CProgramCounters.h>
-#include <core/CStringUtils.h>
+#include <core/CWordDictionary.h>
+#include <core/CZygote.h>
+#include <core/Concurrency.h>
 #include <core/CoreTypes.h>
 
 #include <ver/CBuildInfo.h>
 
-#include <model/CAnomalyDetectorModelConfig.h>
-#include <model/CLimits.h>
-#include <model/ModelTypes.h>
-
-#include <api/CAnomalyJob.h>
-#include <api/CAnomalyJobConfig.h>
-#include <api/CCmdSkeleton.h>
-#include <api/CCsvInputParser.h>
-#include <api/CFieldDataCategorizer.h>
+#include <api/CAnomalyJobHost.h>
 #include <api/CIoManager.h>
-#include <api/CJsonOutputWriter.h>
-#include <api/CLengthEncodedInputParser.h>
-#include <api/CModelSnapshotJsonWriter.h>
-#include <api/CPersistenceManager.h>
-#include <api/CSingleStreamDataAdder.h>
-#include <api/CSingleStreamSearcher.h>
-#include <api/CStateRestoreStreamFilter.h>
 
 #include <seccomp/CSystemCallFilter.h>
 
 #include "CCmdLineParser.h"
 
 #include <chrono>
-#include <cstdio>
 #include <cstdlib>
-#include <functional>
-#include <memory>
 
 int main(int argc, char** argv) {
 
+    // If started as a zygote this returns only in the forked children. Loading
+    // the word dictionary up front means they don't each have to.
+    ml::core::CZygote::serveIfRequested(
+        argc, argv, [] { ml::core::CWordDictionary::instance(); });
+
     // Register the set of counters in which this program is interested
     const ml::counter_t::TCounterTypeSet counters{
         ml::counter_t::E_TSADNumberNewPeopleNotAllowed,
@@ -83,47 +73,33 @@ int main(int argc, char** argv) {
         ml::counter_t::E_TSADNumberMemoryLimitModelCreationFailures,
         ml::counter_t::E_TSADNumberPrunedItems,
         ml::counter_t::E_TSADAssignmentMemoryBasis,
-        ml::counter_t::E_TSADOutputMemoryAllocatorUsage};
+        ml::counter_t::E_TSADOutputMemoryAllocatorUsage,
+        ml::counter_t::E_TSADOutputQueueDepth};
 
     ml::core::CProgramCounters::registerProgramCounterTypes(counters);
 
-    using TStrVec = ml::autodetect::CCmdLineParser::TStrVec;
-
     // Read command line options
-    std::string configFile;
-    std::string filtersConfigFile;
-    std::string eventsConfigFile;
-    std::string modelConfigFile;
+    ml::api::CAnomalyJobHost::SJobOptions options;
     std::string logProperties;
     std::string logPipe;
-    char delimiter{'\t'};
-    bool lengthEncodedInput{false};
-    std::string timeFormat;
-    std::string quantilesStateFile;
-    bool deleteStateFiles{false};
-    std::size_t bucketPersistInterval{0};
+    std::size_t numberThreads{1};
     ml::core_t::TTime namedPipeConnectTimeout{
         ml::core::CBlockingCallCancellingTimer::DEFAULT_TIMEOUT_SECONDS};
-    std::string inputFileName;
-    bool isInputFileNamedPipe{false};
-    std::string outputFileName;
-    bool isOutputFileNamedPipe{false};
-    std::string restoreFileName;
-    bool isRestoreFileNamedPipe{false};
-    std::string persistFileName;
-    bool isPersistFileNamedPipe{false};
-    bool isPersistInForeground{false};
-    std::size_t maxAnomalyRecords{100};
-    bool memoryUsage{false};
+    bool isHost{false};
     bool validElasticLicenseKeyConfirmed{false};
     if (ml::autodetect::CCmdLineParser::parse(
-            argc, argv, configFile, filtersConfigFile, eventsConfigFile,
-            modelConfigFile, logProperties, logPipe, delimiter, lengthEncodedInput,
-            timeFormat, quantilesStateFile, deleteStateFiles, bucketPersistInterval,
-            namedPipeConnectTimeout, inputFileName, isInputFileNamedPipe, outputFileName,
-            isOutputFileNamedPipe, restoreFileName, isRestoreFileNamedPipe,
-            persistFileName, isPersistFileNamedPipe, isPersistInForeground,
-            maxAnomalyRecords, memoryUsage, validElasticLicenseKeyConfirmed) == false) {
+            argc, argv, options.s_ConfigFile, options.s_FiltersConfigFile,
+            options.s_EventsConfigFile, options.s_ModelConfigFile, logProperties,
+            logPipe, options.s_Delimiter, options.s_LengthEncodedInput,
+            options.s_TimeFormat, options.s_QuantilesStateFile,
+            options.s_DeleteStateFiles, options.s_BucketPersistInterval,
+            numberThreads, namedPipeConnectTimeout, options.s_InputFileName,
+            options.s_IsInputFileNamedPipe, options.s_OutputFileName,
+            options.s_IsOutputFileNamedPipe, options.s_RestoreFileName,
+            options.s_IsRestoreFileNamedPipe, options.s_PersistFileName,
+            options.s_IsPersistFileNamedPipe, options.s_IsPersistInForeground,
+            options.s_MaxAnomalyRecords, options.s_MemoryUsage, isHost,
+            validElasticLicenseKeyConfirmed) == false) {
         return EXIT_FAILURE;
     }
 
@@ -132,10 +108,15 @@ int main(int argc, char** argv) {
 
     // Construct the IO manager before reconfiguring the logger, as it performs
     // std::ios actions that only work before first use
-    ml::api::CIoManager ioMgr{
-        cancellerThread,        inputFileName,         isInputFileNamedPipe,
-        outputFileName,         isOutputFileNamedPipe, restoreFileName,
-        isRestoreFileNamedPipe, persistFileName,       isPersistFileNamedPipe};
+    ml::api::CIoManager ioMgr{cancellerThread,
+                              options.s_InputFileName,
+                              options.s_IsInputFileNamedPipe,
+                              options.s_OutputFileName,
+                              options.s_IsOutputFileNamedPipe,
+                              options.s_RestoreFileName,
+                              options.s_IsRestoreFileNamedPipe,
+                              options.s_PersistFileName,
+                              options.s_IsPersistFileNamedPipe};
 
     if (cancellerThread.start() == false) {
         // This log message will probably never been seen as it will go to the
@@ -176,163 +157,22 @@ int main(int argc, char** argv) {
     // hence is done before reducing CPU priority.
     ml::core::CProcessPriority::reduceCpuPriority();
 
-    ml::api::CAnomalyJobConfig jobConfig;
-    if (jobConfig.initFromFiles(configFile, filtersConfigFile, eventsConfigFile) == false) {
-        LOG_FATAL(<< "JSON config could not be interpreted");
-        return EXIT_FAILURE;
-    }
-
-    const ml::api::CAnomalyJobConfig::CAnalysisLimits& analysisLimits =
-        jobConfig.analysisLimits();
-    ml::model::CLimits limits{isPersistInForeground};
-    limits.init(analysisLimits.categorizationExamplesLimit(),
-                analysisLimits.modelMemoryLimitMb());
-
-    const ml::api::CAnomalyJobConfig::CAnalysisConfig& analysisConfig =
-        jobConfig.analysisConfig();
-
-    bool doingCategorization{analysisConfig.categorizationFieldName().empty() == false};
-    TStrVec mutableFields;
-    if (doingCategorization) {
-        mutableFields.push_back(ml::api::CFieldDataCategorizer::MLCATEGORY_NAME);
+    if (numberThreads > 1) {
+        ml::core::startDefaultAsyncExecutor(numberThreads);
     }
 
-    ml::model::CAnomalyDetectorModelConfig modelConfig = analysisConfig.makeModelConfig();
-
-    if (!modelConfigFile.empty() && modelConfig.init(modelConfigFile) == false) {
-        LOG_FATAL(<< "ML model config file '" << modelConfigFile << "' could not be loaded");
-        return EXIT_FAILURE;
-    }
-
-    const ml::api::CAnomalyJobConfig::CModelPlotConfig& modelPlotConfig =
-        jobConfig.modelPlotConfig();
-    modelConfig.configureModelPlot(modelPlotConfig.enabled(),
-                                   modelPlotConfig.annotationsEnabled(),
-                                   modelPlotConfig.terms());
-
-    using TDataSearcherUPtr = std::unique_ptr<ml::core::CDataSearcher>;
-    const TDataSearcherUPtr restoreSearcher{[isRestoreFileNamedPipe, &ioMgr]() -> TDataSearcherUPtr {
-        if (ioMgr.restoreStream()) {
-            // Check whether state is restored from a file, if so we assume that this is a debugging case
-            // and therefore does not originate from the ML Java code.
-            if (!isRestoreFileNamedPipe) {
-                // apply a filter to overcome differences in the way persistence vs. restore works
-                auto strm = std::make_shared<boost::iostreams::filtering_istream>();
-                strm->push(ml::api::CStateRestoreStreamFilter());
-                strm->push(*ioMgr.restoreStream());
-                return std::make_unique<ml::api::CSingleStreamSearcher>(strm);
-            }
-            return std::make_unique<ml::api::CSingleStreamSearcher>(ioMgr.restoreStream());
-        }
-        return nullptr;
-    }()};
-
-    using TDataAdderUPtr = std::unique_ptr<ml::core::CDataAdder>;
-    const TDataAdderUPtr persister{[&ioMgr]() -> TDataAdderUPtr {
-        if (ioMgr.persistStream()) {
-            return std::make_unique<ml::api::CSingleStreamDataAdder>(ioMgr.persistStream());
-        }
-        return nullptr;
-    }()};
-
-    ml::core_t::TTime persistInterval{jobConfig.persistInterval()};
-    if ((bucketPersistInterval > 0 || persistInterval >= 0) && persister == nullptr) {
-        LOG_FATAL(<< "Periodic persistence cannot be enabled using the '"
-                  << ((persistInterval >= 0) ? "persistInterval" : "bucketPersistInterval")
-                  << "' argument unless a place to persist to has been specified using the 'persist' argument");
-        return EXIT_FAILURE;
-    }
-
-    using TPersistenceManagerUPtr = std::unique_ptr<ml::api::CPersistenceManager>;
-    const TPersistenceManagerUPtr persistenceManager{
-        [persistInterval, isPersistInForeground, &persister,
-         &bucketPersistInterval]() -> TPersistenceManagerUPtr {
-            if (persistInterval >= 0 || bucketPersistInterval > 0) {
-                return std::make_unique<ml::api::CPersistenceManager>(
-                    persistInterval, isPersistInForeground, *persister, bucketPersistInterval);
-            }
-            return nullptr;
-        }()};
-
-    using InputParserCUPtr = std::unique_ptr<ml::api::CInputParser>;
-    const InputParserCUPtr inputParser{[lengthEncodedInput, &mutableFields,
-                                        &ioMgr, delimiter]() -> InputParserCUPtr {
-        if (lengthEncodedInput) {
-            return std::make_unique<ml::api::CLengthEncodedInputParser>(
-                mutableFields, ioMgr.inputStream());
-        }
-        return std::make_unique<ml::api::CCsvInputParser>(
-            mutableFields, ioMgr.inputStream(), delimiter);
-    }()};
-
-    const std::string jobId{jobConfig.jobId()};
-    ml::core::CJsonOutputStreamWrapper wrappedOutputStream{ioMgr.outputStream()};
-    ml::api::CModelSnapshotJsonWriter modelSnapshotWriter{jobId, wrappedOutputStream};
-
-    // The anomaly job knows how to detect anomalies
-    ml::api::CAnomalyJob job{jobId,
-                             limits,
-                             jobConfig,
-                             modelConfig,
-                             wrappedOutputStream,
-                             std::bind(&ml::api::CModelSnapshotJsonWriter::write,
-                                       &modelSnapshotWriter, std::placeholders::_1),
-                             persistenceManager.get(),
-                             jobConfig.quantilePersistInterval(),
-                             jobConfig.dataDescription().timeField(),
-                             timeFormat,
-                             maxAnomalyRecords};
-
-    if (!quantilesStateFile.empty()) {
-        if (job.initNormalizer(quantilesStateFile) == false) {
-            LOG_FATAL(<< "Failed to restore quantiles and initialize normalizer");
+    if (isHost) {
+        // Each line of input is a command to start a job, which has its own
+        // named pipes
+        ml::api::CAnomalyJobHost host{namedPipeConnectTimeout};
+        if (host.processCommands(ioMgr.inputStream()) == false) {
+            LOG_FATAL(<< "ML anomaly detector host had failed jobs");
             return EXIT_FAILURE;
         }
-        if (deleteStateFiles) {
-            std::remove(quantilesStateFile.c_str());
-        }
-    }
-
-    // The categorizer knows how to assign categories to records
-    ml::api::CFieldDataCategorizer categorizer{
-        jobId,
-        analysisConfig,
-        limits,
-        jobConfig.dataDescription().timeField(),
-        timeFormat,
-        &job,
-        wrappedOutputStream,
-        persistenceManager.get(),
-        analysisConfig.perPartitionCategorizationStopOnWarn()};
-
-    ml::api::CDataProcessor* firstProcessor{nullptr};
-    if (doingCategorization) {
-        LOG_DEBUG(<< "Applying the categorizer for anomaly detection");
-        firstProcessor = &categorizer;
-    } else {
-        firstProcessor = &job;
-    }
-
-    if (persistenceManager != nullptr) {
-        persistenceManager->firstProcessorBackgroundPeriodicPersistFunc(std::bind(
-            &ml::api::CDataProcessor::periodicPersistStateInBackground, firstProcessor));
-
-        persistenceManager->firstProcessorForegroundPeriodicPersistFunc(std::bind(
-            &ml::api::CDataProcessor::periodicPersistStateInForeground, firstProcessor));
-    }
-
-    // The skeleton avoids the need to duplicate a lot of boilerplate code
-    ml::api::CCmdSkeleton skeleton{restoreSearcher.get(), persister.get(),
-                                   *inputParser, *firstProcessor};
-    if (skeleton.ioLoop() == false) {
-        LOG_FATAL(<< "ML anomaly detector job failed");
+    } else if (ml::api::CAnomalyJobHost::runJob(options, ioMgr) == false) {
         return EXIT_FAILURE;
     }
 
-    if (memoryUsage) {
-        job.descriptionAndDebugMemoryUsage();
-    }
-
     // Print out the runtime counters generated during this execution context
     LOG_DEBUG(<< ml::core::CProgramCounters::instance());
 
@@ -25,6 +25,8 @@
 #include <core/CLogger.h>
 #include <core/CProcessPriority.h>
 #include <core/CProgramCounters.h>
+#include <core/CWordDictionary.h>
+#include <core/CZygote.h>
 #include <core/CoreTypes.h>
 
 #include <ver/CBuildInfo.h>
@@ -54,6 +56,11 @@
 
 int main(int argc, char** argv) {
 
+    // If started as a zygote this returns only in the forked children. Loading
+    // the word dictionary up front means they don't each have to.
+    ml::core::CZygote::serveIfRequested(
+        argc, argv, [] { ml::core::CWordDictionary::instance(); });
+
     // Register the set of counters in which this program is interested
     const ml::counter_t::TCounterTypeSet counters{
         ml::counter_t::E_TSADMemoryUsage, ml::counter_t::E_TSADPeakMemoryUsage,
@@ -53,6 +53,10 @@ namespace controller {
 //! Only processes started by this controller may be killed; requests to
 //! kill other processes are ignored.
 //!
+//! Optionally, processes can be started by forking pre-initialised zygotes,
+//! which is much faster than starting them from scratch.  This makes no
+//! difference to which processes may be started or killed.
+//!
 class CCommandProcessor {
 public:
     using TStrVec = std::vector<std::string>;
@@ -63,7 +67,10 @@ public:
     static const std::string KILL;
 
 public:
-    CCommandProcessor(const TStrVec& permittedProcessPaths, std::ostream& responseStream);
+    //! Processes in \p zygoteProcessPaths are started from zygotes.
+    CCommandProcessor(const TStrVec& permittedProcessPaths,
+                      std::ostream& responseStream,
+                      const TStrVec& zygoteProcessPaths = TStrVec{});
 
     //! Action commands read from the supplied \p commandStream until
     //! end-of-file is reached.
@@ -39,6 +39,10 @@
 //! Always logs to a named pipe and accepts commands from
 //! a named pipe.
 //!
+//! If --useZygotes is specified then, on platforms which support it,
+//! autodetect, categorize, data_frame_analyzer and normalize are started
+//! by forking pre-initialised zygotes rather than from scratch.
+//!
 //! Additionally, reads from STDIN and will exit when it detects
 //! EOF on STDIN.  This is so that it can exit if the JVM that
 //! started it dies before the command named pipe is set up.
@@ -73,8 +77,9 @@ int main(int argc, char** argv) {
     std::string logPipe;
     std::string commandPipe;
     std::string outputPipe;
-    if (ml::controller::CCmdLineParser::parse(argc, argv, jvmPidStr, logPipe,
-                                              commandPipe, outputPipe) == false) {
+    bool useZygotes{false};
+    if (ml::controller::CCmdLineParser::parse(argc, argv, jvmPidStr, logPipe, commandPipe,
+                                              outputPipe, useZygotes) == false) {
         return EXIT_FAILURE;
     }
 
@@ -165,7 +170,16 @@ int main(int argc, char** argv) {
         "./autodetect", "./categorize", "./data_frame_analyzer", "./normalize",
         "./pytorch_inference"};
 
-    ml::controller::CCommandProcessor processor{permittedProcessPaths, *outputStream};
+    // pytorch_inference is excluded because libtorch may create threads when
+    // it is loaded and a zygote must be single threaded when it forks
+    ml::controller::CCommandProcessor::TStrVec zygoteProcessPaths;
+    if (useZygotes) {
+        zygoteProcessPaths = {"./autodetect", "./categorize",
+                              "./data_frame_analyzer", "./normalize"};
+    }
+
+    ml::controller::CCommandProcessor processor{permittedProcessPaths, *outputStream,
+                                                zygoteProcessPaths};
     processor.processCommands(*commandStream);
 
     cancellerThread.stop();
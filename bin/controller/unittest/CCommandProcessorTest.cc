@@ -95,6 +95,49 @@ BOOST_AUTO_TEST_CASE(testStartPermitted) {
     BOOST_REQUIRE_EQUAL(0, std::remove(OUTPUT_FILE.c_str()));
 }
 
+BOOST_AUTO_TEST_CASE(testStartPermittedWithUnavailableZygote) {
+    // The process can't run as a zygote, so it should be started from scratch
+
+    std::remove(OUTPUT_FILE.c_str());
+
+    std::ostringstream responseStream;
+    {
+        ml::controller::CCommandProcessor::TStrVec permittedPaths{PROCESS_PATH};
+        ml::controller::CCommandProcessor processor{permittedPaths, responseStream,
+                                                    permittedPaths};
+
+        std::string command{"1\t" + ml::controller::CCommandProcessor::START + '\t' + PROCESS_PATH};
+        for (std::size_t index = 0; index < std::size(PROCESS_ARGS1); ++index) {
+            command += '\t';
+            command += PROCESS_ARGS1[index];
+        }
+
+        std::istringstream commandStream{command + '\n'};
+        processor.processCommands(commandStream);
+
+        // Expect the copy to complete in less than 1 second
+        std::this_thread::sleep_for(std::chrono::seconds{1});
+
+        std::ifstream ifs{OUTPUT_FILE};
+        BOOST_TEST_REQUIRE(ifs.is_open());
+        std::string content;
+        std::getline(ifs, content);
+        ifs.close();
+
+        BOOST_REQUIRE_EQUAL(SLOGAN1, content);
+    }
+
+    std::string jsonEscapedProcessPath{PROCESS_PATH};
+    ml::core::CStringUtils::replace("\\", "\\\\", jsonEscapedProcessPath);
+    BOOST_REQUIRE_EQUAL("[{\"id\":1,\"success\":true,\"reason\":\"Process '" +
+                            jsonEscapedProcessPath +
+                            "' started\"}\n"
+                            "]",
+                        responseStream.str());
+
+    BOOST_REQUIRE_EQUAL(0, std::remove(OUTPUT_FILE.c_str()));
+}
+
 BOOST_AUTO_TEST_CASE(testStartNonPermitted) {
     std::ostringstream responseStream;
     {
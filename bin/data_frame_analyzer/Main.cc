@@ -28,6 +28,7 @@
 #include <core/CProcessPriority.h>
 #include <core/CProgramCounters.h>
 #include <core/CStringUtils.h>
+#include <core/CZygote.h>
 #include <core/Concurrency.h>
 
 #include <ver/CBuildInfo.h>
@@ -79,6 +80,9 @@ CCleanUpOnExit::TTemporaryDirectoryPtr CCleanUpOnExit::m_DataFrameDirectory{};
 }
 
 int main(int argc, char** argv) {
+    // If started as a zygote this returns only in the forked children.
+    ml::core::CZygote::serveIfRequested(argc, argv, ml::core::CZygote::TInitialiseFunc{});
+
     // Register the set of counters in which this program is interested
     const ml::counter_t::TCounterTypeSet counters{
         ml::counter_t::E_DFOEstimatedPeakMemoryUsage,
@@ -21,6 +21,7 @@
 #include <core/CBlockingCallCancellingTimer.h>
 #include <core/CLogger.h>
 #include <core/CProcessPriority.h>
+#include <core/CZygote.h>
 #include <core/CoreTypes.h>
 
 #include <ver/CBuildInfo.h>
@@ -46,6 +47,9 @@
 #include <string>
 
 int main(int argc, char** argv) {
+    // If started as a zygote this returns only in the forked children.
+    ml::core::CZygote::serveIfRequested(argc, argv, ml::core::CZygote::TInitialiseFunc{});
+
     // Read command line options
     std::string modelConfigFile;
     std::string logProperties;
@@ -145,7 +149,8 @@ int main(int argc, char** argv) {
     }()};
 
     // This object will do the work
-    ml::api::CResultNormalizer normalizer{modelConfig, *outputWriter};
+    ml::api::CResultNormalizer normalizer{modelConfig, *outputWriter,
+                                          ml::api::CResultNormalizer::DEFAULT_BATCH_SIZE};
 
     // Restore state
     if (!quantilesStateFile.empty()) {
@@ -165,6 +170,10 @@ int main(int argc, char** argv) {
         LOG_FATAL(<< "Failed to handle input to be normalized");
         return EXIT_FAILURE;
     }
+    if (normalizer.finalise() == false) {
+        LOG_FATAL(<< "Failed to write normalized results");
+        return EXIT_FAILURE;
+    }
 
     // This message makes it easier to spot process crashes in a log file - if
     // this isn't present in the log for a given PID and there's no other log
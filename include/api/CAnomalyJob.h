@@ -213,6 +213,16 @@ public:
     //! here.
     const SRestoredStateDetail& restoreStateStatus() const;
 
+private:
+    //! \brief The state of a single detector which has been extracted from
+    //! the restore stream but not yet restored.
+    struct SDetectorStateChunk {
+        TAnomalyDetectorPtr s_Detector;
+        std::string s_PartitionFieldValue;
+        std::string s_State;
+    };
+    using TDetectorStateChunkVec = std::vector<SDetectorStateChunk>;
+
 private:
     //! NULL pointer that we can take a long-lived const reference to
     static const TAnomalyDetectorPtr NULL_DETECTOR;
@@ -252,13 +262,26 @@ private:
                       std::size_t& numDetectors);
 
     //! Attempt to restore one detector from an already-created traverser.
-    bool restoreSingleDetector(core::CStateRestoreTraverser& traverser);
+    //!
+    //! If the state is to be restored in parallel the detector is created
+    //! and its state is appended to \p pendingStates for later restoration.
+    bool restoreSingleDetector(core::CStateRestoreTraverser& traverser,
+                               TDetectorStateChunkVec* pendingStates);
 
     //! Restore the detector identified by \p key and \p partitionFieldValue
     //! from \p traverser.
+    //!
+    //! If \p pendingStates is not null and the detector isn't the simple count
+    //! detector then its state is extracted and appended to \p pendingStates
+    //! rather than being restored immediately.
     bool restoreDetectorState(const model::CSearchKey& key,
                               const std::string& partitionFieldValue,
-                              core::CStateRestoreTraverser& traverser);
+                              core::CStateRestoreTraverser& traverser,
+                              TDetectorStateChunkVec* pendingStates);
+
+    //! Restore the detectors whose state is in \p pendingStates in parallel
+    //! using the default async executor.
+    bool restorePendingDetectorStates(TDetectorStateChunkVec& pendingStates);
 
     //! Persist current state in the background
     bool backgroundPersistState();
@@ -355,7 +378,8 @@ private:
 
     //! Write the pre-generated model plot to the output stream of the user's
     //! choosing: either file or streamed to the API
-    void writeOutModelPlot(const TModelPlotDataVec& modelPlotData);
+    //! This is formatted on the output stream's thread.
+    void writeOutModelPlot(TModelPlotDataVec modelPlotData);
 
     //! Write the annotations to the output stream.
     void writeOutAnnotations(const TAnnotationVec& annotations);
@@ -0,0 +1,158 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#ifndef INCLUDED_ml_api_CAnomalyJobHost_h
+#define INCLUDED_ml_api_CAnomalyJobHost_h
+
+#include <core/CBlockingCallCancellingTimer.h>
+#include <core/CoreTypes.h>
+
+#include <api/ImportExport.h>
+
+#include <cstddef>
+#include <future>
+#include <iosfwd>
+#include <list>
+#include <string>
+
+namespace ml {
+namespace api {
+class CIoManager;
+
+//! \brief
+//! Runs many anomaly detection jobs in one process.
+//!
+//! DESCRIPTION:\n
+//! Each anomaly detection job normally runs in its own autodetect process,
+//! which has its own thread pool, word dictionary, string caches and logger.
+//! For very small jobs this baseline overhead can dwarf the memory used by
+//! the models themselves. In host mode a single autodetect process reads a
+//! command for each job it should run, one JSON object per line, and runs
+//! the job alongside the others it's hosting.
+//!
+//! The command for a job has the same fields as the autodetect command line
+//! options for a single job, for example:
+//! \code
+//! {"config":"job1.json","input":"job1_input","inputIsPipe":true,
+//!  "output":"job1_output","outputIsPipe":true,"lengthEncodedInput":true}
+//! \endcode
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! Each hosted job has its own named pipes, managed by its own CIoManager,
+//! and its own CLimits, so its own CResourceMonitor and memory limit. The
+//! default async executor, word dictionary and string stores are process
+//! wide singletons and so are shared between the hosted jobs.
+//!
+//! The input parsers pull data from their streams so each hosted job runs
+//! on its own thread. These spend almost all of their time blocked reading
+//! input so they are cheap compared to one process per job.
+//!
+//! The program counters and the default random number generator used by
+//! maths::common::CSampling are also process wide. Restoring them with each
+//! hosted job would overwrite the values the other jobs are using, so while
+//! a host exists detectors neither persist nor restore them. The program
+//! counters are written once for the process when it exits. Counters which
+//! are incremented, such as the number of records handled, sum over all the
+//! hosted jobs. However, counters which are set, such as the memory usage,
+//! are overwritten by each job, so they report whichever job set them last. The jobs draw interleaved values from
+//! the shared random number generator, so a hosted job's results aren't
+//! reproducible bit for bit and don't match running it in its own process.
+//!
+//! Other state which is shared between the hosted jobs is the logger and
+//! any other singletons.
+//!
+class API_EXPORT CAnomalyJobHost {
+public:
+    //! \brief The options for running a single anomaly detection job.
+    struct API_EXPORT SJobOptions {
+        std::string s_ConfigFile;
+        std::string s_FiltersConfigFile;
+        std::string s_EventsConfigFile;
+        std::string s_ModelConfigFile;
+        char s_Delimiter{'\t'};
+        bool s_LengthEncodedInput{false};
+        std::string s_TimeFormat;
+        std::string s_QuantilesStateFile;
+        bool s_DeleteStateFiles{false};
+        std::size_t s_BucketPersistInterval{0};
+        std::string s_InputFileName;
+        bool s_IsInputFileNamedPipe{false};
+        std::string s_OutputFileName;
+        bool s_IsOutputFileNamedPipe{false};
+        std::string s_RestoreFileName;
+        bool s_IsRestoreFileNamedPipe{false};
+        std::string s_PersistFileName;
+        bool s_IsPersistFileNamedPipe{false};
+        bool s_IsPersistInForeground{false};
+        std::size_t s_MaxAnomalyRecords{100};
+        bool s_MemoryUsage{false};
+    };
+
+public:
+    //! Turns off persisting the process wide statics with each job.
+    explicit CAnomalyJobHost(core_t::TTime namedPipeConnectTimeout =
+                                 core::CBlockingCallCancellingTimer::DEFAULT_TIMEOUT_SECONDS);
+
+    //! Waits for all the hosted jobs to finish and turns persisting the
+    //! process wide statics back on.
+    ~CAnomalyJobHost();
+
+    CAnomalyJobHost(const CAnomalyJobHost&) = delete;
+    CAnomalyJobHost& operator=(const CAnomalyJobHost&) = delete;
+
+    //! Start a job for each command read from \p commandStream until it's
+    //! exhausted and then wait for all the hosted jobs to finish.
+    //!
+    //! \return True if every command was valid and every job succeeded.
+    bool processCommands(std::istream& commandStream);
+
+    //! Start running a job with \p options on a new thread.
+    void startJob(const SJobOptions& options);
+
+    //! Wait for all the hosted jobs to finish.
+    //!
+    //! \return True if every job succeeded.
+    bool waitForJobs();
+
+    //! Get the number of jobs which haven't been waited for yet.
+    std::size_t numberJobs() const;
+
+    //! Parse the command \p command to start a job into \p options.
+    static bool parseJobOptions(const std::string& command, SJobOptions& options);
+
+    //! Run the job with \p options to completion on the calling thread using
+    //! streams from \p ioMgr, which must already have been initialised.
+    static bool runJob(const SJobOptions& options, CIoManager& ioMgr);
+
+private:
+    using TBoolFutureList = std::list<std::future<bool>>;
+
+private:
+    //! Run the job with \p options on the calling thread, including setting
+    //! up its streams.
+    bool runHostedJob(const SJobOptions& options) const;
+
+    //! Remove any jobs which have finished.
+    void reapFinishedJobs();
+
+private:
+    //! The timeout for connecting each hosted job's named pipes.
+    core_t::TTime m_NamedPipeConnectTimeout;
+
+    //! The results of the running hosted jobs.
+    TBoolFutureList m_Jobs;
+
+    //! The number of hosted jobs which have failed.
+    std::size_t m_NumberFailedJobs{0};
+};
+}
+}
+
+#endif // INCLUDED_ml_api_CAnomalyJobHost_h
@@ -125,6 +125,9 @@ protected:
     TWriter* writer();
     void memoryReestimate(std::int64_t memoryReestimate);
     void memoryStatus(EMemoryStatus status);
+    //! Write the statistics for the parallel loops run since they were last
+    //! written to \p parentObject.
+    void writeParallelForEachStats(json::object& parentObject);
 
 private:
     static const std::string NO_TASK;
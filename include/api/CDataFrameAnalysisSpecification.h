@@ -76,6 +76,7 @@ public:
     static const std::string MISSING_FIELD_VALUE;
     static const std::string CATEGORICAL_FIELD_NAMES;
     static const std::string DISK_USAGE_ALLOWED;
+    static const std::string RECORD_PARALLEL_LOOP_STATS;
     static const std::string ANALYSIS;
     static const std::string NAME;
     static const std::string PARAMETERS;
@@ -168,6 +169,10 @@ public:
     //! fit in memory.
     bool diskUsageAllowed() const;
 
+    //! \return True if the analysis should record per call site statistics
+    //! for the adaptively partitioned parallel loops.
+    bool recordParallelLoopStats() const;
+
     //! \return The temporary directory if this analysis is using disk storage.
     const std::string& temporaryDirectory() const;
 
@@ -210,6 +215,7 @@ private:
     std::string m_MissingFieldValue;
     TStrVec m_CategoricalFieldNames;
     bool m_DiskUsageAllowed;
+    bool m_RecordParallelLoopStats = false;
     // TODO Sparse table support
     // double m_TableLoadFactor = 0.0;
     TRunnerFactoryUPtrVec m_RunnerFactories;
@@ -15,17 +15,18 @@
 #include <api/ImportExport.h>
 
 #include <core/CBoostJsonConcurrentLineWriter.h>
+#include <core/CDataFrame.h>
 
 #include <cinttypes>
 #include <cstddef>
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
 
 namespace ml {
 namespace core {
-class CDataFrame;
 class CJsonOutputStreamWrapper;
 class CTemporaryDirectory;
 }
@@ -34,9 +35,15 @@ class CDataFrameAnalysisRunner;
 class CDataFrameAnalysisSpecification;
 
 //! \brief Handles input to the data_frame_analyzer command.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! Rows are gathered into blocks. The numeric values of a full block are
+//! parsed in parallel while the next block is read, then the block is
+//! written to the data frame, in order, on the input thread.
 class API_EXPORT CDataFrameAnalyzer {
 public:
     using TStrVec = std::vector<std::string>;
+    using TStrVecVec = std::vector<TStrVec>;
     using TPtrdiffVec = std::vector<std::ptrdiff_t>;
     using TPtrdiffVecUPtr = std::unique_ptr<TPtrdiffVec>;
     using TJsonOutputStreamWrapperUPtr = std::unique_ptr<core::CJsonOutputStreamWrapper>;
@@ -93,6 +100,10 @@ private:
     void initializeDataFrameColumnMap(TStrVec columnNames);
     void validateCategoricalColumnsMatch() const;
     void addRowToDataFrame(const TStrVec& fieldValues);
+    std::size_t rowBlockCapacity() const;
+    core::CDataFrame::SRowFieldLayout rowFieldLayout() const;
+    void parseRowBlock();
+    void writeParsedRowBlock();
     void writeResultsOf(const CDataFrameAnalysisRunner& analysis,
                         core::CBoostJsonConcurrentLineWriter& writer) const;
     void writeInferenceModel(const CDataFrameAnalysisRunner& analysis,
@@ -112,6 +123,16 @@ private:
     TDataFrameAnalysisSpecificationUPtr m_AnalysisSpecification;
     TDataFrameUPtr m_DataFrame;
     TPtrdiffVecUPtr m_DataFrameColumnMap;
+    //! \name Row Blocks
+    //@{
+    //! The block of rows being read.
+    TStrVecVec m_RowBlock;
+    std::size_t m_RowBlockSize{0};
+    //! The block of rows being parsed.
+    TStrVecVec m_ParsingRowBlock;
+    core::CDataFrame::SParsedRows m_ParsedRows;
+    std::future<void> m_RowBlockParsed;
+    //@}
     TTemporaryDirectoryPtr m_DataFrameDirectory;
     TJsonOutputStreamWrapperUPtrSupplier m_ResultsStreamSupplier;
 };
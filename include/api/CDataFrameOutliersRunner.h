@@ -31,6 +31,7 @@ public:
     static const std::string COMPUTE_FEATURE_INFLUENCE;
     static const std::string FEATURE_INFLUENCE_THRESHOLD;
     static const std::string OUTLIER_FRACTION;
+    static const std::string NEIGHBOR_SEARCH_APPROXIMATION;
 
 public:
     //! This is not intended to be called directly: use CDataFrameOutliersRunnerFactory.
@@ -93,6 +94,10 @@ private:
 
     //! The fraction of true outliers amoung the points.
     double m_OutlierFraction = 0.05;
+
+    //! The relative error in nearest neighbour distances we accept in order
+    //! to speed up neighbour searches; zero means search for exact neighbours.
+    double m_NeighborSearchApproximation = 0.0;
     //@}
 
     CDataFrameOutliersInstrumentation m_Instrumentation;
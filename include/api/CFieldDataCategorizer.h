@@ -74,6 +74,23 @@ class CPersistenceManager;
 //! lower level model library categorizer.  This is keyed on
 //! the empty string in the map of lower level categorizers.
 //!
+//! When per-partition categorization is used and the default async
+//! executor has more than one thread, records are buffered and the
+//! partitions' categorizers are run concurrently on each batch.  The
+//! categorizers share no mutable state, and the records in each
+//! partition are categorized in the order they were received.  Mapping
+//! to global category IDs, writing category definitions and passing
+//! records on to the chained processor all happen afterwards on the
+//! calling thread in the order the records were received, so the records
+//! get the same categories, definitions are written for the same categories
+//! and the state is the same as if the records had been categorized one at
+//! a time.  However, a category definition or urgent categorizer stats
+//! written part way through a batch reflect all the batch's records for
+//! that partition, so their counts and terms may be ahead of the record
+//! which triggered the write.  Also, changes to the memory status, and to
+//! the categorization status when stopping on warn status, only take
+//! effect at the start of the next batch.
+//!
 class API_EXPORT CFieldDataCategorizer : public CDataProcessor {
 public:
     //! The name of the field where the category is going to be written
@@ -87,6 +104,10 @@ public:
     //! The current state version
     static const std::string STATE_VERSION;
 
+    //! The maximum number of records to buffer for concurrent per-partition
+    //! categorization.
+    static const std::size_t MAX_BUFFERED_RECORDS;
+
 public:
     // A type of token list data categorizer that DOESN'T exclude fields from
     // its analysis
@@ -164,7 +185,47 @@ private:
     using TStrSingleFieldDataCategorizerUPtrMap =
         std::map<std::string, TSingleFieldDataCategorizerUPtr>;
 
+    //! \brief A record buffered for concurrent categorization.
+    struct SBufferedRecord {
+        TStrStrUMap s_Fields;
+        TOptionalTime s_Time;
+        //! The raw message, which is a field of s_Fields.
+        const std::string* s_RawMessage = nullptr;
+        //! The message after applying the categorization filter.
+        std::string s_FilteredMessage;
+        CSingleFieldDataCategorizer* s_Categorizer = nullptr;
+        model::CLocalCategoryId s_LocalCategoryId;
+        CGlobalCategoryId s_GlobalCategoryId;
+    };
+    using TBufferedRecordVec = std::vector<SBufferedRecord>;
+
 private:
+    //! Get the categorizer for a record and the value of its categorization
+    //! field.  If the record can't be categorized this returns nullptr and
+    //! sets \p globalCategoryId to the category to assign to the record.
+    CSingleFieldDataCategorizer* categorizerForRecord(const TStrStrUMap& dataRowFields,
+                                                      const std::string*& fieldValue,
+                                                      CGlobalCategoryId& globalCategoryId);
+
+    //! Set the category of a record and pass it on to the chained processor.
+    //! \p outputFieldCategory is where to write the category, if anywhere.
+    bool passOnRecord(CGlobalCategoryId globalCategoryId,
+                      const TStrStrUMap& dataRowFields,
+                      const TOptionalTime& time,
+                      std::string* outputFieldCategory);
+
+    //! Should records be buffered for concurrent categorization?
+    bool isBufferingRecords() const;
+
+    //! Buffer a copy of a record for concurrent categorization, handling the
+    //! buffered records if the buffer is full.
+    bool bufferRecord(const TStrStrUMap& dataRowFields, const TOptionalTime& time);
+
+    //! Categorize the buffered records, running the categorizers for different
+    //! partitions concurrently, and pass them on in the order they were
+    //! received.
+    bool handleBufferedRecords();
+
     //! Get the appropriate categorizer key from the given input record
     const std::string& categorizerKeyForRecord(const TStrStrUMap& dataRowFields);
 
@@ -277,6 +338,14 @@ private:
     //! on each invocation of the program if the same partition values are seen
     //! again.
     TStrUSet m_CategorizerAllocationFailedPartitions;
+
+    //! Records buffered for concurrent categorization.  Only the first
+    //! m_NumberBufferedRecords are in use, the rest are retained so their
+    //! storage can be reused.
+    TBufferedRecordVec m_BufferedRecords;
+
+    //! The number of records buffered for concurrent categorization.
+    std::size_t m_NumberBufferedRecords = 0;
 };
 }
 }
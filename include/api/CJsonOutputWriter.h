@@ -13,6 +13,7 @@
 
 #include <core/CBoostJsonConcurrentLineWriter.h>
 #include <core/CSmallVector.h>
+#include <core/CStringBufWriter.h>
 #include <core/CoreTypes.h>
 
 #include <model/CCategoryExamplesCollector.h>
@@ -24,6 +25,7 @@
 #include <api/ImportExport.h>
 
 #include <cstdint>
+#include <future>
 #include <map>
 #include <memory>
 #include <optional>
@@ -33,6 +35,7 @@
 
 namespace ml {
 namespace core {
+class CBoostJsonPoolAllocator;
 class CJsonOutputStreamWrapper;
 }
 namespace model {
@@ -72,6 +75,11 @@ namespace api {
 //!
 //! Empty string fields are not written to the output.
 //!
+//! Formatting a batch of results is done on the thread which writes to the
+//! output stream, so it overlaps with processing the next bucket.  The writer
+//! is double buffered: the documents for at most one batch are in flight and
+//! endOutputBatch() waits for them to be written before handing over another.
+//!
 //! Memory for values added to the output documents is allocated from a pool (to
 //! reduce allocation cost and memory fragmentation).  This pool is cleared
 //! between buckets to avoid excessive accumulation of memory over long periods.
@@ -283,12 +291,20 @@ private:
     void popAllocator();
 
 private:
+    //! Add the fields which are common to all documents in a bucket and
+    //! order its records ready for writing.
+    void prepareBucket(bool isInterim, core_t::TTime bucketTime, SBucketData& bucketData);
+
     //! Write out all the JSON documents that have been built up for
     //! a particular bucket
-    void writeBucket(bool isInterim,
+    void writeBucket(core::CStringBufWriter& writer,
+                     bool isInterim,
                      core_t::TTime bucketTime,
-                     SBucketData& bucketData,
-                     std::uint64_t bucketProcessingTime);
+                     const SBucketData& bucketData,
+                     std::uint64_t bucketProcessingTime) const;
+
+    //! Wait until the last batch has been written and release its documents.
+    void waitForPendingBatch();
 
     //! Add the fields for a metric detector
     void addMetricFields(const CHierarchicalResultsWriter::TResults& results,
@@ -323,6 +339,9 @@ private:
     //! The job ID
     std::string m_JobId;
 
+    //! The output stream
+    core::CJsonOutputStreamWrapper& m_OutputStream;
+
     //! JSON line writer
     core::CBoostJsonConcurrentLineWriter m_Writer;
 
@@ -346,6 +365,17 @@ private:
     //! m_JsonPoolAllocator.  (Hence this is declared after the memory pool
     //! so that it's destroyed first when the destructor runs.)
     TTimeBucketDataMap m_BucketDataByTime;
+
+    //! The allocator which owns the memory of the documents in the batch
+    //! being written.  Holding it keeps the documents alive until they've
+    //! been written, even if the allocator is removed from m_Writer.
+    std::shared_ptr<core::CBoostJsonPoolAllocator> m_PendingAllocator;
+
+    //! Bucket data in the batch being written.
+    TTimeBucketDataMap m_PendingBucketData;
+
+    //! Ready when the batch being written has been written.
+    std::future<void> m_PendingBatch;
 };
 }
 }
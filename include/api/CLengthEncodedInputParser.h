@@ -21,6 +21,9 @@
 #include <string>
 
 namespace ml {
+namespace core {
+class CPipeReadBuffer;
+}
 namespace api {
 
 //! \brief
@@ -75,6 +78,10 @@ namespace api {
 //! interfacing with Java (which doesn't have built-in unsigned
 //! types) easier.
 //!
+//! If the stream reads from a core::CPipeReadBuffer the records are
+//! parsed directly from its buffer rather than being copied into a
+//! small work buffer first.
+//!
 class API_EXPORT CLengthEncodedInputParser : public CInputParser {
 public:
     //! Construct with an input stream to be parsed.  Once a stream is
@@ -146,6 +153,9 @@ private:
     //! Refill the working buffer from the stream
     std::ptrdiff_t refillBuffer();
 
+    //! Check if we've reached the end of the stream.
+    bool endOfStream() const;
+
 private:
     //! Allocate this much memory for the working buffer
     static const std::size_t WORK_BUFFER_SIZE;
@@ -153,6 +163,10 @@ private:
     //! Reference to the stream we're going to read from
     std::istream& m_StrmIn;
 
+    //! The stream's buffer if it reads from a pipe, in which case the
+    //! working buffer pointers point into it.
+    core::CPipeReadBuffer* m_PipeBuffer;
+
     using TScopedCharArray = boost::scoped_array<char>;
 
     //! The working buffer is also held as a member to avoid constantly
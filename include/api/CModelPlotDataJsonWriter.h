@@ -22,6 +22,7 @@
 #include <boost/json.hpp>
 
 #include <iosfwd>
+#include <optional>
 #include <string>
 
 namespace json = boost::json;
@@ -79,6 +80,9 @@ public:
     //! Constructor that causes to be written to the specified stream
     explicit CModelPlotDataJsonWriter(core::CJsonOutputStreamWrapper& outStream);
 
+    //! Constructor that causes to be written using the specified writer
+    explicit CModelPlotDataJsonWriter(core::CStringBufWriter& writer);
+
     void writeFlat(const std::string& jobId, const model::CModelPlotData& data);
 
 private:
@@ -95,8 +99,11 @@ private:
                       json::object& doc);
 
 private:
+    //! Owned JSON line writer if constructed with a stream
+    std::optional<core::CBoostJsonConcurrentLineWriter> m_ConcurrentWriter;
+
     //! JSON line writer
-    core::CBoostJsonConcurrentLineWriter m_Writer;
+    core::CStringBufWriter& m_Writer;
 };
 }
 }
@@ -20,6 +20,9 @@
 #include <utility>
 
 namespace ml {
+namespace core {
+class CPipeReadBuffer;
+}
 namespace api {
 
 //! \brief
@@ -36,6 +39,9 @@ namespace api {
 //! The original use case was to factor out commonality from the
 //! ND-JSON parser and (now deleted) newline delimited XML parser.
 //!
+//! If the stream reads from a core::CPipeReadBuffer lines are found and
+//! zero terminated directly in its buffer, so the data is never copied.
+//!
 class API_EXPORT CNdInputParser : public CInputParser {
 public:
     //! Construct with an input stream to be parsed.  Once a stream is
@@ -65,6 +71,10 @@ protected:
     //! changed.
     void resetBuffer();
 
+private:
+    //! Implements parseLine() for streams which read from a pipe.
+    TCharPSizePr parseLineInPlace();
+
 private:
     //! Allocate this much memory for the working buffer
     static const std::size_t WORK_BUFFER_SIZE;
@@ -72,6 +82,9 @@ private:
     //! Reference to the stream we're going to read from
     std::istream& m_StrmIn;
 
+    //! The stream's buffer if it reads from a pipe.
+    core::CPipeReadBuffer* m_PipeBuffer;
+
     using TScopedCharArray = boost::scoped_array<char>;
 
     //! The working buffer is a raw character array rather than a string to
@@ -22,6 +22,7 @@
 
 #include <boost/unordered_map.hpp>
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -48,6 +49,12 @@ namespace api {
 //! Does not support processor chaining functionality as it is unlikely
 //! that this class would ever be chained to another data processor.
 //!
+//! Records can be buffered and normalized in batches.  The records in a
+//! batch are grouped by the normalizer they use and each group is normalized
+//! in one pass, which means the parts of the calculation that only depend on
+//! the normalizer are done once per group rather than once per record.  The
+//! results are always written in the order the records were received.
+//!
 class API_EXPORT CResultNormalizer {
 public:
     //! Field names used in records to be normalised
@@ -70,6 +77,9 @@ public:
 
     static const std::string ZERO;
 
+    //! The default number of records to buffer when normalizing in batches.
+    static const std::size_t DEFAULT_BATCH_SIZE;
+
 public:
     using TStrVec = std::vector<std::string>;
     using TStrVecItr = TStrVec::iterator;
@@ -80,8 +90,12 @@ public:
     using TStrStrUMapCItr = TStrStrUMap::const_iterator;
 
 public:
+    //! \param[in] batchSize The number of records to buffer before they
+    //! are normalized.  If this is greater than one then finalise() must
+    //! be called after the last record.
     CResultNormalizer(const model::CAnomalyDetectorModelConfig& modelConfig,
-                      CSimpleOutputWriter& outputWriter);
+                      CSimpleOutputWriter& outputWriter,
+                      std::size_t batchSize = 1);
 
     //! Initialise the system change normalizer
     bool initNormalizer(const std::string& stateFileName);
@@ -89,7 +103,37 @@ public:
     //! Handle a record to be normalized
     bool handleRecord(const TStrStrUMap& dataRowFields);
 
+    //! Normalize and write any records which are still buffered.
+    bool finalise();
+
+private:
+    using TOptionalStr = std::optional<std::string>;
+    using TSizeVec = std::vector<std::size_t>;
+
+    //! \brief A record waiting to be normalized.
+    struct SBufferedRecord {
+        TStrStrUMap s_Fields;
+        bool s_IsNormalizable{false};
+        std::string s_Level;
+        TOptionalStr s_PartitionName{std::in_place};
+        TOptionalStr s_PartitionValue{std::in_place};
+        TOptionalStr s_PersonName{std::in_place};
+        TOptionalStr s_PersonValue{std::in_place};
+        std::string s_Function;
+        std::string s_ValueFieldName;
+        double s_Score{0.0};
+        const model::CAnomalyScore::CNormalizer* s_Normalizer{nullptr};
+    };
+    using TBufferedRecordVec = std::vector<SBufferedRecord>;
+
 private:
+    //! Normalize and write the buffered records.
+    bool handleBufferedRecords();
+
+    //! Find the normalizer for \p record.
+    const model::CAnomalyScore::CNormalizer*
+    levelNormalizer(const SBufferedRecord& record) const;
+
     bool parseDataFields(const TStrStrUMap& dataRowFields,
                          std::string& level,
                          std::string& partitionName,
@@ -133,6 +177,16 @@ private:
 
     //! The hierarchical results normalizer
     model::CHierarchicalResultsNormalizer m_Normalizer;
+
+    //! The number of records to normalize in each batch.
+    std::size_t m_BatchSize;
+
+    //! The records waiting to be normalized.  Entries are reused between
+    //! batches to avoid reallocating their fields.
+    TBufferedRecordVec m_BufferedRecords;
+
+    //! The number of entries in m_BufferedRecords in the current batch.
+    std::size_t m_NumberBufferedRecords{0};
 };
 }
 }
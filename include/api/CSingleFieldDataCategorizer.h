@@ -77,6 +77,26 @@ public:
                              model::CResourceMonitor& resourceMonitor,
                              CJsonOutputWriter& jsonOutputWriter);
 
+    //! Compute the local category of a string.  This is the first half of
+    //! computeAndUpdateCategory().  It only modifies the state of the wrapped
+    //! categorizer, so may be called concurrently for different objects.
+    model::CLocalCategoryId computeCategory(bool isDryRun,
+                                            const model::CDataCategorizer::TStrStrUMap& fields,
+                                            const std::string& messageToCategorize,
+                                            const std::string& rawMessage);
+
+    //! Map a local category computed by computeCategory() to its global
+    //! category, update the category's examples and if it changes as a
+    //! result write it to the output.  This is the second half of
+    //! computeAndUpdateCategory().  Since global category IDs may be shared
+    //! between objects, calls to this must be made in the order the strings
+    //! were received.
+    CGlobalCategoryId updateCategory(model::CLocalCategoryId localCategoryId,
+                                     const TOptionalTime& messageTime,
+                                     const std::string& rawMessage,
+                                     model::CResourceMonitor& resourceMonitor,
+                                     CJsonOutputWriter& jsonOutputWriter);
+
     //! Make a function that can be called later to persist state in the
     //! foreground, i.e. in the knowledge that no other thread will be
     //! accessing the data structures this method accesses.
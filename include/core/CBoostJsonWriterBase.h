@@ -469,18 +469,7 @@ public:
         case json::kind::null:
             return this->onNull();
         case json::kind::object:
-            if (this->onObjectBegin() == false) {
-                return false;
-            }
-            for (const auto& member : doc.as_object()) {
-                if (this->onKey(member.key()) == false) {
-                    return false;
-                }
-                if (this->write(member.value()) == false) {
-                    return false;
-                }
-            }
-            return this->onObjectEnd(doc.as_object().size());
+            return this->write(doc.as_object());
         case json::kind::array:
             if (this->onArrayBegin() == false) {
                 return false;
@@ -505,6 +494,25 @@ public:
         return true;
     }
 
+    //! write the boost::json object document to the output stream
+    //! \p[in] doc boost::json object to write out
+    //! \note This only reads \p doc, whereas converting it to a value would
+    //! copy it using its allocator.
+    bool write(const TDocument& doc) {
+        if (this->onObjectBegin() == false) {
+            return false;
+        }
+        for (const auto& member : doc) {
+            if (this->onKey(member.key()) == false) {
+                return false;
+            }
+            if (this->write(member.value()) == false) {
+                return false;
+            }
+        }
+        return this->onObjectEnd(doc.size());
+    }
+
     //! Return a new boost::json document
     TDocument makeDoc() const { return TDocument(this->getStoragePointer()); }
 
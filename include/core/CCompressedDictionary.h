@@ -17,6 +17,7 @@
 #include <core/CStringUtils.h>
 
 #include <boost/operators.hpp>
+#include <boost/unordered/unordered_flat_map_fwd.hpp>
 #include <boost/unordered/unordered_map_fwd.hpp>
 #include <boost/unordered/unordered_set_fwd.hpp>
 
@@ -25,6 +26,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 namespace ml {
@@ -140,9 +142,13 @@ public:
         explicit CTranslator(const TUInt64Array& seeds) : m_Hashes{seeds} {}
 
         void add(const std::string& value) {
+            this->add(std::string_view{value});
+        }
+
+        void add(std::string_view value) {
             for (auto& hash : m_Hashes) {
                 hash = CHashing::safeMurmurHash64(
-                    value.c_str(), static_cast<int>(value.size()), hash);
+                    value.data(), static_cast<int>(value.size()), hash);
             }
         }
 
@@ -174,8 +180,13 @@ public:
     };
 
     //! \brief A fast hash of a dictionary word.
+    //!
+    //! The word is a murmur hash so is already well mixed and the open
+    //! addressing containers can use it without further mixing.
     class CHash {
     public:
+        using is_avalanching = void;
+
         inline std::size_t operator()(const CWord& word) const {
             return word.hash();
         }
@@ -195,6 +206,11 @@ public:
     template<typename T>
     using TWordTUMap = boost::unordered_map<CWord, T, CHash>;
 
+    //! A template typedef of an open addressing map from words to objects
+    //! of type T. This should be preferred when T is small.
+    template<typename T>
+    using TWordTUFlatMap = boost::unordered_flat_map<CWord, T, CHash>;
+
 public:
     CCompressedDictionary() {
         // 472882027 and 982451653 are prime numbers, so repeatedly
@@ -210,7 +226,7 @@ public:
     }
 
     //! Translate \p word to a dictionary word.
-    CWord word(const std::string& word) const {
+    CWord word(std::string_view word) const {
         CTranslator translator{m_Seeds};
         translator.add(word);
         return translator.word();
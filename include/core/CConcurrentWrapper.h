@@ -70,6 +70,9 @@ public:
     //! Get the memory used by this component.
     std::size_t memoryUsage() const { return m_Queue.memoryUsage(); }
 
+    //! Get the number of tasks waiting to be executed.
+    std::size_t size() const { return m_Queue.size(); }
+
 private:
     //! Queue for the tasks
     mutable CConcurrentQueue<std::function<void()>> m_Queue;
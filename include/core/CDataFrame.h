@@ -44,12 +44,100 @@ using TFloatVecItr = TFloatVec::iterator;
 using TInt32Vec = std::vector<std::int32_t>;
 using TInt32VecCItr = TInt32Vec::const_iterator;
 
+//! \brief An iterator over the indices of the masked rows.
+//!
+//! DESCRIPTION:\n
+//! This either reads the indices directly from the mask's run length encoding
+//! or from a sorted array of the indices. Sparse masks, such as the row masks
+//! of deep tree nodes, have many short runs and we want to avoid decoding all
+//! runs before a slice just to find its first masked row. The array lets each
+//! slice binary search for its first masked row and then scan contiguously.
+class CORE_EXPORT CMaskedRowIterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::size_t*;
+    using reference = std::size_t&;
+    using TUInt32Vec = std::vector<std::uint32_t>;
+    using TUInt32VecCItr = TUInt32Vec::const_iterator;
+    using TOneBitIndexConstIterator = CPackedBitVector::COneBitIndexConstIterator;
+
+public:
+    CMaskedRowIterator() = default;
+    explicit CMaskedRowIterator(const TOneBitIndexConstIterator& oneBit)
+        : m_OneBit{oneBit} {}
+    explicit CMaskedRowIterator(const TUInt32VecCItr& index)
+        : m_Index{index}, m_Indexed{true} {}
+
+    std::size_t operator*() const {
+        return m_Indexed ? static_cast<std::size_t>(*m_Index) : *m_OneBit;
+    }
+
+    bool operator==(const CMaskedRowIterator& rhs) const {
+        return m_Indexed ? m_Index == rhs.m_Index : m_OneBit == rhs.m_OneBit;
+    }
+    bool operator!=(const CMaskedRowIterator& rhs) const {
+        return (*this == rhs) == false;
+    }
+
+    CMaskedRowIterator& operator++() {
+        if (m_Indexed) {
+            ++m_Index;
+        } else {
+            ++m_OneBit;
+        }
+        return *this;
+    }
+
+    //! Advance to the first masked row whose index is at least \p index.
+    void advanceTo(std::size_t index, const CMaskedRowIterator& end);
+
+private:
+    TOneBitIndexConstIterator m_OneBit;
+    TUInt32VecCItr m_Index;
+    bool m_Indexed{false};
+};
+
+//! \brief The masked rows of a single read of the data frame.
+//!
+//! DESCRIPTION:\n
+//! This chooses how to iterate over the masked rows based on the fraction of
+//! rows which are masked. If it is small we decode the mask once into a sorted
+//! array of row indices which all threads reading the data frame share.
+class CORE_EXPORT CMaskedRows {
+public:
+    //! The maximum fraction of rows in the mask for which we use an array of
+    //! the row indices.
+    static const double MAXIMUM_FRACTION_TO_INDEX;
+
+public:
+    explicit CMaskedRows(const CPackedBitVector& rowMask);
+
+    CMaskedRows(const CMaskedRows&) = delete;
+    CMaskedRows& operator=(const CMaskedRows&) = delete;
+
+    //! Check if we decoded the mask into an array of row indices.
+    bool indexed() const { return m_Indexed; }
+
+    CMaskedRowIterator begin() const;
+    CMaskedRowIterator end() const;
+
+private:
+    using TUInt32Vec = CMaskedRowIterator::TUInt32Vec;
+
+private:
+    const CPackedBitVector* m_RowMask;
+    TUInt32Vec m_Index;
+    bool m_Indexed{false};
+};
+
 //! \brief A callback used to iterate over only the masked rows.
 class CORE_EXPORT CPopMaskedRow {
 public:
     CPopMaskedRow(std::size_t endSliceRows,
-                  CPackedBitVector::COneBitIndexConstIterator& maskedRow,
-                  const CPackedBitVector::COneBitIndexConstIterator& endMaskedRows)
+                  CMaskedRowIterator& maskedRow,
+                  const CMaskedRowIterator& endMaskedRows)
         : m_EndSliceRows{endSliceRows}, m_MaskedRow{&maskedRow}, m_EndMaskedRows{&endMaskedRows} {
     }
 
@@ -61,8 +149,8 @@ public:
 
 private:
     std::size_t m_EndSliceRows;
-    CPackedBitVector::COneBitIndexConstIterator* m_MaskedRow;
-    const CPackedBitVector::COneBitIndexConstIterator* m_EndMaskedRows;
+    CMaskedRowIterator* m_MaskedRow;
+    const CMaskedRowIterator* m_EndMaskedRows;
 };
 
 using TOptionalPopMaskedRow = std::optional<CPopMaskedRow>;
@@ -483,6 +571,74 @@ public:
                           const TPtrdiffVec* columnMap = nullptr,
                           const std::string* hash = nullptr);
 
+    //! \brief Describes where the values of each column are in the rows of
+    //! field values passed to parseRows and writeParsedRows.
+    struct CORE_EXPORT SRowFieldLayout {
+        //! The number of columns each row has.
+        std::size_t numberColumns() const;
+
+        //! Get the value of \p column in \p fieldValues.
+        const std::string& columnValue(const TStrVec& fieldValues,
+                                       std::size_t column,
+                                       const std::string& missing) const;
+
+        //! The position of the first column value in the fields.
+        std::size_t s_BeginColumnValues{0};
+        //! The position of the end of the column values in the fields.
+        std::size_t s_EndColumnValues{0};
+        //! If non-null defines a map between the column values and their
+        //! position in the data frame. Negative values denote missing columns.
+        const TPtrdiffVec* s_ColumnMap{nullptr};
+        //! The position of the document hash in the fields or -1 if there
+        //! isn't one.
+        std::ptrdiff_t s_DocHashField{-1};
+    };
+
+    //! \brief The values of a block of rows which have been parsed by
+    //! parseRows and are waiting to be written by writeParsedRows.
+    struct SParsedRows {
+        std::size_t s_NumberRows{0};
+        //! The row major numeric column values. Categorical column values are
+        //! encoded when the rows are written.
+        TFloatVec s_Values;
+        TInt32Vec s_DocHashes;
+        std::uint64_t s_MissingValueCount{0};
+        std::uint64_t s_BadValueCount{0};
+        std::uint64_t s_BadDocHashCount{0};
+    };
+
+    //! Parses the numeric column values and document hashes of the first
+    //! \p numberRows of \p rows in parallel.
+    //!
+    //! This together with writeParsedRows is equivalent to calling
+    //! parseAndWriteRow for each row. It is split in two because only the
+    //! encoding of categorical values, which depends on the order in which
+    //! the categories are seen, and the writing of rows need to happen
+    //! sequentially. This only reads state of the data frame which doesn't
+    //! change while rows are being written, so it can run concurrently with
+    //! reading more rows.
+    //!
+    //! \param[in] numberThreads The target number of threads to use.
+    //! \param[in] rows The field values of each row.
+    //! \param[in] numberRows The number of rows of \p rows to parse.
+    //! \param[in] layout Describes where the column values are in each row.
+    //! \param[out] parsed Filled in with the parsed values.
+    void parseRows(std::size_t numberThreads,
+                   const TStrVecVec& rows,
+                   std::size_t numberRows,
+                   const SRowFieldLayout& layout,
+                   SParsedRows& parsed) const;
+
+    //! Encodes the categorical column values of rows parsed by parseRows and
+    //! writes them in order via writeRow.
+    //!
+    //! \param[in] rows The field values of each row passed to parseRows.
+    //! \param[in] layout Describes where the column values are in each row.
+    //! \param[in] parsed The values parsed by parseRows.
+    void writeParsedRows(const TStrVecVec& rows,
+                         const SRowFieldLayout& layout,
+                         const SParsedRows& parsed);
+
     //! This writes a single row of the data frame via a callback.
     //!
     //! If asynchronous read and write to store was selected in the constructor
@@ -565,6 +721,7 @@ private:
     using TStrSizeUMapVec = std::vector<TStrSizeUMap>;
     using TSizeSizePr = std::pair<std::size_t, std::size_t>;
     using TSizeDataFrameRowSlicePtrVecPr = std::pair<std::size_t, TRowSlicePtrVec>;
+    using TMaskedRowIterator = data_frame_detail::CMaskedRowIterator;
     using TOptionalPopMaskedRow = data_frame_detail::TOptionalPopMaskedRow;
 
     //! \brief Writes rows to the data frame.
@@ -599,6 +756,15 @@ private:
 private:
     void fillCategoricalColumnValueLookup();
 
+    //! Parse a numeric column value updating the counts of missing and bad
+    //! values.
+    CFloatStorage parseNumericValue(const std::string& columnValue,
+                                    std::uint64_t& missingValueCount,
+                                    std::uint64_t& badValueCount) const;
+
+    //! Get the integer encoding of a categorical value of \p column.
+    CFloatStorage parseCategoricalValue(std::size_t column, const std::string& columnValue);
+
     bool parallelApplyToAllRows(std::size_t beginRows,
                                 std::size_t endRows,
                                 TRowFuncVec& funcs,
@@ -619,9 +785,8 @@ private:
     TRowSlicePtrVecCItr beginSlices(std::size_t beginRows) const;
     TRowSlicePtrVecCItr endSlices(std::size_t endRows) const;
 
-    template<typename ITR>
-    bool maskedRowsInSlice(ITR& maskedRow,
-                           ITR endMaskedRows,
+    bool maskedRowsInSlice(TMaskedRowIterator& maskedRow,
+                           const TMaskedRowIterator& endMaskedRows,
                            std::size_t beginSliceRows,
                            std::size_t endSliceRows) const;
 
@@ -12,8 +12,10 @@
 #define INCLUDED_ml_core_CDetachedProcessSpawner_h
 
 #include <core/CProcess.h>
+#include <core/CZygote.h>
 #include <core/ImportExport.h>
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -40,6 +42,14 @@ class CTrackerThread;
 //!
 //! Can also kill processes that it started.
 //!
+//! Optionally, some of the permitted processes can be started by forking a
+//! pre-initialised zygote, see CZygote.  The zygotes are started when this
+//! object is constructed and they exit when it is destroyed.  If a zygote
+//! is unavailable the process is started from scratch instead.  However,
+//! if a request was sent to a zygote which didn't reply the spawn fails,
+//! because the zygote may have started the process.  Zygotes are only
+//! supported on Linux.
+//!
 //! IMPLEMENTATION DECISIONS:\n
 //! Closes parent process file descriptors in the spawned children.
 //!
@@ -77,7 +87,11 @@ public:
     //! /usr/bin/grep is permitted then you cannot invoke it as ./grep
     //! while the current working directory is /usr/bin.  On Windows,
     //! the supplied names should NOT have the .exe extension.
-    CDetachedProcessSpawner(const TStrVec& permittedProcessPaths);
+    //!
+    //! Processes in \p zygoteProcessPaths, which must also be permitted, are
+    //! started by forking a zygote.
+    CDetachedProcessSpawner(const TStrVec& permittedProcessPaths,
+                            const TStrVec& zygoteProcessPaths = TStrVec{});
 
     ~CDetachedProcessSpawner();
 
@@ -101,6 +115,18 @@ public:
     //! that is still running.
     bool hasChild(CProcess::TPid pid) const;
 
+private:
+    //! Start a zygote for \p processPath.
+    void startZygote(const std::string& processPath);
+
+    //! Try to start a process using the zygote for \p processPath.
+    CZygote::ERequestResult spawnFromZygote(const std::string& processPath,
+                                            const TStrVec& argv,
+                                            CProcess::TPid& childPid);
+
+private:
+    using TStrIntMap = std::map<std::string, int>;
+
 private:
     //! Paths to processes that may be spawned.
     TStrVec m_PermittedProcessPaths;
@@ -115,6 +141,10 @@ private:
     //! descriptor that's in use.
     int m_MaxObservedFd{1000000};
 #endif
+
+    //! Sockets used to send requests to the zygotes keyed by process path.
+    //! A value of -1 means the zygote needs to be restarted.
+    TStrIntMap m_ZygoteFds;
 };
 }
 }
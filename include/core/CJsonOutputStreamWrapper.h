@@ -16,8 +16,11 @@
 #include <core/CConcurrentWrapper.h>
 #include <core/CMemoryUsage.h>
 #include <core/CNonCopyable.h>
+#include <core/CStringBufWriter.h>
 #include <core/ImportExport.h>
 
+#include <functional>
+#include <future>
 #include <ostream>
 
 namespace json = boost::json;
@@ -54,6 +57,7 @@ private:
 public:
     using TOStreamConcurrentWrapper = core::CConcurrentWrapper<std::ostream>;
     using TGenericLineWriter = core::CBoostJsonLineWriter<std::string>;
+    using TWriteFunc = std::function<void(CStringBufWriter&)>;
 
 public:
     //! Wrap a given ostream for concurrent access.
@@ -85,6 +89,19 @@ public:
     //! Write preformatted JSON.
     void writeJson(std::string json);
 
+    //! Format and write JSON on the thread which writes to the wrapped stream.
+    //!
+    //! \p write is called on that thread with a line writer and each top level
+    //! object it writes is added to the stream in order with everything else
+    //! written via this wrapper. This moves formatting off the calling thread.
+    //!
+    //! \note Anything \p write reads must not be modified until the returned
+    //! future is ready.
+    std::future<void> writeAsync(TWriteFunc write);
+
+    //! Get the number of writes waiting to be added to the wrapped stream.
+    std::size_t queueDepth() const;
+
     //! Debug the memory used by this component.
     void debugMemoryUsage(const CMemoryUsage::TMemoryUsagePtr& mem) const;
 
@@ -94,6 +111,9 @@ public:
 private:
     void returnAndCheckBuffer(std::string* buffer);
 
+    //! Write \p object to \p o delimiting it from the previous object.
+    void writeObject(std::ostream& o, const std::string& object);
+
 private:
     //! the pool of buffers
     std::string m_StringBuffers[BUFFER_POOL_SIZE];
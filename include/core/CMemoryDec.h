@@ -17,6 +17,8 @@
 #include <boost/circular_buffer_fwd.hpp>
 #include <boost/container/container_fwd.hpp>
 #include <boost/multi_index_container_fwd.hpp>
+#include <boost/unordered/unordered_flat_map_fwd.hpp>
+#include <boost/unordered/unordered_flat_set_fwd.hpp>
 #include <boost/unordered/unordered_map_fwd.hpp>
 #include <boost/unordered/unordered_set_fwd.hpp>
 
@@ -108,6 +110,23 @@ constexpr std::size_t bucketGroupOverhead(const boost::unordered_set<T, H, P, A>
            4 * sizeof(std::size_t);
 }
 
+//! The overhead associated with the open addressing container's group
+//! metadata. Slots are organised in groups of 15, each of which has 16
+//! bytes of metadata, so this is a little over 1 byte per slot.
+//! See https://www.boost.org/doc/libs/1_83_0/libs/unordered/doc/html/unordered.html#structures_open_addressing_containers
+//! for more detail.
+template<typename K, typename V, typename H, typename P, typename A>
+constexpr std::size_t bucketGroupOverhead(const boost::unordered_flat_map<K, V, H, P, A>& t) {
+    return ((t.bucket_count() + 14) / 15) * 16;
+}
+
+//! The overhead associated with the open addressing container's group
+//! metadata. See the boost::unordered_flat_map overload for details.
+template<typename T, typename H, typename P, typename A>
+constexpr std::size_t bucketGroupOverhead(const boost::unordered_flat_set<T, H, P, A>& t) {
+    return ((t.bucket_count() + 14) / 15) * 16;
+}
+
 //! Default implementation.
 template<typename T>
 std::size_t staticSize(const T& t) {
@@ -160,12 +179,18 @@ std::size_t dynamicSize(const CSmallVector<T, N>& t);
 template<typename K, typename V, typename H, typename P, typename A>
 std::size_t dynamicSize(const boost::unordered_map<K, V, H, P, A>& t);
 
+template<typename K, typename V, typename H, typename P, typename A>
+std::size_t dynamicSize(const boost::unordered_flat_map<K, V, H, P, A>& t);
+
 template<typename K, typename V, typename C, typename A>
 std::size_t dynamicSize(const boost::container::flat_map<K, V, C, A>& t);
 
 template<typename T, typename H, typename P, typename A>
 std::size_t dynamicSize(const boost::unordered_set<T, H, P, A>& t);
 
+template<typename T, typename H, typename P, typename A>
+std::size_t dynamicSize(const boost::unordered_flat_set<T, H, P, A>& t);
+
 template<typename T, typename C, typename A>
 std::size_t dynamicSize(const boost::container::flat_set<T, C, A>& t);
 
@@ -254,6 +279,11 @@ void dynamicSize(const char* name,
                  const boost::unordered_map<K, V, H, P, A>& t,
                  const CMemoryUsage::TMemoryUsagePtr& mem);
 
+template<typename K, typename V, typename H, typename P, typename A>
+void dynamicSize(const char* name,
+                 const boost::unordered_flat_map<K, V, H, P, A>& t,
+                 const CMemoryUsage::TMemoryUsagePtr& mem);
+
 template<typename K, typename V, typename C, typename A>
 void dynamicSize(const char* name,
                  const boost::container::flat_map<K, V, C, A>& t,
@@ -264,6 +294,11 @@ void dynamicSize(const char* name,
                  const boost::unordered_set<T, H, P, A>& t,
                  const CMemoryUsage::TMemoryUsagePtr& mem);
 
+template<typename T, typename H, typename P, typename A>
+void dynamicSize(const char* name,
+                 const boost::unordered_flat_set<T, H, P, A>& t,
+                 const CMemoryUsage::TMemoryUsagePtr& mem);
+
 template<typename T, typename C, typename A>
 void dynamicSize(const char* name,
                  const boost::container::flat_set<T, C, A>& t,
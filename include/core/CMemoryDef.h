@@ -211,6 +211,12 @@ std::size_t dynamicSize(const boost::unordered_map<K, V, H, P, A>& t) {
            memory::bucketGroupOverhead(t);
 }
 
+template<typename K, typename V, typename H, typename P, typename A>
+std::size_t dynamicSize(const boost::unordered_flat_map<K, V, H, P, A>& t) {
+    return memory::elementDynamicSize(t) + t.bucket_count() * sizeof(std::pair<K, V>) +
+           memory::bucketGroupOverhead(t);
+}
+
 template<typename K, typename V, typename C, typename A>
 std::size_t dynamicSize(const boost::container::flat_map<K, V, C, A>& t) {
     return memory::elementDynamicSize(t) + t.capacity() * sizeof(std::pair<K, V>);
@@ -223,6 +229,12 @@ std::size_t dynamicSize(const boost::unordered_set<T, H, P, A>& t) {
            memory::bucketGroupOverhead(t);
 }
 
+template<typename T, typename H, typename P, typename A>
+std::size_t dynamicSize(const boost::unordered_flat_set<T, H, P, A>& t) {
+    return memory::elementDynamicSize(t) + t.bucket_count() * sizeof(T) +
+           memory::bucketGroupOverhead(t);
+}
+
 template<typename T, typename C, typename A>
 std::size_t dynamicSize(const boost::container::flat_set<T, C, A>& t) {
     return memory::elementDynamicSize(t) + t.capacity() * sizeof(T);
@@ -503,6 +515,26 @@ void dynamicSize(const char* name,
     memory_debug::associativeElementDynamicSize(std::move(componentName), t, mem);
 }
 
+template<typename K, typename V, typename H, typename P, typename A>
+void dynamicSize(const char* name,
+                 const boost::unordered_flat_map<K, V, H, P, A>& t,
+                 const CMemoryUsage::TMemoryUsagePtr& mem) {
+    std::string componentName(name);
+    componentName += "_ufmap";
+
+    std::size_t items = t.size();
+    std::size_t capacity = t.bucket_count();
+
+    CMemoryUsage::SMemoryUsage usage(
+        componentName + "::" + typeid(std::pair<K, V>).name(),
+        capacity * sizeof(std::pair<K, V>) + memory::bucketGroupOverhead(t),
+        (capacity - items) * sizeof(std::pair<K, V>));
+    CMemoryUsage::TMemoryUsagePtr ptr = mem->addChild();
+    ptr->setName(usage);
+
+    memory_debug::associativeElementDynamicSize(std::move(componentName), t, mem);
+}
+
 template<typename K, typename V, typename C, typename A>
 void dynamicSize(const char* name,
                  const boost::container::flat_map<K, V, C, A>& t,
@@ -541,6 +573,25 @@ void dynamicSize(const char* name,
     memory_debug::elementDynamicSize(std::move(componentName), t, mem);
 }
 
+template<typename T, typename H, typename P, typename A>
+void dynamicSize(const char* name,
+                 const boost::unordered_flat_set<T, H, P, A>& t,
+                 const CMemoryUsage::TMemoryUsagePtr& mem) {
+    std::string componentName(name);
+    componentName += "_ufset";
+
+    std::size_t items = t.size();
+    std::size_t capacity = t.bucket_count();
+
+    CMemoryUsage::SMemoryUsage usage(componentName + "::" + typeid(T).name(),
+                                     capacity * sizeof(T) + memory::bucketGroupOverhead(t),
+                                     (capacity - items) * sizeof(T));
+    CMemoryUsage::TMemoryUsagePtr ptr = mem->addChild();
+    ptr->setName(usage);
+
+    memory_debug::elementDynamicSize(std::move(componentName), t, mem);
+}
+
 template<typename T, typename C, typename A>
 void dynamicSize(const char* name,
                  const boost::container::flat_set<T, C, A>& t,
@@ -16,6 +16,7 @@
 #include <core/WindowsSafe.h>
 
 #include <atomic>
+#include <cstddef>
 #include <iosfwd>
 #include <memory>
 #include <string>
@@ -78,6 +79,12 @@ public:
     static TIStreamP openPipeStreamRead(const std::string& fileName,
                                         const std::atomic_bool& isCancelled);
 
+    //! As above but the stream buffers what it reads in a buffer with
+    //! initial capacity \p bufferCapacity.
+    static TIStreamP openPipeStreamRead(const std::string& fileName,
+                                        const std::atomic_bool& isCancelled,
+                                        std::size_t bufferCapacity);
+
     //! Initialise and open a named pipe for writing, returning a C++ stream
     //! that can be used to write to it.  Returns a NULL pointer on failure.
     static TOStreamP openPipeStreamWrite(const std::string& fileName,
@@ -106,6 +106,12 @@ public:
             return result;
         }
 
+        //! Advance to the first one bit whose index is at least \p index.
+        //!
+        //! \note This skips whole runs so is much cheaper than incrementing
+        //! up to \p index when the vector has long runs.
+        void advanceTo(std::size_t index);
+
     private:
         void skipRun();
 
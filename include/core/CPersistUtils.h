@@ -20,6 +20,8 @@
 #include <core/ImportExport.h>
 
 #include <boost/iterator/indirect_iterator.hpp>
+#include <boost/unordered/unordered_flat_map_fwd.hpp>
+#include <boost/unordered/unordered_flat_set_fwd.hpp>
 #include <boost/unordered/unordered_map_fwd.hpp>
 #include <boost/unordered/unordered_set_fwd.hpp>
 
@@ -798,8 +800,50 @@ public:
     static void dispatch(const std::string& tag,
                          const boost::unordered_set<T, H, P, A>& container,
                          CStatePersistInserter& inserter) {
+        dispatchOrderedSet(tag, container, inserter);
+    }
+
+    //! Specialisation for boost::unordered_map which orders values.
+    template<typename K, typename V, typename H, typename P, typename A>
+    static void dispatch(const std::string& tag,
+                         const boost::unordered_map<K, V, H, P, A>& container,
+                         CStatePersistInserter& inserter) {
+        dispatchOrderedMap(tag, container, inserter);
+    }
+
+    //! Specialisation for boost::unordered_flat_set which orders values.
+    template<typename T, typename H, typename P, typename A>
+    static void dispatch(const std::string& tag,
+                         const boost::unordered_flat_set<T, H, P, A>& container,
+                         CStatePersistInserter& inserter) {
+        dispatchOrderedSet(tag, container, inserter);
+    }
+
+    //! Specialisation for boost::unordered_flat_map which orders values.
+    template<typename K, typename V, typename H, typename P, typename A>
+    static void dispatch(const std::string& tag,
+                         const boost::unordered_flat_map<K, V, H, P, A>& container,
+                         CStatePersistInserter& inserter) {
+        dispatchOrderedMap(tag, container, inserter);
+    }
+
+    //! Specialisation for std::string, which has iterators but doesn't need
+    //! to be split up into individual characters
+    static void dispatch(const std::string& tag,
+                         const std::string& str,
+                         CStatePersistInserter& inserter) {
+        inserter.insertValue(tag, str);
+    }
+
+private:
+    //! Persist an unordered set ordering its values.
+    template<typename SET>
+    static void dispatchOrderedSet(const std::string& tag,
+                                   const SET& container,
+                                   CStatePersistInserter& inserter) {
+        using T = typename SET::value_type;
         using TVec = typename std::vector<T>;
-        using TCItr = typename boost::unordered_set<T, H, P, A>::const_iterator;
+        using TCItr = typename SET::const_iterator;
         using TCItrVec = typename std::vector<TCItr>;
 
         if (std::is_arithmetic<T>::value) {
@@ -820,12 +864,12 @@ public:
         }
     }
 
-    //! Specialisation for boost::unordered_map which orders values.
-    template<typename K, typename V, typename H, typename P, typename A>
-    static void dispatch(const std::string& tag,
-                         const boost::unordered_map<K, V, H, P, A>& container,
-                         CStatePersistInserter& inserter) {
-        using TCItr = typename boost::unordered_map<K, V, H, P, A>::const_iterator;
+    //! Persist an unordered map ordering its keys.
+    template<typename MAP>
+    static void dispatchOrderedMap(const std::string& tag,
+                                   const MAP& container,
+                                   CStatePersistInserter& inserter) {
+        using TCItr = typename MAP::const_iterator;
         using TCItrVec = typename std::vector<TCItr>;
 
         TCItrVec iterators;
@@ -840,15 +884,6 @@ public:
         doInsert(tag, iterators, inserter, std::false_type{}, std::true_type{});
     }
 
-    //! Specialisation for std::string, which has iterators but doesn't need
-    //! to be split up into individual characters
-    static void dispatch(const std::string& tag,
-                         const std::string& str,
-                         CStatePersistInserter& inserter) {
-        inserter.insertValue(tag, str);
-    }
-
-private:
     //! Handle the case of a built-in type.
     //!
     //! \note Type T is not an iterator
@@ -0,0 +1,147 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#ifndef INCLUDED_ml_core_CPipeReadBuffer_h
+#define INCLUDED_ml_core_CPipeReadBuffer_h
+
+#include <core/ImportExport.h>
+#include <core/WindowsSafe.h>
+
+#include <cstddef>
+#include <istream>
+#include <streambuf>
+
+namespace ml {
+namespace core {
+
+//! \brief
+//! A stream buffer which reads from a pipe into a large reusable buffer.
+//!
+//! DESCRIPTION:\n
+//! This can be used by anything which reads from a std::istream. However,
+//! its main purpose is to let parsers tokenise the input in place. They can
+//! get the unread data directly, with unreadBegin() and unreadEnd(), mark the
+//! data they've parsed as read, with consume(), and ask for more data, with
+//! fill(). This avoids copying the data from the stream buffer into a work
+//! buffer of their own.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! Each call to fill() is a single read of as much data as fits in the free
+//! space in the buffer, so it returns as soon as any data is available. By
+//! contrast, std::istream::read blocks until it's read everything it asked
+//! for, which forced the parsers to use small work buffers so they didn't
+//! stall waiting for data which hadn't been sent yet.
+//!
+//! Unread data is moved to the start of the buffer when the free space runs
+//! low, rather than wrapping around, so the unread data is always contiguous.
+//! This is cheap because parsers consume all but the last partial record.
+//! The buffer only grows if it is full of unread data.
+//!
+//! Pointers into the buffer are invalidated by fill() and by any read from
+//! the stream which has to get more data.
+//!
+//! On Linux a buffer whose capacity is a multiple of HUGE_PAGE_CAPACITY is
+//! aligned to and advised to use transparent huge pages, which reduces TLB
+//! misses when scanning it. This is only worthwhile for the main data input
+//! so other pipes use a small buffer by default.
+//!
+//! This takes ownership of the pipe handle and closes it when destroyed.
+//!
+class CORE_EXPORT CPipeReadBuffer final : public std::streambuf {
+public:
+#ifdef Windows
+    using TPipeHandle = HANDLE;
+#else
+    using TPipeHandle = int;
+#endif
+
+public:
+    //! The default buffer capacity.
+    static const std::size_t DEFAULT_CAPACITY;
+    //! The buffer capacity to use for the main data input which is the
+    //! size of a huge page.
+    static const std::size_t HUGE_PAGE_CAPACITY;
+
+public:
+    explicit CPipeReadBuffer(TPipeHandle handle, std::size_t capacity = DEFAULT_CAPACITY);
+    ~CPipeReadBuffer() override;
+
+    CPipeReadBuffer(const CPipeReadBuffer&) = delete;
+    CPipeReadBuffer& operator=(const CPipeReadBuffer&) = delete;
+
+    //! Get the start of the unread data.
+    char* unreadBegin() const { return this->gptr(); }
+
+    //! Get the end of the unread data.
+    char* unreadEnd() const { return this->egptr(); }
+
+    //! Mark the data before \p position as read.
+    //!
+    //! \note \p position must be in [unreadBegin(), unreadEnd()].
+    void consume(const char* position);
+
+    //! Read more data from the pipe, blocking until some is available.
+    //!
+    //! \return The number of bytes read, which is zero at the end of the
+    //! input or if reading failed.
+    std::size_t fill();
+
+    //! Check if the end of the input has been reached.
+    bool eof() const { return m_Eof; }
+
+    //! Check if reading from the pipe failed.
+    bool bad() const { return m_Bad; }
+
+    //! Get the current buffer capacity.
+    std::size_t capacity() const { return m_Capacity; }
+
+protected:
+    int_type underflow() override;
+    std::streamsize showmanyc() override;
+
+private:
+    //! Make sure there is a reasonable amount of free space after the
+    //! unread data.
+    void makeSpace();
+
+    //! Read at most \p size bytes into \p buffer.
+    std::size_t readSome(char* buffer, std::size_t size);
+
+    static char* allocate(std::size_t capacity);
+    static void deallocate(char* buffer, std::size_t capacity);
+
+private:
+    TPipeHandle m_Handle;
+    std::size_t m_Capacity;
+    char* m_Buffer;
+    bool m_Eof{false};
+    bool m_Bad{false};
+};
+
+//! \brief
+//! An input stream which reads from a pipe through a CPipeReadBuffer.
+class CORE_EXPORT CPipeReadStream final : public std::istream {
+public:
+    using TPipeHandle = CPipeReadBuffer::TPipeHandle;
+
+public:
+    explicit CPipeReadStream(TPipeHandle handle,
+                             std::size_t capacity = CPipeReadBuffer::DEFAULT_CAPACITY);
+
+    CPipeReadStream(const CPipeReadStream&) = delete;
+    CPipeReadStream& operator=(const CPipeReadStream&) = delete;
+
+private:
+    CPipeReadBuffer m_Buffer;
+};
+}
+}
+
+#endif // INCLUDED_ml_core_CPipeReadBuffer_h
@@ -12,6 +12,7 @@
 #define INCLUDED_ml_core_CStaticThreadPool_h
 
 #include <core/CConcurrentQueue.h>
+#include <core/CWorkStealingDeque.h>
 #include <core/Concurrency.h>
 #include <core/ImportExport.h>
 
@@ -32,6 +33,15 @@ namespace core {
 //! This purposely has very limited interface and is intended to mainly support
 //! CThreadPoolExecutor which provides the mechanism by which we expose the thread
 //! pool to the rest of the code via calls core::async.
+//!
+//! Tasks scheduled from outside the pool are added round robin to bounded queues,
+//! one per worker, so that the pool exerts back pressure on the threads producing
+//! work. Tasks scheduled by a task running in the pool are pushed onto a lock free
+//! deque owned by the worker running it. Workers pop from their own deque first,
+//! then their queues, and when they run out of work they steal from the deques of
+//! random victims. Since a worker which is waiting for tasks it scheduled can run
+//! them itself, see runPendingTask, nested parallelism can't deadlock the pool or
+//! start more threads than the pool size.
 class CORE_EXPORT CStaticThreadPool {
 public:
     using TTask = std::function<void()>;
@@ -69,6 +79,17 @@ public:
     //! Check if the thread pool has been marked as busy.
     void busy(bool busy);
 
+    //! Check if the calling thread is one of this pool's workers.
+    bool isWorkerThread() const;
+
+    //! If called from one of this pool's workers, run one task from the work
+    //! stealing deques if one is available.
+    //!
+    //! \note This is intended to be used by a task which is waiting for tasks
+    //! it scheduled to finish.
+    //! \return True if a task was run.
+    bool runPendingTask();
+
 private:
     using TOptionalSize = std::optional<std::size_t>;
     class CWrappedTask {
@@ -83,15 +104,24 @@ private:
         TOptionalSize m_ThreadId;
     };
     using TOptionalTask = std::optional<CWrappedTask>;
+    using TWrappedTaskUPtr = std::unique_ptr<CWrappedTask>;
     using TWrappedTaskQueue = CConcurrentQueue<CWrappedTask>;
     using TWrappedTaskQueueUPtr = std::unique_ptr<TWrappedTaskQueue>;
     using TWrappedTaskQueueUPtrVec = std::vector<TWrappedTaskQueueUPtr>;
+    using TWrappedTaskDeque = CWorkStealingDeque<CWrappedTask>;
+    using TWrappedTaskDequeUPtr = std::unique_ptr<TWrappedTaskDeque>;
+    using TWrappedTaskDequeUPtrVec = std::vector<TWrappedTaskDequeUPtr>;
+    using TAtomicBoolUPtr = std::unique_ptr<std::atomic_bool>;
+    using TAtomicBoolUPtrVec = std::vector<TAtomicBoolUPtr>;
     using TThreadVec = std::vector<std::thread>;
 
 private:
     void shutdown();
     void worker(std::size_t id);
     void drainQueuesWithoutBlocking();
+    bool scheduleOnWorker(std::size_t id, CWrappedTask& task);
+    TWrappedTaskUPtr popOrSteal(std::size_t id);
+    void wakeSleepingWorker();
 
 private:
     // This doesn't have to be atomic because it is always only set to true,
@@ -102,6 +132,8 @@ private:
     std::atomic<std::uint64_t> m_Cursor;
     std::atomic<std::size_t> m_NumberThreadsInUse;
     TWrappedTaskQueueUPtrVec m_TaskQueues;
+    TWrappedTaskDequeUPtrVec m_TaskDeques;
+    TAtomicBoolUPtrVec m_Sleeping;
     TThreadVec m_Pool;
 };
 }
@@ -207,8 +207,9 @@ public:
     //! matrix diagonals are not necessarily monotonically increasing.
     //! See http://www.cs.helsinki.fi/u/ukkonen/InfCont85.PDF
     //!
-    //! TODO - It may be possible to apply some of the lesser optimisations
-    //! from section 2 of Ukkonen's paper to this algorithm.
+    //! If the distance is only of interest when it is within some bound,
+    //! use the overload which takes the bound, since this can avoid
+    //! evaluating most of the matrix.
     template<typename PAIRCONTAINER>
     size_t weightedEditDistance(const PAIRCONTAINER& first, const PAIRCONTAINER& second) const {
         // This is similar to the levenshteinDistanceSimple() method below,
@@ -292,6 +293,135 @@ public:
         return currentCol[secondLen];
     }
 
+    //! Calculate the weighted edit distance between two sequences, but
+    //! only if it is no greater than \p bound.  This is useful when the
+    //! caller only needs to know if the sequences are within some distance
+    //! of one another.  Otherwise, it is as weightedEditDistance().
+    //!
+    //! This applies the cut-off from section 2 of Ukkonen's paper: since
+    //! all costs are non-negative, a cell can only be within \p bound if
+    //! one of its predecessors is.  So in each column we only evaluate the
+    //! cells between the first and last cells within \p bound in the
+    //! previous column, plus any run of cells below these reachable by
+    //! insertions, and stop as soon as a column has no cells within \p bound.
+    //! Note that equal elements can have different weights, for example
+    //! if the weights are positional, so the difference between the total
+    //! weights of the sequences is not a lower bound for the distance.
+    //!
+    //! The bit-parallel algorithms for unit costs can't be applied here
+    //! for the same reason the Berghel-Roach algorithm can't.
+    //!
+    //! \return The weighted edit distance if it is no greater than
+    //! \p bound and \p bound + 1 otherwise.
+    template<typename PAIRCONTAINER>
+    size_t weightedEditDistance(const PAIRCONTAINER& first,
+                                const PAIRCONTAINER& second,
+                                size_t bound) const {
+        size_t firstLen(first.size());
+        size_t secondLen(second.size());
+
+        // Deleting everything from the first sequence and inserting
+        // everything from the second is always possible, so if this is
+        // within the bound it can't prune anything
+        size_t totalWeight(0);
+        for (size_t index = 0; index < firstLen; ++index) {
+            totalWeight += first[index].second;
+        }
+        for (size_t index = 0; index < secondLen; ++index) {
+            totalWeight += second[index].second;
+        }
+        if (totalWeight <= bound) {
+            return this->weightedEditDistance(first, second);
+        }
+
+        // Any cost greater than the bound is saturated to this value
+        size_t outOfBound(bound + 1);
+
+        // Rule out boundary cases
+        if (firstLen == 0 || secondLen == 0) {
+            return outOfBound;
+        }
+
+        TScopedSizeArray data(new size_t[(secondLen + 1) * 2]);
+        size_t* currentCol(data.get());
+        size_t* prevCol(currentCol + (secondLen + 1));
+
+        // Populate the left column.  The cells within the bound in each
+        // column lie in the range [minDown, maxDown] and we treat all cells
+        // outside this range as out of bound.
+        size_t minDown(0);
+        size_t maxDown(0);
+        currentCol[0] = 0;
+        for (size_t downMinusOne = 0; downMinusOne < secondLen; ++downMinusOne) {
+            currentCol[downMinusOne + 1] = currentCol[downMinusOne] +
+                                           second[downMinusOne].second;
+            if (currentCol[downMinusOne + 1] > bound) {
+                break;
+            }
+            maxDown = downMinusOne + 1;
+        }
+
+        // Calculate the other entries in the matrix which may be within
+        // the bound
+        for (size_t acrossMinusOne = 0; acrossMinusOne < firstLen; ++acrossMinusOne) {
+            std::swap(currentCol, prevCol);
+            size_t prevMinDown(minDown);
+            size_t prevMaxDown(maxDown);
+            auto prevCost = [&](size_t down) {
+                return down >= prevMinDown && down <= prevMaxDown ? prevCol[down]
+                                                                  : outOfBound;
+            };
+
+            size_t firstCost(first[acrossMinusOne].second);
+            size_t down(prevMinDown);
+            size_t aboveCost(outOfBound);
+            if (down == 0) {
+                aboveCost = std::min(prevCol[0] + firstCost, outOfBound);
+                currentCol[0] = aboveCost;
+                ++down;
+            }
+
+            minDown = secondLen + 1;
+            maxDown = 0;
+            if (aboveCost <= bound) {
+                minDown = 0;
+            }
+
+            for (/**/; down <= secondLen; ++down) {
+                size_t secondCost(second[down - 1].second);
+
+                // The same 3 options as weightedEditDistance()
+                size_t option1(prevCost(down) + firstCost);
+                size_t option2(aboveCost + secondCost);
+                size_t option3(prevCost(down - 1) +
+                               ((first[acrossMinusOne].first == second[down - 1].first)
+                                    ? 0
+                                    : std::max(firstCost, secondCost)));
+
+                aboveCost = std::min(std::min(std::min(option1, option2), option3),
+                                     outOfBound);
+                currentCol[down] = aboveCost;
+                if (aboveCost <= bound) {
+                    minDown = std::min(minDown, down);
+                    maxDown = down;
+                } else if (down > prevMaxDown) {
+                    // Below the range in the previous column cells can only
+                    // be reached by insertions from the cell above
+                    break;
+                }
+            }
+
+            // Every path to the bottom right hand corner of the matrix
+            // passes through this column
+            if (minDown > maxDown) {
+                return outOfBound;
+            }
+        }
+
+        // Result is the value in the bottom right hand corner of the matrix
+        return maxDown == secondLen ? currentCol[secondLen] : outOfBound;
+    }
+
     //! Debug the memory used by this similarity tester.
     void debugMemoryUsage(const core::CMemoryUsage::TMemoryUsagePtr& mem) const;
 
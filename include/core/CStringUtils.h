@@ -36,6 +36,10 @@ public:
     //! whitespace in the "C" locale
     static const std::string WHITESPACE_CHARS;
 
+    //! The size of buffer which is large enough to hold any string written
+    //! by typeToStringPrecise.
+    static constexpr std::size_t MAX_PRECISE_STRING_LENGTH{32};
+
 public:
     using TSizeBoolPr = std::pair<std::size_t, bool>;
     using TStrBoolPr = std::pair<std::string, bool>;
@@ -71,6 +75,16 @@ public:
     //! Convert a double to a string with the specified precision
     static std::string typeToStringPrecise(double d, CIEEE754::EPrecision precision);
 
+    //! Write a double with the specified precision to \p buffer, which must
+    //! hold at least MAX_PRECISE_STRING_LENGTH characters, without allocating
+    //! and return the number of characters written. The string written is
+    //! not null terminated.
+    //!
+    //! \note Double precision values are written using the shortest string
+    //! which reads back to the same value.
+    static std::size_t
+    typeToStringPrecise(double d, CIEEE754::EPrecision precision, char* buffer);
+
     //! For types other than double, default conversions are precise
     template<typename T>
     static std::string typeToStringPrecise(const T& type, CIEEE754::EPrecision /*precision*/) {
@@ -18,7 +18,9 @@
 #include <boost/unordered_set.hpp>
 
 #include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
 
 namespace ml {
 namespace core {
@@ -76,7 +78,7 @@ public:
     //! Is a given word a day of the week name, month name, or timezone
     //! abbreviation in the current locale?  Input should be trimmed of
     //! whitespace before calling this function.
-    static bool isDateWord(const std::string& word);
+    static bool isDateWord(std::string_view word);
 
     //! Formats the given duration as human-readable string.
     static std::string durationToString(core_t::TTime duration);
@@ -100,7 +102,7 @@ private:
         static const CDateWordCache& instance();
 
         //! Check if a word is a date word
-        bool isDateWord(const std::string& word) const;
+        bool isDateWord(std::string_view word) const;
 
     private:
         //! Constructor for a singleton is private
@@ -114,7 +116,15 @@ private:
         //! this variable is visible in every thread).
         static CDateWordCache* ms_Instance;
 
-        using TStrUSet = boost::unordered_set<std::string>;
+        //! Allows lookup of string views without constructing a string.
+        struct SStrHash {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view word) const {
+                return std::hash<std::string_view>{}(word);
+            }
+        };
+
+        using TStrUSet = boost::unordered_set<std::string, SStrHash, std::equal_to<>>;
 
         //! Our cache of date words
         TStrUSet m_DateWords;
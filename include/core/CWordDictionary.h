@@ -16,7 +16,10 @@
 #include <boost/unordered_map.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace ml {
 namespace core {
@@ -43,6 +46,13 @@ namespace core {
 //!
 //! All checks are case-insensitive.
 //!
+//! Every token categorization sees is looked up in this dictionary so,
+//! once loaded, the words are compiled into a minimal perfect hash table
+//! using the "hash and displace" scheme.  The words are packed into a
+//! single string and each table entry holds the offset and length of its
+//! word together with its part of speech.  A lookup hashes the word once
+//! and makes a single comparison, and there is no per-word heap allocation.
+//!
 //! TODO - extend this to cope with different dictionaries for
 //! different languages.
 //!
@@ -190,14 +200,14 @@ public:
     //! partOfSpeech().  Instead simply call partOfSpeech(), noting that
     //! it will return E_NotInDictionary in cases where this method will
     //! return false.
-    bool isInDictionary(const std::string& str) const;
+    bool isInDictionary(std::string_view str) const;
 
     //! Check what part of speech a word is primarily used for.  Note that
     //! many words can be used in different parts of speech and this method
     //! only returns what Grady Ward thought was the primary use when he
     //! created Moby.  This method returns E_NotInDictionary for words that
     //! aren't in the dictionary.
-    EPartOfSpeech partOfSpeech(const std::string& str) const;
+    EPartOfSpeech partOfSpeech(std::string_view str) const;
 
     //! No copying
     CWordDictionary(const CWordDictionary&) = delete;
@@ -209,14 +219,22 @@ private:
     ~CWordDictionary();
 
 private:
+    //! Transparent so that words can be looked up from views into the
+    //! middle of other strings without copying them.
     class CStrHashIgnoreCase {
     public:
-        std::size_t operator()(const std::string& str) const;
+        using is_transparent = void;
+
+    public:
+        std::size_t operator()(std::string_view str) const;
     };
 
     class CStrEqualIgnoreCase {
     public:
-        bool operator()(const std::string& lhs, const std::string& rhs) const;
+        using is_transparent = void;
+
+    public:
+        bool operator()(std::string_view lhs, std::string_view rhs) const;
     };
 
 private:
@@ -229,15 +247,39 @@ private:
     //! this variable is visible in every thread).
     static CWordDictionary* ms_Instance;
 
-    //! Stores the dictionary words - using a multi-index even though
-    //! there's only one index, because of its flexible key extractors.
-    //! The key is the string, but hashed and compared ignoring case.
+    //! Used to remove duplicate words, ignoring case, when loading the
+    //! dictionary.
     using TStrUMap =
         boost::unordered_map<std::string, EPartOfSpeech, CStrHashIgnoreCase, CStrEqualIgnoreCase>;
-    using TStrUMapCItr = TStrUMap::const_iterator;
 
-    //! Our dictionary of words
-    TStrUMap m_DictionaryWords;
+    //! The location of a word in m_Words and its part of speech.
+    struct SEntry {
+        std::uint32_t s_Offset;
+        std::uint16_t s_Length;
+        std::uint16_t s_PartOfSpeech;
+    };
+
+    using TEntryVec = std::vector<SEntry>;
+    using TInt32Vec = std::vector<std::int32_t>;
+
+private:
+    //! Compile \p words into the perfect hash table.
+    void buildPerfectHash(const TStrUMap& words);
+
+    //! Get the table slot for \p str.  This is only the slot of \p str if
+    //! it is in the dictionary.
+    std::size_t slot(std::string_view str) const;
+
+private:
+    //! All the dictionary words concatenated.
+    std::string m_Words;
+
+    //! The perfect hash table entries.
+    TEntryVec m_Entries;
+
+    //! The displacements of each bucket.  Negative values encode the slot
+    //! of single word buckets directly.
+    TInt32Vec m_Displacements;
 };
 }
 }
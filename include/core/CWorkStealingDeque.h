@@ -0,0 +1,156 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#ifndef INCLUDED_ml_core_CWorkStealingDeque_h
+#define INCLUDED_ml_core_CWorkStealingDeque_h
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ml {
+namespace core {
+
+//! \brief
+//! A bounded lock free work stealing deque of pointers.
+//!
+//! DESCRIPTION:\n
+//! One thread, the owner, pushes and pops items at the bottom of the deque
+//! and any number of other threads can concurrently steal items from the
+//! top. None of the operations block or take a lock. The owner only needs
+//! to synchronise with thieves when there is at most one item left.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! This is the Chase-Lev deque with the memory orderings from "Correct and
+//! Efficient Work-Stealing for Weak Memory Models", Le et al., 2013. The
+//! buffer has a fixed size so, unlike the original, push fails rather than
+//! growing the buffer when the deque is full. This avoids having to manage
+//! the lifetime of old buffers which thieves may still be reading.
+//!
+//! The deque doesn't own the objects it points to.
+//!
+//! @tparam T the type of objects pointed to by the items in the deque
+template<typename T>
+class CWorkStealingDeque final {
+public:
+    //! \note \p capacity is rounded up to a power of two.
+    explicit CWorkStealingDeque(std::size_t capacity)
+        : m_Capacity{roundUpToPowerOfTwo(capacity)}, m_Mask{m_Capacity - 1},
+          m_Buffer{std::make_unique<std::atomic<T*>[]>(m_Capacity)} {}
+
+    CWorkStealingDeque(const CWorkStealingDeque&) = delete;
+    CWorkStealingDeque& operator=(const CWorkStealingDeque&) = delete;
+    CWorkStealingDeque(CWorkStealingDeque&&) = delete;
+    CWorkStealingDeque& operator=(CWorkStealingDeque&&) = delete;
+
+    //! Push \p item onto the bottom of the deque.
+    //!
+    //! \note This must only be called by the owner.
+    //! \return False if the deque is full.
+    bool push(T* item) {
+        std::int64_t bottom{m_Bottom.load(std::memory_order_relaxed)};
+        std::int64_t top{m_Top.load(std::memory_order_acquire)};
+        if (bottom - top >= static_cast<std::int64_t>(m_Capacity)) {
+            return false;
+        }
+        m_Buffer[static_cast<std::size_t>(bottom) & m_Mask].store(
+            item, std::memory_order_relaxed);
+        // Le et al. use a release fence and a relaxed store here. A release
+        // store is sufficient and, unlike fences, thread sanitizer models it.
+        m_Bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! Pop the item at the bottom of the deque, i.e. the one pushed most
+    //! recently.
+    //!
+    //! \note This must only be called by the owner.
+    //! \return Null if the deque is empty.
+    T* pop() {
+        std::int64_t bottom{m_Bottom.load(std::memory_order_relaxed) - 1};
+        m_Bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t top{m_Top.load(std::memory_order_relaxed)};
+
+        if (top > bottom) {
+            // Empty.
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T* item{m_Buffer[static_cast<std::size_t>(bottom) & m_Mask].load(
+            std::memory_order_relaxed)};
+        if (top == bottom) {
+            // This is the last item so we race with thieves for it.
+            if (m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed) == false) {
+                item = nullptr;
+            }
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    //! Steal the item at the top of the deque, i.e. the oldest one.
+    //!
+    //! \note This can be called by any thread.
+    //! \return Null if the deque is empty or another thread won the race
+    //! for the item.
+    T* steal() {
+        std::int64_t top{m_Top.load(std::memory_order_acquire)};
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t bottom{m_Bottom.load(std::memory_order_acquire)};
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        T* item{m_Buffer[static_cast<std::size_t>(top) & m_Mask].load(
+            std::memory_order_relaxed)};
+        if (m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed) == false) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    //! Check if the deque is empty.
+    //!
+    //! \note This is only a snapshot if other threads are accessing the deque.
+    bool empty() const {
+        return m_Bottom.load(std::memory_order_relaxed) <=
+               m_Top.load(std::memory_order_relaxed);
+    }
+
+    //! Get the maximum number of items the deque can hold.
+    std::size_t capacity() const { return m_Capacity; }
+
+private:
+    static std::size_t roundUpToPowerOfTwo(std::size_t capacity) {
+        std::size_t result{1};
+        while (result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+private:
+    std::size_t m_Capacity;
+    std::size_t m_Mask;
+    std::unique_ptr<std::atomic<T*>[]> m_Buffer;
+    // Keep the ends of the deque on separate cache lines since they're
+    // written by different threads.
+    alignas(64) std::atomic<std::int64_t> m_Top{0};
+    alignas(64) std::atomic<std::int64_t> m_Bottom{0};
+};
+}
+}
+
+#endif // INCLUDED_ml_core_CWorkStealingDeque_h
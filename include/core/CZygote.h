@@ -0,0 +1,108 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#ifndef INCLUDED_ml_core_CZygote_h
+#define INCLUDED_ml_core_CZygote_h
+
+#include <core/CNonInstantiatable.h>
+#include <core/CProcess.h>
+#include <core/ImportExport.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ml {
+namespace core {
+
+//! \brief
+//! Start processes by forking a pre-initialised copy of a program.
+//!
+//! DESCRIPTION:\n
+//! Starting a program from scratch pays for dynamic loading and any one-off
+//! initialisation, such as loading the word dictionary, every time. A zygote
+//! is a copy of the program which is started in advance, does all of this
+//! once and then forks a child for each request it receives. Each child
+//! carries on exactly as if the program had been started with the arguments
+//! in the request.
+//!
+//! A program supports this by calling serveIfRequested() at the very start
+//! of main(). CDetachedProcessSpawner starts zygotes and sends requests.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! This is a static class - it's not possible to construct an instance of it.
+//!
+//! Requests are sent over a socket whose file descriptor is passed to the
+//! zygote on its command line. The zygote exits when the spawner closes its
+//! end of the socket.
+//!
+//! Children are created by forking twice, so they are orphaned immediately
+//! and are adopted by the spawner, which must be a child subreaper. This
+//! means the spawner can track and kill them exactly as if it had started
+//! them itself. Child subreapers are only available on Linux, so zygotes
+//! are not supported on other platforms.
+//!
+//! If the reply with a child's PID can't be delivered the zygote kills the
+//! child, since the spawner wouldn't be able to track it.
+//!
+//! The zygote must be single threaded when it forks, so the initialisation
+//! it does must not start any threads.
+//!
+class CORE_EXPORT CZygote : private CNonInstantiatable {
+public:
+    using TStrVec = std::vector<std::string>;
+    using TInitialiseFunc = std::function<void()>;
+
+    //! The outcome of asking a zygote to start a child.
+    enum ERequestResult {
+        //! The child was started.
+        E_ChildStarted,
+        //! No child was started because the request couldn't be sent or
+        //! the zygote failed to fork.
+        E_ChildNotStarted,
+        //! The request was sent but the zygote didn't reply in time. The
+        //! zygote kills the child if it can't deliver the reply, but the
+        //! child may run briefly.
+        E_NoReply
+    };
+
+public:
+    //! Prefix of the argument which makes a program run as a zygote. It is
+    //! followed by the file descriptor of the socket to read requests from.
+    static const std::string ZYGOTE_ARG_PREFIX;
+
+public:
+    //! Is it possible to start processes using zygotes on this platform?
+    static bool isSupported();
+
+    //! Make the calling process adopt the orphaned descendants of processes
+    //! it starts. This must be called before using zygotes.
+    static bool becomeSubreaper();
+
+    //! If the command line requests it, run as a zygote: call \p initialise
+    //! and then fork a child for each request received. This returns only
+    //! in the children, with \p argc and \p argv replaced by the arguments
+    //! of the request, and the zygote itself exits when there are no more
+    //! requests. If the command line doesn't request zygote mode this
+    //! returns immediately.
+    static void serveIfRequested(int& argc, char**& argv, const TInitialiseFunc& initialise);
+
+    //! Ask the zygote listening on \p fd to start a child with the command
+    //! line \p argv, which includes the program name. If the child is started
+    //! \p childPid is set to its PID.
+    //!
+    //! \note If the zygote doesn't reply \p fd is shut down, so it must not
+    //! be used for further requests.
+    static ERequestResult requestChild(int fd, const TStrVec& argv, CProcess::TPid& childPid);
+};
+}
+}
+
+#endif // INCLUDED_ml_core_CZygote_h
@@ -17,8 +17,14 @@
 #include <core/ImportExport.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <future>
+#include <iterator>
+#include <map>
+#include <string>
 #include <thread>
 #include <type_traits>
 #include <vector>
@@ -81,6 +87,10 @@ public:
     virtual void busy(bool value) = 0;
     virtual std::size_t numberThreadsInUse() const = 0;
     virtual void numberThreadsInUse(std::size_t threads) = 0;
+    //! Check if the calling thread is one the executor runs tasks on.
+    virtual bool isWorkerThread() const = 0;
+    //! Run a task scheduled by a task on the calling thread if one is waiting.
+    virtual bool runPendingTask() = 0;
 };
 
 //! Setup the global default executor for async.
@@ -146,9 +156,9 @@ void invokeAndWriteResultToPromise(F& f, P& promise, const std::true_type&) {
 //! \warning This behaves differently from std::async which can lead to deadlocks
 //! in situations where launching a new thread would not. For example, if you're
 //! using the defaultAsyncExecutor you need to be careful calling async nested as
-//! it is easy to create a deadlock if tasks wait on other tasks enqueued after
-//! them. Prefer using high level primitives, such as parallel_for_each, which are
-//! safer.
+//! it is easy to create a deadlock if tasks block waiting on other tasks enqueued
+//! after them. Prefer using high level primitives, such as parallel_for_each, which
+//! run pending tasks while they wait.
 template<typename FUNCTION, typename... ARGS>
 std::future<std::invoke_result_t<std::decay_t<FUNCTION>, std::decay_t<ARGS>...>>
 async(CExecutor& executor, FUNCTION&& f, ARGS&&... args) {
@@ -208,15 +218,193 @@ private:
 };
 
 //! Get the conjunction of all \p futures.
+//!
+//! \note If called from a task running on the default async executor this runs
+//! other pending tasks while it waits.
 CORE_EXPORT
 bool get_conjunction_of_all(std::vector<std::future<bool>>& futures);
 
+//! \brief Summary statistics for the parallel loops run at one call site.
+//!
+//! DESCRIPTION:\n
+//! Times are in microseconds. The idle time is the time the tasks of a loop
+//! could have been running, i.e. the number of tasks times the loop duration,
+//! less the time they spent running the loop body. This includes the time
+//! tasks wait to be started and the time they wait for the slowest task.
+//! Stolen tasks are those run by a different worker from the one which
+//! scheduled them, which only happens for loops nested in another task.
+struct CORE_EXPORT SParallelForEachStats {
+    std::uint64_t s_Calls{0};
+    std::uint64_t s_Tasks{0};
+    std::uint64_t s_StolenTasks{0};
+    std::uint64_t s_Chunks{0};
+    std::uint64_t s_WallTime{0};
+    std::uint64_t s_BusyTime{0};
+    std::uint64_t s_IdleTime{0};
+};
+
+using TStrParallelForEachStatsMap = std::map<std::string, SParallelForEachStats>;
+
+//! \brief Names the call site of parallel loops run by the calling thread
+//! while this is in scope.
+//!
+//! DESCRIPTION:\n
+//! Loops run by the tasks of a named loop inherit its name. Loops which run
+//! without a name are recorded as "unnamed".
+//!
+//! \note \p name must have static storage duration, i.e. be a string literal.
+class CORE_EXPORT CScopedParallelForEachCallSite {
+public:
+    explicit CScopedParallelForEachCallSite(const char* name);
+    ~CScopedParallelForEachCallSite();
+
+    CScopedParallelForEachCallSite(const CScopedParallelForEachCallSite&) = delete;
+    CScopedParallelForEachCallSite& operator=(const CScopedParallelForEachCallSite&) = delete;
+
+private:
+    const char* m_PreviousName;
+};
+
+//! Set whether to record statistics for parallel loops.
+//!
+//! This is off by default since recording them serialises every parallel loop
+//! on a process wide lock. It is intended for diagnosing performance problems.
+CORE_EXPORT
+void recordParallelForEachStats(bool enabled);
+
+//! Get the statistics for the parallel loops run by each call site since
+//! they were last reset.
+//!
+//! \note Loops which run sequentially, or when recording statistics is off,
+//! are not recorded.
+CORE_EXPORT
+TStrParallelForEachStatsMap parallelForEachStats();
+
+//! Reset the statistics for the parallel loops run by every call site.
+CORE_EXPORT
+void resetParallelForEachStats();
+
 namespace concurrency_detail {
+//! The ways a parallel loop's indices can be assigned to the functions which
+//! run it.
+enum class EPartition {
+    //! Each function always gets the same indices for a given range size and
+    //! number of functions.
+    E_Fixed,
+    //! Functions claim chunks of the range as they go so which function gets
+    //! which index depends on timing.
+    E_Adaptive
+};
+
+//! \brief Hands out the chunks of a parallel loop's range to the tasks
+//! running it.
+//!
+//! DESCRIPTION:\n
+//! Each task runs one of the loop's functions and each function visits its
+//! indices in contiguous chunks in increasing order.
+//!
+//! For fixed partitioning the range is split into chunks whose size depends
+//! only on the range size and the number of tasks and task t gets chunks t,
+//! t + n, t + 2n, ... for n tasks. This means functions which accumulate state
+//! whose value depends on the order it's accumulated in, such as floating point
+//! sums, get the same result whatever the timing of the tasks. Using several
+//! chunks per task evens out the work when its cost varies smoothly over the
+//! range.
+//!
+//! For adaptive partitioning each task's first chunk is assigned up front and
+//! is a 1 / 2n share of the range, so every task gets a fair share even if the
+//! tasks start at very different times. After that tasks claim chunks from the
+//! front of the rest of the range as they need them. These start large, to keep
+//! the overheads low, and shrink as the range is consumed so tasks finish at
+//! about the same time even when the cost per index varies. A task never claims
+//! a chunk so small that the overhead of claiming it is significant, which it
+//! judges from the cost per index it has measured so far.
+//!
+//! This also records the loop's progress and, if recording statistics is on,
+//! its statistics for its call site when it's destroyed.
+class CORE_EXPORT CPartitioner {
+public:
+    using TProgressCallback = std::function<void(double)>;
+
+    //! \brief Claims chunks of the range for one task and times them.
+    class CORE_EXPORT CTask {
+    public:
+        CTask(CPartitioner& partitioner, std::size_t task);
+        ~CTask();
+
+        CTask(const CTask&) = delete;
+        CTask& operator=(const CTask&) = delete;
+
+        //! Get the next chunk [\p begin, \p end) of the range to process.
+        //!
+        //! \return False if there are no chunks left.
+        bool nextChunk(std::size_t& begin, std::size_t& end);
+
+    private:
+        using TTimePoint = std::chrono::steady_clock::time_point;
+
+    private:
+        CPartitioner& m_Partitioner;
+        const char* m_PreviousCallSite;
+        std::size_t m_Task;
+        std::size_t m_NumberClaims{0};
+        TTimePoint m_ChunkStart;
+        std::size_t m_ChunkSize{0};
+        double m_SecondsPerIndex{0.0};
+        std::uint64_t m_BusyTime{0};
+        bool m_Exhausted{false};
+    };
+
+public:
+    CPartitioner(EPartition partition,
+                 std::size_t size,
+                 std::size_t numberTasks,
+                 const TProgressCallback& recordProgress);
+    ~CPartitioner();
+
+    CPartitioner(const CPartitioner&) = delete;
+    CPartitioner& operator=(const CPartitioner&) = delete;
+
+private:
+    using TTimePoint = std::chrono::steady_clock::time_point;
+
+private:
+    bool timed() const;
+    bool claim(std::size_t task,
+               std::size_t numberClaims,
+               double secondsPerIndex,
+               std::size_t& begin,
+               std::size_t& end);
+    void recordProgress(std::size_t processed);
+
+private:
+    EPartition m_Partition;
+    std::size_t m_Size;
+    std::size_t m_NumberTasks;
+    //! The fixed chunk size for fixed partitioning and the size of each
+    //! task's first chunk for adaptive partitioning.
+    std::size_t m_ChunkSize;
+    const TProgressCallback& m_RecordProgress;
+    const char* m_CallSite;
+    bool m_RecordStats;
+    std::thread::id m_SchedulingThread;
+    bool m_ScheduledByWorker{false};
+    TTimePoint m_Start;
+    std::atomic_size_t m_Next;
+    std::atomic_size_t m_Processed{0};
+    std::atomic_bool m_Stopped{false};
+    std::atomic<std::uint64_t> m_Chunks{0};
+    std::atomic<std::uint64_t> m_StolenTasks{0};
+    std::atomic<std::uint64_t> m_BusyTime{0};
+};
+
 class CORE_EXPORT CDefaultAsyncExecutorBusyForScope {
 public:
     CDefaultAsyncExecutorBusyForScope();
     ~CDefaultAsyncExecutorBusyForScope();
     bool wasBusy() const;
+    //! Check if a parallel loop should run sequentially on the calling thread.
+    bool runSequentially() const;
 
 private:
     bool m_WasBusy;
@@ -226,94 +414,122 @@ CORE_EXPORT
 void noop(double);
 
 template<typename FUNCTION>
-void parallel_for_each(std::size_t start,
+void parallel_for_each(EPartition partition,
+                       std::size_t start,
                        std::size_t end,
                        std::vector<FUNCTION>& functions,
                        const std::function<void(double)>& recordProgress) {
 
-    // Threads access the indices in the following pattern:
-    //   [0, m,   2*m,   ...]
-    //   [1, m+1, 2*m+1, ...]
-    //   [2, m+2, 2*m+2, ...]
-    //   ...
-    // for m partitions. This is choosen because it is expected that the index
-    // will often be used to access elements in a contiguous block of memory.
-    // Provided the threads are doing roughly equal work per call this should
-    // ensure the best possible locality of reference for reads which occur
-    // at a similar time in the different threads.
+    // Each function visits contiguous chunks of indices, which is good for
+    // locality of reference when the index is used to access a contiguous
+    // block of memory, and always visits indices in increasing order, which
+    // callers rely on. See CPartitioner for how chunks are assigned.
+
+    CPartitioner partitioner{partition, end - start, functions.size(), recordProgress};
 
     std::vector<std::future<bool>> finished;
     finished.reserve(functions.size());
 
-    for (std::size_t offset = 0, partitions = functions.size();
-         offset < partitions; ++offset, ++start) {
+    for (std::size_t task = 0; task < functions.size(); ++task) {
 
-        // Note there is one f for each thread so capture by reference is thread
+        // Note there is one f for each task so capture by reference is thread
         // safe provided each f is thread safe. Also, we always wait until all
-        // calls are finished before returning so functions always live beyond
-        // these references.
-
-        CLoopProgress progress{end - offset, recordProgress,
-                               1.0 / static_cast<double>(partitions)};
-
-        auto& f = functions[offset];
-        finished.emplace_back(
-            async(defaultAsyncExecutor(),
-                  [&f, partitions, progress](std::size_t start_, std::size_t end_) mutable {
-                      for (std::size_t i = start_; i < end_;
-                           i += partitions, progress.increment(partitions)) {
-                          f(i);
-                      }
-                      return true; // So we can check for exceptions via get.
-                  },
-                  start, end));
+        // calls are finished before returning so functions and the partitioner
+        // always live beyond these references.
+
+        auto& f = functions[task];
+        finished.emplace_back(async(defaultAsyncExecutor(), [&f, &partitioner, task, start] {
+            CPartitioner::CTask task_{partitioner, task};
+            std::size_t chunkBegin{0};
+            std::size_t chunkEnd{0};
+            while (task_.nextChunk(chunkBegin, chunkEnd)) {
+                for (std::size_t i = start + chunkBegin; i < start + chunkEnd; ++i) {
+                    f(i);
+                }
+            }
+            return true; // So we can check for exceptions via get.
+        }));
     }
 
     get_conjunction_of_all(finished);
 }
 
 template<typename ITR, typename FUNCTION>
-void parallel_for_each(ITR start,
+void parallel_for_each(EPartition partition,
+                       ITR start,
                        std::size_t size,
                        std::vector<FUNCTION>& functions,
                        const std::function<void(double)>& recordProgress = concurrency_detail::noop) {
 
-    // See above for the rationale for this access pattern.
+    // See above for the rationale for this scheme.
+
+    CPartitioner partitioner{partition, size, functions.size(), recordProgress};
 
     std::vector<std::future<bool>> finished;
     finished.reserve(functions.size());
 
-    for (std::size_t offset = 0, partitions = functions.size();
-         offset < partitions; ++offset, ++start) {
+    for (std::size_t task = 0; task < functions.size(); ++task) {
+
+        // As above, capturing by reference here is safe.
+
+        auto& f = functions[task];
+        finished.emplace_back(async(defaultAsyncExecutor(), [&f, &partitioner, task, start] {
+            CPartitioner::CTask task_{partitioner, task};
+            // Chunks are claimed in increasing order so we only ever need to
+            // advance the iterator.
+            ITR i{start};
+            std::size_t position{0};
+            std::size_t chunkBegin{0};
+            std::size_t chunkEnd{0};
+            while (task_.nextChunk(chunkBegin, chunkEnd)) {
+                std::advance(i, chunkBegin - position);
+                for (position = chunkBegin; position < chunkEnd; ++position, ++i) {
+                    f(*i);
+                }
+            }
+            return true; // So we can check for exceptions via get.
+        }));
+    }
 
-        // As above, capturing by reference here is  safe.
+    get_conjunction_of_all(finished);
+}
 
-        CLoopProgress progress{size - offset, recordProgress,
-                               1.0 / static_cast<double>(partitions)};
+//! Run copies of \p f on the indices [\p start, \p end) with \p partition.
+template<typename FUNCTION>
+std::vector<FUNCTION> parallel_for_each(EPartition partition,
+                                        std::size_t partitions,
+                                        std::size_t start,
+                                        std::size_t end,
+                                        FUNCTION&& f,
+                                        const std::function<void(double)>& recordProgress) {
 
-        auto& f = functions[offset];
-        finished.emplace_back(async(
-            defaultAsyncExecutor(),
-            [&f, partitions, offset, size, progress](ITR start_) mutable {
+    if (end <= start) {
+        recordProgress(1.0);
+        return {std::forward<FUNCTION>(f)};
+    }
 
-                std::size_t i{offset};
+    // See core::parallel_for_each for details.
 
-                auto incrementByPartitions = [&i, partitions, size](ITR& j) {
-                    if (i < size) {
-                        std::advance(j, partitions);
-                    }
-                };
+    CDefaultAsyncExecutorBusyForScope scope;
 
-                for (ITR j = start_; i < size; i += partitions,
-                         incrementByPartitions(j), progress.increment(partitions)) {
-                    f(*j);
-                }
-                return true; // So we can check for exceptions via get.
-            },
-            start));
+    partitions = std::min(partitions, end - start);
+
+    if (partitions < 2 || scope.runSequentially()) {
+        CLoopProgress progress{end - start, recordProgress};
+        for (std::size_t i = start; i < end; ++i, progress.increment()) {
+            f(i);
+        }
+
+        // Avoid the copy from an initializer_list.
+        std::vector<FUNCTION> functions;
+        functions.reserve(1);
+        functions.push_back(std::forward<FUNCTION>(f));
+        return functions;
     }
 
-    get_conjunction_of_all(finished);
+    std::vector<FUNCTION> functions(partitions, std::forward<FUNCTION>(f));
+    parallel_for_each(partition, start, end, functions, recordProgress);
+    return functions;
 }
 }
 
@@ -337,29 +553,22 @@ bool parallel_for_each(std::size_t start,
         return false;
     }
 
-    // This function is not re-entrant without the chance of deadlock if we always
-    // execute in parallel. In particular, we wait on the completion of tasks which
-    // are enqueued in the global thread pool. However, if this has already been
-    // called further up the stack we will enqueue functions which will wait on the
-    // results of these and will block the tasks they need to complete behind them
-    // in the queues. There are a couple strategies we could take, two obvious ones
-    // in order of increasing complexity and decreasing pessimism are:
-    //   1) Execute sequentially if there are any tasks in the thread pool, we then
-    //      won't wait here and nothing will block in the queue,
-    //   2) Assign tasks a priority and ensure in the queue that tasks are executed
-    //      in priority order. Then we can assign these tasks "highest priority in
-    //      queue" + 1.
+    // This function waits on the completion of tasks which are enqueued in the
+    // global thread pool. If it is called from one of those tasks, i.e. nested,
+    // the tasks it schedules go on the worker's own deque, from which idle workers
+    // steal, and the worker runs pending tasks while it waits. So nested calls are
+    // executed in parallel without the chance of deadlock or of running more
+    // threads than the pool size.
     //
-    // This implements 1) because it is significantly simpler to and in practice we
-    // probably don't actually need to nest parallel_for_each. We're just interested
-    // in guarding against accidental deadlock in the case someone inadvertantly calls
-    // parallelised code in the function to execute.
+    // Otherwise, if the pool is busy because some other thread is already running
+    // a parallel loop, we execute sequentially. This avoids blocking the calling
+    // thread behind the other thread's tasks in the queues.
 
     concurrency_detail::CDefaultAsyncExecutorBusyForScope scope;
 
     functions.resize(std::min(functions.size(), end - start));
 
-    if (functions.size() < 2 || scope.wasBusy()) {
+    if (functions.size() < 2 || scope.runSequentially()) {
         functions.resize(1); // For the case scope was busy.
         CLoopProgress progress{end - start, recordProgress};
         for (std::size_t i = start; i < end; ++i, progress.increment()) {
@@ -368,7 +577,8 @@ bool parallel_for_each(std::size_t start,
         return true;
     }
 
-    concurrency_detail::parallel_for_each(start, end, functions, recordProgress);
+    concurrency_detail::parallel_for_each(concurrency_detail::EPartition::E_Fixed,
+                                          start, end, functions, recordProgress);
     return true;
 }
 
@@ -392,34 +602,9 @@ parallel_for_each(std::size_t partitions,
                   std::size_t end,
                   FUNCTION&& f,
                   const std::function<void(double)>& recordProgress = concurrency_detail::noop) {
-
-    if (end <= start) {
-        recordProgress(1.0);
-        return {std::forward<FUNCTION>(f)};
-    }
-
-    // See above for details.
-
-    concurrency_detail::CDefaultAsyncExecutorBusyForScope scope;
-
-    partitions = std::min(partitions, end - start);
-
-    if (partitions < 2 || scope.wasBusy()) {
-        CLoopProgress progress{end - start, recordProgress};
-        for (std::size_t i = start; i < end; ++i, progress.increment()) {
-            f(i);
-        }
-
-        // Avoid the copy from an initializer_list.
-        std::vector<FUNCTION> functions;
-        functions.reserve(1);
-        functions.push_back(std::forward<FUNCTION>(f));
-        return functions;
-    }
-
-    std::vector<FUNCTION> functions(partitions, std::forward<FUNCTION>(f));
-    concurrency_detail::parallel_for_each(start, end, functions, recordProgress);
-    return functions;
+    return concurrency_detail::parallel_for_each(
+        concurrency_detail::EPartition::E_Fixed, partitions, start, end,
+        std::forward<FUNCTION>(f), recordProgress);
 }
 
 //! Overload with number of threads partitions.
@@ -433,15 +618,46 @@ parallel_for_each(std::size_t start,
                              std::forward<FUNCTION>(f), recordProgress);
 }
 
-//! Run \p functions in parallel using async.
+//! Run \p f in parallel using async partitioning the range adaptively.
 //!
-//! This executes \p functions on a partition of the dereferenced iterators in
-//! the range [\p start, \p end) using the default async executor.
+//! This is the same as parallel_for_each except that copies of \p f claim
+//! chunks of the range as they go. This balances the load much better when
+//! the cost per index varies, but which copy of \p f gets which index depends
+//! on timing. Only use it if \p f doesn't accumulate state whose value depends
+//! on the order in which it's accumulated, such as floating point sums, or
+//! the results won't be reproducible.
+template<typename FUNCTION>
+std::vector<FUNCTION>
+parallel_for_each_adaptively(std::size_t partitions,
+                             std::size_t start,
+                             std::size_t end,
+                             FUNCTION&& f,
+                             const std::function<void(double)>& recordProgress = concurrency_detail::noop) {
+    return concurrency_detail::parallel_for_each(
+        concurrency_detail::EPartition::E_Adaptive, partitions, start, end,
+        std::forward<FUNCTION>(f), recordProgress);
+}
+
+//! Overload with number of threads partitions.
+template<typename FUNCTION>
+std::vector<FUNCTION>
+parallel_for_each_adaptively(std::size_t start,
+                             std::size_t end,
+                             FUNCTION&& f,
+                             const std::function<void(double)>& recordProgress = concurrency_detail::noop) {
+    return parallel_for_each_adaptively(defaultAsyncThreadPoolSize(), start, end,
+                                        std::forward<FUNCTION>(f), recordProgress);
+}
+
+namespace concurrency_detail {
+//! Run \p functions on the dereferenced iterators [\p start, \p end) with
+//! \p partition.
 template<typename ITR, typename FUNCTION>
-bool parallel_for_each(ITR start,
-                       ITR end,
-                       std::vector<FUNCTION>& functions,
-                       const std::function<void(double)>& recordProgress = concurrency_detail::noop) {
+bool parallel_for_each_value(EPartition partition,
+                             ITR start,
+                             ITR end,
+                             std::vector<FUNCTION>& functions,
+                             const std::function<void(double)>& recordProgress) {
 
     std::size_t size(std::distance(start, end));
     if (size == 0) {
@@ -454,13 +670,13 @@ bool parallel_for_each(ITR start,
         return false;
     }
 
-    // See above for details.
+    // See core::parallel_for_each for details.
 
-    concurrency_detail::CDefaultAsyncExecutorBusyForScope scope;
+    CDefaultAsyncExecutorBusyForScope scope;
 
     functions.resize(std::min(functions.size(), size));
 
-    if (functions.size() < 2 || scope.wasBusy()) {
+    if (functions.size() < 2 || scope.runSequentially()) {
         functions.resize(1); // For the case scope was busy.
         CLoopProgress progress{size, recordProgress};
         for (ITR i = start; i != end; ++i, progress.increment()) {
@@ -469,30 +685,19 @@ bool parallel_for_each(ITR start,
         return true;
     }
 
-    concurrency_detail::parallel_for_each(start, size, functions, recordProgress);
+    parallel_for_each(partition, start, size, functions, recordProgress);
     return true;
 }
 
-//! Run \p f in parallel using async.
-//!
-//! This executes \p f on each dereferenced iterator value in the range
-//! [\p start, \p end) using the default async executor.
-//!
-//! \param[in] partitions The number of tasks into which to partition the range.
-//! \param[in] start The first iterator for the values on which to execute \p f.
-//! \param[in] end The end iterator for the values on which to execute \p f.
-//! \param[in,out] f The function to execute on each value. This expected to
-//! be a Callable equivalent to std::function<void (decltype(*start))>.
-//! \note f must be copy constructible.
-//! \note f must be thread safe.
-//! \note If f throws this will throw.
+//! Run copies of \p f on the dereferenced iterators [\p start, \p end) with
+//! \p partition.
 template<typename ITR, typename FUNCTION>
-std::vector<FUNCTION>
-parallel_for_each(std::size_t partitions,
-                  ITR start,
-                  ITR end,
-                  FUNCTION&& f,
-                  const std::function<void(double)>& recordProgress = concurrency_detail::noop) {
+std::vector<FUNCTION> parallel_for_each_value(EPartition partition,
+                                              std::size_t partitions,
+                                              ITR start,
+                                              ITR end,
+                                              FUNCTION&& f,
+                                              const std::function<void(double)>& recordProgress) {
 
     std::size_t size(std::distance(start, end));
     if (size == 0) {
@@ -500,13 +705,13 @@ parallel_for_each(std::size_t partitions,
         return {std::forward<FUNCTION>(f)};
     }
 
-    // See above for details.
+    // See core::parallel_for_each for details.
 
-    concurrency_detail::CDefaultAsyncExecutorBusyForScope scope;
+    CDefaultAsyncExecutorBusyForScope scope;
 
     partitions = std::min(partitions, size);
 
-    if (partitions < 2 || scope.wasBusy()) {
+    if (partitions < 2 || scope.runSequentially()) {
         CLoopProgress progress{size, recordProgress};
         for (ITR i = start; i != end; ++i, progress.increment()) {
             f(*i);
@@ -520,9 +725,60 @@ parallel_for_each(std::size_t partitions,
     }
 
     std::vector<FUNCTION> functions(partitions, std::forward<FUNCTION>(f));
-    concurrency_detail::parallel_for_each(start, size, functions, recordProgress);
+    parallel_for_each(partition, start, size, functions, recordProgress);
     return functions;
 }
+}
+
+//! Run \p functions in parallel using async.
+//!
+//! This executes \p functions on a partition of the dereferenced iterators in
+//! the range [\p start, \p end) using the default async executor.
+template<typename ITR, typename FUNCTION>
+bool parallel_for_each(ITR start,
+                       ITR end,
+                       std::vector<FUNCTION>& functions,
+                       const std::function<void(double)>& recordProgress = concurrency_detail::noop) {
+    return concurrency_detail::parallel_for_each_value(
+        concurrency_detail::EPartition::E_Fixed, start, end, functions, recordProgress);
+}
+
+//! Run \p functions in parallel using async partitioning the range adaptively.
+//!
+//! See parallel_for_each_adaptively for when this can be used.
+template<typename ITR, typename FUNCTION>
+bool parallel_for_each_adaptively(ITR start,
+                                  ITR end,
+                                  std::vector<FUNCTION>& functions,
+                                  const std::function<void(double)>& recordProgress = concurrency_detail::noop) {
+    return concurrency_detail::parallel_for_each_value(
+        concurrency_detail::EPartition::E_Adaptive, start, end, functions, recordProgress);
+}
+
+//! Run \p f in parallel using async.
+//!
+//! This executes \p f on each dereferenced iterator value in the range
+//! [\p start, \p end) using the default async executor.
+//!
+//! \param[in] partitions The number of tasks into which to partition the range.
+//! \param[in] start The first iterator for the values on which to execute \p f.
+//! \param[in] end The end iterator for the values on which to execute \p f.
+//! \param[in,out] f The function to execute on each value. This expected to
+//! be a Callable equivalent to std::function<void (decltype(*start))>.
+//! \note f must be copy constructible.
+//! \note f must be thread safe.
+//! \note If f throws this will throw.
+template<typename ITR, typename FUNCTION>
+std::vector<FUNCTION>
+parallel_for_each(std::size_t partitions,
+                  ITR start,
+                  ITR end,
+                  FUNCTION&& f,
+                  const std::function<void(double)>& recordProgress = concurrency_detail::noop) {
+    return concurrency_detail::parallel_for_each_value(
+        concurrency_detail::EPartition::E_Fixed, partitions, start, end,
+        std::forward<FUNCTION>(f), recordProgress);
+}
 
 //! Overload with number of threads partitions.
 template<typename ITR, typename FUNCTION>
@@ -534,6 +790,32 @@ parallel_for_each(ITR start,
     return parallel_for_each(defaultAsyncThreadPoolSize(), start, end,
                              std::forward<FUNCTION>(f), recordProgress);
 }
+
+//! Run \p f in parallel using async partitioning the range adaptively.
+//!
+//! See parallel_for_each_adaptively for when this can be used.
+template<typename ITR, typename FUNCTION>
+std::vector<FUNCTION>
+parallel_for_each_adaptively(std::size_t partitions,
+                             ITR start,
+                             ITR end,
+                             FUNCTION&& f,
+                             const std::function<void(double)>& recordProgress = concurrency_detail::noop) {
+    return concurrency_detail::parallel_for_each_value(
+        concurrency_detail::EPartition::E_Adaptive, partitions, start, end,
+        std::forward<FUNCTION>(f), recordProgress);
+}
+
+//! Overload with number of threads partitions.
+template<typename ITR, typename FUNCTION>
+std::vector<FUNCTION>
+parallel_for_each_adaptively(ITR start,
+                             ITR end,
+                             FUNCTION&& f,
+                             const std::function<void(double)>& recordProgress = concurrency_detail::noop) {
+    return parallel_for_each_adaptively(defaultAsyncThreadPoolSize(), start, end,
+                                        std::forward<FUNCTION>(f), recordProgress);
+}
 }
 }
 
@@ -0,0 +1,93 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#ifndef INCLUDED_ml_maths_analytics_CBoostedTreeColumnMajorSplits_h
+#define INCLUDED_ml_maths_analytics_CBoostedTreeColumnMajorSplits_h
+
+#include <maths/analytics/ImportExport.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ml {
+namespace core {
+class CDataFrame;
+class CPackedBitVector;
+}
+namespace maths {
+namespace analytics {
+
+//! \brief A column major copy of the training rows' candidate split indices.
+//!
+//! DESCRIPTION:\n
+//! The data frame stores each row contiguously with the row's split indices
+//! packed four to a float. Aggregating loss derivatives for a leaf only needs
+//! the split indices of the features in the tree's feature bag, but reading
+//! them from the data frame pulls in the indices of every feature. This holds
+//! one byte per row for each feature so we can stream the indices of just the
+//! bagged features.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! The columns are indexed by data frame row index so any row mask selects
+//! the same rows here as in the data frame. The columns must be refreshed
+//! whenever the split indices stored in the data frame change.
+//!
+//! This duplicates the split indices stored in the data frame so is only worth
+//! its memory when the feature bag is a small fraction of the features.
+class MATHS_ANALYTICS_EXPORT CBoostedTreeColumnMajorSplits {
+public:
+    using TBoolVec = std::vector<bool>;
+    using TSizeVec = std::vector<std::size_t>;
+
+public:
+    //! Copy the split indices of the features in \p featureMask for the rows
+    //! in \p rowMask from \p frame.
+    //!
+    //! \param[in] numberThreads The number of threads available.
+    //! \param[in] frame The data frame holding the packed split indices.
+    //! \param[in] extraColumns The tree's extra columns.
+    //! \param[in] featureMask A mask of the features to copy.
+    //! \param[in] rowMask A mask of the rows to copy.
+    void refresh(std::size_t numberThreads,
+                 const core::CDataFrame& frame,
+                 const TSizeVec& extraColumns,
+                 const TBoolVec& featureMask,
+                 const core::CPackedBitVector& rowMask);
+
+    //! Check if we have the split indices of \p feature.
+    bool hasColumn(std::size_t feature) const {
+        return feature < m_Columns.size() && m_Columns[feature].empty() == false;
+    }
+
+    //! Check if we have the split indices of all \p features.
+    bool hasColumns(const TSizeVec& features) const;
+
+    //! Get the split indices of \p feature indexed by row.
+    const std::uint8_t* column(std::size_t feature) const {
+        return m_Columns[feature].data();
+    }
+
+    //! Get the memory used by this object.
+    std::size_t memoryUsage() const;
+
+private:
+    using TUInt8Vec = std::vector<std::uint8_t>;
+    using TUInt8VecVec = std::vector<TUInt8Vec>;
+
+private:
+    TUInt8VecVec m_Columns;
+};
+}
+}
+}
+
+#endif // INCLUDED_ml_maths_analytics_CBoostedTreeColumnMajorSplits_h
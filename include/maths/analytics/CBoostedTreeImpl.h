@@ -45,6 +45,7 @@ struct testRetrainTreeSelectionProbabilities;
 namespace ml {
 namespace maths {
 namespace analytics {
+class CBoostedTreeColumnMajorSplits;
 class CTreeShapFeatureImportance;
 namespace boosted_tree {
 class CArgMinLoss;
@@ -329,6 +330,13 @@ private:
                             const TBoolVec& featureMask,
                             const core::CPackedBitVector& trainingRowMask) const;
 
+    //! Copy the rows' cached splits to \p splits, and use them in \p workspace,
+    //! if the feature bag is small enough for this to be worthwhile.
+    void refreshColumnMajorSplits(const core::CDataFrame& frame,
+                                  const core::CPackedBitVector& trainingRowMask,
+                                  CBoostedTreeColumnMajorSplits& splits,
+                                  TWorkspace& workspace) const;
+
     //! Train one tree on the rows of \p frame in the mask \p trainingRowMask.
     TNodeVec trainTree(core::CDataFrame& frame,
                        const core::CPackedBitVector& trainingRowMask,
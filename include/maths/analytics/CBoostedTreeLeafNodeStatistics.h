@@ -45,6 +45,7 @@ struct testComputeBestSplitStatisticsThreading;
 namespace ml {
 namespace maths {
 namespace analytics {
+class CBoostedTreeColumnMajorSplits;
 class CBoostedTreeNode;
 class CDataFrameCategoryEncoder;
 class CEncodedDataFrameRowRef;
@@ -617,6 +618,17 @@ public:
         //! Get the tree being retrained if there is one.
         const TNodeVec* retraining() const { return m_TreeToRetrain; }
 
+        //! Set the column major split indices to use to aggregate loss
+        //! derivatives or null to read them from the data frame.
+        void columnMajorSplits(const CBoostedTreeColumnMajorSplits* splits) {
+            m_ColumnMajorSplits = splits;
+        }
+
+        //! Get the column major split indices if there are any.
+        const CBoostedTreeColumnMajorSplits* columnMajorSplits() const {
+            return m_ColumnMajorSplits;
+        }
+
         //! Get the minimum leaf gain which will generate a split.
         double minimumGain() const { return m_MinimumGain; }
 
@@ -690,6 +702,7 @@ public:
 
     private:
         const TNodeVec* m_TreeToRetrain{nullptr};
+        const CBoostedTreeColumnMajorSplits* m_ColumnMajorSplits{nullptr};
         std::size_t m_DimensionGradient{1};
         std::size_t m_NumberToReduce{0};
         double m_MinimumGain{0.0};
@@ -912,6 +925,12 @@ private:
                            const TSizeVec& featureBag,
                            const TRowRef& row,
                            CSplitsDerivatives& splitsDerivatives) const;
+    static void addBoundDerivatives(CLookAheadBound,
+                                    const TMemoryMappedFloatVector& derivatives,
+                                    CSplitsDerivatives& splitsDerivatives);
+    static void addBoundDerivatives(CNoLookAheadBound,
+                                    const TMemoryMappedFloatVector&,
+                                    CSplitsDerivatives&) {}
 
 private:
     std::size_t m_Id;
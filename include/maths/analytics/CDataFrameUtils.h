@@ -459,34 +459,6 @@ public:
     static bool isMissing(double value);
 
 private:
-    static TSizeDoublePrVecVecVec
-    categoricalMicWithColumnDataFrameInMemory(const CColumnValue& target,
-                                              const core::CDataFrame& frame,
-                                              const core::CPackedBitVector& rowMask,
-                                              const TSizeVec& columnMask,
-                                              const TEncoderFactoryVec& encoderFactories,
-                                              const TDoubleVecVec& frequencies,
-                                              std::size_t numberSamples);
-    static TSizeDoublePrVecVecVec
-    categoricalMicWithColumnDataFrameOnDisk(const CColumnValue& target,
-                                            const core::CDataFrame& frame,
-                                            const core::CPackedBitVector& rowMask,
-                                            const TSizeVec& columnMask,
-                                            const TEncoderFactoryVec& encoderFactories,
-                                            const TDoubleVecVec& frequencies,
-                                            std::size_t numberSamples);
-    static TDoubleVec
-    metricMicWithColumnDataFrameInMemory(const CColumnValue& target,
-                                         const core::CDataFrame& frame,
-                                         const core::CPackedBitVector& rowMask,
-                                         const TSizeVec& columnMask,
-                                         std::size_t numberSamples);
-    static TDoubleVec
-    metricMicWithColumnDataFrameOnDisk(const CColumnValue& target,
-                                       const core::CDataFrame& frame,
-                                       const core::CPackedBitVector& rowMask,
-                                       const TSizeVec& columnMask,
-                                       std::size_t numberSamples);
     static TDoubleVector
     maximizeMinimumRecallForBinary(std::size_t numberThreads,
                                    const core::CDataFrame& frame,
@@ -62,8 +62,6 @@ private:
     using TSizeVec2Ary = std::array<TSizeVec, 2>;
     using TVector2d = common::CVectorNx1<double, 2>;
     using TVector2dVec = std::vector<TVector2d>;
-    using TVectorXd = common::CVector<double>;
-    using TVectorXdVec = std::vector<TVectorXd>;
 
 private:
     void setup();
@@ -71,7 +69,7 @@ private:
     double maximumXAxisPartitionSizeToSearch() const;
     TDoubleVec equipartitionAxis(std::size_t variable, std::size_t l) const;
     TDoubleVec optimizeXAxis(const TDoubleVec& q, std::size_t l, std::size_t k) const;
-    static double entropy(const TVectorXd& dist);
+    static double entropy(const double* dist, std::size_t n);
 
 private:
     TVector2dVec m_Samples;
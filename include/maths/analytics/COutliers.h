@@ -710,6 +710,10 @@ public:
         bool s_ComputeFeatureInfluence;
         //! The fraction of true outliers among the points.
         double s_OutlierFraction;
+        //! The relative error in the nearest neighbour distances we accept
+        //! to speed up searching for neighbours. Zero means we use the exact
+        //! nearest neighbours.
+        double s_NeighbourSearchApproximation{0.0};
     };
 
 public:
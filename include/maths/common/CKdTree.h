@@ -12,6 +12,7 @@
 #ifndef INCLUDED_ml_maths_common_CKdTree_h
 #define INCLUDED_ml_maths_common_CKdTree_h
 
+#include <core/CFloatStorage.h>
 #include <core/CLogger.h>
 #include <core/CMemoryUsage.h>
 #include <core/UnwrapRef.h>
@@ -24,12 +25,15 @@
 #include <maths/common/COrderings.h>
 #include <maths/common/COrderingsSimultaneousSort.h>
 #include <maths/common/CTypeTraits.h>
+#include <maths/common/ImportExport.h>
 
 #include <boost/operators.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <type_traits>
@@ -43,6 +47,22 @@ namespace kdtree_detail {
 //! \brief Stubs out the node data parameter for k-d tree.
 struct SEmptyNodeData {};
 
+//! Compute the Euclidean distances between \p point and the \p n points
+//! whose coordinates start at \p coordinates and are stored coordinate
+//! major with \p stride.
+//!
+//! The distances are identical to las::distance up to ties and rounding.
+//!
+//! \note This works on four points at a time so there must be valid
+//! memory to read up to the next multiple of four points and \p distances
+//! must have space for that many values.
+MATHS_COMMON_EXPORT void blockDistances(const float* coordinates,
+                                        std::size_t stride,
+                                        std::size_t dimension,
+                                        const float* point,
+                                        std::size_t n,
+                                        float* distances);
+
 } // kdtree_detail::
 
 //! \brief A k-d tree.
@@ -66,6 +86,13 @@ struct SEmptyNodeData {};
 //! when it is not needed). This should be default constructible and
 //! have value semantics. This can be useful for implementing certain
 //! algorithms efficiently.
+//!
+//! For single precision dense vectors, which is what we use for outlier
+//! detection, we also keep a coordinate major copy of the points. Since
+//! each subtree occupies a contiguous range of the nodes, subtrees with
+//! at most LEAF_BLOCK_SIZE points are searched by brute force computing
+//! their distances to the query point four at a time. This avoids most
+//! of the branching and pointer chasing close to the leaves.
 template<typename POINT, typename NODE_DATA = kdtree_detail::SEmptyNodeData>
 class CKdTree {
 public:
@@ -78,6 +105,14 @@ public:
     using TPointCRef = std::reference_wrapper<const POINT>;
     using TCoordinatePrecisePointCRefPr = std::pair<TCoordinatePrecise, TPointCRef>;
     using TCoordinatePrecisePointCRefPrVec = std::vector<TCoordinatePrecisePointCRefPr>;
+    using TUInt32Vec = std::vector<std::uint32_t>;
+    using TFloatVec = std::vector<float>;
+
+    //! True if we can search blocks of points using blockDistances.
+    static constexpr bool HAS_BLOCK_SEARCH{
+        std::is_base_of<CDenseVector<core::CFloatStorage>, TPoint>::value};
+    //! The maximum number of points in a subtree which we search by brute force.
+    static constexpr std::size_t LEAF_BLOCK_SIZE{32};
 
     //! Less on a specific coordinate of point position vector.
     class CCoordinateLess {
@@ -242,14 +277,34 @@ public:
         m_Dimension = las::dimension(core::unwrap_ref(*begin));
         m_Nodes.clear();
         m_Nodes.reserve(std::distance(begin, end));
+        m_SubtreeSizes.clear();
+        m_Coordinates.clear();
+        if constexpr (HAS_BLOCK_SEARCH) {
+            m_SubtreeSizes.reserve(std::distance(begin, end));
+        }
         this->buildRecursively(nullptr, // Parent pointer
                                0,       // Split coordinate
                                begin, end, move);
+        if constexpr (HAS_BLOCK_SEARCH) {
+            this->buildCoordinates();
+        }
     }
 
     //! Get the number of points in the tree.
     std::size_t size() const { return m_Nodes.size(); }
 
+    //! Set the relative error in the neighbour distances which we accept in
+    //! order to speed up searches.
+    //!
+    //! We only search a branch if it could contain a point closer than the
+    //! current furthest neighbour divided by 1 + \p approximation. This means
+    //! the distance to the i'th neighbour found is at most 1 + \p approximation
+    //! times the distance to the true i'th nearest neighbour. Zero, the default,
+    //! means we find the exact nearest neighbours.
+    void approximation(double approximation) {
+        m_PruneScale = 1.0 + std::max(approximation, 0.0);
+    }
+
     //! Branch and bound search for nearest neighbour of \p point.
     const POINT* nearestNeighbour(const TPoint& point) const {
         // Sometimes the return type of las::zero() is not POINT. In this case
@@ -368,7 +423,9 @@ public:
 
     //! Get the memory used by this object.
     std::size_t memoryUsage() const {
-        return core::memory::dynamicSize(m_Nodes);
+        return core::memory::dynamicSize(m_Nodes) +
+               core::memory::dynamicSize(m_SubtreeSizes) +
+               core::memory::dynamicSize(m_Coordinates);
     }
 
     //! Estimate the amount of memory the k-d tree will use.
@@ -376,7 +433,11 @@ public:
     //! \param[in] numberPoints The number of points it will hold.
     //! \param[in] dimension The dimension of points it will hold.
     static std::size_t estimateMemoryUsage(std::size_t numberPoints, std::size_t dimension) {
-        return numberPoints * SNode::estimateMemoryUsage(dimension);
+        std::size_t blockSearchMemory{
+            HAS_BLOCK_SEARCH ? numberPoints * sizeof(std::uint32_t) +
+                                   (numberPoints + 3) * dimension * sizeof(float)
+                             : 0};
+        return numberPoints * SNode::estimateMemoryUsage(dimension) + blockSearchMemory;
     }
 
 private:
@@ -397,6 +458,9 @@ private:
         ITR median{begin + n};
         std::nth_element(begin, median, end, CCoordinateLess(coordinate));
         this->append(move, parent, *median);
+        if constexpr (HAS_BLOCK_SEARCH) {
+            m_SubtreeSizes.push_back(static_cast<std::uint32_t>(end - begin));
+        }
         SNode* node{&m_Nodes.back()};
         if (median - begin > 0) {
             std::size_t next{this->nextCoordinate(coordinate)};
@@ -411,6 +475,44 @@ private:
         return node;
     }
 
+    //! Copy the point coordinates in coordinate major order for block search.
+    //!
+    //! The coordinates of each node's subtree are stored contiguously since
+    //! the nodes are in pre-order. We pad with three extra points so we can
+    //! always read four points at a time.
+    void buildCoordinates() {
+        std::size_t stride{this->coordinatesStride()};
+        m_Coordinates.assign(m_Dimension * stride, 0.0F);
+        for (std::size_t i = 0; i < m_Nodes.size(); ++i) {
+            const TPoint& point{core::unwrap_ref(m_Nodes[i].s_Point)};
+            for (std::size_t j = 0; j < m_Dimension; ++j) {
+                m_Coordinates[j * stride + i] = point(j).cstorage();
+            }
+        }
+    }
+
+    //! Get the stride between coordinates of the points for block search.
+    std::size_t coordinatesStride() const { return m_Nodes.size() + 3; }
+
+    //! Get the index of \p node and the number of points in its subtree if
+    //! it should be searched by brute force.
+    std::pair<std::size_t, std::size_t> block(const SNode& node) const {
+        std::size_t index{static_cast<std::size_t>(&node - m_Nodes.data())};
+        std::size_t size{m_SubtreeSizes[index]};
+        return {index, size <= LEAF_BLOCK_SIZE ? size : 0};
+    }
+
+    //! Compute the distances between \p point and the \p size points in the
+    //! subtree rooted at the node at \p index.
+    void blockDistances(const TPoint& point,
+                        std::size_t index,
+                        std::size_t size,
+                        std::array<float, LEAF_BLOCK_SIZE + 3>& distances) const {
+        kdtree_detail::blockDistances(&m_Coordinates[index], this->coordinatesStride(),
+                                      m_Dimension, &point(0).cstorage(), size,
+                                      distances.data());
+    }
+
     //! Recursively find the nearest point to \p point.
     const POINT* nearestNeighbour(const TPoint& point,
                                   const SNode& node,
@@ -419,6 +521,24 @@ private:
                                   const POINT* nearest,
                                   TCoordinatePrecise& distanceToNearest) const {
 
+        if constexpr (HAS_BLOCK_SEARCH) {
+            auto[index, size] = this->block(node);
+            if (size > 0) {
+                std::array<float, LEAF_BLOCK_SIZE + 3> distances;
+                this->blockDistances(point, index, size, distances);
+                for (std::size_t i = 0; i < size; ++i) {
+                    TCoordinatePrecise distance{distances[i]};
+                    const POINT& candidate{m_Nodes[index + i].s_Point};
+                    if (distance < distanceToNearest ||
+                        (distance == distanceToNearest && core::unwrap_ref(candidate) < point)) {
+                        distanceToNearest = distance;
+                        nearest = &candidate;
+                    }
+                }
+                return nearest;
+            }
+        }
+
         TCoordinatePrecise distance{las::distance(point, core::unwrap_ref(node.s_Point))};
 
         if (distance < distanceToNearest ||
@@ -444,7 +564,7 @@ private:
             nearest = this->nearestNeighbour(point, *primary, distancesToHyperplanes,
                                              nextCoordinate, nearest, distanceToNearest);
             std::swap(distancesToHyperplanes(coordinate), distanceToHyperplane);
-            if (las::norm(distancesToHyperplanes) < distanceToNearest) {
+            if (m_PruneScale * las::norm(distancesToHyperplanes) < distanceToNearest) {
                 nearest = this->nearestNeighbour(point, *secondary,
                                                  distancesToHyperplanes, nextCoordinate,
                                                  nearest, distanceToNearest);
@@ -471,6 +591,26 @@ private:
                            std::size_t coordinate,
                            TCoordinatePrecisePointCRefPrVec& nearest) const {
 
+        if constexpr (HAS_BLOCK_SEARCH) {
+            auto[index, size] = this->block(node);
+            if (size > 0) {
+                std::array<float, LEAF_BLOCK_SIZE + 3> distances;
+                this->blockDistances(point, index, size, distances);
+                for (std::size_t i = 0; i < size; ++i) {
+                    TCoordinatePrecise distance{distances[i]};
+                    const TPoint& candidate{core::unwrap_ref(m_Nodes[index + i].s_Point)};
+                    if (distance < nearest.front().first ||
+                        (distance == nearest.front().first && candidate < point)) {
+                        std::pop_heap(nearest.begin(), nearest.end(), less);
+                        nearest.back().first = distance;
+                        nearest.back().second = std::cref(candidate);
+                        std::push_heap(nearest.begin(), nearest.end(), less);
+                    }
+                }
+                return;
+            }
+        }
+
         TCoordinatePrecise distance{las::distance(point, core::unwrap_ref(node.s_Point))};
 
         if (distance < nearest.front().first ||
@@ -498,7 +638,7 @@ private:
             this->nearestNeighbours(point, less, *primary, distancesToHyperplanes,
                                     nextCoordinate, nearest);
             std::swap(distancesToHyperplanes(coordinate), distanceToHyperplane);
-            if (las::norm(distancesToHyperplanes) < nearest.front().first) {
+            if (m_PruneScale * las::norm(distancesToHyperplanes) < nearest.front().first) {
                 this->nearestNeighbours(point, less, *secondary, distancesToHyperplanes,
                                         nextCoordinate, nearest);
             }
@@ -550,8 +690,18 @@ private:
     //! The point dimension.
     std::size_t m_Dimension;
 
+    //! The multiplier of the distance to a branch used to decide whether to
+    //! search it. This is one plus the approximation.
+    double m_PruneScale{1.0};
+
     //! The representation of the points.
     TNodeVec m_Nodes;
+
+    //! The number of points in the subtree rooted at each node.
+    TUInt32Vec m_SubtreeSizes;
+
+    //! The point coordinates in coordinate major order for block search.
+    TFloatVec m_Coordinates;
 };
 }
 }
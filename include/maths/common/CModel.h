@@ -371,6 +371,7 @@ public:
     using TDouble2VecWeightsAry = maths_t::TDouble2VecWeightsAry;
     using TDouble2VecWeightsAry1Vec = maths_t::TDouble2VecWeightsAry1Vec;
     using TTail2Vec = core::CSmallVector<maths_t::ETail, 2>;
+    using TDoubleVec = std::vector<double>;
 
     //! Possible statuses for updating a model.
     enum EUpdateResult {
@@ -489,6 +490,27 @@ public:
                              const TDouble2Vec1Vec& value,
                              common::SModelProbabilityResult& result) const = 0;
 
+    //! Compute the probabilities of drawing each of \p values at \p time.
+    //!
+    //! This is equivalent to calling probability for each value in turn with
+    //! the corresponding element of \p weights and reading off the overall
+    //! probability, but implementations can share the work which only depends
+    //! on \p time and skip computing the anomaly score explanation.
+    //!
+    //! \param[in] params The parameters for the calculation. Their weights
+    //! are ignored in favour of \p weights.
+    //! \param[in] time The time of \p values.
+    //! \param[in] values The values for which to compute probabilities.
+    //! \param[in] weights The weights of each of \p values.
+    //! \param[out] probabilities Filled in with the probability of each of
+    //! \p values.
+    //! \return False if any of the probabilities couldn't be computed.
+    virtual bool probabilities(const CModelProbabilityParams& params,
+                               const TTime2Vec1Vec& time,
+                               const TDouble2Vec1Vec& values,
+                               const TDouble2VecWeightsAry1Vec& weights,
+                               TDoubleVec& probabilities) const;
+
     //! Fill in \p trendWeights and \p residualWeights with the count related
     //! weights for \p value.
     virtual void countWeights(core_t::TTime time,
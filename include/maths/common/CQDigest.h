@@ -83,6 +83,7 @@ class MATHS_COMMON_EXPORT CQDigest : private core::CNonCopyable {
 public:
     using TUInt32UInt64Pr = std::pair<std::uint32_t, std::uint64_t>;
     using TUInt32UInt64PrVec = std::vector<TUInt32UInt64Pr>;
+    using TUInt32Vec = std::vector<std::uint32_t>;
 
 public:
     //! \name XML Tag Names
@@ -187,6 +188,16 @@ public:
     //! \param[out] result Filled in with the summary.
     void summary(TUInt32UInt64PrVec& result) const;
 
+    //! Get the points at which the c.d.f. and p.d.f. bounds can change.
+    //!
+    //! The bounds are piecewise constant functions of \p x and for any
+    //! \p x they are equal to their values at the largest change point
+    //! less than or equal to \p x.
+    //!
+    //! \param[out] result Filled in with the change points in ascending
+    //! order. This always includes zero.
+    void changePoints(TUInt32Vec& result) const;
+
     //! Get the total number of values added to the q-digest.
     std::uint64_t n() const;
 
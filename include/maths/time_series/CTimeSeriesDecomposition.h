@@ -61,6 +61,9 @@ namespace time_series {
 class MATHS_TIME_SERIES_EXPORT EMPTY_BASE_OPT CTimeSeriesDecomposition
     : public CTimeSeriesDecompositionInterface,
       private CTimeSeriesDecompositionDetail {
+public:
+    using TDoubleVec = CTimeSeriesDecompositionInterface::TDoubleVec;
+
 public:
     //! \param[in] decayRate The rate at which information is lost.
     //! \param[in] bucketLength The data bucketing length.
@@ -188,6 +191,13 @@ public:
                    bool isNonNegative,
                    core_t::TTime maximumTimeShift = 0) const override;
 
+    //! Remove the prediction of the component models at \p time from each
+    //! of \p values.
+    void detrend(core_t::TTime time,
+                 double confidence,
+                 bool isNonNegative,
+                 TDoubleVec& values) const override;
+
     //! Get the mean variance of the baseline.
     double meanVariance() const override;
 
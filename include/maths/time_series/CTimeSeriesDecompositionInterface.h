@@ -56,6 +56,7 @@ public:
 class MATHS_TIME_SERIES_EXPORT CTimeSeriesDecompositionInterface
     : public CTimeSeriesDecompositionTypes {
 public:
+    using TDoubleVec = std::vector<double>;
     using TVector2x1 = common::CVectorNx1<double, 2>;
     using TDouble3Vec = core::CSmallVector<double, 3>;
     using TDouble3VecVec = std::vector<TDouble3Vec>;
@@ -173,6 +174,16 @@ public:
                            bool isNonNegative,
                            core_t::TTime maximumTimeShift = 0) const = 0;
 
+    //! Remove the prediction of the component models at \p time from each
+    //! of \p values.
+    //!
+    //! This is equivalent to calling detrend for each value without a time
+    //! shift, but computes the prediction only once.
+    virtual void detrend(core_t::TTime time,
+                         double confidence,
+                         bool isNonNegative,
+                         TDoubleVec& values) const = 0;
+
     //! Get the mean variance of the baseline.
     virtual double meanVariance() const = 0;
 
@@ -91,6 +91,12 @@ public:
                    bool isNonNegative,
                    core_t::TTime maximumTimeShift = 0) const override;
 
+    //! No-op.
+    void detrend(core_t::TTime time,
+                 double confidence,
+                 bool isNonNegative,
+                 TDoubleVec& values) const override;
+
     //! Returns 0.0.
     double meanVariance() const override;
 
@@ -148,6 +148,17 @@ public:
                      const TDouble2Vec1Vec& value,
                      common::SModelProbabilityResult& result) const override;
 
+    //! Compute the probabilities of drawing each of \p values at \p time.
+    //!
+    //! For uncorrelated values without multi-bucket features or the anomaly
+    //! model this detrends all values in one go and only computes the residual
+    //! model probabilities.
+    bool probabilities(const common::CModelProbabilityParams& params,
+                       const TTime2Vec1Vec& time,
+                       const TDouble2Vec1Vec& values,
+                       const TDouble2VecWeightsAry1Vec& weights,
+                       TDoubleVec& probabilities) const override;
+
     //! Fill in \p trendWeights and \p residualWeights with the count related
     //! weights for \p value.
     void countWeights(core_t::TTime time,
@@ -153,6 +153,17 @@ public:
     //! simple count detector to ensure singleton behaviour
     bool staticsAcceptRestoreTraverser(core::CStateRestoreTraverser& traverser);
 
+    //! Set whether detectors persist and restore the process wide statics,
+    //! i.e. the program counters and the default random number generator.
+    //!
+    //! This is on by default. It must be turned off if several jobs run in
+    //! one process, since restoring one job would overwrite the statics the
+    //! other jobs are using.
+    static void persistStatics(bool enabled);
+
+    //! Check whether detectors persist and restore the process wide statics.
+    static bool persistsStatics();
+
     //! Find the partition field value given part of an state document.
     //!
     //! \note This is static so it can be called before the state is fully
@@ -270,6 +281,13 @@ public:
     //! Return the total memory usage
     std::size_t memoryUsage() const override;
 
+    //! Returns true, as anomaly detectors track their memory usage.
+    bool supportsMemoryTracking() const override;
+
+    //! Get the memory usage from the counters the gatherer and model
+    //! maintain as people, attributes and bucket data are added and removed.
+    std::size_t trackedMemoryUsage() const override;
+
     //! Get the static size of this object - used for virtual hierarchies
     std::size_t staticSize() const override;
 
@@ -447,6 +447,11 @@ public:
     //! Get the memory used by this model
     virtual std::size_t memoryUsage() const = 0;
 
+    //! Get the memory used by the people and attributes' models, which is
+    //! maintained as they are created, recycled and pruned. This is cheap
+    //! to compute, but doesn't include growth of the models themselves.
+    std::size_t trackedMemoryUsage() const;
+
     //! Estimate the memory usage of the model based on number of people,
     //! attributes and correlations. Returns empty when the estimator
     //! is unable to produce an estimate.
@@ -721,6 +726,16 @@ protected:
     TUint64TTimePrVec& appliedRuleChecksums();
     const TUint64TTimePrVec& appliedRuleChecksums() const;
 
+    //! Add \p memory to the tracked memory usage.
+    void increaseTrackedMemoryUsage(std::size_t memory);
+
+    //! Subtract \p memory from the tracked memory usage.
+    void decreaseTrackedMemoryUsage(std::size_t memory);
+
+    //! Update the tracked memory usage for replacing a model whose memory
+    //! usage is \p previous with \p model.
+    void replaceTrackedModel(std::size_t previous, const maths::common::CModel& model);
+
 private:
     using TModelParamsCRef = std::reference_wrapper<const SModelParams>;
 
@@ -752,6 +767,10 @@ private:
 
     //! Checksums of the rules that should be applied only once.
     TUint64TTimePrVec m_AppliedRuleChecksums;
+
+    //! The memory used by the people and attributes' models when they were
+    //! created. (This is not persisted.)
+    std::size_t m_TrackedMemoryUsage{0};
 };
 
 class CMemoryCircuitBreaker : public core::CMemoryCircuitBreaker {
@@ -128,6 +128,7 @@ public:
             TOptionalStrCRef m_PersonFieldName;
             TOptionalStrCRef m_PersonFieldValue;
         };
+        using TMaximumScoreScopeVec = std::vector<CMaximumScoreScope>;
 
     public:
         explicit CNormalizer(const CAnomalyDetectorModelConfig& config);
@@ -140,6 +141,12 @@ public:
         //! of a vector of scores to be aggregated.
         bool normalize(const CMaximumScoreScope& scope, double& score) const;
 
+        //! Normalize each of \p scores, whose scopes are \p scopes, in place.
+        //!
+        //! This is equivalent to normalizing each score in turn, but computes
+        //! the terms which don't depend on the score only once.
+        bool normalize(const TMaximumScoreScopeVec& scopes, TDoubleVec& scores) const;
+
         //! Estimate the quantile range including the \p score.
         //!
         //! \param[in] score The score to estimate.
@@ -188,6 +195,9 @@ public:
     private:
         using TDoubleDoublePr = std::pair<double, double>;
         using TDoubleDoublePrVec = std::vector<TDoubleDoublePr>;
+        using TOptionalDoubleDoublePr = std::optional<TDoubleDoublePr>;
+        using TOptionalDoubleDoublePrVec = std::vector<TOptionalDoubleDoublePr>;
+        using TUInt32Vec = std::vector<std::uint32_t>;
 
         //! \brief Wraps a maximum score.
         class CMaxScore {
@@ -219,6 +229,42 @@ public:
         };
         using TWordMaxScoreUMap = TDictionary::TWordTUMap<CMaxScore>;
 
+        //! \brief The terms in the normalized score which only depend on
+        //! the quantile summary.
+        struct SScoreIndependentTerms {
+            //! The noise percentile discrete score.
+            std::uint32_t s_NoiseScore;
+            //! The normalized score at the noise percentile.
+            double s_NoiseKnotPoint;
+            //! The contribution to the noise ceiling of the zero score c.d.f.
+            double s_ZeroScoreCeiling;
+        };
+        using TOptionalScoreIndependentTerms = std::optional<SScoreIndependentTerms>;
+
+        //! \brief A lookup table for the percentiles of the raw scores.
+        //!
+        //! DESCRIPTION:
+        //! The percentile range of a discrete score only changes at the
+        //! change points of the quantile summaries. Once enough scores
+        //! have been normalized since the summaries last changed we find
+        //! these and look up the interval containing each score with a
+        //! binary search. The range for each interval is computed the
+        //! first time it is needed so building the table never costs
+        //! more than querying the summaries directly.
+        struct SPercentileLookup {
+            //! Invalidate the table after the quantile summaries change.
+            void clear();
+
+            //! The number of scores normalized since the table was cleared.
+            std::size_t s_NumberQueries{0};
+            //! The discrete scores at which the percentile range can change.
+            TUInt32Vec s_ChangePoints;
+            //! The percentile range for each interval between change points.
+            TOptionalDoubleDoublePrVec s_Percentiles;
+            //! The terms in the normalized score which don't depend on the score.
+            TOptionalScoreIndependentTerms s_ScoreIndependentTerms;
+        };
+
     private:
         //! Used to convert raw scores in to integers so that we
         //! can use the q-digest.
@@ -243,6 +289,10 @@ public:
         //! big change when updating the quantiles.
         constexpr static double BIG_CHANGE_FACTOR{1.1};
 
+        //! The number of scores which must be normalized between changes
+        //! to the quantile summaries before we build the percentile lookup.
+        constexpr static std::size_t MINIMUM_QUERIES_FOR_PERCENTILE_LOOKUP{32};
+
     private:
         //! Compute the discrete score from a raw score.
         std::uint32_t discreteScore(double rawScore) const;
@@ -253,6 +303,25 @@ public:
         //! Retrieve the maximum score for a partition
         bool maxScore(const CMaximumScoreScope& scope, double& maxScore) const;
 
+        //! Get the terms in the normalized score which don't depend on the
+        //! score.
+        const SScoreIndependentTerms& scoreIndependentTerms() const;
+
+        //! Estimate the quantile range including \p discreteScore.
+        void discreteScoreQuantile(std::uint32_t discreteScore,
+                                   double confidence,
+                                   double& lowerBound,
+                                   double& upperBound) const;
+
+        //! Get the percentile range including \p discreteScore using the
+        //! lookup table when it is available.
+        void percentiles(std::uint32_t discreteScore, double& lowerBound, double& upperBound) const;
+
+        //! Normalize the non-zero \p score given \p terms.
+        void normalize(const SScoreIndependentTerms& terms,
+                       const CMaximumScoreScope& scope,
+                       double& score) const;
+
     private:
         //! The percentile defining the largest noise score.
         double m_NoisePercentile;
@@ -293,6 +362,10 @@ public:
         //! The time to when we next age the quantiles.
         double m_TimeToQuantileDecay;
 
+        //! A lookup table for the percentiles of the raw scores which is
+        //! valid until the quantile summaries next change.
+        mutable SPercentileLookup m_PercentileLookup;
+
     private:
         friend struct CAnomalyScoreTest::testNormalizerGetMaxScore;
     };
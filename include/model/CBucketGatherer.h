@@ -23,6 +23,8 @@
 #include <model/ImportExport.h>
 #include <model/ModelTypes.h>
 
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <boost/unordered/unordered_flat_set.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
 
@@ -78,7 +80,22 @@ public:
     using TWordSizeUMap = TDictionary::TWordTUMap<std::size_t>;
     using TWordSizeUMapItr = TWordSizeUMap::iterator;
     using TWordSizeUMapCItr = TWordSizeUMap::const_iterator;
-    using TSizeSizePrUInt64UMap = boost::unordered_map<TSizeSizePr, std::uint64_t>;
+
+    //! \brief Hashes a (person, attribute) identifier pair.
+    //!
+    //! The identifiers are packed into a single 64 bit word. The open
+    //! addressing containers post-mix the hash so this needs no further
+    //! mixing and is much cheaper than hashing the pair's members.
+    struct MODEL_EXPORT SSizeSizePrHash {
+        std::size_t operator()(const TSizeSizePr& key) const {
+            return static_cast<std::size_t>(
+                (static_cast<std::uint64_t>(key.first) << 32) ^
+                static_cast<std::uint64_t>(key.second));
+        }
+    };
+
+    using TSizeSizePrUInt64UMap =
+        boost::unordered_flat_map<TSizeSizePr, std::uint64_t, SSizeSizePrHash>;
     using TSizeSizePrUInt64UMapItr = TSizeSizePrUInt64UMap::iterator;
     using TSizeSizePrUInt64UMapCItr = TSizeSizePrUInt64UMap::const_iterator;
     using TSizeSizePrUInt64UMapQueue = CBucketQueue<TSizeSizePrUInt64UMap>;
@@ -86,7 +103,7 @@ public:
     using TSizeSizePrUInt64UMapQueueItr = TSizeSizePrUInt64UMapQueue::iterator;
     using TSizeSizePrUInt64UMapQueueCItr = TSizeSizePrUInt64UMapQueue::const_iterator;
     using TSizeSizePrUInt64UMapQueueCRItr = TSizeSizePrUInt64UMapQueue::const_reverse_iterator;
-    using TSizeSizePrUSet = boost::unordered_set<TSizeSizePr>;
+    using TSizeSizePrUSet = boost::unordered_flat_set<TSizeSizePr, SSizeSizePrHash>;
     using TSizeSizePrUSetCItr = TSizeSizePrUSet::const_iterator;
     using TSizeSizePrUSetQueue = CBucketQueue<TSizeSizePrUSet>;
     using TTimeSizeSizePrUSetMap = std::map<core_t::TTime, TSizeSizePrUSet>;
@@ -115,7 +132,7 @@ public:
     };
 
     using TSizeSizePrOptionalStrPrUInt64UMap =
-        boost::unordered_map<TSizeSizePrOptionalStrPr, std::uint64_t, SSizeSizePrOptionalStrPrHash, SSizeSizePrOptionalStrPrEqual>;
+        boost::unordered_flat_map<TSizeSizePrOptionalStrPr, std::uint64_t, SSizeSizePrOptionalStrPrHash, SSizeSizePrOptionalStrPrEqual>;
     using TSizeSizePrOptionalStrPrUInt64UMapCItr = TSizeSizePrOptionalStrPrUInt64UMap::const_iterator;
     using TSizeSizePrOptionalStrPrUInt64UMapItr = TSizeSizePrOptionalStrPrUInt64UMap::iterator;
     using TSizeSizePrOptionalStrPrUInt64UMapVec = std::vector<TSizeSizePrOptionalStrPrUInt64UMap>;
@@ -317,6 +334,11 @@ public:
     //! Get the memory used by this component.
     virtual std::size_t memoryUsage() const = 0;
 
+    //! Get the memory used by the bucket data, which is maintained as it
+    //! is added and removed. This is cheap to compute, but doesn't include
+    //! the growth of the data for existing (person, attribute) pairs.
+    std::size_t trackedMemoryUsage() const;
+
     //! Get the static size of this object.
     virtual std::size_t staticSize() const = 0;
 
@@ -432,6 +454,12 @@ private:
     void hiddenTimeNow(core_t::TTime time, bool skipUpdates);
 
 protected:
+    //! Add \p memory to the tracked memory usage.
+    void increaseTrackedMemoryUsage(std::size_t memory);
+
+    //! Subtract \p memory from the tracked memory usage.
+    void decreaseTrackedMemoryUsage(std::size_t memory);
+
     //! Reference to the owning data gatherer
     CDataGatherer& m_DataGatherer;
 
@@ -452,6 +480,9 @@ private:
 
     //! The influencing field value counts per person and/or attribute.
     TSizeSizePrOptionalStrPrUInt64UMapVecQueue m_InfluencerCounts;
+
+    //! The memory used by the bucket data when it was added.
+    std::size_t m_TrackedMemoryUsage{0};
 };
 }
 }
@@ -21,6 +21,7 @@
 
 #include <functional>
 #include <string>
+#include <utility>
 
 namespace ml {
 namespace model {
@@ -104,6 +105,31 @@ public:
         this->push(item);
     }
 
+    //! Moves the earliest item to the front of the queue, after calling
+    //! \p reset on it, and moves the time forward by bucket length. This
+    //! is equivalent to push except that the storage of the item which
+    //! falls out of the queue is reused for the new bucket. If the \p time
+    //! is earlier than the latest bucket end, the operation is ignored.
+    //!
+    //! \param[in] reset Resets the recycled item to its initial state.
+    //! \param[in] time The time to which the item corresponds.
+    template<typename F>
+    void recycle(const F& reset, core_t::TTime time) {
+        if (time <= m_LatestBucketEnd) {
+            LOG_ERROR(<< "Recycle was called with early time = " << time
+                      << ", latest bucket end time = " << m_LatestBucketEnd);
+            return;
+        }
+        m_LatestBucketEnd += m_BucketLength;
+        T item;
+        if (m_Queue.full()) {
+            item = std::move(m_Queue.back());
+        }
+        reset(item);
+        m_Queue.push_front(std::move(item));
+        LOG_TRACE(<< "Queue after recycle -> " << *this);
+    }
+
     //! Pushes an item to the queue. This is only intended to be used
     //! internally and from clients that perform restoration of the queue.
     void push(const T& item) {
@@ -112,7 +112,7 @@ public:
     using TSizeSizePr = std::pair<std::size_t, std::size_t>;
     using TSizeSizePrUInt64Pr = std::pair<TSizeSizePr, std::uint64_t>;
     using TSizeSizePrUInt64PrVec = std::vector<TSizeSizePrUInt64Pr>;
-    using TSizeSizePrUInt64UMap = boost::unordered_map<TSizeSizePr, std::uint64_t>;
+    using TSizeSizePrUInt64UMap = CBucketGatherer::TSizeSizePrUInt64UMap;
     using TSizeSizePrUInt64UMapQueue = CBucketQueue<TSizeSizePrUInt64UMap>;
     using TSizeSizePrOptionalStrPrUInt64UMap = CBucketGatherer::TSizeSizePrOptionalStrPrUInt64UMap;
     using TSizeSizePrOptionalStrPrUInt64UMapVec = std::vector<TSizeSizePrOptionalStrPrUInt64UMap>;
@@ -377,6 +377,9 @@ public:
     //! Get the number of active people (not pruned).
     std::size_t numberActivePeople() const;
 
+    //! Get the mean memory used to register each active person.
+    std::size_t memoryUsagePerPerson() const;
+
     //! Get the maximum person identifier seen so far
     //! (some of which might have been pruned).
     std::size_t numberPeople() const;
@@ -448,6 +451,9 @@ public:
     //! Get the number of active attributes (not pruned).
     std::size_t numberActiveAttributes() const;
 
+    //! Get the mean memory used to register each active attribute.
+    std::size_t memoryUsagePerAttribute() const;
+
     //! Get the maximum attribute identifier seen so far
     //! (some of which might have been pruned).
     std::size_t numberAttributes() const;
@@ -570,6 +576,11 @@ public:
     //! Get the memory used by this component.
     std::size_t memoryUsage() const;
 
+    //! Get the memory used by the people and attributes registered with
+    //! this gatherer and its bucket data, which is maintained as they are
+    //! added and removed.
+    std::size_t trackedMemoryUsage() const;
+
     //! Clear this data gatherer.
     void clear();
 
@@ -19,9 +19,10 @@
 
 #include <model/ImportExport.h>
 
-#include <boost/unordered_map.hpp>
+#include <boost/unordered/unordered_flat_map.hpp>
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ml {
@@ -39,10 +40,17 @@ class CResourceMonitor;
 //! The registry provides mapping from a registered string to its id and
 //! vice versa. In addition, the registry provides a recycling mechanism
 //! in order to reuse IDs whose mapped string is no longer relevant.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! Names are looked up by their compressed dictionary word, which is
+//! computed once per lookup directly from the name's characters. The
+//! words are stored in an open addressing table so a lookup is usually
+//! a single probe of contiguous memory, and the hash is reused without
+//! further mixing. The table entries don't hold the names themselves.
 class MODEL_EXPORT CDynamicStringIdRegistry {
 public:
     using TDictionary = core::CCompressedDictionary<2>;
-    using TWordSizeUMap = TDictionary::TWordTUMap<std::size_t>;
+    using TWordSizeUMap = TDictionary::TWordTUFlatMap<std::size_t>;
     using TWordSizeUMapItr = TWordSizeUMap::iterator;
     using TWordSizeUMapCItr = TWordSizeUMap::const_iterator;
     using TSizeVec = std::vector<std::size_t>;
@@ -85,7 +93,7 @@ public:
     //! \param[out] result Filled in with the identifier of \p name
     //! if it exists otherwise max std::size_t.
     //! \return True if the name exists and false otherwise.
-    bool id(const std::string& name, std::size_t& result) const;
+    bool id(std::string_view name, std::size_t& result) const;
 
     //! Get the unique identifier of an arbitrary known name.
     //! \param[out] result Filled in with the identifier of a name
@@ -134,6 +142,14 @@ public:
     //! Get the memory used by this registry.
     std::size_t memoryUsage() const;
 
+    //! Get the memory used by the registered names, which is maintained
+    //! as names are added and removed and so is cheap to compute.
+    std::size_t trackedMemoryUsage() const;
+
+    //! Get the mean memory used per active name, including its entry in
+    //! the identifier lookup table.
+    std::size_t memoryUsagePerName() const;
+
     void acceptPersistInserter(core::CStatePersistInserter& inserter) const;
     bool acceptRestoreTraverser(core::CStateRestoreTraverser& traverser);
 
@@ -167,6 +183,9 @@ private:
 
     //! A list of recycled unique identifiers.
     TSizeVec m_RecycledUids;
+
+    //! The memory used by the registered names and their identifiers.
+    std::size_t m_TrackedMemoryUsage{0};
 };
 }
 }
@@ -12,6 +12,7 @@
 #ifndef INCLUDED_ml_model_CModelFactory_h
 #define INCLUDED_ml_model_CModelFactory_h
 
+#include <core/CFastMutex.h>
 #include <core/CoreTypes.h>
 
 #include <maths/common/COrderings.h>
@@ -146,7 +147,9 @@ public:
     //! CModelConfig this is ensured for you.
     CModelFactory(const SModelParams& params,
                   const TInterimBucketCorrectorWPtr& interimBucketCorrector);
+    CModelFactory(const CModelFactory& other);
     virtual ~CModelFactory() = default;
+    CModelFactory& operator=(const CModelFactory&) = delete;
 
     //! Create a copy of the factory owned by the calling code.
     virtual CModelFactory* clone() const = 0;
@@ -447,6 +450,11 @@ private:
     //! memory usage in the objects this creates.
     TInterimBucketCorrectorWPtr m_InterimBucketCorrector;
 
+    //! Protects the caches, which are filled on demand and so can be
+    //! written by detectors sharing this factory which are restored
+    //! concurrently.
+    mutable core::CFastMutex m_CacheMutex;
+
     //! A cache of models for collections of features.
     mutable TFeatureVecMathsModelMap m_MathsModelCache;
 
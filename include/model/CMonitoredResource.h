@@ -29,8 +29,8 @@ namespace model {
 //!
 //! IMPLEMENTATION DECISIONS:\n
 //! Defaults to the assumption that monitored resources do not support
-//! pruning.  Methods related to pruning have default implementations
-//! consistent with this assumption.
+//! pruning or memory tracking.  Methods related to these have default
+//! implementations consistent with this assumption.
 //!
 class MODEL_EXPORT CMonitoredResource {
 public:
@@ -45,6 +45,15 @@ public:
     //! Get the static size of the derived class
     virtual std::size_t staticSize() const = 0;
 
+    //! Does this monitored resource track its memory usage?
+    virtual bool supportsMemoryTracking() const;
+
+    //! Get the memory usage from counters which are maintained as memory
+    //! is allocated and freed. This must be much cheaper to compute than
+    //! memoryUsage. It is only used to estimate the change in memory usage
+    //! since the last call to memoryUsage, so it needn't count everything.
+    virtual std::size_t trackedMemoryUsage() const;
+
     //! Does this monitored resource support pruning?
     virtual bool supportsPruning() const;
 
@@ -29,6 +29,8 @@ class CTestFixture;
 struct testMonitor;
 struct testPeakUsage;
 struct testPruning;
+struct testTrackedMemoryUsage;
+struct testUntrackedMemoryGrowthBound;
 struct testUpdateMoments;
 }
 namespace CResourceLimitTest {
@@ -57,6 +59,7 @@ public:
         std::size_t s_ByFields{0};
         std::size_t s_PartitionFields{0};
         std::size_t s_OverFields{0};
+        std::size_t s_MaximumMemoryUsagePerFieldValue{0};
         std::size_t s_AllocationFailures{0};
         model_t::EMemoryStatus s_MemoryStatus{model_t::E_MemoryStatusOk};
         model_t::EAssignmentMemoryBasis s_AssignmentMemoryBasis{model_t::E_AssignmentBasisUnknown};
@@ -79,6 +82,12 @@ public:
     static const double DEFAULT_BYTE_LIMIT_MARGIN;
     //! The maximum value of elapsed time used to scale the byte limit margin
     static const core_t::TTime MAXIMUM_BYTE_LIMIT_MARGIN_PERIOD;
+    //! The maximum number of times a resource's memory usage is updated from
+    //! its tracked memory usage before it is fully recalculated
+    static const std::size_t MAXIMUM_TRACKED_UPDATES;
+    //! The maximum fraction of a resource's memory usage which can grow
+    //! untracked between full recalculations
+    static const double MAXIMUM_UNTRACKED_MEMORY_FRACTION;
 
 public:
     //! Default constructor
@@ -104,10 +113,14 @@ public:
     //! Register a callback to be used when the memory usage grows
     void memoryUsageReporter(const TMemoryUsageReporterFunc& reporter);
 
-    //! Recalculate the memory usage if there is a memory limit
+    //! Update the memory usage if there is a memory limit
+    //!
+    //! \note For resources which track their memory usage this only does a
+    //! full recalculation periodically.
     void refresh(CMonitoredResource& resource);
 
-    //! Recalculate the memory usage regardless of whether there is a memory limit
+    //! Fully recalculate the memory usage regardless of whether there is a
+    //! memory limit
     void forceRefresh(CMonitoredResource& resource);
 
     //! Recalculate the memory usage for all monitored resources
@@ -178,8 +191,21 @@ public:
     void decreaseMargin(core_t::TTime elapsedTime);
 
 private:
-    using TMonitoredResourcePtrSizeUMap =
-        boost::unordered_map<CMonitoredResource*, std::size_t>;
+    //! \brief The memory usage of a monitored resource.
+    struct SResourceMemoryUsage {
+        //! The most recent memory usage.
+        std::size_t s_Usage{0};
+        //! The memory usage at the last full calculation.
+        std::size_t s_CalculatedUsage{0};
+        //! The tracked memory usage at the last full calculation.
+        std::size_t s_TrackedUsage{0};
+        //! The number of updates since the last full calculation.
+        std::size_t s_TrackedUpdates{0};
+        //! The number of updates allowed before the next full calculation.
+        std::size_t s_MaximumTrackedUpdates{0};
+    };
+    using TMonitoredResourcePtrMemoryUsageUMap =
+        boost::unordered_map<CMonitoredResource*, SResourceMemoryUsage>;
     using TMeanVarAccumulator =
         maths::common::CBasicStatistics::SSampleMeanVar<double>::TAccumulator;
 
@@ -189,7 +215,22 @@ private:
     void updateMemoryLimitsAndPruneThreshold(std::size_t limitMBs);
 
     //! Update the given model and recalculate the total usage
-    void memUsage(CMonitoredResource* resource);
+    //!
+    //! \param[in] calculate If true the usage is fully recalculated,
+    //! otherwise it is updated from the resource's tracked memory usage
+    //! when that is supported.
+    void memUsage(CMonitoredResource* resource, bool calculate);
+
+    //! Fully recalculate the memory usage of \p resource.
+    //!
+    //! This also sets the number of tracked updates before the next full
+    //! calculation. The memory the resource doesn't track, for example the
+    //! per bucket data held by data gatherers, can grow between them. We
+    //! measure its growth per update from the error in the tracked usage and
+    //! allow only as many updates as keep the untracked growth less than
+    //! MAXIMUM_UNTRACKED_MEMORY_FRACTION of the usage.
+    static void calculateMemUsage(CMonitoredResource& resource,
+                                  SResourceMemoryUsage& usage);
 
     //! Update the moments that are used to determine whether memory is stable
     void updateMoments(std::size_t totalMemory,
@@ -231,7 +272,7 @@ private:
 
 private:
     //! The registered collection of components
-    TMonitoredResourcePtrSizeUMap m_Resources;
+    TMonitoredResourcePtrMemoryUsageUMap m_Resources;
 
     //! Is there enough free memory to allow creating new components
     bool m_AllowAllocations{true};
@@ -316,6 +357,8 @@ private:
     friend struct CResourceMonitorTest::testMonitor;
     friend struct CResourceMonitorTest::testPeakUsage;
     friend struct CResourceMonitorTest::testPruning;
+    friend struct CResourceMonitorTest::testTrackedMemoryUsage;
+    friend struct CResourceMonitorTest::testUntrackedMemoryGrowthBound;
     friend struct CResourceMonitorTest::testUpdateMoments;
     friend struct CAnomalyJobLimitTest::testAccuracy;
     friend struct CAnomalyJobLimitTest::testLimit;
@@ -20,11 +20,55 @@
 #include <model/CTokenListDataCategorizerBase.h>
 
 #include <algorithm>
-#include <cctype>
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace ml {
 namespace model {
+namespace tokeniser_detail {
+//! Bits of the character class table used by the tokeniser.
+enum ECharClass : std::uint8_t {
+    E_Alnum = 0x01,
+    E_Digit = 0x02,
+    E_TokenChar = 0x04, //!< Can appear anywhere in a token
+    E_Joiner = 0x08,    //!< Can appear after the first character of a token
+    E_NonHex = 0x10,
+    E_Newline = 0x20
+};
+
+//! Build the table of character classes used by the tokeniser.  This avoids
+//! locale dependent character classification calls and lets the tokeniser
+//! decide how to treat each character with a single lookup.
+template<bool ALLOW_UNDERSCORE, bool ALLOW_DOT, bool ALLOW_DASH, bool ALLOW_FORWARD_SLASH>
+constexpr std::array<std::uint8_t, 256> charClasses() {
+    std::array<std::uint8_t, 256> result{};
+    for (int c = '0'; c <= '9'; ++c) {
+        result[c] = E_Alnum | E_Digit | E_TokenChar;
+    }
+    for (int c = 'a'; c <= 'z'; ++c) {
+        result[c] = E_Alnum | E_TokenChar | (c > 'f' ? E_NonHex : 0);
+    }
+    for (int c = 'A'; c <= 'Z'; ++c) {
+        result[c] = E_Alnum | E_TokenChar | (c > 'F' ? E_NonHex : 0);
+    }
+    if (ALLOW_UNDERSCORE) {
+        result['_'] = E_Joiner | E_NonHex;
+    }
+    if (ALLOW_DOT) {
+        result['.'] = E_Joiner;
+    }
+    if (ALLOW_DASH) {
+        result['-'] = E_Joiner;
+    }
+    if (ALLOW_FORWARD_SLASH) {
+        result['/'] = E_TokenChar | E_NonHex;
+    }
+    result['\n'] = E_Newline;
+    return result;
+}
+}
 
 //! \brief
 //! Concrete implementation class to categorise strings.
@@ -55,6 +99,9 @@ template<bool DO_WARPING = true,
          bool TRUNCATE_AT_NEWLINE = true,
          typename DICTIONARY_WEIGHT_FUNC = core::CWordDictionary::TWeightAll2>
 class CTokenListDataCategorizer : public CTokenListDataCategorizerBase {
+public:
+    using TUInt8Array256 = std::array<std::uint8_t, 256>;
+
 public:
     //! Create a data categorizer with threshold for how comparable categories are
     //! 0.0 means everything is the same category
@@ -63,8 +110,7 @@ public:
                               const TTokenListReverseSearchCreatorCPtr& reverseSearchCreator,
                               double threshold,
                               const std::string& fieldName)
-        : CTokenListDataCategorizerBase{limits, reverseSearchCreator, threshold, fieldName},
-          m_Dict{core::CWordDictionary::instance()} {}
+        : CTokenListDataCategorizerBase{limits, reverseSearchCreator, threshold, fieldName} {}
 
     //! No copying allowed (because it would complicate the resource monitoring).
     CTokenListDataCategorizer(const CTokenListDataCategorizer&) = delete;
@@ -103,47 +149,47 @@ protected:
         tokenUniqueIds.clear();
         totalWeight = 0;
 
-        std::string temp;
-
-        // TODO - make more efficient
-        std::string::size_type nonHexPos(std::string::npos);
-        for (const char curChar : str) {
+        // Tokens are views into str so no memory is allocated per token.
+        const char* data{str.data()};
+        std::size_t tokenStart{0};
+        std::size_t tokenLength{0};
+        std::size_t nonHexPos{std::string_view::npos};
+        for (std::size_t i = 0; i < str.length(); ++i) {
+            std::uint8_t charClass{CHAR_CLASSES[static_cast<unsigned char>(data[i])]};
 
-            if (TRUNCATE_AT_NEWLINE && curChar == '\n') {
+            if (TRUNCATE_AT_NEWLINE && (charClass & tokeniser_detail::E_Newline) != 0) {
                 break;
             }
 
             // Basically tokenise into [a-zA-Z0-9/]+ strings, possibly
             // allowing underscores, dots and dashes in the middle
-            if (std::isalnum(static_cast<unsigned char>(curChar)) ||
-                (!temp.empty() && ((ALLOW_UNDERSCORE && curChar == '_') ||
-                                   (ALLOW_DOT && curChar == '.') ||
-                                   (ALLOW_DASH && curChar == '-'))) ||
-                (ALLOW_FORWARD_SLASH && curChar == '/')) {
-                temp += curChar;
-                if (IGNORE_HEX) {
-                    // Count dots and dashes as numeric
-                    if (!std::isxdigit(static_cast<unsigned char>(curChar)) &&
-                        curChar != '.' && curChar != '-') {
-                        nonHexPos = temp.length() - 1;
-                    }
+            if ((charClass & tokeniser_detail::E_TokenChar) != 0 ||
+                (tokenLength > 0 && (charClass & tokeniser_detail::E_Joiner) != 0)) {
+                if (tokenLength == 0) {
+                    tokenStart = i;
+                }
+                if (IGNORE_HEX && (charClass & tokeniser_detail::E_NonHex) != 0) {
+                    nonHexPos = tokenLength;
                 }
+                ++tokenLength;
             } else {
-                if (!temp.empty()) {
-                    this->considerToken(fields, nonHexPos, temp, tokenIds, tokenUniqueIds,
-                                        totalWeight, minReweightedTotalWeight,
-                                        maxReweightedTotalWeight);
-                    temp.clear();
+                if (tokenLength > 0) {
+                    this->considerToken(fields, nonHexPos,
+                                        std::string_view{data + tokenStart, tokenLength},
+                                        tokenIds, tokenUniqueIds, totalWeight,
+                                        minReweightedTotalWeight, maxReweightedTotalWeight);
+                    tokenLength = 0;
                 }
 
                 if (IGNORE_HEX) {
-                    nonHexPos = std::string::npos;
+                    nonHexPos = std::string_view::npos;
                 }
             }
         }
 
-        if (!temp.empty()) {
-            this->considerToken(fields, nonHexPos, temp, tokenIds, tokenUniqueIds, totalWeight,
+        if (tokenLength > 0) {
+            this->considerToken(fields, nonHexPos, std::string_view{data + tokenStart, tokenLength},
+                                tokenIds, tokenUniqueIds, totalWeight,
                                 minReweightedTotalWeight, maxReweightedTotalWeight);
         }
 
@@ -155,7 +201,7 @@ protected:
 
     //! Take a string token, convert it to a numeric ID and a weighting and
     //! add these to the provided data structures.
-    void tokenToIdAndWeight(const std::string& token,
+    void tokenToIdAndWeight(std::string_view token,
                             TSizeSizePrVec& tokenIds,
                             TSizeSizeMap& tokenUniqueIds,
                             std::size_t& totalWeight,
@@ -164,8 +210,10 @@ protected:
         TSizeSizePr idWithWeight(this->idForToken(token), 1);
 
         if (token.length() >= MIN_DICTIONARY_LENGTH) {
-            // Give more weighting to tokens that are dictionary words.
-            idWithWeight.second += m_DictionaryWeightFunc(m_Dict.partOfSpeech(token));
+            // Give more weighting to tokens that are dictionary words. The
+            // part of speech is cached against the token ID so we don't need
+            // to search the dictionary again.
+            idWithWeight.second += m_DictionaryWeightFunc(this->partOfSpeech(idWithWeight.first));
         }
 
         tokenIds.push_back(idWithWeight);
@@ -183,11 +231,26 @@ protected:
     double similarity(const TSizeSizePrVec& left,
                       std::size_t leftWeight,
                       const TSizeSizePrVec& right,
-                      std::size_t rightWeight) const override {
+                      std::size_t rightWeight,
+                      double minSimilarity) const override {
         double similarity(1.0);
 
         std::size_t maxWeight(std::max(leftWeight, rightWeight));
         if (maxWeight > 0) {
+            if (DO_WARPING) {
+                // The similarity is greater than minSimilarity only if the
+                // edit distance is less than maxDiff.  The edit distance
+                // can't exceed the sum of the weights so only bound it if
+                // maxDiff is smaller.
+                double maxDiff((1.0 - minSimilarity) * double(maxWeight));
+                if (maxDiff < double(leftWeight + rightWeight)) {
+                    std::size_t bound(maxDiff > 0.0 ? static_cast<std::size_t>(maxDiff) : 0);
+                    std::size_t diff(m_SimilarityTester.weightedEditDistance(left, right, bound));
+                    similarity = 1.0 - double(diff) / double(maxWeight);
+                    return diff > bound ? std::min(similarity, minSimilarity) : similarity;
+                }
+            }
+
             std::size_t diff(DO_WARPING ? m_SimilarityTester.weightedEditDistance(left, right)
                                         : this->compareNoWarp(left, right));
 
@@ -229,23 +292,24 @@ private:
 
     //! Consider adding a token to the data structures that will be used in
     //! the comparison.  The \p token argument must not be empty when this
-    //! method is called.  This method may modify \p token.
+    //! method is called.
     void considerToken(const TStrStrUMap& fields,
-                       std::string::size_type nonHexPos,
-                       std::string& token,
+                       std::size_t nonHexPos,
+                       std::string_view token,
                        TSizeSizePrVec& tokenIds,
                        TSizeSizeMap& tokenUniqueIds,
                        std::size_t& totalWeight,
                        std::size_t& minReweightedTotalWeight,
                        std::size_t& maxReweightedTotalWeight) {
-        if (IGNORE_LEADING_DIGIT && std::isdigit(static_cast<unsigned char>(token[0]))) {
+        if (IGNORE_LEADING_DIGIT &&
+            (CHAR_CLASSES[static_cast<unsigned char>(token[0])] & tokeniser_detail::E_Digit) != 0) {
             return;
         }
 
         // If configured, ignore pure hex numbers, with or without a 0x
         // prefix.
         if (IGNORE_HEX) {
-            if (nonHexPos == std::string::npos) {
+            if (nonHexPos == std::string_view::npos) {
                 // Implies hex without 0x prefix.
                 return;
             }
@@ -255,33 +319,44 @@ private:
             // check to be completely compiled away as IGNORE_LEADING_DIGIT
             // is a template argument
             if (!IGNORE_LEADING_DIGIT && nonHexPos == 1 &&
-                token.compare(0, 2, "0x") == 0 && token.length() != 2) {
+                token.substr(0, 2) == "0x" && token.length() != 2) {
                 // Implies hex with 0x prefix.
                 return;
             }
         }
 
-        // If the last character is not alphanumeric, strip it.
-        while (!std::isalnum(static_cast<unsigned char>(token[token.length() - 1]))) {
-            token.erase(token.length() - 1);
+        // If the last character is not alphanumeric, strip it.  A token
+        // consisting only of forward slashes is stripped away entirely.
+        while (token.empty() == false &&
+               (CHAR_CLASSES[static_cast<unsigned char>(token.back())] &
+                tokeniser_detail::E_Alnum) == 0) {
+            token.remove_suffix(1);
+        }
+        if (token.empty()) {
+            return;
         }
 
         if (IGNORE_DATE_WORDS && core::CTimeUtils::isDateWord(token)) {
             return;
         }
 
-        if (IGNORE_FIELD_NAMES && fields.find(token) != fields.end()) {
-            return;
+        if (IGNORE_FIELD_NAMES && fields.empty() == false) {
+            m_FieldNameBuffer.assign(token);
+            if (fields.find(m_FieldNameBuffer) != fields.end()) {
+                return;
+            }
         }
 
         this->tokenToIdAndWeight(token, tokenIds, tokenUniqueIds, totalWeight,
                                  minReweightedTotalWeight, maxReweightedTotalWeight);
     }
 
-private:
-    //! Reference to a part-of-speech dictionary.
-    const core::CWordDictionary& m_Dict;
+    //! Character classes indexed by unsigned character value.
+    static constexpr TUInt8Array256 CHAR_CLASSES{
+        tokeniser_detail::charClasses<ALLOW_UNDERSCORE, ALLOW_DOT, ALLOW_DASH,
+                                      ALLOW_FORWARD_SLASH>()};
 
+private:
     //! Used for determining the edit distance between two vectors of
     //! strings, i.e. how many insertions, deletions or changes would it
     //! take to convert one to the other
@@ -289,6 +364,9 @@ private:
 
     //! Function used to increase weighting for dictionary words
     DICTIONARY_WEIGHT_FUNC m_DictionaryWeightFunc;
+
+    //! Reused to look up tokens in the field names without allocating.
+    std::string m_FieldNameBuffer;
 };
 }
 }
@@ -13,16 +13,19 @@
 
 #include <core/BoostMultiIndex.h>
 #include <core/CCsvLineParser.h>
+#include <core/CWordDictionary.h>
 
 #include <model/CDataCategorizer.h>
 #include <model/CTokenListCategory.h>
 #include <model/ImportExport.h>
 #include <model/ModelTypes.h>
 
+#include <functional>
 #include <iosfwd>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -225,7 +228,7 @@ protected:
 
     //! Take a string token, convert it to a numeric ID and a weighting and
     //! add these to the provided data structures.
-    virtual void tokenToIdAndWeight(const std::string& token,
+    virtual void tokenToIdAndWeight(std::string_view token,
                                     TSizeSizePrVec& tokenIds,
                                     TSizeSizeMap& tokenUniqueIds,
                                     std::size_t& totalWeight,
@@ -234,11 +237,15 @@ protected:
 
     virtual void reset() = 0;
 
-    //! Compute similarity between two vectors
+    //! Compute similarity between two vectors.  If the similarity is no
+    //! greater than \p minSimilarity then the value returned is only
+    //! guaranteed to be no greater than \p minSimilarity, which allows the
+    //! calculation to stop early.
     virtual double similarity(const TSizeSizePrVec& left,
                               std::size_t leftWeight,
                               const TSizeSizePrVec& right,
-                              std::size_t rightWeight) const = 0;
+                              std::size_t rightWeight,
+                              double minSimilarity) const = 0;
 
     //! Add a match to an existing category
     void addCategoryMatch(bool isDryRun,
@@ -260,7 +267,11 @@ protected:
 
     //! Get the unique token ID for a given token (assigning one if it's
     //! being seen for the first time)
-    std::size_t idForToken(const std::string& token);
+    std::size_t idForToken(std::string_view token);
+
+    //! Get the part of speech of the token with ID \p tokenId.  This is
+    //! looked up when the token is first seen so is cheap to get.
+    core::CWordDictionary::EPartOfSpeech partOfSpeech(std::size_t tokenId) const;
 
     //! Discard the most recently added tokens from the token to ID map.
     //! This must only be called if the caller is certain that none of
@@ -278,11 +289,12 @@ private:
     //! Value category for the TTokenMIndex below
     class CTokenInfoItem {
     public:
-        CTokenInfoItem(const std::string& str, std::size_t index);
+        CTokenInfoItem(std::string_view str, std::size_t index);
 
         //! Accessors
         const std::string& str() const;
         std::size_t index() const;
+        core::CWordDictionary::EPartOfSpeech partOfSpeech() const;
         std::size_t categoryCount() const;
         void categoryCount(std::size_t categoryCount);
 
@@ -302,6 +314,10 @@ private:
         //! Index of the token
         std::size_t m_Index;
 
+        //! The token's part of speech, cached so the dictionary needn't
+        //! be searched each time the token is seen
+        core::CWordDictionary::EPartOfSpeech m_PartOfSpeech;
+
         //! How many categories use this token?
         std::size_t m_CategoryCount;
     };
@@ -326,13 +342,24 @@ private:
     //! not expensive because CTokenListCategory is movable)
     using TTokenListCategoryVec = std::vector<CTokenListCategory>;
 
+    //! Used for indexing categories by token ID
+    using TSizeVec = std::vector<std::size_t>;
+    using TSizeVecVec = std::vector<TSizeVec>;
+
     //! Tag for the token index
     struct SToken {};
 
+    //! Hashes tokens so they can be looked up from string views
+    struct STokenHash {
+        std::size_t operator()(std::string_view token) const {
+            return std::hash<std::string_view>{}(token);
+        }
+    };
+
     using TTokenMIndex = boost::multi_index::multi_index_container<
         CTokenInfoItem,
         boost::multi_index::indexed_by<boost::multi_index::random_access<>,
-                                       boost::multi_index::hashed_unique<boost::multi_index::tag<SToken>, BOOST_MULTI_INDEX_CONST_TYPE_CONST_MEM_FUN(CTokenInfoItem, std::string, str)>>>;
+                                       boost::multi_index::hashed_unique<boost::multi_index::tag<SToken>, BOOST_MULTI_INDEX_CONST_TYPE_CONST_MEM_FUN(CTokenInfoItem, std::string, str), STokenHash, std::equal_to<>>>>;
 
 private:
     //! Used by deferred persistence functions
@@ -360,6 +387,29 @@ private:
     //!             for which usurped categories are to be found.
     TLocalCategoryIdVec usurpedCategories(TSizeSizePrVecCItr iter) const;
 
+    //! Add the category at \p index in m_Categories to the candidate index.
+    //! This must be called when a category is created or restored, at which
+    //! point its common unique tokens are a superset of those it will ever
+    //! have in the future.
+    void indexCategory(std::size_t index);
+
+    //! Rebuild the candidate index and the category positions from scratch.
+    void rebuildCategoryIndex();
+
+    //! Get the positions in m_CategoriesByCount of the only categories that
+    //! could possibly match a string with unique tokens \p tokenUniqueIds,
+    //! in ascending order.
+    //!
+    //! A category can only match if it shares at least one common unique
+    //! token with the string, or has no common unique token weight at all.
+    //! Any other category either fails the reverse search check or loses
+    //! all its common unique tokens by adding the string and so is rejected
+    //! by the lower threshold before any similarity is calculated.
+    //!
+    //! If the index can't rule out enough categories then \p positions is
+    //! filled in with the positions of all categories.
+    void candidateCategories(const TSizeSizeMap& tokenUniqueIds, TSizeVec& positions) const;
+
 private:
     //! Reference to the object we'll use to create reverse searches
     const TTokenListReverseSearchCreatorCPtr m_ReverseSearchCreator;
@@ -383,6 +433,20 @@ private:
     //! not a category ID.
     TSizeSizePrVec m_CategoriesByCount;
 
+    //! The position of each category in m_CategoriesByCount, indexed by
+    //! the category's index in m_Categories.
+    TSizeVec m_CategoryPositions;
+
+    //! Inverted index from token ID to the indices of the categories which
+    //! had that token as a common unique token when they were created or
+    //! restored.  Common unique tokens are only ever removed from categories,
+    //! so this may contain stale entries but never misses a current one.
+    TSizeVecVec m_CategoriesByTokenId;
+
+    //! The indices of categories which have no common unique token weight
+    //! and so can't be found via m_CategoriesByTokenId.
+    TSizeVec m_UnindexedCategories;
+
     //! Sum of all category counts.  Equal to the sum of .first for all elements
     //! of m_CategoriesByCount.
     std::size_t m_TotalCount = 0;
@@ -402,6 +466,10 @@ private:
     //! repeated reallocations for different strings.
     TSizeSizeMap m_WorkTokenUniqueIds;
 
+    //! Used to build up the positions of candidate categories.  This is a
+    //! member to save repeated reallocations for different strings.
+    TSizeVec m_WorkCandidatePositions;
+
     //! Used to parse pre-tokenised input supplied as CSV.
     core::CCsvLineParser m_CsvLineParser;
 
@@ -12,6 +12,7 @@
 
 #include <core/CDataAdder.h>
 #include <core/CDataSearcher.h>
+#include <core/CJsonOutputStreamWrapper.h>
 #include <core/CJsonStatePersistInserter.h>
 #include <core/CJsonStateRestoreTraverser.h>
 #include <core/CLogger.h>
@@ -24,6 +25,7 @@
 #include <core/CStopWatch.h>
 #include <core/CStringUtils.h>
 #include <core/CTimeUtils.h>
+#include <core/Concurrency.h>
 #include <core/UnwrapRef.h>
 
 #include <maths/common/CIntegerTools.h>
@@ -47,6 +49,8 @@
 
 #include <algorithm>
 #include <fstream>
+#include <memory>
+#include <sstream>
 #include <string>
 
 namespace ml {
@@ -93,6 +97,34 @@ const std::string INITIAL_LAST_FINALISED_BUCKET_END_TIME("l");
 //! compatibility code.)
 const std::string MODEL_SNAPSHOT_MIN_VERSION("8.3.0");
 
+//! The maximum number of bytes of extracted detector state we buffer before
+//! restoring the buffered detectors.
+const std::size_t MAX_PENDING_DETECTOR_STATE_BYTES{128 * 1024 * 1024};
+
+//! Copy the element \p traverser points to, its siblings and all their
+//! descendents to \p inserter.
+bool copyState(core::CStateRestoreTraverser& traverser, core::CStatePersistInserter& inserter) {
+    do {
+        const std::string& name{traverser.name()};
+        if (traverser.hasSubLevel()) {
+            bool copied{false};
+            inserter.insertLevel(name, [&](core::CStatePersistInserter& levelInserter) {
+                copied = traverser.traverseSubLevel(
+                    [&levelInserter](core::CStateRestoreTraverser& levelTraverser) {
+                        return copyState(levelTraverser, levelInserter);
+                    });
+            });
+            if (copied == false) {
+                return false;
+            }
+        } else if (name.empty() == false) {
+            // Empty levels are presented as a single element with no name.
+            inserter.insertValue(name, traverser.value());
+        }
+    } while (traverser.next());
+    return true;
+}
+
 //! Persist state as JSON with meaningful tag names.
 class CReadableJsonStatePersistInserter : public core::CJsonStatePersistInserter {
 public:
@@ -709,7 +741,7 @@ void CAnomalyJob::outputResults(core_t::TTime bucketStartTime) {
 
     // Model plots must be written first so the Java persists them
     // once the bucket result is processed
-    this->writeOutModelPlot(modelPlotData);
+    this->writeOutModelPlot(std::move(modelPlotData));
     this->writeOutAnnotations(annotations);
     this->writeOutResults(false, results, bucketStartTime, processingTime);
 
@@ -958,6 +990,13 @@ bool CAnomalyJob::restoreState(core::CStateRestoreTraverser& traverser,
         return true;
     }
 
+    // Detectors are always created, and so registered with the resource monitor,
+    // in the order they appear in the state. If we have a thread pool we extract
+    // each detector's state and restore batches of detectors in parallel.
+    bool restoreInParallel{core::defaultAsyncThreadPoolSize() > 1};
+    TDetectorStateChunkVec pendingStates;
+    std::size_t pendingStateBytes{0};
+
     while (traverser.next()) {
         const std::string& name = traverser.name();
         if (name == INTERIM_BUCKET_CORRECTOR_TAG) {
@@ -972,12 +1011,23 @@ bool CAnomalyJob::restoreState(core::CStateRestoreTraverser& traverser,
             }
             m_ModelConfig.interimBucketCorrector(interimBucketCorrector);
         } else if (name == TOP_LEVEL_DETECTOR_TAG) {
-            if (traverser.traverseSubLevel(std::bind(&CAnomalyJob::restoreSingleDetector,
-                                                     this, std::placeholders::_1)) == false) {
+            std::size_t numberPending{pendingStates.size()};
+            if (traverser.traverseSubLevel(std::bind(
+                    &CAnomalyJob::restoreSingleDetector, this, std::placeholders::_1,
+                    restoreInParallel ? &pendingStates : nullptr)) == false) {
                 LOG_ERROR(<< "Cannot restore anomaly detector");
                 return false;
             }
             ++numDetectors;
+            if (pendingStates.size() > numberPending) {
+                pendingStateBytes += pendingStates.back().s_State.size();
+            }
+            if (pendingStateBytes > MAX_PENDING_DETECTOR_STATE_BYTES) {
+                if (this->restorePendingDetectorStates(pendingStates) == false) {
+                    return false;
+                }
+                pendingStateBytes = 0;
+            }
         } else if (name == RESULTS_AGGREGATOR_TAG) {
             if (traverser.traverseSubLevel(std::bind(
                     &model::CHierarchicalResultsAggregator::acceptRestoreTraverser,
@@ -995,12 +1045,17 @@ bool CAnomalyJob::restoreState(core::CStateRestoreTraverser& traverser,
         }
     }
 
+    if (this->restorePendingDetectorStates(pendingStates) == false) {
+        return false;
+    }
+
     m_RestoredStateDetail.s_RestoredStateStatus = E_Success;
 
     return true;
 }
 
-bool CAnomalyJob::restoreSingleDetector(core::CStateRestoreTraverser& traverser) {
+bool CAnomalyJob::restoreSingleDetector(core::CStateRestoreTraverser& traverser,
+                                        TDetectorStateChunkVec* pendingStates) {
     if (traverser.name() != KEY_TAG) {
         LOG_ERROR(<< "Cannot restore anomaly detector - " << KEY_TAG << " element expected but found "
                   << traverser.name() << '=' << traverser.value());
@@ -1062,7 +1117,7 @@ bool CAnomalyJob::restoreSingleDetector(core::CStateRestoreTraverser& traverser)
         return false;
     }
 
-    if (this->restoreDetectorState(key, partitionFieldValue, traverser) == false) {
+    if (this->restoreDetectorState(key, partitionFieldValue, traverser, pendingStates) == false) {
         LOG_ERROR(<< "Delegated portion of anomaly detector restore failed");
         m_RestoredStateDetail.s_RestoredStateStatus = E_Failure;
         return false;
@@ -1074,7 +1129,8 @@ bool CAnomalyJob::restoreSingleDetector(core::CStateRestoreTraverser& traverser)
 
 bool CAnomalyJob::restoreDetectorState(const model::CSearchKey& key,
                                        const std::string& partitionFieldValue,
-                                       core::CStateRestoreTraverser& traverser) {
+                                       core::CStateRestoreTraverser& traverser,
+                                       TDetectorStateChunkVec* pendingStates) {
     const TAnomalyDetectorPtr& detector =
         this->detectorForKey(true, // for restoring
                              0,    // time reset later
@@ -1088,6 +1144,34 @@ bool CAnomalyJob::restoreDetectorState(const model::CSearchKey& key,
         return false;
     }
 
+    // The simple count detector also restores global state so must always be
+    // restored in the calling thread. Note that creating the detector primes
+    // the caches its model factory uses so these are only read by restore.
+    if (pendingStates != nullptr && key.isSimpleCount() == false) {
+        LOG_DEBUG(<< "Extracting state for detector with key '" << key.debug()
+                  << '/' << partitionFieldValue << '\'');
+
+        std::ostringstream state;
+        bool extracted{false};
+        {
+            core::CJsonStatePersistInserter inserter{state};
+            inserter.insertLevel(DETECTOR_TAG, [&](core::CStatePersistInserter& levelInserter) {
+                extracted = traverser.traverseSubLevel(
+                    [&levelInserter](core::CStateRestoreTraverser& levelTraverser) {
+                        return copyState(levelTraverser, levelInserter);
+                    });
+            });
+        }
+        if (extracted == false) {
+            LOG_ERROR(<< "Error extracting anomaly detector state for key '"
+                      << key.debug() << '/' << partitionFieldValue << '\'');
+            return false;
+        }
+
+        pendingStates->push_back({detector, partitionFieldValue, state.str()});
+        return true;
+    }
+
     LOG_DEBUG(<< "Restoring state for detector with key '" << key.debug() << '/'
               << partitionFieldValue << '\'');
 
@@ -1102,6 +1186,48 @@ bool CAnomalyJob::restoreDetectorState(const model::CSearchKey& key,
     return true;
 }
 
+bool CAnomalyJob::restorePendingDetectorStates(TDetectorStateChunkVec& pendingStates) {
+    if (pendingStates.empty()) {
+        return true;
+    }
+
+    LOG_DEBUG(<< "Restoring " << pendingStates.size() << " detectors in parallel");
+
+    // Each detector owns all the state it modifies on restore so they can be
+    // restored independently. The exception is the model factory, which is
+    // shared by detectors with the same key and fills its caches of default
+    // models under a lock. Note std::vector<bool> isn't safe to write from
+    // different threads.
+    std::vector<std::uint8_t> restored(pendingStates.size(), 0);
+    core::parallel_for_each(0, pendingStates.size(), [&](std::size_t i) {
+        SDetectorStateChunk& pending{pendingStates[i]};
+        std::istringstream state{pending.s_State};
+        core::CJsonStateRestoreTraverser traverser{state};
+        if (traverser.name() == DETECTOR_TAG &&
+            traverser.traverseSubLevel(std::bind(
+                &model::CAnomalyDetector::acceptRestoreTraverser,
+                pending.s_Detector.get(), std::cref(pending.s_PartitionFieldValue),
+                std::placeholders::_1))) {
+            restored[i] = 1;
+        }
+        // Free the extracted state as soon as we're done with it.
+        std::string{}.swap(pending.s_State);
+    });
+
+    bool result{true};
+    for (std::size_t i = 0; i < pendingStates.size(); ++i) {
+        if (restored[i] == 0) {
+            LOG_ERROR(<< "Error restoring anomaly detector for key '"
+                      << pendingStates[i].s_Detector->description() << '\'');
+            m_RestoredStateDetail.s_RestoredStateStatus = E_Failure;
+            result = false;
+        }
+    }
+    pendingStates.clear();
+
+    return result;
+}
+
 bool CAnomalyJob::persistModelsState(core::CDataAdder& persister,
                                      core_t::TTime timestamp,
                                      const std::string& outputFormat) {
@@ -1111,7 +1237,10 @@ bool CAnomalyJob::persistModelsState(core::CDataAdder& persister,
     // Persistence operates on a cached collection of counters rather than on the live counters directly.
     // This is in order that background persistence operates on a consistent set of counters however we
     // also must ensure that foreground persistence has access to an up-to-date cache of counters as well.
-    core::CProgramCounters::cacheCounters();
+    // Hosted jobs don't persist the counters and mustn't touch the process wide cache.
+    if (model::CAnomalyDetector::persistsStatics()) {
+        core::CProgramCounters::cacheCounters();
+    }
 
     return this->persistModelsState(detectors, persister, timestamp, outputFormat);
 }
@@ -1152,7 +1281,10 @@ bool CAnomalyJob::doPersistStateInForeground(core::CDataAdder& persister,
     // than on the live counters directly. This is in order that the more frequently used background persistence
     // operates on a consistent set of counters. Hence, to avoid an error regarding the cache not existing, we
     // also must ensure that foreground persistence has access to an up-to-date cache of counters.
-    core::CProgramCounters::cacheCounters();
+    // Hosted jobs don't persist the counters and mustn't touch the process wide cache.
+    if (model::CAnomalyDetector::persistsStatics()) {
+        core::CProgramCounters::cacheCounters();
+    }
 
     return this->persistCopiedState(
         description, snapshotId, snapshotTimestamp, m_LastFinalisedBucketEndTime, detectors,
@@ -1513,11 +1645,19 @@ void CAnomalyJob::generateModelPlot(core_t::TTime startTime,
     }
 }
 
-void CAnomalyJob::writeOutModelPlot(const TModelPlotDataVec& modelPlotData) {
-    CModelPlotDataJsonWriter modelPlotWriter(m_OutputStream);
-    for (const auto& plot : modelPlotData) {
-        modelPlotWriter.writeFlat(m_JobId, plot);
+void CAnomalyJob::writeOutModelPlot(TModelPlotDataVec modelPlotData) {
+    if (modelPlotData.empty()) {
+        return;
     }
+    // Formatting happens on the output stream's thread. The writes are ordered
+    // with all other output so there is no need to wait for them to complete.
+    auto modelPlotData_ = std::make_shared<TModelPlotDataVec>(std::move(modelPlotData));
+    m_OutputStream.writeAsync([jobId = m_JobId, modelPlotData_](core::CStringBufWriter& writer) {
+        CModelPlotDataJsonWriter modelPlotWriter(writer);
+        for (const auto& plot : *modelPlotData_) {
+            modelPlotWriter.writeFlat(jobId, plot);
+        }
+    });
 }
 
 void CAnomalyJob::writeOutAnnotations(const TAnnotationVec& annotations) {
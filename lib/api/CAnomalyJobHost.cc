@@ -0,0 +1,404 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#include <api/CAnomalyJobHost.h>
+
+#include <core/CBoostJsonParser.h>
+#include <core/CDataAdder.h>
+#include <core/CDataSearcher.h>
+#include <core/CJsonOutputStreamWrapper.h>
+#include <core/CLogger.h>
+#include <core/CThread.h>
+
+#include <model/CAnomalyDetector.h>
+#include <model/CAnomalyDetectorModelConfig.h>
+#include <model/CLimits.h>
+
+#include <api/CAnomalyJob.h>
+#include <api/CAnomalyJobConfig.h>
+#include <api/CAnomalyJobConfigReader.h>
+#include <api/CCmdSkeleton.h>
+#include <api/CCsvInputParser.h>
+#include <api/CFieldDataCategorizer.h>
+#include <api/CIoManager.h>
+#include <api/CLengthEncodedInputParser.h>
+#include <api/CModelSnapshotJsonWriter.h>
+#include <api/CPersistenceManager.h>
+#include <api/CSingleStreamDataAdder.h>
+#include <api/CSingleStreamSearcher.h>
+#include <api/CStateRestoreStreamFilter.h>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/json.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <istream>
+#include <memory>
+
+namespace ml {
+namespace api {
+
+namespace {
+using TStrVec = std::vector<std::string>;
+
+// The command fields match the autodetect command line options.
+const std::string CONFIG{"config"};
+const std::string FILTERS_CONFIG{"filtersconfig"};
+const std::string EVENTS_CONFIG{"eventsconfig"};
+const std::string MODEL_CONFIG{"modelconfig"};
+const std::string DELIMITER{"delimiter"};
+const std::string LENGTH_ENCODED_INPUT{"lengthEncodedInput"};
+const std::string TIME_FORMAT{"timeformat"};
+const std::string QUANTILES_STATE{"quantilesState"};
+const std::string DELETE_STATE_FILES{"deleteStateFiles"};
+const std::string BUCKET_PERSIST_INTERVAL{"bucketPersistInterval"};
+const std::string INPUT{"input"};
+const std::string INPUT_IS_PIPE{"inputIsPipe"};
+const std::string OUTPUT{"output"};
+const std::string OUTPUT_IS_PIPE{"outputIsPipe"};
+const std::string RESTORE{"restore"};
+const std::string RESTORE_IS_PIPE{"restoreIsPipe"};
+const std::string PERSIST{"persist"};
+const std::string PERSIST_IS_PIPE{"persistIsPipe"};
+const std::string PERSIST_IN_FOREGROUND{"persistInForeground"};
+const std::string MAX_ANOMALY_RECORDS{"maxAnomalyRecords"};
+const std::string MEMORY_USAGE{"memoryUsage"};
+
+const CAnomalyJobConfigReader COMMAND_READER{[] {
+    CAnomalyJobConfigReader theReader;
+    theReader.addParameter(CONFIG, CAnomalyJobConfigReader::E_RequiredParameter);
+    for (const auto& name :
+         {FILTERS_CONFIG, EVENTS_CONFIG, MODEL_CONFIG, DELIMITER, LENGTH_ENCODED_INPUT,
+          TIME_FORMAT, QUANTILES_STATE, DELETE_STATE_FILES, BUCKET_PERSIST_INTERVAL,
+          INPUT, INPUT_IS_PIPE, OUTPUT, OUTPUT_IS_PIPE, RESTORE, RESTORE_IS_PIPE,
+          PERSIST, PERSIST_IS_PIPE, PERSIST_IN_FOREGROUND, MAX_ANOMALY_RECORDS, MEMORY_USAGE}) {
+        theReader.addParameter(name, CAnomalyJobConfigReader::E_OptionalParameter);
+    }
+    return theReader;
+}()};
+}
+
+CAnomalyJobHost::CAnomalyJobHost(core_t::TTime namedPipeConnectTimeout)
+    : m_NamedPipeConnectTimeout{namedPipeConnectTimeout} {
+    model::CAnomalyDetector::persistStatics(false);
+}
+
+CAnomalyJobHost::~CAnomalyJobHost() {
+    this->waitForJobs();
+    model::CAnomalyDetector::persistStatics(true);
+}
+
+bool CAnomalyJobHost::processCommands(std::istream& commandStream) {
+    bool allCommandsValid{true};
+    std::string command;
+    while (std::getline(commandStream, command)) {
+        if (command.empty()) {
+            continue;
+        }
+        this->reapFinishedJobs();
+        SJobOptions options;
+        if (parseJobOptions(command, options) == false) {
+            LOG_ERROR(<< "Ignoring invalid command to start a job: " << command);
+            allCommandsValid = false;
+            continue;
+        }
+        this->startJob(options);
+    }
+
+    LOG_DEBUG(<< "No more commands - waiting for " << m_Jobs.size() << " jobs to finish");
+
+    return this->waitForJobs() && allCommandsValid;
+}
+
+void CAnomalyJobHost::startJob(const SJobOptions& options) {
+    m_Jobs.push_back(std::async(std::launch::async, [this, options] {
+        return this->runHostedJob(options);
+    }));
+}
+
+bool CAnomalyJobHost::waitForJobs() {
+    for (auto& job : m_Jobs) {
+        if (job.get() == false) {
+            ++m_NumberFailedJobs;
+        }
+    }
+    m_Jobs.clear();
+    return m_NumberFailedJobs == 0;
+}
+
+std::size_t CAnomalyJobHost::numberJobs() const {
+    return m_Jobs.size();
+}
+
+bool CAnomalyJobHost::parseJobOptions(const std::string& command, SJobOptions& options) {
+    json::value doc;
+    if (core::CBoostJsonParser::parse(command, doc) == false || doc.is_object() == false) {
+        LOG_ERROR(<< "Job command is not a JSON object: " << command);
+        return false;
+    }
+
+    try {
+        auto parameters = COMMAND_READER.read(doc);
+
+        std::string delimiter{parameters[DELIMITER].fallback(std::string(1, options.s_Delimiter))};
+        if (delimiter.length() != 1) {
+            LOG_ERROR(<< "Invalid delimiter '" << delimiter << "'");
+            return false;
+        }
+
+        options.s_ConfigFile = parameters[CONFIG].as<std::string>();
+        options.s_FiltersConfigFile = parameters[FILTERS_CONFIG].fallback(std::string{});
+        options.s_EventsConfigFile = parameters[EVENTS_CONFIG].fallback(std::string{});
+        options.s_ModelConfigFile = parameters[MODEL_CONFIG].fallback(std::string{});
+        options.s_Delimiter = delimiter[0];
+        options.s_LengthEncodedInput = parameters[LENGTH_ENCODED_INPUT].fallback(false);
+        options.s_TimeFormat = parameters[TIME_FORMAT].fallback(std::string{});
+        options.s_QuantilesStateFile = parameters[QUANTILES_STATE].fallback(std::string{});
+        options.s_DeleteStateFiles = parameters[DELETE_STATE_FILES].fallback(false);
+        options.s_BucketPersistInterval =
+            parameters[BUCKET_PERSIST_INTERVAL].fallback(std::size_t{0});
+        options.s_InputFileName = parameters[INPUT].fallback(std::string{});
+        options.s_IsInputFileNamedPipe = parameters[INPUT_IS_PIPE].fallback(false);
+        options.s_OutputFileName = parameters[OUTPUT].fallback(std::string{});
+        options.s_IsOutputFileNamedPipe = parameters[OUTPUT_IS_PIPE].fallback(false);
+        options.s_RestoreFileName = parameters[RESTORE].fallback(std::string{});
+        options.s_IsRestoreFileNamedPipe = parameters[RESTORE_IS_PIPE].fallback(false);
+        options.s_PersistFileName = parameters[PERSIST].fallback(std::string{});
+        options.s_IsPersistFileNamedPipe = parameters[PERSIST_IS_PIPE].fallback(false);
+        options.s_IsPersistInForeground = parameters[PERSIST_IN_FOREGROUND].fallback(false);
+        options.s_MaxAnomalyRecords =
+            parameters[MAX_ANOMALY_RECORDS].fallback(options.s_MaxAnomalyRecords);
+        options.s_MemoryUsage = parameters[MEMORY_USAGE].fallback(false);
+
+    } catch (CAnomalyJobConfigReader::CParseError& e) {
+        LOG_ERROR(<< "Error parsing job command: " << e.what());
+        return false;
+    }
+
+    // Hosted jobs can't share the host's standard input and output.
+    if (options.s_InputFileName.empty() || options.s_OutputFileName.empty()) {
+        LOG_ERROR(<< "A hosted job must have its own input and output: " << command);
+        return false;
+    }
+
+    return true;
+}
+
+bool CAnomalyJobHost::runJob(const SJobOptions& options, CIoManager& ioMgr) {
+
+    CAnomalyJobConfig jobConfig;
+    if (jobConfig.initFromFiles(options.s_ConfigFile, options.s_FiltersConfigFile,
+                                options.s_EventsConfigFile) == false) {
+        LOG_FATAL(<< "JSON config could not be interpreted");
+        return false;
+    }
+
+    const CAnomalyJobConfig::CAnalysisLimits& analysisLimits = jobConfig.analysisLimits();
+    model::CLimits limits{options.s_IsPersistInForeground};
+    limits.init(analysisLimits.categorizationExamplesLimit(),
+                analysisLimits.modelMemoryLimitMb());
+
+    const CAnomalyJobConfig::CAnalysisConfig& analysisConfig = jobConfig.analysisConfig();
+
+    bool doingCategorization{analysisConfig.categorizationFieldName().empty() == false};
+    TStrVec mutableFields;
+    if (doingCategorization) {
+        mutableFields.push_back(CFieldDataCategorizer::MLCATEGORY_NAME);
+    }
+
+    model::CAnomalyDetectorModelConfig modelConfig = analysisConfig.makeModelConfig();
+
+    if (!options.s_ModelConfigFile.empty() &&
+        modelConfig.init(options.s_ModelConfigFile) == false) {
+        LOG_FATAL(<< "ML model config file '" << options.s_ModelConfigFile
+                  << "' could not be loaded");
+        return false;
+    }
+
+    const CAnomalyJobConfig::CModelPlotConfig& modelPlotConfig = jobConfig.modelPlotConfig();
+    modelConfig.configureModelPlot(modelPlotConfig.enabled(),
+                                   modelPlotConfig.annotationsEnabled(),
+                                   modelPlotConfig.terms());
+
+    using TDataSearcherUPtr = std::unique_ptr<core::CDataSearcher>;
+    const TDataSearcherUPtr restoreSearcher{[&options, &ioMgr]() -> TDataSearcherUPtr {
+        if (ioMgr.restoreStream()) {
+            // Check whether state is restored from a file, if so we assume that this is a debugging case
+            // and therefore does not originate from the ML Java code.
+            if (!options.s_IsRestoreFileNamedPipe) {
+                // apply a filter to overcome differences in the way persistence vs. restore works
+                auto strm = std::make_shared<boost::iostreams::filtering_istream>();
+                strm->push(CStateRestoreStreamFilter());
+                strm->push(*ioMgr.restoreStream());
+                return std::make_unique<CSingleStreamSearcher>(strm);
+            }
+            return std::make_unique<CSingleStreamSearcher>(ioMgr.restoreStream());
+        }
+        return nullptr;
+    }()};
+
+    using TDataAdderUPtr = std::unique_ptr<core::CDataAdder>;
+    const TDataAdderUPtr persister{[&ioMgr]() -> TDataAdderUPtr {
+        if (ioMgr.persistStream()) {
+            return std::make_unique<CSingleStreamDataAdder>(ioMgr.persistStream());
+        }
+        return nullptr;
+    }()};
+
+    core_t::TTime persistInterval{jobConfig.persistInterval()};
+    if ((options.s_BucketPersistInterval > 0 || persistInterval >= 0) && persister == nullptr) {
+        LOG_FATAL(<< "Periodic persistence cannot be enabled using the '"
+                  << ((persistInterval >= 0) ? "persistInterval" : "bucketPersistInterval")
+                  << "' argument unless a place to persist to has been specified using the 'persist' argument");
+        return false;
+    }
+
+    using TPersistenceManagerUPtr = std::unique_ptr<CPersistenceManager>;
+    const TPersistenceManagerUPtr persistenceManager{
+        [persistInterval, &options, &persister]() -> TPersistenceManagerUPtr {
+            if (persistInterval >= 0 || options.s_BucketPersistInterval > 0) {
+                return std::make_unique<CPersistenceManager>(
+                    persistInterval, options.s_IsPersistInForeground,
+                    *persister, options.s_BucketPersistInterval);
+            }
+            return nullptr;
+        }()};
+
+    using InputParserCUPtr = std::unique_ptr<CInputParser>;
+    const InputParserCUPtr inputParser{[&options, &mutableFields, &ioMgr]() -> InputParserCUPtr {
+        if (options.s_LengthEncodedInput) {
+            return std::make_unique<CLengthEncodedInputParser>(
+                mutableFields, ioMgr.inputStream());
+        }
+        return std::make_unique<CCsvInputParser>(mutableFields, ioMgr.inputStream(),
+                                                 options.s_Delimiter);
+    }()};
+
+    const std::string jobId{jobConfig.jobId()};
+    core::CJsonOutputStreamWrapper wrappedOutputStream{ioMgr.outputStream()};
+    CModelSnapshotJsonWriter modelSnapshotWriter{jobId, wrappedOutputStream};
+
+    // The anomaly job knows how to detect anomalies
+    CAnomalyJob job{jobId,
+                    limits,
+                    jobConfig,
+                    modelConfig,
+                    wrappedOutputStream,
+                    std::bind(&CModelSnapshotJsonWriter::write,
+                              &modelSnapshotWriter, std::placeholders::_1),
+                    persistenceManager.get(),
+                    jobConfig.quantilePersistInterval(),
+                    jobConfig.dataDescription().timeField(),
+                    options.s_TimeFormat,
+                    options.s_MaxAnomalyRecords};
+
+    if (!options.s_QuantilesStateFile.empty()) {
+        if (job.initNormalizer(options.s_QuantilesStateFile) == false) {
+            LOG_FATAL(<< "Failed to restore quantiles and initialize normalizer");
+            return false;
+        }
+        if (options.s_DeleteStateFiles) {
+            std::remove(options.s_QuantilesStateFile.c_str());
+        }
+    }
+
+    // The categorizer knows how to assign categories to records
+    CFieldDataCategorizer categorizer{jobId,
+                                      analysisConfig,
+                                      limits,
+                                      jobConfig.dataDescription().timeField(),
+                                      options.s_TimeFormat,
+                                      &job,
+                                      wrappedOutputStream,
+                                      persistenceManager.get(),
+                                      analysisConfig.perPartitionCategorizationStopOnWarn()};
+
+    CDataProcessor* firstProcessor{nullptr};
+    if (doingCategorization) {
+        LOG_DEBUG(<< "Applying the categorizer for anomaly detection");
+        firstProcessor = &categorizer;
+    } else {
+        firstProcessor = &job;
+    }
+
+    if (persistenceManager != nullptr) {
+        persistenceManager->firstProcessorBackgroundPeriodicPersistFunc(std::bind(
+            &CDataProcessor::periodicPersistStateInBackground, firstProcessor));
+
+        persistenceManager->firstProcessorForegroundPeriodicPersistFunc(std::bind(
+            &CDataProcessor::periodicPersistStateInForeground, firstProcessor));
+    }
+
+    // The skeleton avoids the need to duplicate a lot of boilerplate code
+    CCmdSkeleton skeleton{restoreSearcher.get(), persister.get(), *inputParser, *firstProcessor};
+    if (skeleton.ioLoop() == false) {
+        LOG_FATAL(<< "ML anomaly detector job failed");
+        return false;
+    }
+
+    if (options.s_MemoryUsage) {
+        job.descriptionAndDebugMemoryUsage();
+    }
+
+    return true;
+}
+
+bool CAnomalyJobHost::runHostedJob(const SJobOptions& options) const {
+
+    LOG_DEBUG(<< "Starting hosted job with config '" << options.s_ConfigFile << "'");
+
+    core::CBlockingCallCancellingTimer cancellerThread{
+        core::CThread::currentThreadId(), std::chrono::seconds{m_NamedPipeConnectTimeout}};
+
+    CIoManager ioMgr{cancellerThread,
+                     options.s_InputFileName,
+                     options.s_IsInputFileNamedPipe,
+                     options.s_OutputFileName,
+                     options.s_IsOutputFileNamedPipe,
+                     options.s_RestoreFileName,
+                     options.s_IsRestoreFileNamedPipe,
+                     options.s_PersistFileName,
+                     options.s_IsPersistFileNamedPipe};
+
+    if (cancellerThread.start() == false) {
+        LOG_ERROR(<< "Could not start blocking call canceller thread");
+        return false;
+    }
+    bool ioInitialised{ioMgr.initIo()};
+    cancellerThread.stop();
+    if (ioInitialised == false) {
+        LOG_ERROR(<< "Failed to initialise IO for hosted job with config '"
+                  << options.s_ConfigFile << "'");
+        return false;
+    }
+
+    bool succeeded{runJob(options, ioMgr)};
+
+    LOG_DEBUG(<< "Hosted job with config '" << options.s_ConfigFile << "' "
+              << (succeeded ? "finished" : "failed"));
+
+    return succeeded;
+}
+
+void CAnomalyJobHost::reapFinishedJobs() {
+    m_Jobs.remove_if([this](std::future<bool>& job) {
+        if (job.wait_for(std::chrono::seconds{0}) != std::future_status::ready) {
+            return false;
+        }
+        if (job.get() == false) {
+            ++m_NumberFailedJobs;
+        }
+        return true;
+    });
+}
+}
+}
@@ -11,6 +11,7 @@
 #include <api/CDataFrameAnalysisInstrumentation.h>
 
 #include <core/CTimeUtils.h>
+#include <core/Concurrency.h>
 #include <core/Constants.h>
 
 #include <maths/analytics/CBoostedTree.h>
@@ -54,6 +55,15 @@ const std::string MEMORY_STATUS_OK_TAG{"ok"};
 const std::string MEMORY_STATUS_TAG{"status"};
 const std::string MEMORY_TYPE_TAG{"analytics_memory_usage"};
 const std::string OUTLIER_DETECTION_STATS{"outlier_detection_stats"};
+const std::string PARALLEL_FOR_EACH_TAG{"parallel_for_each"};
+const std::string PARALLEL_FOR_EACH_BUSY_TIME_TAG{"busy_time"};
+const std::string PARALLEL_FOR_EACH_CALL_SITE_TAG{"call_site"};
+const std::string PARALLEL_FOR_EACH_CALLS_TAG{"calls"};
+const std::string PARALLEL_FOR_EACH_CHUNKS_TAG{"chunks"};
+const std::string PARALLEL_FOR_EACH_IDLE_TIME_TAG{"idle_time"};
+const std::string PARALLEL_FOR_EACH_STOLEN_TASKS_TAG{"stolen_tasks"};
+const std::string PARALLEL_FOR_EACH_TASKS_TAG{"tasks"};
+const std::string PARALLEL_FOR_EACH_WALL_TIME_TAG{"wall_time"};
 const std::string PARAMETERS_TAG{"parameters"};
 const std::string PEAK_MEMORY_USAGE_TAG{"peak_usage_bytes"};
 const std::string PROGRESS_TAG{"progress"};
@@ -101,6 +111,10 @@ std::string bytesToString(std::int64_t value) {
 std::string bytesToString(double bytes) {
     return bytesToString(static_cast<std::int64_t>(bytes));
 }
+
+double microsecondsToMilliseconds(std::uint64_t time) {
+    return static_cast<double>(time) / 1000.0;
+}
 }
 
 CDataFrameAnalysisInstrumentation::CDataFrameAnalysisInstrumentation(const std::string& jobId,
@@ -242,6 +256,41 @@ void CDataFrameAnalysisInstrumentation::writeMemoryAndAnalysisStats() {
     }
 }
 
+void CDataFrameAnalysisInstrumentation::writeParallelForEachStats(json::object& parentObject) {
+    // These are the statistics for the parallel loops run since they were last
+    // written. Loops which run sequentially aren't recorded and nothing is unless
+    // the analysis specification sets record_parallel_loop_stats, so there may be
+    // none.
+    auto* writer = this->writer();
+    auto stats = core::parallelForEachStats();
+    core::resetParallelForEachStats();
+    if (writer == nullptr || stats.empty()) {
+        return;
+    }
+    // NOTE: Do not use brace initialization here as that will
+    // result in "statsArray" being created as a nested array on linux
+    json::array statsArray = writer->makeArray();
+    for (const auto& callSiteStats : stats) {
+        const auto& stat = callSiteStats.second;
+        json::object item{writer->makeObject()};
+        writer->addMember(PARALLEL_FOR_EACH_CALL_SITE_TAG,
+                          json::value(callSiteStats.first), item);
+        writer->addMember(PARALLEL_FOR_EACH_CALLS_TAG, json::value(stat.s_Calls), item);
+        writer->addMember(PARALLEL_FOR_EACH_TASKS_TAG, json::value(stat.s_Tasks), item);
+        writer->addMember(PARALLEL_FOR_EACH_STOLEN_TASKS_TAG,
+                          json::value(stat.s_StolenTasks), item);
+        writer->addMember(PARALLEL_FOR_EACH_CHUNKS_TAG, json::value(stat.s_Chunks), item);
+        writer->addMember(PARALLEL_FOR_EACH_WALL_TIME_TAG,
+                          json::value(microsecondsToMilliseconds(stat.s_WallTime)), item);
+        writer->addMember(PARALLEL_FOR_EACH_BUSY_TIME_TAG,
+                          json::value(microsecondsToMilliseconds(stat.s_BusyTime)), item);
+        writer->addMember(PARALLEL_FOR_EACH_IDLE_TIME_TAG,
+                          json::value(microsecondsToMilliseconds(stat.s_IdleTime)), item);
+        statsArray.push_back(item);
+    }
+    writer->addMember(PARALLEL_FOR_EACH_TAG, statsArray, parentObject);
+}
+
 void CDataFrameAnalysisInstrumentation::writeMemory(std::int64_t timestamp) {
     if (m_Writer != nullptr) {
         m_Writer->onKey(MEMORY_TYPE_TAG);
@@ -340,6 +389,7 @@ void CDataFrameOutliersInstrumentation::writeTimingStats(json::object& parentObj
     auto* writer = this->writer();
     if (writer != nullptr) {
         writer->addMember(TIMING_ELAPSED_TIME_TAG, json::value(m_ElapsedTime), parentObject);
+        this->writeParallelForEachStats(parentObject);
     }
 }
 
@@ -537,6 +587,7 @@ void CDataFrameTrainBoostedTreeInstrumentation::writeTimingStats(json::object& p
     if (writer != nullptr) {
         writer->addMember(TIMING_ELAPSED_TIME_TAG, json::value(m_ElapsedTime), parentObject);
         writer->addMember(TIMING_ITERATION_TIME_TAG, json::value(m_IterationTime), parentObject);
+        this->writeParallelForEachStats(parentObject);
     }
 }
 
@@ -15,6 +15,7 @@
 #include <core/CDataFrame.h>
 #include <core/CLogger.h>
 #include <core/CStringUtils.h>
+#include <core/Concurrency.h>
 
 #include <api/CDataFrameAnalysisConfigReader.h>
 #include <api/CDataFrameOutliersRunner.h>
@@ -41,6 +42,7 @@ const std::string CDataFrameAnalysisSpecification::RESULTS_FIELD{"results_field"
 const std::string CDataFrameAnalysisSpecification::MISSING_FIELD_VALUE{"missing_field_value"};
 const std::string CDataFrameAnalysisSpecification::CATEGORICAL_FIELD_NAMES{"categorical_fields"};
 const std::string CDataFrameAnalysisSpecification::DISK_USAGE_ALLOWED{"disk_usage_allowed"};
+const std::string CDataFrameAnalysisSpecification::RECORD_PARALLEL_LOOP_STATS{"record_parallel_loop_stats"};
 const std::string CDataFrameAnalysisSpecification::ANALYSIS{"analysis"};
 const std::string CDataFrameAnalysisSpecification::NAME{"name"};
 const std::string CDataFrameAnalysisSpecification::PARAMETERS{"parameters"};
@@ -62,6 +64,7 @@ TRunnerFactoryUPtrVec analysisFactories() {
 
 const std::string DEFAULT_RESULT_FIELD("ml");
 const bool DEFAULT_DISK_USAGE_ALLOWED(false);
+const bool DEFAULT_RECORD_PARALLEL_LOOP_STATS(false);
 
 const CDataFrameAnalysisConfigReader CONFIG_READER{[] {
     CDataFrameAnalysisConfigReader theReader;
@@ -85,6 +88,8 @@ const CDataFrameAnalysisConfigReader CONFIG_READER{[] {
                            CDataFrameAnalysisConfigReader::E_OptionalParameter);
     theReader.addParameter(CDataFrameAnalysisSpecification::DISK_USAGE_ALLOWED,
                            CDataFrameAnalysisConfigReader::E_OptionalParameter);
+    theReader.addParameter(CDataFrameAnalysisSpecification::RECORD_PARALLEL_LOOP_STATS,
+                           CDataFrameAnalysisConfigReader::E_OptionalParameter);
     theReader.addParameter(CDataFrameAnalysisSpecification::ANALYSIS,
                            CDataFrameAnalysisConfigReader::E_RequiredParameter);
     return theReader;
@@ -143,6 +148,13 @@ CDataFrameAnalysisSpecification::CDataFrameAnalysisSpecification(
             core::CDataFrame::DEFAULT_MISSING_STRING);
         m_CategoricalFieldNames = parameters[CATEGORICAL_FIELD_NAMES].fallback(TStrVec{});
         m_DiskUsageAllowed = parameters[DISK_USAGE_ALLOWED].fallback(DEFAULT_DISK_USAGE_ALLOWED);
+        m_RecordParallelLoopStats = parameters[RECORD_PARALLEL_LOOP_STATS].fallback(
+            DEFAULT_RECORD_PARALLEL_LOOP_STATS);
+
+        // The statistics are process wide so start each analysis from a clean
+        // slate. They are written with the analysis timing stats.
+        core::resetParallelForEachStats();
+        core::recordParallelForEachStats(m_RecordParallelLoopStats);
 
         double missing;
         if (m_MissingFieldValue != core::CDataFrame::DEFAULT_MISSING_STRING &&
@@ -207,6 +219,10 @@ bool CDataFrameAnalysisSpecification::diskUsageAllowed() const {
     return m_DiskUsageAllowed;
 }
 
+bool CDataFrameAnalysisSpecification::recordParallelLoopStats() const {
+    return m_RecordParallelLoopStats;
+}
+
 const std::string& CDataFrameAnalysisSpecification::temporaryDirectory() const {
     return m_TemporaryDirectory;
 }
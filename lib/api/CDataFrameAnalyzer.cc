@@ -17,7 +17,7 @@
 #include <core/CJsonOutputStreamWrapper.h>
 #include <core/CLogger.h>
 #include <core/CStopWatch.h>
-#include <core/CVectorRange.h>
+#include <core/Concurrency.h>
 
 #include <maths/common/CBasicStatistics.h>
 #include <maths/common/COrderings.h>
@@ -52,6 +52,11 @@ const std::string ROW_RESULTS{"row_results"};
 // Row result fields
 const std::string CHECKSUM{"checksum"};
 const std::string RESULTS{"results"};
+
+// The target number of field values in a block of rows. This bounds the
+// memory used by the row blocks.
+const std::size_t ROW_BLOCK_NUMBER_FIELD_VALUES{65536};
+const std::size_t MIN_ROW_BLOCK_CAPACITY{16};
 }
 
 CDataFrameAnalyzer::CDataFrameAnalyzer(TDataFrameAnalysisSpecificationUPtr analysisSpecification,
@@ -65,7 +70,12 @@ CDataFrameAnalyzer::CDataFrameAnalyzer(TDataFrameAnalysisSpecificationUPtr analy
     }
 }
 
-CDataFrameAnalyzer::~CDataFrameAnalyzer() = default;
+CDataFrameAnalyzer::~CDataFrameAnalyzer() {
+    // The task parsing a row block refers to our state.
+    if (m_RowBlockParsed.valid()) {
+        m_RowBlockParsed.wait();
+    }
+}
 
 bool CDataFrameAnalyzer::usingControlMessages() const {
     return m_ControlFieldIndex >= 0;
@@ -112,6 +122,10 @@ bool CDataFrameAnalyzer::handleRecord(const TStrVec& fieldNames, const TStrVec&
 
 void CDataFrameAnalyzer::receivedAllRows() {
     if (m_DataFrame != nullptr) {
+        if (m_RowBlockSize > 0) {
+            this->parseRowBlock();
+        }
+        this->writeParsedRowBlock();
         m_DataFrame->finishWritingRows();
         LOG_DEBUG(<< "Received " << m_DataFrame->numberRows() << " rows");
     }
@@ -329,12 +343,47 @@ void CDataFrameAnalyzer::addRowToDataFrame(const TStrVec& fieldValues) {
     if (m_DataFrame == nullptr) {
         return;
     }
-    auto columnValues = core::make_range(fieldValues, m_BeginDataFieldValues,
-                                         m_EndDataFieldValues);
-    m_DataFrame->parseAndWriteRow(columnValues, m_DataFrameColumnMap.get(),
-                                  m_DocHashFieldIndex != FIELD_MISSING
-                                      ? &fieldValues[m_DocHashFieldIndex]
-                                      : nullptr);
+    if (m_RowBlockSize == m_RowBlock.size()) {
+        m_RowBlock.emplace_back();
+    }
+    // Assigning reuses the memory of the strings in the block.
+    m_RowBlock[m_RowBlockSize++] = fieldValues;
+    if (m_RowBlockSize == this->rowBlockCapacity()) {
+        this->parseRowBlock();
+    }
+}
+
+std::size_t CDataFrameAnalyzer::rowBlockCapacity() const {
+    std::size_t numberFieldValues{m_AnalysisSpecification->numberColumns() + 2};
+    return std::max(ROW_BLOCK_NUMBER_FIELD_VALUES / numberFieldValues, MIN_ROW_BLOCK_CAPACITY);
+}
+
+core::CDataFrame::SRowFieldLayout CDataFrameAnalyzer::rowFieldLayout() const {
+    core::CDataFrame::SRowFieldLayout layout;
+    layout.s_BeginColumnValues = static_cast<std::size_t>(m_BeginDataFieldValues);
+    layout.s_EndColumnValues = static_cast<std::size_t>(m_EndDataFieldValues);
+    layout.s_ColumnMap = m_DataFrameColumnMap.get();
+    layout.s_DocHashField = m_DocHashFieldIndex >= 0 ? m_DocHashFieldIndex : -1;
+    return layout;
+}
+
+void CDataFrameAnalyzer::parseRowBlock() {
+    // We parse one block at a time so must write the previous one first.
+    this->writeParsedRowBlock();
+    std::swap(m_RowBlock, m_ParsingRowBlock);
+    std::size_t numberRows{m_RowBlockSize};
+    m_RowBlockSize = 0;
+    m_RowBlockParsed = core::async(core::defaultAsyncExecutor(), [this, numberRows] {
+        m_DataFrame->parseRows(m_AnalysisSpecification->numberThreads(), m_ParsingRowBlock,
+                               numberRows, this->rowFieldLayout(), m_ParsedRows);
+    });
+}
+
+void CDataFrameAnalyzer::writeParsedRowBlock() {
+    if (m_RowBlockParsed.valid()) {
+        m_RowBlockParsed.get();
+        m_DataFrame->writeParsedRows(m_ParsingRowBlock, this->rowFieldLayout(), m_ParsedRows);
+    }
 }
 
 void CDataFrameAnalyzer::writeInferenceModel(const CDataFrameAnalysisRunner& analysis,
@@ -53,6 +53,8 @@ const CDataFrameAnalysisConfigReader& parameterReader() {
                                CDataFrameAnalysisConfigReader::E_OptionalParameter);
         theReader.addParameter(CDataFrameOutliersRunner::OUTLIER_FRACTION,
                                CDataFrameAnalysisConfigReader::E_OptionalParameter);
+        theReader.addParameter(CDataFrameOutliersRunner::NEIGHBOR_SEARCH_APPROXIMATION,
+                               CDataFrameAnalysisConfigReader::E_OptionalParameter);
         return theReader;
     }()};
     return PARAMETER_READER;
@@ -77,6 +79,11 @@ CDataFrameOutliersRunner::CDataFrameOutliersRunner(const CDataFrameAnalysisSpeci
     m_ComputeFeatureInfluence = parameters[COMPUTE_FEATURE_INFLUENCE].fallback(true);
     m_FeatureInfluenceThreshold = parameters[FEATURE_INFLUENCE_THRESHOLD].fallback(0.1);
     m_OutlierFraction = parameters[OUTLIER_FRACTION].fallback(0.05);
+    m_NeighborSearchApproximation = parameters[NEIGHBOR_SEARCH_APPROXIMATION].fallback(0.0);
+    if (m_NeighborSearchApproximation < 0.0) {
+        HANDLE_FATAL(<< "Input error: '" << NEIGHBOR_SEARCH_APPROXIMATION
+                     << "' should be non-negative.");
+    }
 
     m_Instrumentation.featureInfluenceThreshold(m_FeatureInfluenceThreshold);
 }
@@ -160,7 +167,8 @@ void CDataFrameOutliersRunner::runImpl(core::CDataFrame& frame) {
         static_cast<maths::analytics::COutliers::EMethod>(m_Method),
         m_NumberNeighbours,
         m_ComputeFeatureInfluence,
-        m_OutlierFraction};
+        m_OutlierFraction,
+        m_NeighborSearchApproximation};
     maths::analytics::COutliers::compute(params, frame, m_Instrumentation);
 }
 
@@ -176,7 +184,8 @@ CDataFrameOutliersRunner::estimateBookkeepingMemoryUsage(std::size_t numberParti
         static_cast<maths::analytics::COutliers::EMethod>(m_Method),
         m_NumberNeighbours,
         m_ComputeFeatureInfluence,
-        m_OutlierFraction};
+        m_OutlierFraction,
+        m_NeighborSearchApproximation};
     return maths::analytics::COutliers::estimateMemoryUsedByCompute(
         params, totalNumberRows, partitionNumberRows, numberColumns);
 }
@@ -187,6 +196,7 @@ const std::string CDataFrameOutliersRunner::METHOD{"method"};
 const std::string CDataFrameOutliersRunner::COMPUTE_FEATURE_INFLUENCE{"compute_feature_influence"};
 const std::string CDataFrameOutliersRunner::FEATURE_INFLUENCE_THRESHOLD{"feature_influence_threshold"};
 const std::string CDataFrameOutliersRunner::OUTLIER_FRACTION{"outlier_fraction"};
+const std::string CDataFrameOutliersRunner::NEIGHBOR_SEARCH_APPROXIMATION{"neighbor_search_approximation"};
 
 const std::string& CDataFrameOutliersRunnerFactory::name() const {
     return NAME;
@@ -22,6 +22,7 @@
 #include <core/CStateDecompressor.h>
 #include <core/CStateRestoreTraverser.h>
 #include <core/CStringUtils.h>
+#include <core/Concurrency.h>
 
 #include <model/CTokenListReverseSearchCreator.h>
 
@@ -52,6 +53,7 @@ const std::string CFieldDataCategorizer::MLCATEGORY_NAME{"mlcategory"};
 const double CFieldDataCategorizer::SIMILARITY_THRESHOLD{0.7};
 const std::string CFieldDataCategorizer::STATE_TYPE{"categorizer_state"};
 const std::string CFieldDataCategorizer::STATE_VERSION{"1"};
+const std::size_t CFieldDataCategorizer::MAX_BUFFERED_RECORDS{1024};
 
 CFieldDataCategorizer::CFieldDataCategorizer(std::string jobId,
                                              const CAnomalyJobConfig::CAnalysisConfig& analysisConfig,
@@ -96,6 +98,10 @@ bool CFieldDataCategorizer::handleRecord(const TStrStrUMap& dataRowFields, TOpti
     // Non-empty control fields take precedence over everything else
     auto iter = dataRowFields.find(CONTROL_FIELD_NAME);
     if (iter != dataRowFields.end() && !iter->second.empty()) {
+        // Records received before the control message must be handled first
+        if (this->handleBufferedRecords() == false) {
+            return false;
+        }
         // Always handle control messages, but signal completion of handling ONLY if we are the last handler
         // e.g. flush requests are acknowledged here if this is the last handler
         bool msgHandled{this->handleControlMessage(iter->second, m_ChainedProcessor == nullptr)};
@@ -109,17 +115,13 @@ bool CFieldDataCategorizer::handleRecord(const TStrStrUMap& dataRowFields, TOpti
         time = this->parseTime(dataRowFields);
     }
 
+    if (this->isBufferingRecords()) {
+        return this->bufferRecord(dataRowFields, time);
+    }
+
     CGlobalCategoryId globalCategoryId{this->computeAndUpdateCategory(dataRowFields, time)};
-    if (globalCategoryId.isHardFailure() == false) {
-        if (m_OutputFieldCategory != nullptr) {
-            *m_OutputFieldCategory =
-                core::CStringUtils::typeToString(globalCategoryId.globalId());
-        }
-        if (m_ChainedProcessor != nullptr &&
-            m_ChainedProcessor->handleRecord(dataRowFields, time) == false) {
-            return false;
-        }
-        ++m_NumRecordsHandled;
+    if (this->passOnRecord(globalCategoryId, dataRowFields, time, m_OutputFieldCategory) == false) {
+        return false;
     }
 
     if (m_PersistenceManager != nullptr) {
@@ -133,6 +135,10 @@ bool CFieldDataCategorizer::handleRecord(const TStrStrUMap& dataRowFields, TOpti
 
 void CFieldDataCategorizer::finalise() {
 
+    if (this->handleBufferedRecords() == false) {
+        LOG_ERROR(<< "Failed to handle buffered records");
+    }
+
     // Make sure model size stats are up to date
     for (const auto& dataCategorizerEntry : m_DataCategorizers) {
         dataCategorizerEntry.second->forceResourceRefresh(m_Limits.resourceMonitor());
@@ -163,20 +169,46 @@ CFieldDataCategorizer::computeAndUpdateCategory(const TStrStrUMap& dataRowFields
                                                 const TOptionalTime& time) {
     CGlobalCategoryId globalCategoryId;
 
+    const std::string* fieldValue{nullptr};
+    CSingleFieldDataCategorizer* dataCategorizer{
+        this->categorizerForRecord(dataRowFields, fieldValue, globalCategoryId)};
+    if (dataCategorizer == nullptr) {
+        return globalCategoryId;
+    }
+    if (m_CategorizationFilter.empty()) {
+        globalCategoryId = dataCategorizer->computeAndUpdateCategory(
+            false, dataRowFields, time, *fieldValue, *fieldValue,
+            m_Limits.resourceMonitor(), m_JsonOutputWriter);
+    } else {
+        std::string filtered{m_CategorizationFilter.apply(*fieldValue)};
+        globalCategoryId = dataCategorizer->computeAndUpdateCategory(
+            false, dataRowFields, time, filtered, *fieldValue,
+            m_Limits.resourceMonitor(), m_JsonOutputWriter);
+    }
+    if (globalCategoryId.isValid()) {
+        dataCategorizer->writeStatsIfUrgent(m_JsonOutputWriter, m_AnnotationJsonWriter);
+    }
+    return globalCategoryId;
+}
+
+CSingleFieldDataCategorizer*
+CFieldDataCategorizer::categorizerForRecord(const TStrStrUMap& dataRowFields,
+                                            const std::string*& fieldValue,
+                                            CGlobalCategoryId& globalCategoryId) {
     auto fieldIter = dataRowFields.find(m_CategorizationFieldName);
     if (fieldIter == dataRowFields.end()) {
         LOG_WARN(<< "Assigning ML category " << globalCategoryId << " to record with no "
                  << m_CategorizationFieldName << " field:" << core_t::LINE_ENDING
                  << this->debugPrintRecord(dataRowFields));
-        return globalCategoryId;
+        return nullptr;
     }
 
-    const std::string& fieldValue{fieldIter->second};
-    if (fieldValue.empty()) {
+    fieldValue = &fieldIter->second;
+    if (fieldValue->empty()) {
         LOG_WARN(<< "Assigning ML category " << globalCategoryId << " to record with blank "
                  << m_CategorizationFieldName << " field:" << core_t::LINE_ENDING
                  << this->debugPrintRecord(dataRowFields));
-        return globalCategoryId;
+        return nullptr;
     }
 
     const std::string& partitionFieldValue{this->categorizerKeyForRecord(dataRowFields)};
@@ -197,28 +229,143 @@ CFieldDataCategorizer::computeAndUpdateCategory(const TStrStrUMap& dataRowFields
             }
         }
         m_Limits.resourceMonitor().categorizerAllocationFailures(m_CategorizerAllocationFailures);
-        return CGlobalCategoryId::hardFailure();
+        globalCategoryId = CGlobalCategoryId::hardFailure();
+        return nullptr;
     }
     if (m_StopCategorizationOnWarnStatus &&
         dataCategorizer->categorizationStatus() == model_t::E_CategorizationStatusWarn) {
         LOG_TRACE(<< "Ignoring input record as its categorizer has a 'warn' status:"
                   << core_t::LINE_ENDING << this->debugPrintRecord(dataRowFields));
-        return CGlobalCategoryId::hardFailure();
+        globalCategoryId = CGlobalCategoryId::hardFailure();
+        return nullptr;
     }
-    if (m_CategorizationFilter.empty()) {
-        globalCategoryId = dataCategorizer->computeAndUpdateCategory(
-            false, dataRowFields, time, fieldValue, fieldValue,
-            m_Limits.resourceMonitor(), m_JsonOutputWriter);
-    } else {
-        std::string filtered{m_CategorizationFilter.apply(fieldValue)};
-        globalCategoryId = dataCategorizer->computeAndUpdateCategory(
-            false, dataRowFields, time, filtered, fieldValue,
-            m_Limits.resourceMonitor(), m_JsonOutputWriter);
+    return dataCategorizer;
+}
+
+bool CFieldDataCategorizer::passOnRecord(CGlobalCategoryId globalCategoryId,
+                                         const TStrStrUMap& dataRowFields,
+                                         const TOptionalTime& time,
+                                         std::string* outputFieldCategory) {
+    if (globalCategoryId.isHardFailure()) {
+        return true;
     }
-    if (globalCategoryId.isValid()) {
-        dataCategorizer->writeStatsIfUrgent(m_JsonOutputWriter, m_AnnotationJsonWriter);
+    if (outputFieldCategory != nullptr) {
+        *outputFieldCategory = core::CStringUtils::typeToString(globalCategoryId.globalId());
     }
-    return globalCategoryId;
+    if (m_ChainedProcessor != nullptr &&
+        m_ChainedProcessor->handleRecord(dataRowFields, time) == false) {
+        return false;
+    }
+    ++m_NumRecordsHandled;
+    return true;
+}
+
+bool CFieldDataCategorizer::isBufferingRecords() const {
+    return m_PartitionFieldName.empty() == false && core::defaultAsyncThreadPoolSize() > 1;
+}
+
+bool CFieldDataCategorizer::bufferRecord(const TStrStrUMap& dataRowFields,
+                                         const TOptionalTime& time) {
+    if (m_NumberBufferedRecords == m_BufferedRecords.size()) {
+        m_BufferedRecords.emplace_back();
+    }
+    // Assigning rather than constructing allows the map to reuse its storage
+    SBufferedRecord& record{m_BufferedRecords[m_NumberBufferedRecords++]};
+    record.s_Fields = dataRowFields;
+    record.s_Time = time;
+    if (m_NumberBufferedRecords >= MAX_BUFFERED_RECORDS) {
+        return this->handleBufferedRecords();
+    }
+    return true;
+}
+
+bool CFieldDataCategorizer::handleBufferedRecords() {
+    if (m_NumberBufferedRecords == 0) {
+        return true;
+    }
+
+    using TSizeVec = std::vector<std::size_t>;
+    using TCategorizerPtrSizeVecMap = std::map<CSingleFieldDataCategorizer*, TSizeVec>;
+
+    // Find each record's categorizer.  This may create categorizers and must
+    // handle allocation failures in the order the records were received.
+    TCategorizerPtrSizeVecMap recordsByCategorizer;
+    for (std::size_t i = 0; i < m_NumberBufferedRecords; ++i) {
+        SBufferedRecord& record{m_BufferedRecords[i]};
+        record.s_GlobalCategoryId = CGlobalCategoryId{};
+        record.s_Categorizer = this->categorizerForRecord(
+            record.s_Fields, record.s_RawMessage, record.s_GlobalCategoryId);
+        if (record.s_Categorizer != nullptr) {
+            if (m_CategorizationFilter.empty() == false) {
+                record.s_FilteredMessage = m_CategorizationFilter.apply(*record.s_RawMessage);
+            }
+            recordsByCategorizer[record.s_Categorizer].push_back(i);
+        }
+    }
+
+    // Each categorizer processes its records in order, but the categorizers
+    // for different partitions run concurrently.
+    using TCategorizerPtrSizeVecMapCItrVec = std::vector<TCategorizerPtrSizeVecMap::const_iterator>;
+    TCategorizerPtrSizeVecMapCItrVec categorizers;
+    categorizers.reserve(recordsByCategorizer.size());
+    for (auto i = recordsByCategorizer.begin(); i != recordsByCategorizer.end(); ++i) {
+        categorizers.push_back(i);
+    }
+    core::parallel_for_each(
+        categorizers.size(), 0, categorizers.size(), [&](std::size_t i) {
+            CSingleFieldDataCategorizer& dataCategorizer{*categorizers[i]->first};
+            for (auto j : categorizers[i]->second) {
+                SBufferedRecord& record{m_BufferedRecords[j]};
+                record.s_LocalCategoryId = dataCategorizer.computeCategory(
+                    false, record.s_Fields,
+                    m_CategorizationFilter.empty() ? *record.s_RawMessage
+                                                   : record.s_FilteredMessage,
+                    *record.s_RawMessage);
+            }
+        });
+
+    // Global IDs are allocated and the output is written in the order the
+    // records were received so they don't depend on the thread scheduling.
+    // Every record has already updated its categorizer so all of them must
+    // get global IDs, even if passing on an earlier record failed.
+    bool result{true};
+    std::size_t numberDropped{0};
+    for (std::size_t i = 0; i < m_NumberBufferedRecords; ++i) {
+        SBufferedRecord& record{m_BufferedRecords[i]};
+        if (record.s_Categorizer != nullptr) {
+            record.s_GlobalCategoryId = record.s_Categorizer->updateCategory(
+                record.s_LocalCategoryId, record.s_Time, *record.s_RawMessage,
+                m_Limits.resourceMonitor(), m_JsonOutputWriter);
+            if (record.s_GlobalCategoryId.isValid()) {
+                record.s_Categorizer->writeStatsIfUrgent(m_JsonOutputWriter,
+                                                         m_AnnotationJsonWriter);
+            }
+        }
+        std::string* outputFieldCategory{nullptr};
+        if (m_OutputFieldCategory != nullptr) {
+            auto fieldIter = record.s_Fields.find(MLCATEGORY_NAME);
+            if (fieldIter != record.s_Fields.end()) {
+                outputFieldCategory = &fieldIter->second;
+            }
+        }
+        if (result == false) {
+            ++numberDropped;
+        } else if (this->passOnRecord(record.s_GlobalCategoryId, record.s_Fields,
+                                      record.s_Time, outputFieldCategory) == false) {
+            result = false;
+        }
+    }
+    if (numberDropped > 0) {
+        LOG_ERROR(<< "Failed to pass on a buffered record - dropped the "
+                  << numberDropped << " buffered records which followed it");
+    }
+    m_NumberBufferedRecords = 0;
+
+    if (result && m_PersistenceManager != nullptr) {
+        m_PersistenceManager->startPersistIfAppropriate();
+    }
+
+    return result;
 }
 
 const std::string& CFieldDataCategorizer::categorizerKeyForRecord(const TStrStrUMap& dataRowFields) {
@@ -12,8 +12,10 @@
 
 #include <core/CBlockingCallCancellerThread.h>
 #include <core/CLogger.h>
+#include <core/CPipeReadBuffer.h>
 
 #include <atomic>
+#include <cstddef>
 #include <fstream>
 #include <ios>
 #include <iostream>
@@ -25,6 +27,7 @@ namespace {
 
 bool setUpIStream(const std::string& fileName,
                   bool isFileNamedPipe,
+                  std::size_t pipeBufferCapacity,
                   core::CBlockingCallCancellerThread& cancellerThread,
                   core::CNamedPipeFactory::TIStreamP& stream) {
     if (fileName.empty()) {
@@ -35,7 +38,7 @@ bool setUpIStream(const std::string& fileName,
         cancellerThread.reset();
         cancellerThread.start();
         stream = core::CNamedPipeFactory::openPipeStreamRead(
-            fileName, cancellerThread.hasCancelledBlockingCall());
+            fileName, cancellerThread.hasCancelledBlockingCall(), pipeBufferCapacity);
         cancellerThread.stop();
         return stream != nullptr && !stream->bad();
     }
@@ -102,11 +105,15 @@ CIoManager::~CIoManager() {
 }
 
 bool CIoManager::initIo() {
+    // Only the data input is read in bulk and parsed in place so only it
+    // gets a huge page buffer.
     m_IoInitialised = setUpIStream(m_InputFileName, m_IsInputFileNamedPipe,
+                                   core::CPipeReadBuffer::HUGE_PAGE_CAPACITY,
                                    m_CancellerThread, m_InputStream) &&
                       setUpOStream(m_OutputFileName, m_IsOutputFileNamedPipe,
                                    m_CancellerThread, m_OutputStream) &&
                       setUpIStream(m_RestoreFileName, m_IsRestoreFileNamedPipe,
+                                   core::CPipeReadBuffer::DEFAULT_CAPACITY,
                                    m_CancellerThread, m_RestoreStream) &&
                       setUpOStream(m_PersistFileName, m_IsPersistFileNamedPipe,
                                    m_CancellerThread, m_PersistStream);
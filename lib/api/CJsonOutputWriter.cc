@@ -11,6 +11,9 @@
 
 #include <api/CJsonOutputWriter.h>
 
+#include <core/CBoostJsonPoolAllocator.h>
+#include <core/CJsonOutputStreamWrapper.h>
+#include <core/CProgramCounters.h>
 #include <core/CTimeUtils.h>
 
 #include <model/CHierarchicalResultsNormalizer.h>
@@ -172,7 +175,7 @@ const CInfluencerGreater BUCKET_INFLUENCER_GREATER = CInfluencerGreater(INITIAL_
 
 CJsonOutputWriter::CJsonOutputWriter(const std::string& jobId,
                                      core::CJsonOutputStreamWrapper& strmOut)
-    : m_JobId(jobId), m_Writer(strmOut), m_LastNonInterimBucketTime(0),
+    : m_JobId(jobId), m_OutputStream(strmOut), m_Writer(strmOut), m_LastNonInterimBucketTime(0),
       m_Finalised(false), m_RecordOutputLimit(0) {
     // Don't write any output in the constructor because, the way things work at
     // the moment, the output stream might be redirected after construction
@@ -180,6 +183,9 @@ CJsonOutputWriter::CJsonOutputWriter(const std::string& jobId,
 
 CJsonOutputWriter::~CJsonOutputWriter() {
     finalise();
+    // The pending batch refers to this object so must be written before it's
+    // destroyed even if the output was finalised.
+    this->waitForPendingBatch();
 }
 
 const std::string& CJsonOutputWriter::jobId() const {
@@ -191,6 +197,8 @@ void CJsonOutputWriter::finalise() {
         return;
     }
 
+    this->waitForPendingBatch();
+
     // Flush the output This ensures that any buffers are written out
     // Note: This is still asynchronous.
     m_Writer.flush();
@@ -356,154 +364,200 @@ void CJsonOutputWriter::acceptBucketTimeInfluencer(core_t::TTime time,
 }
 
 bool CJsonOutputWriter::endOutputBatch(bool isInterim, std::uint64_t bucketProcessingTime) {
-    for (TTimeBucketDataMapItr iter = m_BucketDataByTime.begin();
-         iter != m_BucketDataByTime.end(); ++iter) {
-        this->writeBucket(isInterim, iter->first, iter->second, bucketProcessingTime);
+    for (auto& [bucketTime, bucketData] : m_BucketDataByTime) {
+        this->prepareBucket(isInterim, bucketTime, bucketData);
         if (!isInterim) {
-            m_LastNonInterimBucketTime = iter->first;
+            m_LastNonInterimBucketTime = bucketTime;
         }
     }
 
-    // After writing the buckets clear all the bucket data so that we don't
-    // accumulate memory.
+    // Only one batch is in flight at any time: this bounds the memory held
+    // for documents which have yet to be written.
+    this->waitForPendingBatch();
+
+    // The documents are kept alive by the allocator which owns them until
+    // the batch has been written.
+    m_PendingAllocator = m_Writer.getAllocator();
+    m_PendingBucketData = std::move(m_BucketDataByTime);
+    m_PendingBatch = m_OutputStream.writeAsync(
+        [this, isInterim, bucketProcessingTime](core::CStringBufWriter& writer) {
+            for (const auto& [bucketTime, bucketData] : m_PendingBucketData) {
+                this->writeBucket(writer, isInterim, bucketTime, bucketData,
+                                  bucketProcessingTime);
+            }
+        });
+    core::CProgramCounters::counter(counter_t::E_TSADOutputQueueDepth) =
+        m_OutputStream.queueDepth();
+
+    // After handing over the buckets clear all the bucket data so that we
+    // don't accumulate memory.
     m_BucketDataByTime.clear();
     m_NestedDocs.clear();
 
     return true;
 }
 
-void CJsonOutputWriter::writeBucket(bool isInterim,
+void CJsonOutputWriter::waitForPendingBatch() {
+    if (m_PendingBatch.valid()) {
+        m_PendingBatch.wait();
+        m_PendingBatch = std::future<void>{};
+    }
+    m_PendingBucketData.clear();
+    m_PendingAllocator.reset();
+}
+
+void CJsonOutputWriter::prepareBucket(bool isInterim,
+                                      core_t::TTime bucketTime,
+                                      SBucketData& bucketData) {
+    // Sort the results so they are grouped by detector and ordered by probability
+    std::sort(bucketData.s_DocumentsToWrite.begin(),
+              bucketData.s_DocumentsToWrite.end(), DETECTOR_PROBABILITY_LESS);
+
+    for (const auto& [weakDoc, detectorIndex] : bucketData.s_DocumentsToWrite) {
+        TDocumentPtr docPtr = weakDoc.lock();
+        if (!docPtr) {
+            LOG_ERROR(<< "Inconsistent program state. JSON document unavailable.");
+            continue;
+        }
+
+        m_Writer.addIntFieldToObj(DETECTOR_INDEX, detectorIndex, *docPtr);
+        m_Writer.addIntFieldToObj(BUCKET_SPAN, bucketData.s_BucketSpan, *docPtr);
+        m_Writer.addStringFieldCopyToObj(JOB_ID, m_JobId, *docPtr);
+        m_Writer.addTimeFieldToObj(TIMESTAMP, bucketTime, *docPtr);
+        if (isInterim) {
+            m_Writer.addBoolFieldToObj(IS_INTERIM, isInterim, *docPtr);
+        }
+    }
+
+    for (const auto& weakDoc : bucketData.s_InfluencerDocuments) {
+        TDocumentPtr docPtr = weakDoc.lock();
+        if (!docPtr) {
+            LOG_ERROR(<< "Inconsistent program state. JSON document unavailable.");
+            continue;
+        }
+
+        m_Writer.addStringFieldCopyToObj(JOB_ID, m_JobId, *docPtr);
+        m_Writer.addTimeFieldToObj(TIMESTAMP, bucketTime, *docPtr);
+        if (isInterim) {
+            m_Writer.addBoolFieldToObj(IS_INTERIM, isInterim, *docPtr);
+        }
+        m_Writer.addIntFieldToObj(BUCKET_SPAN, bucketData.s_BucketSpan, *docPtr);
+    }
+
+    for (const auto& weakDoc : bucketData.s_BucketInfluencerDocuments) {
+        TDocumentPtr docPtr = weakDoc.lock();
+        if (!docPtr) {
+            LOG_ERROR(<< "Inconsistent program state. JSON document unavailable.");
+            continue;
+        }
+
+        m_Writer.addStringFieldCopyToObj(JOB_ID, m_JobId, *docPtr);
+        m_Writer.addTimeFieldToObj(TIMESTAMP, bucketTime, *docPtr);
+        m_Writer.addIntFieldToObj(BUCKET_SPAN, bucketData.s_BucketSpan, *docPtr);
+        if (isInterim) {
+            m_Writer.addBoolFieldToObj(IS_INTERIM, isInterim, *docPtr);
+        }
+    }
+}
+
+void CJsonOutputWriter::writeBucket(core::CStringBufWriter& writer,
+                                    bool isInterim,
                                     core_t::TTime bucketTime,
-                                    SBucketData& bucketData,
-                                    std::uint64_t bucketProcessingTime) {
+                                    const SBucketData& bucketData,
+                                    std::uint64_t bucketProcessingTime) const {
     // Write records
     if (!bucketData.s_DocumentsToWrite.empty()) {
-        // Sort the results so they are grouped by detector and
-        // ordered by probability
-        std::sort(bucketData.s_DocumentsToWrite.begin(),
-                  bucketData.s_DocumentsToWrite.end(), DETECTOR_PROBABILITY_LESS);
-
-        m_Writer.onObjectBegin();
-        m_Writer.onKey(RECORDS);
-        m_Writer.onArrayBegin();
+        writer.onObjectBegin();
+        writer.onKey(RECORDS);
+        writer.onArrayBegin();
 
         // Iterate over the different detectors that we have results for
-        for (TDocumentWeakPtrIntPrVecItr detectorIter =
-                 bucketData.s_DocumentsToWrite.begin();
-             detectorIter != bucketData.s_DocumentsToWrite.end(); ++detectorIter) {
-            // Write the document, adding some extra fields as we go
-            int detectorIndex = detectorIter->second;
-            TDocumentWeakPtr weakDoc = detectorIter->first;
-            TDocumentPtr docPtr = weakDoc.lock();
+        for (const auto& detectorDoc : bucketData.s_DocumentsToWrite) {
+            TDocumentPtr docPtr = detectorDoc.first.lock();
             if (!docPtr) {
                 LOG_ERROR(<< "Inconsistent program state. JSON document unavailable.");
                 continue;
             }
-
-            m_Writer.addIntFieldToObj(DETECTOR_INDEX, detectorIndex, *docPtr);
-            m_Writer.addIntFieldToObj(BUCKET_SPAN, bucketData.s_BucketSpan, *docPtr);
-            m_Writer.addStringFieldCopyToObj(JOB_ID, m_JobId, *docPtr);
-            m_Writer.addTimeFieldToObj(TIMESTAMP, bucketTime, *docPtr);
-
-            if (isInterim) {
-                m_Writer.addBoolFieldToObj(IS_INTERIM, isInterim, *docPtr);
-            }
-            m_Writer.write(*docPtr);
+            writer.write(*docPtr);
         }
-        m_Writer.onArrayEnd();
-        m_Writer.onObjectEnd();
+        writer.onArrayEnd();
+        writer.onObjectEnd();
     }
 
     // Write influencers
     if (!bucketData.s_InfluencerDocuments.empty()) {
-        m_Writer.onObjectBegin();
-        m_Writer.onKey(INFLUENCERS);
-        m_Writer.onArrayBegin();
-        for (TDocumentWeakPtrVecItr influencerIter =
+        writer.onObjectBegin();
+        writer.onKey(INFLUENCERS);
+        writer.onArrayBegin();
+        for (TDocumentWeakPtrVecCItr influencerIter =
                  bucketData.s_InfluencerDocuments.begin();
              influencerIter != bucketData.s_InfluencerDocuments.end(); ++influencerIter) {
-            TDocumentWeakPtr weakDoc = *influencerIter;
-            TDocumentPtr docPtr = weakDoc.lock();
+            TDocumentPtr docPtr = influencerIter->lock();
             if (!docPtr) {
                 LOG_ERROR(<< "Inconsistent program state. JSON document unavailable.");
                 continue;
             }
-
-            m_Writer.addStringFieldCopyToObj(JOB_ID, m_JobId, *docPtr);
-            m_Writer.addTimeFieldToObj(TIMESTAMP, bucketTime, *docPtr);
-            if (isInterim) {
-                m_Writer.addBoolFieldToObj(IS_INTERIM, isInterim, *docPtr);
-            }
-            m_Writer.addIntFieldToObj(BUCKET_SPAN, bucketData.s_BucketSpan, *docPtr);
-            m_Writer.write(*docPtr);
+            writer.write(*docPtr);
         }
-        m_Writer.onArrayEnd();
-        m_Writer.onObjectEnd();
+        writer.onArrayEnd();
+        writer.onObjectEnd();
     }
 
     // Write bucket at the end, as some of its values need to iterate over records, etc.
-    m_Writer.onObjectBegin();
-    m_Writer.onKey(BUCKET);
-
-    m_Writer.onObjectBegin();
-    m_Writer.onKey(JOB_ID);
-    m_Writer.onString(m_JobId);
-    m_Writer.onKey(TIMESTAMP);
-    m_Writer.onTime(bucketTime);
-
-    m_Writer.onKey(ANOMALY_SCORE);
-    m_Writer.onDouble(bucketData.s_MaxBucketInfluencerNormalizedAnomalyScore);
-    m_Writer.onKey(INITIAL_SCORE);
-    m_Writer.onDouble(bucketData.s_MaxBucketInfluencerNormalizedAnomalyScore);
-    m_Writer.onKey(EVENT_COUNT);
-    m_Writer.onUint64(bucketData.s_InputEventCount);
+    writer.onObjectBegin();
+    writer.onKey(BUCKET);
+
+    writer.onObjectBegin();
+    writer.onKey(JOB_ID);
+    writer.onString(m_JobId);
+    writer.onKey(TIMESTAMP);
+    writer.onTime(bucketTime);
+
+    writer.onKey(ANOMALY_SCORE);
+    writer.onDouble(bucketData.s_MaxBucketInfluencerNormalizedAnomalyScore);
+    writer.onKey(INITIAL_SCORE);
+    writer.onDouble(bucketData.s_MaxBucketInfluencerNormalizedAnomalyScore);
+    writer.onKey(EVENT_COUNT);
+    writer.onUint64(bucketData.s_InputEventCount);
     if (isInterim) {
-        m_Writer.onKey(IS_INTERIM);
-        m_Writer.onBool(isInterim);
+        writer.onKey(IS_INTERIM);
+        writer.onBool(isInterim);
     }
-    m_Writer.onKey(BUCKET_SPAN);
-    m_Writer.onInt64(bucketData.s_BucketSpan);
+    writer.onKey(BUCKET_SPAN);
+    writer.onInt64(bucketData.s_BucketSpan);
 
     if (!bucketData.s_BucketInfluencerDocuments.empty()) {
         // Write the array of influencers
-        m_Writer.onKey(BUCKET_INFLUENCERS);
-        m_Writer.onArrayBegin();
-        for (TDocumentWeakPtrVecItr influencerIter =
+        writer.onKey(BUCKET_INFLUENCERS);
+        writer.onArrayBegin();
+        for (TDocumentWeakPtrVecCItr influencerIter =
                  bucketData.s_BucketInfluencerDocuments.begin();
              influencerIter != bucketData.s_BucketInfluencerDocuments.end();
              ++influencerIter) {
-            TDocumentWeakPtr weakDoc = *influencerIter;
-            TDocumentPtr docPtr = weakDoc.lock();
+            TDocumentPtr docPtr = influencerIter->lock();
             if (!docPtr) {
                 LOG_ERROR(<< "Inconsistent program state. JSON document unavailable.");
                 continue;
             }
-
-            m_Writer.addStringFieldCopyToObj(JOB_ID, m_JobId, *docPtr);
-            m_Writer.addTimeFieldToObj(TIMESTAMP, bucketTime, *docPtr);
-            m_Writer.addIntFieldToObj(BUCKET_SPAN, bucketData.s_BucketSpan, *docPtr);
-            if (isInterim) {
-                m_Writer.addBoolFieldToObj(IS_INTERIM, isInterim, *docPtr);
-            }
-            m_Writer.write(*docPtr);
+            writer.write(*docPtr);
         }
-        m_Writer.onArrayEnd();
+        writer.onArrayEnd();
     }
 
-    m_Writer.onKey(PROCESSING_TIME);
-    m_Writer.onUint64(bucketProcessingTime);
+    writer.onKey(PROCESSING_TIME);
+    writer.onUint64(bucketProcessingTime);
 
     if (bucketData.s_ScheduledEventDescriptions.empty() == false) {
-        m_Writer.onKey(SCHEDULED_EVENTS);
-        m_Writer.onArrayBegin();
+        writer.onKey(SCHEDULED_EVENTS);
+        writer.onArrayBegin();
         for (const auto& it : bucketData.s_ScheduledEventDescriptions) {
-            m_Writer.onString(it);
+            writer.onString(it);
         }
-        m_Writer.onArrayEnd();
+        writer.onArrayEnd();
     }
 
-    m_Writer.onObjectEnd();
-    m_Writer.onObjectEnd();
+    writer.onObjectEnd();
+    writer.onObjectEnd();
 }
 
 void CJsonOutputWriter::addMetricFields(const CHierarchicalResultsWriter::TResults& results,
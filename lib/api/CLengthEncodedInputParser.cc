@@ -11,6 +11,7 @@
 #include <api/CLengthEncodedInputParser.h>
 
 #include <core/CLogger.h>
+#include <core/CPipeReadBuffer.h>
 #include <core/CSetMode.h>
 
 #include <algorithm>
@@ -35,6 +36,8 @@ namespace api {
 // than the OS buffer for the named pipes (smallest is windows at 4KB).
 // This allows flushing the buffer from the java side by sending spaces
 // without the risk of blocking the thread that writes to the process.
+// This doesn't apply when reading from a CPipeReadBuffer because it
+// returns whatever data is available rather than waiting to fill up.
 const std::size_t CLengthEncodedInputParser::WORK_BUFFER_SIZE{2048}; // 2kB
 
 CLengthEncodedInputParser::CLengthEncodedInputParser(std::istream& strmIn)
@@ -43,7 +46,8 @@ CLengthEncodedInputParser::CLengthEncodedInputParser(std::istream& strmIn)
 
 CLengthEncodedInputParser::CLengthEncodedInputParser(TStrVec mutableFieldNames,
                                                      std::istream& strmIn)
-    : CInputParser{std::move(mutableFieldNames)}, m_StrmIn{strmIn} {
+    : CInputParser{std::move(mutableFieldNames)}, m_StrmIn{strmIn},
+      m_PipeBuffer{dynamic_cast<core::CPipeReadBuffer*>(strmIn.rdbuf())} {
     // This test is not ideal because std::cin's stream buffer could have been
     // changed
     if (strmIn.rdbuf() == std::cin.rdbuf()) {
@@ -110,7 +114,12 @@ bool CLengthEncodedInputParser::readStreamIntoVecs(const TVecReaderFunc& readerF
 
 bool CLengthEncodedInputParser::readFieldNames() {
     // Reset the record buffer pointers in case we're reading a new stream
-    m_WorkBufferEnd = m_WorkBufferPtr;
+    if (m_PipeBuffer != nullptr) {
+        m_WorkBufferPtr = m_PipeBuffer->unreadBegin();
+        m_WorkBufferEnd = m_PipeBuffer->unreadEnd();
+    } else {
+        m_WorkBufferEnd = m_WorkBufferPtr;
+    }
     m_NoMoreRecords = false;
     TStrVec& fieldNames{this->fieldNames()};
 
@@ -161,7 +170,7 @@ bool CLengthEncodedInputParser::parseRecordFromStream(STR_VEC& values) {
     // for the delimiter and then memcpy() to transfer data to the target
     // std::string, but sadly this is not the case for the Microsoft and Apache
     // STLs.
-    if (m_WorkBuffer == nullptr) {
+    if (m_PipeBuffer == nullptr && m_WorkBuffer == nullptr) {
         m_WorkBuffer.reset(new char[WORK_BUFFER_SIZE]);
         m_WorkBufferPtr = m_WorkBuffer.get();
         m_WorkBufferEnd = m_WorkBufferPtr;
@@ -169,7 +178,7 @@ bool CLengthEncodedInputParser::parseRecordFromStream(STR_VEC& values) {
 
     std::uint32_t numFields{0};
     if (this->parseUInt32FromStream(numFields) == false) {
-        if (m_StrmIn.eof()) {
+        if (this->endOfStream()) {
             // End-of-file is not an error at this point in the parsing
             m_NoMoreRecords = true;
             return true;
@@ -230,14 +239,21 @@ bool CLengthEncodedInputParser::parseRecordFromStream(STR_VEC& values) {
         }
     }
 
+    if (m_PipeBuffer != nullptr) {
+        m_PipeBuffer->consume(m_WorkBufferPtr);
+    }
+
     return true;
 }
 
 bool CLengthEncodedInputParser::parseUInt32FromStream(std::uint32_t& num) {
     std::ptrdiff_t avail{m_WorkBufferEnd - m_WorkBufferPtr};
-    if (avail < static_cast<std::ptrdiff_t>(sizeof(std::uint32_t))) {
+    while (avail < static_cast<std::ptrdiff_t>(sizeof(std::uint32_t))) {
+        // A pipe buffer may return fewer bytes than we need so keep going
+        // until we stop getting more data.
+        std::ptrdiff_t lastAvail{avail};
         avail = this->refillBuffer();
-        if (avail < static_cast<std::ptrdiff_t>(sizeof(std::uint32_t))) {
+        if (avail == lastAvail) {
             return false;
         }
     }
@@ -290,11 +306,24 @@ std::ptrdiff_t CLengthEncodedInputParser::refillBuffer() {
     // when calling this method.
 
     std::ptrdiff_t avail{m_WorkBufferEnd - m_WorkBufferPtr};
-    if (m_StrmIn.eof()) {
+    if (this->endOfStream()) {
         // We can't read any more data - whatever's available now won't change
         return avail;
     }
 
+    if (m_PipeBuffer != nullptr) {
+        // Parse in place: this only moves the unread data if the buffer
+        // is running out of space.
+        m_PipeBuffer->consume(m_WorkBufferPtr);
+        m_PipeBuffer->fill();
+        if (m_PipeBuffer->bad()) {
+            LOG_ERROR(<< "Input stream is bad");
+        }
+        m_WorkBufferPtr = m_PipeBuffer->unreadBegin();
+        m_WorkBufferEnd = m_PipeBuffer->unreadEnd();
+        return m_WorkBufferEnd - m_WorkBufferPtr;
+    }
+
     if (avail > 0) {
         std::memcpy(m_WorkBuffer.get(), m_WorkBufferPtr, avail);
     }
@@ -311,5 +340,10 @@ std::ptrdiff_t CLengthEncodedInputParser::refillBuffer() {
 
     return avail;
 }
+
+bool CLengthEncodedInputParser::endOfStream() const {
+    return m_PipeBuffer != nullptr ? m_PipeBuffer->eof() || m_PipeBuffer->bad()
+                                   : m_StrmIn.eof();
+}
 }
 }
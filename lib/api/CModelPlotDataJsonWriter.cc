@@ -34,7 +34,11 @@ const std::string CModelPlotDataJsonWriter::ACTUAL("actual");
 const std::string CModelPlotDataJsonWriter::BUCKET_SPAN("bucket_span");
 
 CModelPlotDataJsonWriter::CModelPlotDataJsonWriter(core::CJsonOutputStreamWrapper& outStream)
-    : m_Writer(outStream) {
+    : m_ConcurrentWriter{std::in_place, outStream}, m_Writer{*m_ConcurrentWriter} {
+}
+
+CModelPlotDataJsonWriter::CModelPlotDataJsonWriter(core::CStringBufWriter& writer)
+    : m_Writer{writer} {
 }
 
 void CModelPlotDataJsonWriter::writeFlat(const std::string& jobId,
@@ -11,6 +11,7 @@
 #include <api/CNdInputParser.h>
 
 #include <core/CLogger.h>
+#include <core/CPipeReadBuffer.h>
 
 #include <cstring>
 #include <istream>
@@ -23,7 +24,8 @@ const char CNdInputParser::LINE_END{'\n'};
 const std::size_t CNdInputParser::WORK_BUFFER_SIZE{131072}; // 128kB
 
 CNdInputParser::CNdInputParser(TStrVec mutableFieldNames, std::istream& strmIn)
-    : CInputParser{std::move(mutableFieldNames)}, m_StrmIn{strmIn}, m_WorkBuffer{nullptr},
+    : CInputParser{std::move(mutableFieldNames)}, m_StrmIn{strmIn},
+      m_PipeBuffer{dynamic_cast<core::CPipeReadBuffer*>(strmIn.rdbuf())}, m_WorkBuffer{nullptr},
       m_WorkBufferCapacity{0}, m_WorkBufferPtr{nullptr}, m_WorkBufferEnd{nullptr} {
 }
 
@@ -35,6 +37,10 @@ CNdInputParser::TCharPSizePr CNdInputParser::parseLine() {
     // for the delimiter and then memcpy() to transfer data to the target
     // std::string, but sadly this is not the case for the Microsoft and Apache
     // STLs.
+    if (m_PipeBuffer != nullptr) {
+        return this->parseLineInPlace();
+    }
+
     if (m_WorkBuffer == nullptr) {
         m_WorkBuffer.reset(new char[WORK_BUFFER_SIZE]);
         m_WorkBufferCapacity = WORK_BUFFER_SIZE;
@@ -92,7 +98,36 @@ CNdInputParser::TCharPSizePr CNdInputParser::parseLine() {
     return TCharPSizePr{nullptr, 0};
 }
 
+CNdInputParser::TCharPSizePr CNdInputParser::parseLineInPlace() {
+    // The pipe buffer takes care of moving a partial line to the start of
+    // its buffer, or growing it, when it needs more space.
+    std::size_t searched{0};
+    for (;;) {
+        char* begin{m_PipeBuffer->unreadBegin()};
+        char* end{m_PipeBuffer->unreadEnd()};
+        char* delimPtr{reinterpret_cast<char*>(std::memchr(
+            begin + searched, LINE_END, static_cast<std::size_t>(end - begin) - searched))};
+        if (delimPtr) {
+            *delimPtr = '\0';
+            m_PipeBuffer->consume(delimPtr + 1);
+            return TCharPSizePr{begin, delimPtr - begin};
+        }
+        searched = static_cast<std::size_t>(end - begin);
+
+        if (m_PipeBuffer->fill() == 0) {
+            if (m_PipeBuffer->bad()) {
+                LOG_ERROR(<< "Input stream is bad");
+            }
+            // We needed to read more data and didn't get any, so stop
+            break;
+        }
+    }
+
+    return TCharPSizePr{nullptr, 0};
+}
+
 void CNdInputParser::resetBuffer() {
+    m_PipeBuffer = dynamic_cast<core::CPipeReadBuffer*>(m_StrmIn.rdbuf());
     m_WorkBufferEnd = m_WorkBufferPtr;
 }
 }
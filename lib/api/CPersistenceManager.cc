@@ -15,6 +15,8 @@
 #include <core/CScopedFastLock.h>
 #include <core/CTimeUtils.h>
 
+#include <model/CAnomalyDetector.h>
+
 #include <string>
 #include <utility>
 
@@ -148,8 +150,11 @@ bool CPersistenceManager::startPersistInBackground() {
     }
 
     // create a cache of the counters, to ensure persistence operates
-    // on a consistent collection of counters
-    core::CProgramCounters::cacheCounters();
+    // on a consistent collection of counters, unless they aren't persisted
+    // because several jobs share this process
+    if (model::CAnomalyDetector::persistsStatics()) {
+        core::CProgramCounters::cacheCounters();
+    }
     m_IsShutdown = false;
     m_IsBusy = m_BackgroundThread.start();
 
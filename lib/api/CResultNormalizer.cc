@@ -14,7 +14,9 @@
 
 #include <maths/common/CTools.h>
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
 
 namespace ml {
 namespace api {
@@ -35,13 +37,15 @@ const std::string CResultNormalizer::PARTITION_LEVEL("part");
 const std::string CResultNormalizer::BUCKET_INFLUENCER_LEVEL("inflb");
 const std::string CResultNormalizer::INFLUENCER_LEVEL("infl");
 const std::string CResultNormalizer::ZERO("0");
+const std::size_t CResultNormalizer::DEFAULT_BATCH_SIZE(1024);
 
 CResultNormalizer::CResultNormalizer(const model::CAnomalyDetectorModelConfig& modelConfig,
-                                     CSimpleOutputWriter& outputWriter)
+                                     CSimpleOutputWriter& outputWriter,
+                                     std::size_t batchSize)
     : m_ModelConfig(modelConfig), m_OutputWriter(outputWriter),
       m_WriteFieldNames(true),
       m_OutputFieldNormalizedScore(m_OutputFields[NORMALIZED_SCORE_NAME]),
-      m_Normalizer(m_ModelConfig) {
+      m_Normalizer(m_ModelConfig), m_BatchSize(std::max(batchSize, std::size_t(1))) {
 }
 
 bool CResultNormalizer::initNormalizer(const std::string& stateFileName) {
@@ -73,82 +77,145 @@ bool CResultNormalizer::handleRecord(const TStrStrUMap& dataRowFields) {
         m_WriteFieldNames = false;
     }
 
-    std::string level;
-    std::string partitionName;
-    std::string partitionValue;
-    std::string personName;
-    std::string personValue;
-    std::string function;
-    std::string valueFieldName;
-    double probability(0.0);
+    if (m_NumberBufferedRecords == m_BufferedRecords.size()) {
+        m_BufferedRecords.emplace_back();
+    }
+    SBufferedRecord& record{m_BufferedRecords[m_NumberBufferedRecords++]};
+    record.s_Fields = dataRowFields;
+    record.s_Score = 0.0;
+    record.s_Normalizer = nullptr;
 
     // As of version 6.5 the 'personValue' field is required for (re)normalization to succeed.
     // In the case of renormalization the 'personValue' field must be included in the set of
     // parameters sent from the Java side ML plugin to Elasticsearch.
     // In production the version of the native code application and the java application it is communicating directly
     // with will always match so supporting BWC with versions prior to 6.5 is not necessary.
-    bool isNormalizable = this->parseDataFields(
-        dataRowFields, level, partitionName, partitionValue, personName,
-        personValue, function, valueFieldName, probability);
-
-    LOG_TRACE(<< "level='" << level << "', partitionName='" << partitionName << "', partitionValue='"
-              << partitionValue << "', personName='" << personName << "', personValue='"
-              << personValue << "', function='" << function << "', valueFieldName='"
-              << valueFieldName << "', probability='" << probability << "'");
-
-    if (isNormalizable) {
-        const model::CAnomalyScore::CNormalizer* levelNormalizer = nullptr;
-        double score = probability > m_ModelConfig.maximumAnomalousProbability()
-                           ? 0.0
-                           : maths::common::CTools::anomalyScore(probability);
-        if (level == ROOT_LEVEL) {
-            levelNormalizer = &m_Normalizer.bucketNormalizer();
-        } else if (level == LEAF_LEVEL) {
-            levelNormalizer = m_Normalizer.leafNormalizer(
-                partitionName, personName, function, valueFieldName);
-        } else if (level == PARTITION_LEVEL) {
-            levelNormalizer = m_Normalizer.partitionNormalizer(partitionName);
-        } else if (level == BUCKET_INFLUENCER_LEVEL) {
-            levelNormalizer = m_Normalizer.influencerBucketNormalizer(personName);
-        } else if (level == INFLUENCER_LEVEL) {
-            levelNormalizer = m_Normalizer.influencerNormalizer(personName);
-        } else {
-            LOG_ERROR(<< "Unexpected   : " << level);
+    double probability(0.0);
+    record.s_IsNormalizable = this->parseDataFields(
+        record.s_Fields, record.s_Level, *record.s_PartitionName,
+        *record.s_PartitionValue, *record.s_PersonName, *record.s_PersonValue,
+        record.s_Function, record.s_ValueFieldName, probability);
+
+    LOG_TRACE(<< "level='" << record.s_Level << "', partitionName='"
+              << *record.s_PartitionName << "', partitionValue='" << *record.s_PartitionValue
+              << "', personName='" << *record.s_PersonName << "', personValue='"
+              << *record.s_PersonValue << "', function='" << record.s_Function
+              << "', valueFieldName='" << record.s_ValueFieldName
+              << "', probability='" << probability << "'");
+
+    if (record.s_IsNormalizable) {
+        record.s_Score = probability > m_ModelConfig.maximumAnomalousProbability()
+                             ? 0.0
+                             : maths::common::CTools::anomalyScore(probability);
+        record.s_Normalizer = this->levelNormalizer(record);
+    }
+
+    return m_NumberBufferedRecords < m_BatchSize || this->handleBufferedRecords();
+}
+
+bool CResultNormalizer::finalise() {
+    return this->handleBufferedRecords();
+}
+
+bool CResultNormalizer::handleBufferedRecords() {
+    using TNormalizerCPtr = const model::CAnomalyScore::CNormalizer*;
+    using TMaximumScoreScopeVec = model::CAnomalyScore::CNormalizer::TMaximumScoreScopeVec;
+    using TDoubleVec = std::vector<double>;
+
+    // Group the records by normalizer so each group can be normalized in
+    // one pass.
+    TSizeVec records;
+    records.reserve(m_NumberBufferedRecords);
+    for (std::size_t i = 0; i < m_NumberBufferedRecords; ++i) {
+        const SBufferedRecord& record{m_BufferedRecords[i]};
+        if (record.s_Normalizer != nullptr && record.s_Normalizer->canNormalize()) {
+            records.push_back(i);
         }
-        if (levelNormalizer != nullptr) {
-            if (levelNormalizer->canNormalize()) {
-                using TOptionalStr = std::optional<std::string>;
-                TOptionalStr partitionNameOpt(partitionName);
-                TOptionalStr partitionValueOpt(partitionValue);
-                TOptionalStr personNameOpt(personName);
-                TOptionalStr personValueOpt(personValue);
-                model::CAnomalyScore::CNormalizer::CMaximumScoreScope scope{
-                    partitionNameOpt, partitionValueOpt, personNameOpt, personValueOpt};
-                if (levelNormalizer->normalize(scope, score) == false) {
-                    LOG_ERROR(<< "Failed to normalize score " << score << " at level \""
-                              << level << "\" using scope " << scope.print());
-                }
-            }
+    }
+    std::stable_sort(records.begin(), records.end(), [this](std::size_t lhs, std::size_t rhs) {
+        return std::less<TNormalizerCPtr>{}(m_BufferedRecords[lhs].s_Normalizer,
+                                            m_BufferedRecords[rhs].s_Normalizer);
+    });
+
+    TMaximumScoreScopeVec scopes;
+    TDoubleVec scores;
+    for (auto group = records.begin(); group != records.end(); /**/) {
+        TNormalizerCPtr normalizer{m_BufferedRecords[*group].s_Normalizer};
+        auto groupEnd = std::find_if(group, records.end(), [&](std::size_t i) {
+            return m_BufferedRecords[i].s_Normalizer != normalizer;
+        });
+
+        scopes.clear();
+        scores.clear();
+        for (auto i = group; i != groupEnd; ++i) {
+            const SBufferedRecord& record{m_BufferedRecords[*i]};
+            scopes.emplace_back(record.s_PartitionName, record.s_PartitionValue,
+                                record.s_PersonName, record.s_PersonValue);
+            scores.push_back(record.s_Score);
+        }
+        if (normalizer->normalize(scopes, scores) == false) {
+            LOG_ERROR(<< "Failed to normalize scores at level \""
+                      << m_BufferedRecords[*group].s_Level << "\"");
         } else {
-            LOG_ERROR(<< "No normalizer available at level '" << level
-                      << "' with partition field name '" << partitionName
-                      << "' and person field name '" << personName << "'");
+            for (auto i = group; i != groupEnd; ++i) {
+                m_BufferedRecords[*i].s_Score = scores[i - group];
+            }
         }
 
-        m_OutputFieldNormalizedScore =
-            (score > 0.0) ? core::CStringUtils::typeToStringPretty(score) : ZERO;
-    } else {
-        m_OutputFieldNormalizedScore.clear();
+        group = groupEnd;
     }
 
-    if (m_OutputWriter.writeRow(dataRowFields, m_OutputFields) == false) {
-        LOG_ERROR(<< "Unable to write normalized output");
-        return false;
+    // Write the results in the order the records were received.
+    std::size_t numberRecords{m_NumberBufferedRecords};
+    m_NumberBufferedRecords = 0;
+    for (std::size_t i = 0; i < numberRecords; ++i) {
+        const SBufferedRecord& record{m_BufferedRecords[i]};
+        if (record.s_IsNormalizable) {
+            m_OutputFieldNormalizedScore =
+                (record.s_Score > 0.0) ? core::CStringUtils::typeToStringPretty(record.s_Score)
+                                       : ZERO;
+        } else {
+            m_OutputFieldNormalizedScore.clear();
+        }
+
+        if (m_OutputWriter.writeRow(record.s_Fields, m_OutputFields) == false) {
+            LOG_ERROR(<< "Unable to write normalized output");
+            return false;
+        }
     }
 
     return true;
 }
 
+const model::CAnomalyScore::CNormalizer*
+CResultNormalizer::levelNormalizer(const SBufferedRecord& record) const {
+    const model::CAnomalyScore::CNormalizer* levelNormalizer = nullptr;
+    const std::string& level{record.s_Level};
+    const std::string& partitionName{*record.s_PartitionName};
+    const std::string& personName{*record.s_PersonName};
+    if (level == ROOT_LEVEL) {
+        levelNormalizer = &m_Normalizer.bucketNormalizer();
+    } else if (level == LEAF_LEVEL) {
+        levelNormalizer = m_Normalizer.leafNormalizer(
+            partitionName, personName, record.s_Function, record.s_ValueFieldName);
+    } else if (level == PARTITION_LEVEL) {
+        levelNormalizer = m_Normalizer.partitionNormalizer(partitionName);
+    } else if (level == BUCKET_INFLUENCER_LEVEL) {
+        levelNormalizer = m_Normalizer.influencerBucketNormalizer(personName);
+    } else if (level == INFLUENCER_LEVEL) {
+        levelNormalizer = m_Normalizer.influencerNormalizer(personName);
+    } else {
+        LOG_ERROR(<< "Unexpected   : " << level);
+        return nullptr;
+    }
+    if (levelNormalizer == nullptr) {
+        LOG_ERROR(<< "No normalizer available at level '" << level
+                  << "' with partition field name '" << partitionName
+                  << "' and person field name '" << personName << "'");
+    }
+    return levelNormalizer;
+}
+
 bool CResultNormalizer::parseDataFields(const TStrStrUMap& dataRowFields,
                                         std::string& level,
                                         std::string& partitionName,
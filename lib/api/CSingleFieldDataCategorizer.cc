@@ -60,8 +60,27 @@ CGlobalCategoryId CSingleFieldDataCategorizer::computeAndUpdateCategory(
     const std::string& rawMessage,
     model::CResourceMonitor& resourceMonitor,
     CJsonOutputWriter& jsonOutputWriter) {
-    model::CLocalCategoryId localCategoryId{m_DataCategorizer->computeCategory(
-        isDryRun, fields, messageToCategorize, rawMessage.length())};
+    model::CLocalCategoryId localCategoryId{
+        this->computeCategory(isDryRun, fields, messageToCategorize, rawMessage)};
+    return this->updateCategory(localCategoryId, messageTime, rawMessage,
+                                resourceMonitor, jsonOutputWriter);
+}
+
+model::CLocalCategoryId
+CSingleFieldDataCategorizer::computeCategory(bool isDryRun,
+                                             const model::CDataCategorizer::TStrStrUMap& fields,
+                                             const std::string& messageToCategorize,
+                                             const std::string& rawMessage) {
+    return m_DataCategorizer->computeCategory(isDryRun, fields, messageToCategorize,
+                                              rawMessage.length());
+}
+
+CGlobalCategoryId
+CSingleFieldDataCategorizer::updateCategory(model::CLocalCategoryId localCategoryId,
+                                            const TOptionalTime& messageTime,
+                                            const std::string& rawMessage,
+                                            model::CResourceMonitor& resourceMonitor,
+                                            CJsonOutputWriter& jsonOutputWriter) {
     CGlobalCategoryId globalCategoryId{m_CategoryIdMapper->map(localCategoryId)};
     if (globalCategoryId.isValid() == false) {
         return globalCategoryId;
@@ -0,0 +1,236 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <core/CBlockingCallCancellingTimer.h>
+#include <core/CLogger.h>
+#include <core/CProgramCounters.h>
+#include <core/CThread.h>
+#include <core/CoreTypes.h>
+
+#include <api/CAnomalyJobHost.h>
+#include <api/CIoManager.h>
+
+#include <test/CTestTmpDir.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(CAnomalyJobHostTest)
+
+namespace {
+using TStrVec = std::vector<std::string>;
+
+std::string makeFileName(const std::string& name) {
+    return ml::test::CTestTmpDir::tmpDir() + "/CAnomalyJobHostTest_" + name;
+}
+
+void writeFile(const std::string& fileName, const std::string& contents) {
+    std::ofstream strm{fileName};
+    BOOST_TEST_REQUIRE(strm.is_open());
+    strm << contents;
+}
+
+std::string readFile(const std::string& fileName) {
+    std::ifstream strm{fileName};
+    BOOST_TEST_REQUIRE(strm.is_open());
+    std::ostringstream contents;
+    contents << strm.rdbuf();
+    return contents.str();
+}
+
+std::string makeJobCommand(const std::string& jobId,
+                           ml::core_t::TTime start = 1359331200,
+                           ml::core_t::TTime length = 2 * 86400,
+                           const std::string& extraOptions = "") {
+    std::string configFile{makeFileName(jobId + "_config.json")};
+    std::string inputFile{makeFileName(jobId + "_input.csv")};
+    std::string outputFile{makeFileName(jobId + "_output.json")};
+
+    writeFile(configFile, "{\"job_id\":\"" + jobId +
+                              "\",\"analysis_config\":{\"bucket_span\":\"1h\","
+                              "\"detectors\":[{\"function\":\"count\"}]}}");
+
+    // One record a minute.
+    std::ostringstream input;
+    input << "time,value\n";
+    for (ml::core_t::TTime time = start; time < start + length; time += 60) {
+        input << time << ",1\n";
+    }
+    writeFile(inputFile, input.str());
+
+    return "{\"config\":\"" + configFile + "\",\"input\":\"" + inputFile +
+           "\",\"output\":\"" + outputFile + "\"" + extraOptions + "}";
+}
+
+void removeJobFiles(const std::string& jobId) {
+    for (const auto& suffix : {"_config.json", "_input.csv", "_output.json"}) {
+        std::remove(makeFileName(jobId + suffix).c_str());
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE(testParseJobOptions) {
+    ml::api::CAnomalyJobHost::SJobOptions options;
+    BOOST_TEST_REQUIRE(ml::api::CAnomalyJobHost::parseJobOptions(
+        "{\"config\":\"config.json\",\"input\":\"in\",\"inputIsPipe\":true,"
+        "\"output\":\"out\",\"outputIsPipe\":true,\"persist\":\"persist\","
+        "\"persistIsPipe\":true,\"lengthEncodedInput\":true,\"delimiter\":\",\","
+        "\"bucketPersistInterval\":10,\"maxAnomalyRecords\":5}",
+        options));
+    BOOST_REQUIRE_EQUAL("config.json", options.s_ConfigFile);
+    BOOST_REQUIRE_EQUAL("in", options.s_InputFileName);
+    BOOST_REQUIRE_EQUAL(true, options.s_IsInputFileNamedPipe);
+    BOOST_REQUIRE_EQUAL("out", options.s_OutputFileName);
+    BOOST_REQUIRE_EQUAL(true, options.s_IsOutputFileNamedPipe);
+    BOOST_REQUIRE_EQUAL("", options.s_RestoreFileName);
+    BOOST_REQUIRE_EQUAL("persist", options.s_PersistFileName);
+    BOOST_REQUIRE_EQUAL(true, options.s_IsPersistFileNamedPipe);
+    BOOST_REQUIRE_EQUAL(true, options.s_LengthEncodedInput);
+    BOOST_REQUIRE_EQUAL(',', options.s_Delimiter);
+    BOOST_REQUIRE_EQUAL(10, options.s_BucketPersistInterval);
+    BOOST_REQUIRE_EQUAL(5, options.s_MaxAnomalyRecords);
+
+    // Defaults.
+    BOOST_TEST_REQUIRE(ml::api::CAnomalyJobHost::parseJobOptions(
+        "{\"config\":\"config.json\",\"input\":\"in\",\"output\":\"out\"}", options));
+    BOOST_REQUIRE_EQUAL(false, options.s_IsInputFileNamedPipe);
+    BOOST_REQUIRE_EQUAL(false, options.s_LengthEncodedInput);
+    BOOST_REQUIRE_EQUAL('\t', options.s_Delimiter);
+    BOOST_REQUIRE_EQUAL(100, options.s_MaxAnomalyRecords);
+
+    // Invalid commands.
+    TStrVec invalidCommands{
+        "not json",
+        "[\"config.json\"]",
+        "{\"input\":\"in\",\"output\":\"out\"}",
+        "{\"config\":\"config.json\",\"output\":\"out\"}",
+        "{\"config\":\"config.json\",\"input\":\"in\"}",
+        "{\"config\":\"config.json\",\"input\":\"in\",\"output\":\"out\",\"inputIsPipe\":\"yes\"}",
+        "{\"config\":\"config.json\",\"input\":\"in\",\"output\":\"out\",\"delimiter\":\",,\"}"};
+    for (const auto& command : invalidCommands) {
+        LOG_DEBUG(<< "Testing " << command);
+        BOOST_REQUIRE_EQUAL(false, ml::api::CAnomalyJobHost::parseJobOptions(command, options));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testProcessCommands) {
+    // Check that all the jobs run and each writes its own results.
+
+    TStrVec jobIds{"host_job_1", "host_job_2", "host_job_3"};
+
+    std::string commands;
+    for (const auto& jobId : jobIds) {
+        commands += makeJobCommand(jobId) + "\n";
+    }
+    std::istringstream commandStream{commands};
+
+    ml::api::CAnomalyJobHost host;
+    BOOST_TEST_REQUIRE(host.processCommands(commandStream));
+    BOOST_REQUIRE_EQUAL(0, host.numberJobs());
+
+    for (const auto& jobId : jobIds) {
+        std::string output{readFile(makeFileName(jobId + "_output.json"))};
+        BOOST_TEST_REQUIRE(output.find("\"bucket\"") != std::string::npos);
+        BOOST_TEST_REQUIRE(output.find("\"job_id\":\"" + jobId + "\"") != std::string::npos);
+        for (const auto& otherJobId : jobIds) {
+            if (otherJobId != jobId) {
+                BOOST_TEST_REQUIRE(output.find(otherJobId) == std::string::npos);
+            }
+        }
+        removeJobFiles(jobId);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testFailedJob) {
+    // A job which fails shouldn't affect the others, but should be reported.
+
+    std::string commands{makeJobCommand("host_job_good") + "\n" +
+                         "{\"config\":\"" + makeFileName("missing_config.json") +
+                         "\",\"input\":\"" + makeFileName("missing_input.csv") +
+                         "\",\"output\":\"" + makeFileName("missing_output.json") +
+                         "\"}\n"};
+    std::istringstream commandStream{commands};
+
+    ml::api::CAnomalyJobHost host;
+    BOOST_REQUIRE_EQUAL(false, host.processCommands(commandStream));
+
+    std::string output{readFile(makeFileName("host_job_good_output.json"))};
+    BOOST_TEST_REQUIRE(output.find("\"job_id\":\"host_job_good\"") != std::string::npos);
+
+    removeJobFiles("host_job_good");
+    std::remove(makeFileName("missing_output.json").c_str());
+}
+
+BOOST_AUTO_TEST_CASE(testRestoreWhileAnotherJobRuns) {
+    // Check that restoring a hosted job doesn't overwrite the process wide
+    // statics another hosted job is using.
+
+    // Persist the state of a job run on its own, which includes the statics.
+
+    std::string persistedFile{makeFileName("host_job_persisted_state.json")};
+    auto& counter = ml::core::CProgramCounters::counter(ml::counter_t::E_DFOTimeToComputeScores);
+    counter = 1000;
+    {
+        ml::api::CAnomalyJobHost::SJobOptions options;
+        BOOST_TEST_REQUIRE(ml::api::CAnomalyJobHost::parseJobOptions(
+            makeJobCommand("host_job_persisted"), options));
+        ml::core::CBlockingCallCancellingTimer cancellerThread{
+            ml::core::CThread::currentThreadId(), std::chrono::seconds{10}};
+        ml::api::CIoManager ioMgr{cancellerThread,
+                                  options.s_InputFileName,
+                                  false,
+                                  options.s_OutputFileName,
+                                  false,
+                                  "",
+                                  false,
+                                  persistedFile,
+                                  false};
+        BOOST_TEST_REQUIRE(ioMgr.initIo());
+        BOOST_TEST_REQUIRE(ml::api::CAnomalyJobHost::runJob(options, ioMgr));
+    }
+    BOOST_TEST_REQUIRE(readFile(persistedFile).empty() == false);
+
+    // Host a job which is running while a second job restores the state.
+
+    counter = 1;
+    std::string commands{
+        makeJobCommand("host_job_running", 1359331200, 20 * 86400) + "\n" +
+        makeJobCommand("host_job_restored", 1359331200 + 2 * 86400, 2 * 86400,
+                       ",\"restore\":\"" + persistedFile + "\"") +
+        "\n"};
+    std::istringstream commandStream{commands};
+
+    {
+        ml::api::CAnomalyJobHost host;
+        BOOST_TEST_REQUIRE(host.processCommands(commandStream));
+    }
+    BOOST_REQUIRE_EQUAL(1, static_cast<std::uint64_t>(counter));
+
+    for (const auto& jobId : {"host_job_running", "host_job_restored"}) {
+        std::string output{readFile(makeFileName(std::string{jobId} + "_output.json"))};
+        BOOST_TEST_REQUIRE(output.find("\"bucket\"") != std::string::npos);
+    }
+
+    counter = 0;
+    for (const auto& jobId : {"host_job_persisted", "host_job_running", "host_job_restored"}) {
+        removeJobFiles(jobId);
+    }
+    std::remove(persistedFile.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
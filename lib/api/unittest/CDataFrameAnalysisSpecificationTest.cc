@@ -12,6 +12,7 @@
 #include <core/CContainerPrinter.h>
 #include <core/CDataFrame.h>
 #include <core/CLogger.h>
+#include <core/Concurrency.h>
 
 #include <api/CDataFrameAnalysisRunner.h>
 #include <api/CDataFrameAnalysisSpecification.h>
@@ -48,6 +49,13 @@ std::string createSpecJsonForTempDirDiskUsageTest(bool tempDirPathSet, bool disk
         "testJob", 100, 3, 500000, 1, "", {}, diskUsageAllowed, tempDir, "",
         "outlier_detection", "");
 }
+
+std::string createSpecJsonForParallelLoopStatsTest(bool recordStats) {
+    std::string spec{api::CDataFrameAnalysisSpecificationJsonWriter::jsonString(
+        "testJob", 100, 3, 500000, 2, "", {}, false, "", "", "outlier_detection", "")};
+    return "{\"" + api::CDataFrameAnalysisSpecification::RECORD_PARALLEL_LOOP_STATS +
+           "\":" + (recordStats ? "true" : "false") + "," + spec.substr(1);
+}
 }
 
 BOOST_AUTO_TEST_CASE(testCreate) {
@@ -459,4 +467,46 @@ BOOST_AUTO_TEST_CASE(testTempDirDiskUsage) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testRecordParallelLoopStats) {
+
+    // Check the option turns recording parallel loop statistics on and off.
+
+    core::startDefaultAsyncExecutor(2);
+
+    auto runLoop = []() {
+        core::CScopedParallelForEachCallSite callSite{"test"};
+        core::parallel_for_each_adaptively(std::size_t{0}, std::size_t{100},
+                                           [](std::size_t) {});
+    };
+
+    {
+        api::CDataFrameAnalysisSpecification spec{
+            api::CDataFrameAnalysisSpecificationJsonWriter::jsonString(
+                "testJob", 100, 3, 500000, 2, "", {}, false, "", "",
+                "outlier_detection", "")};
+        BOOST_REQUIRE_EQUAL(false, spec.recordParallelLoopStats());
+        runLoop();
+        BOOST_TEST_REQUIRE(core::parallelForEachStats().empty());
+    }
+    {
+        api::CDataFrameAnalysisSpecification spec{createSpecJsonForParallelLoopStatsTest(true)};
+        BOOST_REQUIRE_EQUAL(true, spec.recordParallelLoopStats());
+        runLoop();
+        auto stats = core::parallelForEachStats();
+        BOOST_REQUIRE_EQUAL(1, stats.size());
+        BOOST_REQUIRE_EQUAL(1, stats.count("test"));
+        BOOST_REQUIRE_EQUAL(1, stats["test"].s_Calls);
+    }
+    {
+        // Each analysis starts with no statistics.
+        api::CDataFrameAnalysisSpecification spec{createSpecJsonForParallelLoopStatsTest(false)};
+        BOOST_REQUIRE_EQUAL(false, spec.recordParallelLoopStats());
+        BOOST_TEST_REQUIRE(core::parallelForEachStats().empty());
+        runLoop();
+        BOOST_TEST_REQUIRE(core::parallelForEachStats().empty());
+    }
+
+    core::stopDefaultAsyncExecutor();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -14,6 +14,7 @@
 #include <core/CDataSearcher.h>
 #include <core/CJsonOutputStreamWrapper.h>
 #include <core/CStringUtils.h>
+#include <core/Concurrency.h>
 
 #include <model/CLimits.h>
 
@@ -28,6 +29,7 @@
 #include <set>
 #include <sstream>
 #include <tuple>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE(CFieldDataCategorizerTest)
 
@@ -53,10 +55,14 @@ public:
 class CTestChainedProcessor : public CDataProcessor {
 public:
     using TIntSet = std::set<int>;
+    using TIntVec = std::vector<int>;
 
 public:
     void finalise() override { m_Finalised = true; }
 
+    //! Fail to handle the \p record'th record, counting from one.
+    void failRecord(std::uint64_t record) { m_FailRecord = record; }
+
     bool hasFinalised() const { return m_Finalised; }
 
     bool handleRecord(const TStrStrUMap& dataRowFields, TOptionalTime /*time*/) override {
@@ -76,6 +82,10 @@ public:
             categoryId > 0) {
             m_CategoryIdsHandled.insert(categoryId);
         }
+        if (++m_NumRecordsSeen == m_FailRecord) {
+            return false;
+        }
+        m_CategoryIdSequence.push_back(categoryId);
         ++m_NumRecordsHandled;
         return true;
     }
@@ -104,13 +114,18 @@ public:
 
     const TIntSet& categoryIdsHandled() const { return m_CategoryIdsHandled; }
 
+    const TIntVec& categoryIdSequence() const { return m_CategoryIdSequence; }
+
 private:
     bool m_Finalised = false;
 
     std::uint64_t m_NumRecordsHandled = 0;
+    std::uint64_t m_NumRecordsSeen = 0;
+    std::uint64_t m_FailRecord = 0;
     std::uint64_t m_NumControlMessages = 0;
 
     TIntSet m_CategoryIdsHandled;
+    TIntVec m_CategoryIdSequence;
 };
 
 class CTestDataSearcher : public core::CDataSearcher {
@@ -208,6 +223,64 @@ std::string setupPerPartitionStopOnWarnTest(bool stopOnWarnAtInit,
     }
     return outputStrm.str();
 }
+
+//! Categorize messages from many partitions and get the category of each
+//! record, the output and the final state.
+std::tuple<CTestChainedProcessor::TIntVec, std::string, std::string>
+categorizeManyPartitions() {
+    model::CLimits limits;
+    CAnomalyJobConfig config;
+    BOOST_TEST_REQUIRE(config.initFromFile("testfiles/new_persist_per_partition_categorization.json"));
+    CTestChainedProcessor testChainedProcessor;
+
+    std::ostringstream outputStrm;
+    std::string state;
+    {
+        core::CJsonOutputStreamWrapper wrappedOutputStream{outputStrm};
+
+        CTestFieldDataCategorizer categorizer{"job", config.analysisConfig(), limits,
+                                              &testChainedProcessor, wrappedOutputStream};
+
+        CFieldDataCategorizer::TStrStrUMap dataRowFields;
+        categorizer.registerMutableField(CFieldDataCategorizer::MLCATEGORY_NAME,
+                                         dataRowFields[CFieldDataCategorizer::MLCATEGORY_NAME]);
+        CFieldDataCategorizer::TStrStrUMap flush;
+
+        std::vector<std::string> templates{
+            "Node %1 started on host %2",
+            "Connection from %2 closed after %1 ms",
+            "User %1 logged in from %2",
+            "Failed to read block %1 of file %2 retrying",
+            "Shard %1 relocated to node %2"};
+
+        // The sizes of the batches shouldn't matter, so include flushes part
+        // way through a batch.
+        for (std::size_t i = 0; i < 5000; ++i) {
+            const std::string& format{templates[(i * 7) % templates.size()]};
+            std::string message{format};
+            message.replace(message.find("%1"), 2, std::to_string(i % 97));
+            message.replace(message.find("%2"), 2, "host" + std::to_string(i % 13));
+            dataRowFields["event.dataset"] = "partition" + std::to_string(i % 11);
+            dataRowFields["message"] = message;
+            BOOST_TEST_REQUIRE(categorizer.handleRecord(dataRowFields));
+            if (i % 1777 == 0) {
+                flush["."] = "f" + std::to_string(i);
+                BOOST_TEST_REQUIRE(categorizer.handleRecord(flush));
+            }
+        }
+        categorizer.finalise();
+
+        BOOST_REQUIRE_EQUAL(5000, categorizer.numRecordsHandled());
+        BOOST_REQUIRE_EQUAL(categorizer.numRecordsHandled(),
+                            testChainedProcessor.numRecordsHandled());
+
+        CTestDataAdder adder;
+        BOOST_TEST_REQUIRE(categorizer.persistStateInForeground(adder, ""));
+        state = dynamic_cast<std::ostringstream&>(*adder.getStream()).str();
+    }
+
+    return {testChainedProcessor.categoryIdSequence(), outputStrm.str(), state};
+}
 }
 
 BOOST_AUTO_TEST_CASE(testWithoutPerPartitionCategorization) {
@@ -427,6 +500,81 @@ BOOST_AUTO_TEST_CASE(testWithPerPartitionCategorization) {
     BOOST_REQUIRE_EQUAL(origJson, newJson);
 }
 
+BOOST_AUTO_TEST_CASE(testWithPerPartitionCategorizationConcurrently) {
+    // Categorizing the partitions concurrently should give the same category
+    // for every record, write definitions for the same categories the same
+    // number of times and give the same state as categorizing them one at a
+    // time.  The contents of definitions written part way through a batch
+    // can differ, because the categorizer has already seen the rest of the
+    // batch.
+
+    CTestChainedProcessor::TIntVec expectedCategoryIds;
+    std::string expectedOutput;
+    std::string expectedState;
+    std::tie(expectedCategoryIds, expectedOutput, expectedState) = categorizeManyPartitions();
+
+    core::startDefaultAsyncExecutor(4);
+    CTestChainedProcessor::TIntVec categoryIds;
+    std::string output;
+    std::string state;
+    std::tie(categoryIds, output, state) = categorizeManyPartitions();
+    core::stopDefaultAsyncExecutor();
+
+    BOOST_REQUIRE_EQUAL(core::CContainerPrinter::print(expectedCategoryIds),
+                        core::CContainerPrinter::print(categoryIds));
+    BOOST_TEST_REQUIRE(countOccurrences(expectedOutput, "\"category_definition\"") > 11);
+    for (const auto& categoryId : std::set<int>(categoryIds.begin(), categoryIds.end())) {
+        std::string definition{"\"category_id\":" + std::to_string(categoryId) + ','};
+        BOOST_REQUIRE_EQUAL(countOccurrences(expectedOutput, definition),
+                            countOccurrences(output, definition));
+    }
+    BOOST_REQUIRE_EQUAL(expectedState, state);
+}
+
+BOOST_AUTO_TEST_CASE(testPassOnBufferedRecordFails) {
+    // If passing on a buffered record fails the later records in the batch
+    // aren't passed on, but they still get global category IDs.
+
+    core::startDefaultAsyncExecutor(4);
+
+    model::CLimits limits;
+    CAnomalyJobConfig config;
+    BOOST_TEST_REQUIRE(config.initFromFile("testfiles/new_persist_per_partition_categorization.json"));
+    CTestChainedProcessor testChainedProcessor;
+    testChainedProcessor.failRecord(3);
+
+    std::ostringstream outputStrm;
+    {
+        core::CJsonOutputStreamWrapper wrappedOutputStream{outputStrm};
+
+        CTestFieldDataCategorizer categorizer{"job", config.analysisConfig(), limits,
+                                              &testChainedProcessor, wrappedOutputStream};
+
+        CFieldDataCategorizer::TStrStrUMap dataRowFields;
+        categorizer.registerMutableField(CFieldDataCategorizer::MLCATEGORY_NAME,
+                                         dataRowFields[CFieldDataCategorizer::MLCATEGORY_NAME]);
+        for (std::size_t i = 0; i < 5; ++i) {
+            dataRowFields["event.dataset"] = "partition" + std::to_string(i);
+            dataRowFields["message"] = "message " + std::to_string(i);
+            BOOST_TEST_REQUIRE(categorizer.handleRecord(dataRowFields));
+        }
+        BOOST_REQUIRE_EQUAL(0, testChainedProcessor.numRecordsHandled());
+
+        CFieldDataCategorizer::TStrStrUMap flush;
+        flush["."] = "f1";
+        BOOST_REQUIRE_EQUAL(false, categorizer.handleRecord(flush));
+        BOOST_REQUIRE_EQUAL(2, categorizer.numRecordsHandled());
+        BOOST_REQUIRE_EQUAL(2, testChainedProcessor.numRecordsHandled());
+
+        categorizer.finalise();
+    }
+
+    core::stopDefaultAsyncExecutor();
+
+    LOG_DEBUG(<< "output = " << outputStrm.str());
+    BOOST_REQUIRE_EQUAL(5, countOccurrences(outputStrm.str(), "\"category_definition\""));
+}
+
 BOOST_AUTO_TEST_CASE(testNodeReverseSearch) {
     model::CLimits limits;
     CAnomalyJobConfig config;
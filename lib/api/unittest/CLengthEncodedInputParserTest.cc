@@ -10,6 +10,7 @@
  */
 
 #include <core/CLogger.h>
+#include <core/CPipeReadBuffer.h>
 #include <core/CStringUtils.h>
 #include <core/CTimeUtils.h>
 
@@ -18,16 +19,20 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <functional>
 #include <ios>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 // For htonl
 #ifdef Windows
 #include <WinSock2.h>
 #else
 #include <netinet/in.h>
+#include <unistd.h>
 #endif
 
 BOOST_TEST_DONT_PRINT_LOG_VALUE(ml::api::CCsvInputParser::TStrVec::iterator)
@@ -281,6 +286,61 @@ BOOST_AUTO_TEST_CASE(testThroughput) {
              << (end - start) << " seconds");
 }
 
+#ifndef Windows
+BOOST_AUTO_TEST_CASE(testPipeInput) {
+    // Check records are parsed correctly in place from a pipe buffer when
+    // they arrive in pieces and are larger than its initial capacity.
+
+    std::ifstream ifs("testfiles/simple.txt");
+    BOOST_TEST_REQUIRE(ifs.is_open());
+
+    CSetupVisitor setupVisitor;
+
+    ml::api::CCsvInputParser setupParser(ifs);
+
+    BOOST_TEST_REQUIRE(setupParser.readStreamIntoVecs(std::ref(setupVisitor)));
+
+    static const size_t TEST_SIZE(20);
+    std::string data{setupVisitor.input(TEST_SIZE)};
+
+    int handles[2];
+    BOOST_TEST_REQUIRE(::pipe(handles) == 0);
+    std::thread writer{[&data, &handles] {
+        for (std::size_t i = 0; i < data.size(); i += 1000) {
+            std::size_t size{std::min(std::size_t{1000}, data.size() - i)};
+            if (::write(handles[1], data.data() + i, size) != static_cast<ssize_t>(size)) {
+                break;
+            }
+        }
+        ::close(handles[1]);
+    }};
+
+    using TStrVecVec = std::vector<ml::api::CLengthEncodedInputParser::TStrVec>;
+    auto readRecords = [](std::istream& input, TStrVecVec& records) {
+        ml::api::CLengthEncodedInputParser parser(input);
+        return parser.readStreamIntoVecs(
+            [&records](const ml::api::CLengthEncodedInputParser::TStrVec&,
+                       const ml::api::CLengthEncodedInputParser::TStrVec& fieldValues) {
+                records.push_back(fieldValues);
+                return true;
+            });
+    };
+
+    ml::core::CPipeReadStream pipeInput(handles[0], 64);
+    TStrVecVec pipeRecords;
+    BOOST_TEST_REQUIRE(readRecords(pipeInput, pipeRecords));
+    writer.join();
+
+    // Input must be binary otherwise Windows will stop at CTRL+Z
+    std::istringstream stringInput(data, std::ios::in | std::ios::binary);
+    TStrVecVec expectedRecords;
+    BOOST_TEST_REQUIRE(readRecords(stringInput, expectedRecords));
+
+    BOOST_REQUIRE_EQUAL(setupVisitor.recordsPerBlock() * TEST_SIZE, pipeRecords.size());
+    BOOST_TEST_REQUIRE(expectedRecords == pipeRecords);
+}
+#endif
+
 BOOST_AUTO_TEST_CASE(testCorruptStreamDetection) {
     std::uint32_t numFields(1);
     std::uint32_t numFieldsNet(htonl(numFields));
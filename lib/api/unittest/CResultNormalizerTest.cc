@@ -549,4 +549,31 @@ BOOST_AUTO_TEST_CASE(testInitNormalizer) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testBatchedNormalization) {
+    ml::model::CAnomalyDetectorModelConfig modelConfig =
+        ml::model::CAnomalyDetectorModelConfig::defaultConfig(900);
+
+    auto normalize = [&](std::size_t batchSize) {
+        ml::api::CNdJsonOutputWriter outputWriter;
+        ml::api::CResultNormalizer normalizer(modelConfig, outputWriter, batchSize);
+        BOOST_TEST_REQUIRE(normalizer.initNormalizer("testfiles/new_quantilesState.json"));
+
+        std::ifstream inputStrm("testfiles/new_normalizerInput.csv");
+        ml::api::CCsvInputParser inputParser(inputStrm);
+        BOOST_TEST_REQUIRE(inputParser.readStreamIntoMaps(std::bind(
+            &ml::api::CResultNormalizer::handleRecord, &normalizer, std::placeholders::_1)));
+        BOOST_TEST_REQUIRE(normalizer.finalise());
+        return outputWriter.internalString();
+    };
+
+    // Batches should give identical results in the same order whether or not
+    // the number of records is a multiple of the batch size.
+    std::string expected{normalize(1)};
+    BOOST_TEST_REQUIRE(expected.empty() == false);
+    for (std::size_t batchSize : {2, 16, 327, 1024}) {
+        LOG_DEBUG(<< "batch size = " << batchSize);
+        BOOST_REQUIRE_EQUAL(expected, normalize(batchSize));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
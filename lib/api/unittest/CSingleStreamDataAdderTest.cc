@@ -12,6 +12,7 @@
 #include <core/CJsonOutputStreamWrapper.h>
 #include <core/COsFileFuncs.h>
 #include <core/CStringUtils.h>
+#include <core/Concurrency.h>
 #include <core/CoreTypes.h>
 
 #include <maths/common/CModelWeight.h>
@@ -52,7 +53,8 @@ void reportPersistComplete(ml::api::CModelSnapshotJsonWriter::SModelSnapshotRepo
 void detectorPersistHelper(const std::string& configFileName,
                            const std::string& inputFilename,
                            int latencyBuckets,
-                           const std::string& timeFormat = std::string()) {
+                           const std::string& timeFormat = std::string(),
+                           bool multivariateByFields = false) {
     // Start by creating a detector with non-trivial state
     static const ml::core_t::TTime BUCKET_SIZE(3600);
     static const std::string JOB_ID("job");
@@ -70,7 +72,8 @@ void detectorPersistHelper(const std::string& configFileName,
 
     ml::model::CAnomalyDetectorModelConfig modelConfig =
         ml::model::CAnomalyDetectorModelConfig::defaultConfig(
-            BUCKET_SIZE, ml::model_t::E_None, "", BUCKET_SIZE * latencyBuckets, false);
+            BUCKET_SIZE, ml::model_t::E_None, "", BUCKET_SIZE * latencyBuckets,
+            multivariateByFields);
 
     ml::core::CJsonOutputStreamWrapper wrappedOutputStream(outputStrm);
 
@@ -207,6 +210,23 @@ BOOST_AUTO_TEST_CASE(testDetectorPersistPartition) {
                           "testfiles/big_ascending.txt", 0, "%d/%b/%Y:%T %z");
 }
 
+BOOST_AUTO_TEST_CASE(testDetectorPersistPartitionRestoreInParallel) {
+    // Restoring the detectors in parallel should give identical state.
+    ml::core::startDefaultAsyncExecutor(4);
+    detectorPersistHelper("testfiles/new_mlfields_partition.json",
+                          "testfiles/big_ascending.txt", 0, "%d/%b/%Y:%T %z");
+    ml::core::stopDefaultAsyncExecutor();
+}
+
+BOOST_AUTO_TEST_CASE(testDetectorPersistPartitionCorrelatesRestoreInParallel) {
+    // Detectors for different partitions share their factory's cache of
+    // correlate priors, which is filled when they're restored in parallel.
+    ml::core::startDefaultAsyncExecutor(4);
+    detectorPersistHelper("testfiles/new_mlfields_partition_by.json",
+                          "testfiles/big_ascending.txt", 0, "%d/%b/%Y:%T %z", true);
+    ml::core::stopDefaultAsyncExecutor();
+}
+
 BOOST_AUTO_TEST_CASE(testDetectorPersistDc) {
     detectorPersistHelper("testfiles/new_persist_dc.json",
                           "testfiles/files_users_programs.csv", 5);
@@ -23,6 +23,7 @@
 #include <core/Constants.h>
 
 #include <algorithm>
+#include <array>
 #include <future>
 #include <limits>
 #include <memory>
@@ -38,6 +39,42 @@ core::CFloatStorage truncateToFloatRange(double value) {
 
 namespace data_frame_detail {
 
+void CMaskedRowIterator::advanceTo(std::size_t index, const CMaskedRowIterator& end) {
+    if (m_Indexed) {
+        m_Index = std::lower_bound(m_Index, end.m_Index, index);
+    } else {
+        m_OneBit.advanceTo(index);
+    }
+}
+
+const double CMaskedRows::MAXIMUM_FRACTION_TO_INDEX{0.1};
+
+CMaskedRows::CMaskedRows(const CPackedBitVector& rowMask) : m_RowMask{&rowMask} {
+    // The indices are stored as 32 bit integers to reduce memory and bandwidth
+    // so we can only use them if every row index fits.
+    if (rowMask.size() > static_cast<std::size_t>(std::numeric_limits<std::uint32_t>::max()) + 1) {
+        return;
+    }
+    double numberMaskedRows{rowMask.manhattan()};
+    if (numberMaskedRows <= MAXIMUM_FRACTION_TO_INDEX * static_cast<double>(rowMask.size())) {
+        m_Index.reserve(static_cast<std::size_t>(numberMaskedRows));
+        for (auto i = rowMask.beginOneBits(); i != rowMask.endOneBits(); ++i) {
+            m_Index.push_back(static_cast<std::uint32_t>(*i));
+        }
+        m_Indexed = true;
+    }
+}
+
+CMaskedRowIterator CMaskedRows::begin() const {
+    return m_Indexed ? CMaskedRowIterator{m_Index.cbegin()}
+                     : CMaskedRowIterator{m_RowMask->beginOneBits()};
+}
+
+CMaskedRowIterator CMaskedRows::end() const {
+    return m_Indexed ? CMaskedRowIterator{m_Index.cend()}
+                     : CMaskedRowIterator{m_RowMask->endOneBits()};
+}
+
 CRowRef::CRowRef(std::size_t index, TFloatVecItr beginColumns, TFloatVecItr endColumns, std::int32_t docHash)
     : m_Index{index}, m_BeginColumns{beginColumns}, m_EndColumns{endColumns}, m_DocHash{docHash} {
 }
@@ -287,51 +324,10 @@ void CDataFrame::parseAndWriteRow(const TStrCRng& columnValues,
                                   const TPtrdiffVec* columnMap,
                                   const std::string* hash) {
 
-    auto stringToValue = [this](bool isCategorical, TStrSizeUMap& categoryLookup,
-                                TStrVec& categories, const std::string& columnValue) {
-        if (columnValue == m_MissingString) {
-            ++m_MissingValueCount;
-            return core::CFloatStorage{valueOfMissing()};
-        }
-
-        if (isCategorical) {
-            // This encodes in a format suitable for efficient storage. The
-            // actual encoding approach is chosen when the analysis runs.
-            std::size_t id;
-            if (categories.size() == MAX_CATEGORICAL_CARDINALITY) {
-                auto itr = categoryLookup.find(columnValue);
-                id = itr != categoryLookup.end()
-                         ? itr->second
-                         : static_cast<std::int64_t>(MAX_CATEGORICAL_CARDINALITY);
-            } else {
-                // We can represent up to float mantissa bits - 1 distinct
-                // categories so can faithfully store categorical fields with
-                // up to around 17M distinct values. For higher cardinalities
-                // one would need to use some form of dimension reduction such
-                // as hashing anyway.
-                std::size_t newId{categories.size()};
-                id = categoryLookup.emplace(columnValue, newId).first->second;
-                if (id == newId) {
-                    categories.push_back(columnValue);
-                }
-            }
-            return core::CFloatStorage{static_cast<double>(id)};
-        }
-
-        // Use NaN to indicate missing or bad values in the data frame. This
-        // needs handling with care from an analysis perspective. If analyses
-        // can deal with missing values they need to treat NaNs as missing
-        // otherwise we must impute or exit with failure.
-
-        double value;
-        if (core::CStringUtils::stringToTypeSilent(columnValue, value) == false) {
-            ++m_BadValueCount;
-            return core::CFloatStorage{valueOfMissing()};
-        }
-
-        // Tuncation is very unlikely since the values will typically be
-        // standardised.
-        return truncateToFloatRange(value);
+    auto stringToValue = [this](std::size_t i, const std::string& columnValue) {
+        return m_ColumnIsCategorical[i]
+                   ? this->parseCategoricalValue(i, columnValue)
+                   : this->parseNumericValue(columnValue, m_MissingValueCount, m_BadValueCount);
     };
 
     // This is only used when writing rows so is resized lazily.
@@ -343,16 +339,11 @@ void CDataFrame::parseAndWriteRow(const TStrCRng& columnValues,
         if (columnMap != nullptr) {
             for (std::size_t i = 0; i < columnMap->size(); ++i, ++columns) {
                 std::ptrdiff_t j{(*columnMap)[i]};
-                *columns = stringToValue(m_ColumnIsCategorical[i],
-                                         m_CategoricalColumnValueLookup[i],
-                                         m_CategoricalColumnValues[i],
-                                         j >= 0 ? columnValues[j] : m_MissingString);
+                *columns = stringToValue(i, j >= 0 ? columnValues[j] : m_MissingString);
             }
         } else {
             for (std::size_t i = 0; i < columnValues.size(); ++i, ++columns) {
-                *columns = stringToValue(
-                    m_ColumnIsCategorical[i], m_CategoricalColumnValueLookup[i],
-                    m_CategoricalColumnValues[i], columnValues[i]);
+                *columns = stringToValue(i, columnValues[i]);
             }
         }
         docHash = 0;
@@ -363,6 +354,95 @@ void CDataFrame::parseAndWriteRow(const TStrCRng& columnValues,
     });
 }
 
+std::size_t CDataFrame::SRowFieldLayout::numberColumns() const {
+    return s_ColumnMap != nullptr ? s_ColumnMap->size()
+                                  : s_EndColumnValues - s_BeginColumnValues;
+}
+
+const std::string&
+CDataFrame::SRowFieldLayout::columnValue(const TStrVec& fieldValues,
+                                         std::size_t column,
+                                         const std::string& missing) const {
+    if (s_ColumnMap != nullptr) {
+        std::ptrdiff_t j{(*s_ColumnMap)[column]};
+        return j >= 0 ? fieldValues[s_BeginColumnValues + j] : missing;
+    }
+    return fieldValues[s_BeginColumnValues + column];
+}
+
+void CDataFrame::parseRows(std::size_t numberThreads,
+                           const TStrVecVec& rows,
+                           std::size_t numberRows,
+                           const SRowFieldLayout& layout,
+                           SParsedRows& parsed) const {
+
+    using TUInt64Ary = std::array<std::uint64_t, 3>;
+
+    std::size_t numberColumns{layout.numberColumns()};
+    parsed.s_NumberRows = numberRows;
+    parsed.s_Values.resize(numberRows * numberColumns);
+    parsed.s_DocHashes.resize(numberRows);
+
+    auto results = parallel_for_each(
+        numberThreads, 0, numberRows,
+        bindRetrievableState(
+            [&](TUInt64Ary& counts, std::size_t row) {
+                const auto& fieldValues = rows[row];
+                auto values = parsed.s_Values.begin() + row * numberColumns;
+                for (std::size_t i = 0; i < numberColumns; ++i) {
+                    if (m_ColumnIsCategorical[i] == false) {
+                        values[i] = this->parseNumericValue(
+                            layout.columnValue(fieldValues, i, m_MissingString),
+                            counts[0], counts[1]);
+                    }
+                }
+                std::int32_t& docHash{parsed.s_DocHashes[row]};
+                docHash = 0;
+                if (layout.s_DocHashField >= 0 &&
+                    core::CStringUtils::stringToTypeSilent(
+                        fieldValues[layout.s_DocHashField], docHash) == false) {
+                    ++counts[2];
+                }
+            },
+            TUInt64Ary{}));
+
+    parsed.s_MissingValueCount = 0;
+    parsed.s_BadValueCount = 0;
+    parsed.s_BadDocHashCount = 0;
+    for (const auto& result : results) {
+        parsed.s_MissingValueCount += result.s_FunctionState[0];
+        parsed.s_BadValueCount += result.s_FunctionState[1];
+        parsed.s_BadDocHashCount += result.s_FunctionState[2];
+    }
+}
+
+void CDataFrame::writeParsedRows(const TStrVecVec& rows,
+                                 const SRowFieldLayout& layout,
+                                 const SParsedRows& parsed) {
+
+    if (m_CategoricalColumnValueLookup.size() != m_NumberColumns) {
+        this->fillCategoricalColumnValueLookup();
+    }
+
+    m_MissingValueCount += parsed.s_MissingValueCount;
+    m_BadValueCount += parsed.s_BadValueCount;
+    m_BadDocHashCount += parsed.s_BadDocHashCount;
+
+    std::size_t numberColumns{layout.numberColumns()};
+    for (std::size_t row = 0; row < parsed.s_NumberRows; ++row) {
+        this->writeRow([&](TFloatVecItr columns, std::int32_t& docHash) {
+            auto values = parsed.s_Values.begin() + row * numberColumns;
+            for (std::size_t i = 0; i < numberColumns; ++i, ++columns) {
+                *columns = m_ColumnIsCategorical[i]
+                               ? this->parseCategoricalValue(
+                                     i, layout.columnValue(rows[row], i, m_MissingString))
+                               : values[i];
+            }
+            docHash = parsed.s_DocHashes[row];
+        });
+    }
+}
+
 void CDataFrame::writeRow(const TWriteFunc& writeRow) {
     if (m_Writer == nullptr) {
         m_Writer = std::make_unique<CDataFrameRowSliceWriter>(
@@ -524,6 +604,63 @@ void CDataFrame::fillCategoricalColumnValueLookup() {
     }
 }
 
+CFloatStorage CDataFrame::parseNumericValue(const std::string& columnValue,
+                                            std::uint64_t& missingValueCount,
+                                            std::uint64_t& badValueCount) const {
+    if (columnValue == m_MissingString) {
+        ++missingValueCount;
+        return CFloatStorage{valueOfMissing()};
+    }
+
+    // Use NaN to indicate missing or bad values in the data frame. This
+    // needs handling with care from an analysis perspective. If analyses
+    // can deal with missing values they need to treat NaNs as missing
+    // otherwise we must impute or exit with failure.
+
+    double value;
+    if (core::CStringUtils::stringToTypeSilent(columnValue, value) == false) {
+        ++badValueCount;
+        return CFloatStorage{valueOfMissing()};
+    }
+
+    // Tuncation is very unlikely since the values will typically be
+    // standardised.
+    return truncateToFloatRange(value);
+}
+
+CFloatStorage CDataFrame::parseCategoricalValue(std::size_t column,
+                                                const std::string& columnValue) {
+    if (columnValue == m_MissingString) {
+        ++m_MissingValueCount;
+        return CFloatStorage{valueOfMissing()};
+    }
+
+    auto& categoryLookup = m_CategoricalColumnValueLookup[column];
+    auto& categories = m_CategoricalColumnValues[column];
+
+    // This encodes in a format suitable for efficient storage. The
+    // actual encoding approach is chosen when the analysis runs.
+    std::size_t id;
+    if (categories.size() == MAX_CATEGORICAL_CARDINALITY) {
+        auto itr = categoryLookup.find(columnValue);
+        id = itr != categoryLookup.end()
+                 ? itr->second
+                 : static_cast<std::int64_t>(MAX_CATEGORICAL_CARDINALITY);
+    } else {
+        // We can represent up to float mantissa bits - 1 distinct
+        // categories so can faithfully store categorical fields with
+        // up to around 17M distinct values. For higher cardinalities
+        // one would need to use some form of dimension reduction such
+        // as hashing anyway.
+        std::size_t newId{categories.size()};
+        id = categoryLookup.emplace(columnValue, newId).first->second;
+        if (id == newId) {
+            categories.push_back(columnValue);
+        }
+    }
+    return CFloatStorage{static_cast<double>(id)};
+}
+
 bool CDataFrame::parallelApplyToAllRows(std::size_t beginRows,
                                         std::size_t endRows,
                                         TRowFuncVec& funcs,
@@ -536,11 +673,13 @@ bool CDataFrame::parallelApplyToAllRows(std::size_t beginRows,
 
     using TSliceFuncVec = std::vector<std::function<void(const TRowSlicePtr&)>>;
 
-    CPackedBitVector::COneBitIndexConstIterator maskedRow;
-    CPackedBitVector::COneBitIndexConstIterator endMaskedRows;
+    std::optional<CMaskedRows> maskedRows;
+    TMaskedRowIterator maskedRow;
+    TMaskedRowIterator endMaskedRows;
     if (rowMask != nullptr) {
-        maskedRow = rowMask->beginOneBits();
-        endMaskedRows = rowMask->endOneBits();
+        maskedRows.emplace(*rowMask);
+        maskedRow = maskedRows->begin();
+        endMaskedRows = maskedRows->end();
     }
 
     std::atomic_bool successful{true};
@@ -596,11 +735,13 @@ bool CDataFrame::sequentialApplyToAllRows(std::size_t beginRows,
                                           const CPackedBitVector* rowMask,
                                           bool commitResult) const {
 
-    CPackedBitVector::COneBitIndexConstIterator maskedRow;
-    CPackedBitVector::COneBitIndexConstIterator endMaskedRows;
+    std::optional<CMaskedRows> maskedRows;
+    TMaskedRowIterator maskedRow;
+    TMaskedRowIterator endMaskedRows;
     if (rowMask != nullptr) {
-        maskedRow = rowMask->beginOneBits();
-        endMaskedRows = rowMask->endOneBits();
+        maskedRows.emplace(*rowMask);
+        maskedRow = maskedRows->begin();
+        endMaskedRows = maskedRows->end();
     }
 
     CDataFrameRowSliceHandle readSlice;
@@ -733,14 +874,11 @@ CDataFrame::TRowSlicePtrVecCItr CDataFrame::endSlices(std::size_t endRows) const
                             });
 }
 
-template<typename ITR>
-bool CDataFrame::maskedRowsInSlice(ITR& maskedRow,
-                                   ITR endMaskedRows,
+bool CDataFrame::maskedRowsInSlice(TMaskedRowIterator& maskedRow,
+                                   const TMaskedRowIterator& endMaskedRows,
                                    std::size_t beginSliceRows,
                                    std::size_t endSliceRows) const {
-    while (maskedRow != endMaskedRows && *maskedRow < beginSliceRows) {
-        ++maskedRow;
-    }
+    maskedRow.advanceTo(beginSliceRows, endMaskedRows);
     return maskedRow != endMaskedRows && *maskedRow < endSliceRows;
 }
 
@@ -14,7 +14,9 @@
 #include <core/CLogger.h>
 #include <core/CMutex.h>
 #include <core/CScopedLock.h>
+#include <core/CStringUtils.h>
 #include <core/CThread.h>
+#include <core/CZygote.h>
 
 #include <algorithm>
 #include <set>
@@ -26,7 +28,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/resource.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -38,11 +42,24 @@ namespace {
 //! Maximum number of newly opened files between calls to setupFileActions().
 const int MAX_NEW_OPEN_FILES{10};
 
-//! Attempt to close all file descriptors except the standard ones.  The
-//! standard file descriptors will be reopened on /dev/null in the spawned
-//! process.  Returns false and sets errno if the actions cannot be initialised
-//! at all, but other errors are ignored.
-bool setupFileActions(posix_spawn_file_actions_t* fileActions, int& maxFdHint) {
+//! Maximum time to wait for a zygote to accept a request or reply to it.
+//! Forking an initialised zygote takes milliseconds, so a zygote which takes
+//! longer than this is assumed to be broken.
+const time_t ZYGOTE_TIMEOUT_SECONDS{5};
+
+#ifdef SOCK_CLOEXEC
+//! Only the zygote should have the other end of its socket open.
+const int ZYGOTE_SOCKET_TYPE{SOCK_STREAM | SOCK_CLOEXEC};
+#else
+//! Zygotes aren't supported on platforms without SOCK_CLOEXEC.
+const int ZYGOTE_SOCKET_TYPE{SOCK_STREAM};
+#endif
+
+//! Attempt to close all file descriptors except the standard ones and
+//! \p keepFd.  The standard file descriptors will be reopened on /dev/null in
+//! the spawned process.  Returns false and sets errno if the actions cannot be
+//! initialised at all, but other errors are ignored.
+bool setupFileActions(posix_spawn_file_actions_t* fileActions, int& maxFdHint, int keepFd = -1) {
     if (::posix_spawn_file_actions_init(fileActions) != 0) {
         return false;
     }
@@ -65,6 +82,8 @@ bool setupFileActions(posix_spawn_file_actions_t* fileActions, int& maxFdHint) {
         } else if (fd == STDOUT_FILENO || fd == STDERR_FILENO) {
             ::posix_spawn_file_actions_addopen(fileActions, fd, "/dev/null", O_WRONLY, S_IWUSR);
             maxFdHint = fd;
+        } else if (fd == keepFd) {
+            maxFdHint = fd;
         } else {
             // Close other files that are open.  There is a race condition here,
             // in that files could be opened or closed between this code running
@@ -216,15 +235,43 @@ private:
 };
 }
 
-CDetachedProcessSpawner::CDetachedProcessSpawner(const TStrVec& permittedProcessPaths)
+CDetachedProcessSpawner::CDetachedProcessSpawner(const TStrVec& permittedProcessPaths,
+                                                 const TStrVec& zygoteProcessPaths)
     : m_PermittedProcessPaths(permittedProcessPaths),
       m_TrackerThread(std::make_shared<detail::CTrackerThread>()) {
     if (m_TrackerThread->start() == false) {
         LOG_ERROR(<< "Failed to start spawned process tracker thread");
     }
+
+    if (zygoteProcessPaths.empty()) {
+        return;
+    }
+    if (CZygote::isSupported() == false) {
+        LOG_WARN(<< "Zygotes are not supported on this platform - processes will be started from scratch");
+        return;
+    }
+    // Processes forked from the zygotes must be adopted by this process so
+    // they can be tracked and killed like any other
+    if (CZygote::becomeSubreaper() == false) {
+        return;
+    }
+    for (const auto& processPath : zygoteProcessPaths) {
+        if (std::find(m_PermittedProcessPaths.begin(), m_PermittedProcessPaths.end(),
+                      processPath) == m_PermittedProcessPaths.end()) {
+            LOG_ERROR(<< "Starting a zygote for '" << processPath << "' is not permitted");
+            continue;
+        }
+        this->startZygote(processPath);
+    }
 }
 
 CDetachedProcessSpawner::~CDetachedProcessSpawner() {
+    // The zygotes exit when their sockets are closed
+    for (const auto& zygote : m_ZygoteFds) {
+        if (zygote.second != -1) {
+            ::close(zygote.second);
+        }
+    }
     if (m_TrackerThread->stop() == false) {
         LOG_ERROR(<< "Failed to stop spawned process tracker thread");
     }
@@ -249,6 +296,18 @@ bool CDetachedProcessSpawner::spawn(const std::string& processPath,
         return false;
     }
 
+    if (m_ZygoteFds.count(processPath) > 0) {
+        switch (this->spawnFromZygote(processPath, args, childPid)) {
+        case CZygote::E_ChildStarted:
+            return true;
+        case CZygote::E_ChildNotStarted:
+            break;
+        case CZygote::E_NoReply:
+            // Starting the process from scratch risks running two copies.
+            return false;
+        }
+    }
+
     using TCharPVec = std::vector<char*>;
     // Size of argv is two bigger than the number of arguments because:
     // 1) We add the program name at the beginning
@@ -303,6 +362,120 @@ bool CDetachedProcessSpawner::spawn(const std::string& processPath,
     return true;
 }
 
+void CDetachedProcessSpawner::startZygote(const std::string& processPath) {
+    int& zygoteFd{m_ZygoteFds[processPath]};
+    zygoteFd = -1;
+
+    int fds[2];
+    if (::socketpair(AF_UNIX, ZYGOTE_SOCKET_TYPE, 0, fds) == -1) {
+        LOG_ERROR(<< "Failed to create socket for zygote of '" << processPath
+                  << "': " << ::strerror(errno));
+        return;
+    }
+    // Requests are made with the tracker thread mutex held, so they must not
+    // be able to block indefinitely if the zygote hangs
+    struct timeval timeout;
+    ::memset(&timeout, 0, sizeof(struct timeval));
+    timeout.tv_sec = ZYGOTE_TIMEOUT_SECONDS;
+    if (::setsockopt(fds[0], SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == -1 ||
+        ::setsockopt(fds[0], SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == -1) {
+        LOG_ERROR(<< "Failed to set timeouts on socket for zygote of '"
+                  << processPath << "': " << ::strerror(errno));
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return;
+    }
+
+    std::string zygoteArg{CZygote::ZYGOTE_ARG_PREFIX + CStringUtils::typeToString(fds[1])};
+    char* argv[]{const_cast<char*>(processPath.c_str()),
+                 const_cast<char*>(zygoteArg.c_str()), nullptr};
+
+    posix_spawn_file_actions_t fileActions;
+    if (setupFileActions(&fileActions, m_MaxObservedFd, fds[1]) == false) {
+        LOG_ERROR(<< "Failed to set up file actions prior to spawn of zygote for '"
+                  << processPath << "': " << ::strerror(errno));
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return;
+    }
+    posix_spawnattr_t spawnAttributes;
+    if (::posix_spawnattr_init(&spawnAttributes) != 0) {
+        LOG_ERROR(<< "Failed to set up spawn attributes prior to spawn of zygote for '"
+                  << processPath << "': " << ::strerror(errno));
+        ::posix_spawn_file_actions_destroy(&fileActions);
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return;
+    }
+    ::posix_spawnattr_setflags(&spawnAttributes, POSIX_SPAWN_SETPGROUP);
+
+    // The zygote isn't added to the tracker so it can't be killed on request
+    CProcess::TPid zygotePid{0};
+    int err(::posix_spawn(&zygotePid, processPath.c_str(), &fileActions,
+                          &spawnAttributes, argv, environ));
+
+    ::posix_spawn_file_actions_destroy(&fileActions);
+    ::posix_spawnattr_destroy(&spawnAttributes);
+    ::close(fds[1]);
+
+    if (err != 0) {
+        LOG_ERROR(<< "Failed to spawn zygote for '" << processPath << "': " << ::strerror(err));
+        ::close(fds[0]);
+        return;
+    }
+
+    zygoteFd = fds[0];
+    LOG_DEBUG(<< "Spawned zygote for '" << processPath << "' with PID " << zygotePid);
+}
+
+CZygote::ERequestResult
+CDetachedProcessSpawner::spawnFromZygote(const std::string& processPath,
+                                         const TStrVec& args,
+                                         CProcess::TPid& childPid) {
+    int& zygoteFd{m_ZygoteFds[processPath]};
+    if (zygoteFd == -1) {
+        // Restart a zygote which failed. This request will wait for it to
+        // initialise, but the next one won't.
+        this->startZygote(processPath);
+        if (zygoteFd == -1) {
+            return CZygote::E_ChildNotStarted;
+        }
+    }
+
+    TStrVec argv;
+    argv.reserve(args.size() + 1);
+    argv.push_back(processPath);
+    argv.insert(argv.end(), args.begin(), args.end());
+
+    CZygote::ERequestResult result{CZygote::E_ChildNotStarted};
+    {
+        // Hold the tracker thread mutex until the PID is added to the tracker
+        // to avoid a race condition if the process is started but dies really
+        // quickly. The child is adopted as soon as the zygote has replied, so
+        // the mutex must be held from before the request is sent. The socket
+        // timeouts bound how long this can take if the zygote hangs.
+        CScopedLock lock(m_TrackerThread->mutex());
+
+        result = CZygote::requestChild(zygoteFd, argv, childPid);
+        if (result == CZygote::E_ChildStarted) {
+            m_TrackerThread->addPid(childPid);
+            LOG_DEBUG(<< "Spawned '" << processPath << "' with PID " << childPid
+                      << " from zygote");
+            return result;
+        }
+    }
+
+    if (result == CZygote::E_NoReply) {
+        LOG_ERROR(<< "Zygote for '" << processPath << "' didn't reply - failed to spawn process");
+    } else {
+        LOG_WARN(<< "Zygote for '" << processPath
+                 << "' is unavailable - starting process from scratch");
+    }
+    ::close(zygoteFd);
+    zygoteFd = -1;
+    return result;
+}
+
 bool CDetachedProcessSpawner::terminateChild(CProcess::TPid pid) {
     return m_TrackerThread->terminatePid(pid);
 }
@@ -137,12 +137,16 @@ private:
 };
 }
 
-CDetachedProcessSpawner::CDetachedProcessSpawner(const TStrVec& permittedProcessPaths)
+CDetachedProcessSpawner::CDetachedProcessSpawner(const TStrVec& permittedProcessPaths,
+                                                 const TStrVec& zygoteProcessPaths)
     : m_PermittedProcessPaths(permittedProcessPaths),
       m_TrackerThread(std::make_shared<detail::CTrackerThread>()) {
     if (m_TrackerThread->start() == false) {
         LOG_ERROR(<< "Failed to start spawned process tracker thread");
     }
+    if (zygoteProcessPaths.empty() == false) {
+        LOG_WARN(<< "Zygotes are not supported on Windows - processes will be started from scratch");
+    }
 }
 
 CDetachedProcessSpawner::~CDetachedProcessSpawner() {
@@ -38,9 +38,6 @@ const std::string LOGGER{CProgName::progName()};
 const std::string TIMESTAMP_NAME{"timestamp"};
 const std::string LEVEL_NAME{"level"};
 const std::string PID_NAME{"pid"};
-// Cast this to std::int64_t as the type varies between std::int32_t and std::uint32_t on
-// different platforms and std::int64_t covers both
-const std::int64_t PID{static_cast<std::int64_t>(ml::core::CProcess::instance().id())};
 const std::string THREAD_NAME{"thread"};
 const std::string MESSAGE_NAME{"message"};
 const std::string CLASS_NAME{"class"};
@@ -78,7 +75,10 @@ void CJsonLogLayout::operator()(const boost::log::record_view& rec,
                      .get();
     writer[LEVEL_NAME] = CLogger::levelToString(level);
 
-    writer[PID_NAME] = PID;
+    // Don't cache this as processes forked from a zygote share its statics.
+    // Cast this to std::int64_t as the type varies between std::int32_t and
+    // std::uint32_t on different platforms and std::int64_t covers both.
+    writer[PID_NAME] = static_cast<std::int64_t>(ml::core::CProcess::instance().id());
 
     auto threadId = boost::log::extract<boost::log::attributes::current_thread_id::value_type>(
                         boost::log::aux::default_attribute_names::thread_id(), rec)
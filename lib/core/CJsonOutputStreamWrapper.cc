@@ -13,10 +13,37 @@
 #include <core/CLogger.h>
 #include <core/CMemoryDef.h>
 
+#include <memory>
 #include <string>
 
 namespace ml {
 namespace core {
+namespace {
+//! \brief Passes each complete top level object written to a callback.
+class CObjectWriter final : public CStringBufWriter {
+public:
+    using TWriteObjectFunc = std::function<void(const std::string&)>;
+
+public:
+    explicit CObjectWriter(TWriteObjectFunc writeObject)
+        : m_WriteObject{std::move(writeObject)} {
+        this->reset(m_Buffer);
+    }
+
+    bool onObjectEnd(std::size_t memberCount = 0) override {
+        bool baseReturnCode{CStringBufWriter::onObjectEnd(memberCount)};
+        if (this->topLevel()) {
+            m_WriteObject(m_Buffer);
+            m_Buffer.clear();
+        }
+        return baseReturnCode;
+    }
+
+private:
+    TWriteObjectFunc m_WriteObject;
+    std::string m_Buffer;
+};
+}
 
 const char CJsonOutputStreamWrapper::JSON_ARRAY_START('[');
 const char CJsonOutputStreamWrapper::JSON_ARRAY_END(']');
@@ -53,13 +80,7 @@ void CJsonOutputStreamWrapper::releaseBuffer(TGenericLineWriter& writer, std::st
     // check for data that has to be written
     if (buffer->size() > 0) {
         m_ConcurrentOutputStream([this, buffer](std::ostream& o) {
-            if (m_FirstObject) {
-                m_FirstObject = false;
-            } else {
-                o.put(JSON_ARRAY_DELIMITER);
-            }
-
-            o << *buffer;
+            this->writeObject(o, *buffer);
             o.flush();
             this->returnAndCheckBuffer(buffer);
         });
@@ -72,12 +93,7 @@ void CJsonOutputStreamWrapper::flushBuffer(TGenericLineWriter& writer, std::stri
     writer.flush();
 
     m_ConcurrentOutputStream([this, buffer](std::ostream& o) {
-        if (m_FirstObject) {
-            m_FirstObject = false;
-        } else {
-            o.put(JSON_ARRAY_DELIMITER);
-        }
-        o << *buffer;
+        this->writeObject(o, *buffer);
         this->returnAndCheckBuffer(buffer);
     });
 
@@ -117,15 +133,40 @@ void CJsonOutputStreamWrapper::syncFlush() {
 
 void CJsonOutputStreamWrapper::writeJson(std::string json) {
     m_ConcurrentOutputStream([ this, json_ = std::move(json) ](std::ostream & o) {
-        if (m_FirstObject) {
-            m_FirstObject = false;
-        } else {
-            o.put(JSON_ARRAY_DELIMITER);
-        }
-        o << json_;
+        this->writeObject(o, json_);
     });
 }
 
+std::future<void> CJsonOutputStreamWrapper::writeAsync(TWriteFunc write) {
+    // The task is copied when it is queued so share the state it captures.
+    auto write_ = std::make_shared<TWriteFunc>(std::move(write));
+    auto written = std::make_shared<std::promise<void>>();
+    auto result = written->get_future();
+
+    m_ConcurrentOutputStream([this, write_, written](std::ostream& o) {
+        CObjectWriter writer{[this, &o](const std::string& object) {
+            this->writeObject(o, object);
+        }};
+        (*write_)(writer);
+        written->set_value();
+    });
+
+    return result;
+}
+
+std::size_t CJsonOutputStreamWrapper::queueDepth() const {
+    return m_ConcurrentOutputStream.size();
+}
+
+void CJsonOutputStreamWrapper::writeObject(std::ostream& o, const std::string& object) {
+    if (m_FirstObject) {
+        m_FirstObject = false;
+    } else {
+        o.put(JSON_ARRAY_DELIMITER);
+    }
+    o << object;
+}
+
 void CJsonOutputStreamWrapper::debugMemoryUsage(const CMemoryUsage::TMemoryUsagePtr& mem) const {
     std::size_t bufferSize{0};
     for (const auto& stringBuffer : m_StringBuffers) {
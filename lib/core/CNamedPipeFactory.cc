@@ -12,6 +12,7 @@
 
 #include <core/CLogger.h>
 #include <core/COsFileFuncs.h>
+#include <core/CPipeReadBuffer.h>
 
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/stream.hpp>
@@ -115,14 +116,18 @@ const char CNamedPipeFactory::TEST_CHAR('\n');
 CNamedPipeFactory::TIStreamP
 CNamedPipeFactory::openPipeStreamRead(const std::string& fileName,
                                       const std::atomic_bool& isCancelled) {
+    return openPipeStreamRead(fileName, isCancelled, CPipeReadBuffer::DEFAULT_CAPACITY);
+}
+
+CNamedPipeFactory::TIStreamP
+CNamedPipeFactory::openPipeStreamRead(const std::string& fileName,
+                                      const std::atomic_bool& isCancelled,
+                                      std::size_t bufferCapacity) {
     TPipeHandle fd{CNamedPipeFactory::initPipeHandle(fileName, false, isCancelled)};
     if (fd == -1) {
         return TIStreamP{};
     }
-    using TFileDescriptorSourceStream =
-        boost::iostreams::stream<boost::iostreams::file_descriptor_source>;
-    return TIStreamP{new TFileDescriptorSourceStream(
-        boost::iostreams::file_descriptor_source(fd, boost::iostreams::close_handle))};
+    return TIStreamP{new CPipeReadStream(fd, bufferCapacity)};
 }
 
 CNamedPipeFactory::TOStreamP
@@ -11,6 +11,7 @@
 #include <core/CNamedPipeFactory.h>
 
 #include <core/CLogger.h>
+#include <core/CPipeReadBuffer.h>
 #include <core/CWindowsError.h>
 
 #include <boost/iostreams/device/file_descriptor.hpp>
@@ -42,14 +43,18 @@ const char CNamedPipeFactory::TEST_CHAR{'\n'};
 CNamedPipeFactory::TIStreamP
 CNamedPipeFactory::openPipeStreamRead(const std::string& fileName,
                                       const std::atomic_bool& isCancelled) {
+    return openPipeStreamRead(fileName, isCancelled, CPipeReadBuffer::DEFAULT_CAPACITY);
+}
+
+CNamedPipeFactory::TIStreamP
+CNamedPipeFactory::openPipeStreamRead(const std::string& fileName,
+                                      const std::atomic_bool& isCancelled,
+                                      std::size_t bufferCapacity) {
     TPipeHandle handle{CNamedPipeFactory::initPipeHandle(fileName, false, isCancelled)};
     if (handle == INVALID_HANDLE_VALUE) {
         return TIStreamP{};
     }
-    using TFileDescriptorSourceStream =
-        boost::iostreams::stream<boost::iostreams::file_descriptor_source>;
-    return TIStreamP{new TFileDescriptorSourceStream(boost::iostreams::file_descriptor_source(
-        handle, boost::iostreams::close_handle))};
+    return TIStreamP{new CPipeReadStream(handle, bufferCapacity)};
 }
 
 CNamedPipeFactory::TOStreamP
@@ -464,6 +464,17 @@ CPackedBitVector::COneBitIndexConstIterator::COneBitIndexConstIterator(std::size
       m_RunLengthsItr{endRunLengthsItr}, m_EndRunLengthsItr{endRunLengthsItr} {
 }
 
+void CPackedBitVector::COneBitIndexConstIterator::advanceTo(std::size_t index) {
+    while (m_EndOfCurrentRun <= index) {
+        m_Current = m_EndOfCurrentRun;
+        if (m_RunLengthsItr == m_EndRunLengthsItr) {
+            return;
+        }
+        this->skipRun();
+    }
+    m_Current = std::max(m_Current, index);
+}
+
 void CPackedBitVector::COneBitIndexConstIterator::skipRun() {
     if (m_RunLengthsItr == m_EndRunLengthsItr) {
         return;
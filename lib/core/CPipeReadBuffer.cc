@@ -0,0 +1,173 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#include <core/CPipeReadBuffer.h>
+
+#include <core/CLogger.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef Windows
+#include <core/CWindowsError.h>
+#else
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace ml {
+namespace core {
+namespace {
+//! The size of a huge page on x86_64 and most aarch64 Linux systems.
+const std::size_t HUGE_PAGE_SIZE{2 * 1024 * 1024};
+}
+
+const std::size_t CPipeReadBuffer::DEFAULT_CAPACITY{4096};
+const std::size_t CPipeReadBuffer::HUGE_PAGE_CAPACITY{HUGE_PAGE_SIZE};
+
+CPipeReadBuffer::CPipeReadBuffer(TPipeHandle handle, std::size_t capacity)
+    : m_Handle{handle}, m_Capacity{std::max(capacity, std::size_t{1})},
+      m_Buffer{allocate(m_Capacity)} {
+    this->setg(m_Buffer, m_Buffer, m_Buffer);
+}
+
+CPipeReadBuffer::~CPipeReadBuffer() {
+#ifdef Windows
+    if (m_Handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_Handle);
+    }
+#else
+    if (m_Handle != -1) {
+        ::close(m_Handle);
+    }
+#endif
+    deallocate(m_Buffer, m_Capacity);
+}
+
+void CPipeReadBuffer::consume(const char* position) {
+    this->setg(m_Buffer, const_cast<char*>(position), this->egptr());
+}
+
+std::size_t CPipeReadBuffer::fill() {
+    if (m_Eof || m_Bad) {
+        return 0;
+    }
+    this->makeSpace();
+    char* end{this->egptr()};
+    std::size_t bytesRead{this->readSome(end, m_Capacity - (end - m_Buffer))};
+    this->setg(m_Buffer, this->gptr(), end + bytesRead);
+    return bytesRead;
+}
+
+CPipeReadBuffer::int_type CPipeReadBuffer::underflow() {
+    if (this->gptr() == this->egptr() && this->fill() == 0) {
+        return traits_type::eof();
+    }
+    return traits_type::to_int_type(*this->gptr());
+}
+
+std::streamsize CPipeReadBuffer::showmanyc() {
+    return m_Eof || m_Bad ? -1 : 0;
+}
+
+void CPipeReadBuffer::makeSpace() {
+    std::size_t unread(this->egptr() - this->gptr());
+    std::size_t free(m_Capacity - (this->egptr() - m_Buffer));
+    if (unread == 0) {
+        this->setg(m_Buffer, m_Buffer, m_Buffer);
+        return;
+    }
+    if (free >= m_Capacity / 4) {
+        return;
+    }
+    if (this->gptr() > m_Buffer) {
+        std::memmove(m_Buffer, this->gptr(), unread);
+        this->setg(m_Buffer, m_Buffer, m_Buffer + unread);
+        free = m_Capacity - unread;
+    }
+    if (free == 0) {
+        // A single record doesn't fit so we have no choice but to grow.
+        std::size_t capacity{2 * m_Capacity};
+        char* buffer{allocate(capacity)};
+        std::memcpy(buffer, m_Buffer, unread);
+        deallocate(m_Buffer, m_Capacity);
+        m_Buffer = buffer;
+        m_Capacity = capacity;
+        this->setg(m_Buffer, m_Buffer, m_Buffer + unread);
+        LOG_DEBUG(<< "Grew pipe read buffer to " << m_Capacity << " bytes");
+    }
+}
+
+std::size_t CPipeReadBuffer::readSome(char* buffer, std::size_t size) {
+#ifdef Windows
+    DWORD bytesRead{0};
+    if (ReadFile(m_Handle, buffer, static_cast<DWORD>(size), &bytesRead, nullptr) == FALSE) {
+        if (GetLastError() == ERROR_BROKEN_PIPE || GetLastError() == ERROR_HANDLE_EOF) {
+            m_Eof = true;
+        } else {
+            LOG_ERROR(<< "Failed to read from pipe: " << CWindowsError());
+            m_Bad = true;
+        }
+        return 0;
+    }
+    if (bytesRead == 0) {
+        m_Eof = true;
+    }
+    return static_cast<std::size_t>(bytesRead);
+#else
+    ssize_t bytesRead{0};
+    do {
+        bytesRead = ::read(m_Handle, buffer, size);
+    } while (bytesRead == -1 && errno == EINTR);
+    if (bytesRead == -1) {
+        LOG_ERROR(<< "Failed to read from pipe: " << ::strerror(errno));
+        m_Bad = true;
+        return 0;
+    }
+    if (bytesRead == 0) {
+        m_Eof = true;
+    }
+    return static_cast<std::size_t>(bytesRead);
+#endif
+}
+
+char* CPipeReadBuffer::allocate(std::size_t capacity) {
+#if defined(Linux) && defined(MADV_HUGEPAGE)
+    if (capacity % HUGE_PAGE_SIZE == 0) {
+        void* buffer{nullptr};
+        if (::posix_memalign(&buffer, HUGE_PAGE_SIZE, capacity) != 0) {
+            throw std::bad_alloc{};
+        }
+        // This is only advice so it doesn't matter if it fails.
+        ::madvise(buffer, capacity, MADV_HUGEPAGE);
+        return static_cast<char*>(buffer);
+    }
+#endif
+    void* buffer{std::malloc(capacity)};
+    if (buffer == nullptr) {
+        throw std::bad_alloc{};
+    }
+    return static_cast<char*>(buffer);
+}
+
+void CPipeReadBuffer::deallocate(char* buffer, std::size_t /*capacity*/) {
+    // Both posix_memalign and malloc memory is freed with free.
+    std::free(buffer);
+}
+
+CPipeReadStream::CPipeReadStream(TPipeHandle handle, std::size_t capacity)
+    : std::istream{nullptr}, m_Buffer{handle, capacity} {
+    this->rdbuf(&m_Buffer);
+}
+}
+}
@@ -10,16 +10,35 @@
  */
 
 #include <core/CStaticThreadPool.h>
+
 #include <memory>
 
 namespace ml {
 namespace core {
 namespace {
+//! The maximum number of tasks which can be waiting in a worker's deque.
+const std::size_t DEQUE_CAPACITY{1024};
+
+//! The pool and index of the worker running on this thread, if any.
+thread_local const CStaticThreadPool* currentPool{nullptr};
+thread_local std::size_t currentWorker{0};
+
+//! State of the generator used to choose victims from which to steal work.
+thread_local std::uint64_t victimState{0x9E3779B97F4A7C15};
+
 std::size_t computeSize(std::size_t hint) {
     std::size_t bound{std::thread::hardware_concurrency()};
     std::size_t size{bound > 0 ? std::min(hint, bound) : hint};
     return std::max(size, std::size_t{1});
 }
+
+std::size_t randomVictim(std::size_t n) {
+    // Xorshift is plenty good enough to spread thieves over the victims.
+    victimState ^= victimState << 13;
+    victimState ^= victimState >> 7;
+    victimState ^= victimState << 17;
+    return static_cast<std::size_t>(victimState % n);
+}
 }
 
 CStaticThreadPool::CStaticThreadPool(std::size_t size, std::size_t queueCapacity)
@@ -30,6 +49,8 @@ CStaticThreadPool::CStaticThreadPool(std::size_t size, std::size_t queueCapacity
 
     for (std::size_t id = 0; id < poolSize; ++id) {
         m_TaskQueues.push_back(std::make_unique<TWrappedTaskQueue>(queueCapacity));
+        m_TaskDeques.push_back(std::make_unique<TWrappedTaskDeque>(DEQUE_CAPACITY));
+        m_Sleeping.push_back(std::make_unique<std::atomic_bool>(false));
     }
     m_NumberThreadsInUse.store(poolSize);
 
@@ -57,17 +78,31 @@ void CStaticThreadPool::numberThreadsInUse(std::size_t threads) {
 }
 
 void CStaticThreadPool::schedule(TTask&& task_) {
+    CWrappedTask task{std::forward<TTask>(task_)};
+
+    // Tasks scheduled by a task go on its worker's deque from which idle workers
+    // can steal them.
+    bool onWorker{currentPool == this};
+    if (onWorker && this->scheduleOnWorker(currentWorker, task)) {
+        return;
+    }
+
     // Only block if every queue is full.
     std::size_t size{m_NumberThreadsInUse.load()};
     std::size_t i{m_Cursor.load()};
     std::size_t end{i + size};
-    CWrappedTask task{std::forward<TTask>(task_)};
     for (/**/; i < end; ++i) {
         if (m_TaskQueues[i % size]->tryPush(std::move(task))) {
             break;
         }
     }
     if (i == end) {
+        if (onWorker) {
+            // A worker mustn't block waiting for space in the queues since it
+            // may be the one which needs to make it.
+            task();
+            return;
+        }
         m_TaskQueues[i % size]->push(std::move(task));
     }
 
@@ -92,6 +127,22 @@ void CStaticThreadPool::busy(bool busy) {
     m_Busy.store(busy);
 }
 
+bool CStaticThreadPool::isWorkerThread() const {
+    return currentPool == this;
+}
+
+bool CStaticThreadPool::runPendingTask() {
+    if (currentPool != this) {
+        return false;
+    }
+    TWrappedTaskUPtr task{this->popOrSteal(currentWorker)};
+    if (task == nullptr) {
+        return false;
+    }
+    (*task)();
+    return true;
+}
+
 void CStaticThreadPool::shutdown() {
 
     // Drain the queues before starting to shut down in order to maximise throughput.
@@ -110,12 +161,25 @@ void CStaticThreadPool::shutdown() {
         }
     }
 
+    // Workers empty their own deque before running their shutdown task so this
+    // is just defensive.
+    for (auto& deque : m_TaskDeques) {
+        while (TWrappedTaskUPtr task{deque->steal()}) {
+            (*task)();
+        }
+    }
+
     m_TaskQueues.clear();
+    m_TaskDeques.clear();
     m_Pool.clear();
 }
 
 void CStaticThreadPool::worker(std::size_t id) {
 
+    currentPool = this;
+    currentWorker = id;
+    victimState += id;
+
     auto ifAllowed = [id](const CWrappedTask& task) {
         return task.executableOnThread(id);
     };
@@ -123,12 +187,13 @@ void CStaticThreadPool::worker(std::size_t id) {
     TOptionalTask task;
 
     while (m_Done == false) {
-        // We maintain "worker count" queues and each worker has an affinity to a
-        // different queue. We don't immediately block if the worker's "queue" is
-        // empty because different tasks can have different duration and we could
-        // assign imbalanced work to the queues. However, this arrangement means
+        // Each worker has its own deque, for tasks scheduled by the tasks it runs,
+        // and a queue, for tasks scheduled from outside the pool. Workers prefer
+        // their own deque, since tasks on it are typically needed to finish the
+        // task which scheduled them. Next they try their queue, then the other
+        // queues, and then steal from the deques of random victims. This means
         // if everything is working well we have essentially no contention between
-        // workers on queue reads.
+        // workers.
 
         std::size_t size{m_NumberThreadsInUse.load()};
 
@@ -138,18 +203,33 @@ void CStaticThreadPool::worker(std::size_t id) {
         // visible, assuming tasks are only added after setting m_NumberThreadsInUse.
         // We don't care about this in practice because we only care that the number
         // of active worker threads soon adapts to the new limit.
+        task = std::nullopt;
         if (id < size) {
+            if (TWrappedTaskUPtr local{m_TaskDeques[id]->pop()}) {
+                (*local)();
+                continue;
+            }
             for (std::size_t i = 0; i < size; ++i) {
                 task = m_TaskQueues[(id + i) % size]->tryPop(ifAllowed);
                 if (task != std::nullopt) {
                     break;
                 }
             }
-        } else {
-            task = std::nullopt;
+            if (task == std::nullopt) {
+                // Tell workers scheduling tasks on their deques we're about to
+                // block and check once more there's nothing to steal so we can't
+                // miss being woken up.
+                m_Sleeping[id]->store(true);
+                if (TWrappedTaskUPtr stolen{this->popOrSteal(id)}) {
+                    m_Sleeping[id]->store(false);
+                    (*stolen)();
+                    continue;
+                }
+            }
         }
         if (task == std::nullopt) {
             task = m_TaskQueues[id]->pop();
+            m_Sleeping[id]->store(false);
         }
 
         (*task)();
@@ -180,6 +260,58 @@ void CStaticThreadPool::drainQueuesWithoutBlocking() {
     }
 }
 
+bool CStaticThreadPool::scheduleOnWorker(std::size_t id, CWrappedTask& task) {
+    if (id >= m_NumberThreadsInUse.load()) {
+        return false;
+    }
+    auto wrapped = std::make_unique<CWrappedTask>(std::move(task));
+    if (m_TaskDeques[id]->push(wrapped.get()) == false) {
+        task = std::move(*wrapped);
+        return false;
+    }
+    wrapped.release();
+    this->wakeSleepingWorker();
+    return true;
+}
+
+CStaticThreadPool::TWrappedTaskUPtr CStaticThreadPool::popOrSteal(std::size_t id) {
+    if (TWrappedTaskUPtr task{m_TaskDeques[id]->pop()}) {
+        return task;
+    }
+    if (id >= m_NumberThreadsInUse.load()) {
+        return nullptr;
+    }
+    // Victims include workers which aren't in use so no task is left behind if
+    // the number of threads in use is reduced.
+    std::size_t n{m_TaskDeques.size()};
+    std::size_t start{randomVictim(n)};
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t victim{(start + i) % n};
+        if (victim != id) {
+            if (TWrappedTaskUPtr task{m_TaskDeques[victim]->steal()}) {
+                return task;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void CStaticThreadPool::wakeSleepingWorker() {
+    // Pairs with the fence in CWorkStealingDeque::steal so either we see a worker
+    // is going to sleep or it sees the task we just pushed.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::size_t size{m_NumberThreadsInUse.load()};
+    for (std::size_t id = 0; id < size; ++id) {
+        bool sleeping{true};
+        if (m_Sleeping[id]->compare_exchange_strong(sleeping, false)) {
+            // The worker only has to wake up to look for work to steal so an
+            // empty task suffices. If its queue is full it isn't idle anyway.
+            m_TaskQueues[id]->tryPush(CWrappedTask{TTask{}});
+            return;
+        }
+    }
+}
+
 CStaticThreadPool::CWrappedTask::CWrappedTask(TTask&& task, TOptionalSize threadId)
     : m_Task{std::forward<TTask>(task)}, m_ThreadId{threadId} {
 }
@@ -18,9 +18,11 @@
 #include <boost/multi_array.hpp>
 
 #include <algorithm>
+#include <charconv>
 #include <cmath>
 #include <limits>
 #include <locale>
+#include <type_traits>
 
 #include <ctype.h>
 #include <errno.h>
@@ -40,6 +42,62 @@ double clampToReadable(double x) {
     return (x < SMALLEST ? SMALLEST : x > LARGEST ? LARGEST : x);
 }
 
+//! Write the integer \p i to a string.
+template<typename T>
+std::string integerToString(T i) {
+    // This is large enough for the digits and sign of any integer type.
+    char buf[4 * sizeof(T)];
+    return std::string(buf, std::to_chars(buf, buf + sizeof(buf), i).ptr);
+}
+
+//! Write \p value to [\p first, \p last) as the format "%.<precision>g" does
+//! in the "C" locale, returning the end of the characters written.
+char* formatGeneral(double value, int precision, char* first, char* last) {
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(first, last, value, std::chars_format::general, precision).ptr;
+#else
+    int length{::snprintf(first, last - first, "%.*g", precision, value)};
+    return first + std::min(std::max(length, 0), static_cast<int>(last - first) - 1);
+#endif
+}
+
+//! Write the shortest string which reads back as \p value to [\p first, \p last),
+//! returning the end of the characters written.
+char* formatShortest(double value, char* first, char* last) {
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(first, last, value).ptr;
+#else
+    return formatGeneral(value, std::numeric_limits<double>::max_digits10, first, last);
+#endif
+}
+
+//! Try to read \p str as a plain base 10 number with std::from_chars, which is
+//! locale independent and much faster than the strto* family of functions.
+//!
+//! This fails, leaving \p value unchanged, for anything else, such as a number
+//! with leading whitespace or an explicit plus sign, a hex or octal integer or
+//! an out of range value. The caller should fall back to the strto* functions
+//! in this case since these handle all such input and report errors.
+template<typename T>
+bool fromChars(const std::string& str, T& value) {
+    const char* first{str.data()};
+    const char* last{first + str.size()};
+    if constexpr (std::is_integral_v<T>) {
+        // A leading zero means octal or hex to the strto* functions.
+        const char* digits{first != last && *first == '-' ? first + 1 : first};
+        if (last - digits > 1 && *digits == '0') {
+            return false;
+        }
+    }
+    T result;
+    auto[end, error] = std::from_chars(first, last, result);
+    if (error != std::errc{} || end != last) {
+        return false;
+    }
+    value = result;
+    return true;
+}
+
 //! Get a locale object for character transformations.
 //!
 //! TODO - remove when we switch to a character conversion library (e.g. ICU).
@@ -273,75 +331,35 @@ void CStringUtils::unEscape(char escape, std::string& str) {
 }
 
 std::string CStringUtils::_typeToString(const unsigned long long& i) {
-    char buf[4 * sizeof(unsigned long long)];
-    ::memset(buf, 0, sizeof(buf));
-
-    ::sprintf(buf, "%llu", i);
-
-    return buf;
+    return integerToString(i);
 }
 
 std::string CStringUtils::_typeToString(const unsigned long& i) {
-    char buf[4 * sizeof(unsigned long)];
-    ::memset(buf, 0, sizeof(buf));
-
-    ::sprintf(buf, "%lu", i);
-
-    return buf;
+    return integerToString(i);
 }
 
 std::string CStringUtils::_typeToString(const unsigned int& i) {
-    char buf[4 * sizeof(unsigned int)];
-    ::memset(buf, 0, sizeof(buf));
-
-    ::sprintf(buf, "%u", i);
-
-    return buf;
+    return integerToString(i);
 }
 
 std::string CStringUtils::_typeToString(const unsigned short& i) {
-    char buf[4 * sizeof(unsigned short)];
-    ::memset(buf, 0, sizeof(buf));
-
-    ::sprintf(buf, "%hu", i);
-
-    return buf;
+    return integerToString(i);
 }
 
 std::string CStringUtils::_typeToString(const long long& i) {
-    char buf[4 * sizeof(long long)];
-    ::memset(buf, 0, sizeof(buf));
-
-    ::sprintf(buf, "%lld", i);
-
-    return buf;
+    return integerToString(i);
 }
 
 std::string CStringUtils::_typeToString(const long& i) {
-    char buf[4 * sizeof(long)];
-    ::memset(buf, 0, sizeof(buf));
-
-    ::sprintf(buf, "%ld", i);
-
-    return buf;
+    return integerToString(i);
 }
 
 std::string CStringUtils::_typeToString(const int& i) {
-    char buf[4 * sizeof(int)];
-    ::memset(buf, 0, sizeof(buf));
-
-    ::sprintf(buf, "%d", i);
-
-    return buf;
+    return integerToString(i);
 }
 
 std::string CStringUtils::_typeToString(const short& i) {
-    char buf[4 * sizeof(short)];
-    ::memset(buf, 0, sizeof(buf));
-
-    ::sprintf(buf, "%hd", i);
-
-    return buf;
+    return integerToString(i);
 }
 
 std::string CStringUtils::_typeToString(const bool& b) {
@@ -353,11 +371,14 @@ std::string CStringUtils::_typeToString(const double& i) {
     // "%f" rather than "%g", which means we could be printing a 308 digit
     // number without resorting to scientific notation
     char buf[64 * sizeof(double)];
+#if defined(__cpp_lib_to_chars)
+    return std::string(
+        buf, std::to_chars(buf, buf + sizeof(buf), i, std::chars_format::fixed, 6).ptr);
+#else
     ::memset(buf, 0, sizeof(buf));
-
     ::sprintf(buf, "%f", i);
-
     return buf;
+#endif
 }
 
 std::string CStringUtils::_typeToString(const char* str) {
@@ -382,15 +403,16 @@ std::string CStringUtils::typeToStringPretty(double d) {
     //              =  16
 
     char buf[16];
-    ::memset(buf, 0, sizeof(buf));
-    ::sprintf(buf, "%.7g", d);
-    return buf;
+    return std::string(buf, formatGeneral(d, 7, buf, buf + sizeof(buf)));
 }
 
 std::string CStringUtils::typeToStringPrecise(double d, CIEEE754::EPrecision precision) {
-    // Just use a large enough buffer to hold maximum precision.
-    char buf[4 * sizeof(double)];
-    ::memset(buf, 0, sizeof(buf));
+    char buf[MAX_PRECISE_STRING_LENGTH];
+    return std::string(buf, typeToStringPrecise(d, precision, buf));
+}
+
+std::size_t
+CStringUtils::typeToStringPrecise(double d, CIEEE754::EPrecision precision, char* buffer) {
 
     // Floats need higher precision to precisely round trip to decimal than
     // considering their effective precision base 10. There's a good discussion
@@ -398,74 +420,56 @@ std::string CStringUtils::typeToStringPrecise(double d, CIEEE754::EPrecision pre
     // We use g format since it is the most efficient. Note also that when
     // printing to limited precision we must round the value before printing
     // because printing just truncates, i.e. sprintf(buf, "%.6e", 0.49999998)
-    // gives 4.999999e-1 rather than the correctly rounded value 0.5.
+    // gives 4.999999e-1 rather than the correctly rounded value 0.5. For full
+    // precision we write the shortest string which reads back to the same
+    // double.
 
-    int ret = 0;
+    char* last{buffer + MAX_PRECISE_STRING_LENGTH};
+    char* end{buffer};
     switch (precision) {
     case CIEEE754::E_HalfPrecision:
-        ret = ::sprintf(buf, "%.5g",
-                        clampToReadable(CIEEE754::round(d, CIEEE754::E_HalfPrecision)));
+        end = formatGeneral(clampToReadable(CIEEE754::round(d, CIEEE754::E_HalfPrecision)),
+                            5, buffer, last);
         break;
     case CIEEE754::E_SinglePrecision:
-        ret = ::sprintf(buf, "%.9g",
-                        clampToReadable(CIEEE754::round(d, CIEEE754::E_SinglePrecision)));
+        end = formatGeneral(clampToReadable(CIEEE754::round(d, CIEEE754::E_SinglePrecision)),
+                            9, buffer, last);
         break;
     case CIEEE754::E_DoublePrecision:
-        ret = ::sprintf(buf, "%.17g", clampToReadable(d));
+        end = formatShortest(clampToReadable(d), buffer, last);
         break;
     }
 
-    // Workaround for Visual C++ 2010 misformatting - replace
-    // 123.45e010 with 123.45e10 and 123.45e-010 with 123.45e-10.
-    // Also it is inefficient to output trailing zeros, i.e.
-    // 1.23456000000000e-11 so we strip these off in the following.
-    if (ret > 2) {
-        // Look for an 'e'
-        char* ptr(static_cast<char*>(::memchr(buf, 'e', ret - 1)));
-        if (ptr != nullptr) {
-            bool edit = false;
-            bool minus = false;
-
-            // Strip off any trailing zeros and a trailing point.
-            char* bwd = ptr;
-            for (;;) {
-                --bwd;
-                if (*bwd == '0' || *bwd == '.') {
-                    edit = true;
-                } else {
-                    break;
-                }
-            }
-
-            // Strip off any leading zeros in the exponent.
-            char* fwd = ptr;
-            for (;;) {
-                ++fwd;
-                if (*fwd == '-') {
-                    minus = true;
-                } else if (*fwd == '+' || *fwd == '0') {
-                    edit = true;
-                } else {
-                    break;
-                }
+    // It is inefficient to output trailing zeros, i.e. 1.23456000000000e-11,
+    // or a plus sign and leading zeros in the exponent, i.e. 1.5e+05, so we
+    // strip these off in place.
+    char* exponent{std::find(buffer, end, 'e')};
+    if (exponent != end) {
+        char* mantissaEnd{exponent};
+        while (mantissaEnd != buffer && (mantissaEnd[-1] == '0' || mantissaEnd[-1] == '.')) {
+            --mantissaEnd;
+        }
+        char* digits{exponent + 1};
+        bool minus{false};
+        for (/**/; digits != end; ++digits) {
+            if (*digits == '-') {
+                minus = true;
+            } else if (*digits != '+' && *digits != '0') {
+                break;
             }
-
-            if (edit) {
-                std::string adjResult;
-                adjResult.reserve(ret - 1);
-                // mantissa
-                adjResult.assign(buf, bwd + 1);
-                if (::isdigit(static_cast<unsigned char>(*fwd))) {
-                    adjResult.append(minus ? "e-" : "e");
-                    // exponent
-                    adjResult.append(fwd);
-                }
-                return adjResult;
+        }
+        char* result{mantissaEnd};
+        if (digits != end) {
+            *result++ = 'e';
+            if (minus) {
+                *result++ = '-';
             }
+            result = std::copy(digits, end, result);
         }
+        end = result;
     }
 
-    return buf;
+    return static_cast<std::size_t>(end - buffer);
 }
 
 CStringUtils::TSizeBoolPr
@@ -537,6 +541,10 @@ bool CStringUtils::_stringToType(bool silent, const std::string& str, unsigned l
         return false;
     }
 
+    if (fromChars(str, i)) {
+        return true;
+    }
+
     char* endPtr(nullptr);
     errno = 0;
     unsigned long long ret(::strtoull(str.c_str(), &endPtr, 0));
@@ -579,6 +587,10 @@ bool CStringUtils::_stringToType(bool silent, const std::string& str, unsigned l
         return false;
     }
 
+    if (fromChars(str, i)) {
+        return true;
+    }
+
     char* endPtr(nullptr);
     errno = 0;
     unsigned long ret(::strtoul(str.c_str(), &endPtr, 0));
@@ -664,6 +676,10 @@ bool CStringUtils::_stringToType(bool silent, const std::string& str, long long&
         return false;
     }
 
+    if (fromChars(str, i)) {
+        return true;
+    }
+
     char* endPtr(nullptr);
     errno = 0;
     long long ret(::strtoll(str.c_str(), &endPtr, 0));
@@ -706,6 +722,10 @@ bool CStringUtils::_stringToType(bool silent, const std::string& str, long& i) {
         return false;
     }
 
+    if (fromChars(str, i)) {
+        return true;
+    }
+
     char* endPtr(nullptr);
     errno = 0;
     long ret(::strtol(str.c_str(), &endPtr, 0));
@@ -861,6 +881,12 @@ bool CStringUtils::_stringToType(bool silent, const std::string& str, double& d)
         return false;
     }
 
+#if defined(__cpp_lib_to_chars)
+    if (fromChars(str, d)) {
+        return true;
+    }
+#endif
+
     char* endPtr(nullptr);
     errno = 0;
     double ret(::strtod(str.c_str(), &endPtr));
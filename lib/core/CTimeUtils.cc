@@ -171,7 +171,7 @@ void CTimeUtils::toStringCommon(core_t::TTime t, const std::string& format, std:
     result = buf;
 }
 
-bool CTimeUtils::isDateWord(const std::string& word) {
+bool CTimeUtils::isDateWord(std::string_view word) {
     return CDateWordCache::instance().isDateWord(word);
 }
 
@@ -272,7 +272,7 @@ const CTimeUtils::CDateWordCache& CTimeUtils::CDateWordCache::instance() {
     return *ms_Instance;
 }
 
-bool CTimeUtils::CDateWordCache::isDateWord(const std::string& word) const {
+bool CTimeUtils::CDateWordCache::isDateWord(std::string_view word) const {
     return m_DateWords.find(word) != m_DateWords.end();
 }
 
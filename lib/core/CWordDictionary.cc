@@ -16,7 +16,10 @@
 #include <core/CStrCaseCmp.h>
 #include <core/CStringUtils.h>
 
+#include <algorithm>
 #include <fstream>
+#include <limits>
+#include <numeric>
 
 #include <ctype.h>
 
@@ -27,6 +30,31 @@ namespace {
 
 const char PART_OF_SPEECH_SEPARATOR('@');
 
+//! The maximum displacement to try when placing a bucket's words.
+const std::int32_t MAX_DISPLACEMENT{std::numeric_limits<std::int32_t>::max()};
+
+//! A case-insensitive hash of \p str.
+std::uint64_t hashIgnoreCase(std::string_view str) {
+    // FNV-1a.
+    std::uint64_t hash{0xcbf29ce484222325ULL};
+    for (const char c : str) {
+        hash ^= static_cast<std::uint64_t>(::tolower(c));
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+//! Mix \p hash with \p seed using the MurmurHash3 finaliser.
+std::uint64_t mix(std::uint64_t hash, std::uint64_t seed) {
+    hash ^= seed * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
 CWordDictionary::EPartOfSpeech partOfSpeechFromCode(char partOfSpeechCode) {
     // These codes are taken from the readme file that comes with Moby
     // Part-of-Speech - see http://icon.shef.ac.uk/Moby/mpos.html
@@ -87,16 +115,20 @@ const CWordDictionary& CWordDictionary::instance() {
     return *ms_Instance;
 }
 
-bool CWordDictionary::isInDictionary(const std::string& str) const {
-    return m_DictionaryWords.find(str) != m_DictionaryWords.end();
+bool CWordDictionary::isInDictionary(std::string_view str) const {
+    return this->partOfSpeech(str) != E_NotInDictionary;
 }
 
-CWordDictionary::EPartOfSpeech CWordDictionary::partOfSpeech(const std::string& str) const {
-    TStrUMapCItr iter = m_DictionaryWords.find(str);
-    if (iter == m_DictionaryWords.end()) {
+CWordDictionary::EPartOfSpeech CWordDictionary::partOfSpeech(std::string_view str) const {
+    if (m_Entries.empty()) {
+        return E_NotInDictionary;
+    }
+    const SEntry& entry{m_Entries[this->slot(str)]};
+    if (CStrEqualIgnoreCase{}(std::string_view{m_Words.data() + entry.s_Offset, entry.s_Length},
+                              str) == false) {
         return E_NotInDictionary;
     }
-    return iter->second;
+    return static_cast<EPartOfSpeech>(entry.s_PartOfSpeech);
 }
 
 CWordDictionary::CWordDictionary() {
@@ -108,6 +140,8 @@ CWordDictionary::CWordDictionary() {
     if (ifs.is_open()) {
         LOG_DEBUG(<< "Populating word dictionary from file " << fileToLoad);
 
+        TStrUMap dictionaryWords;
+
         std::string word;
         while (std::getline(ifs, word)) {
             CStringUtils::trimWhitespace(word);
@@ -134,11 +168,17 @@ CWordDictionary::CWordDictionary() {
                           << ") for word: " << word);
                 continue;
             }
+            if (sepPos > std::numeric_limits<std::uint16_t>::max()) {
+                LOG_ERROR(<< "Found word that is too long: " << word);
+                continue;
+            }
             word.erase(sepPos);
-            m_DictionaryWords[word] = partOfSpeech;
+            dictionaryWords[word] = partOfSpeech;
         }
 
-        LOG_DEBUG(<< "Populated word dictionary with " << m_DictionaryWords.size() << " words");
+        this->buildPerfectHash(dictionaryWords);
+
+        LOG_DEBUG(<< "Populated word dictionary with " << m_Entries.size() << " words");
     } else {
         LOG_ERROR(<< "Failed to open dictionary file " << fileToLoad);
     }
@@ -148,21 +188,118 @@ CWordDictionary::~CWordDictionary() {
     ms_Instance = nullptr;
 }
 
-size_t CWordDictionary::CStrHashIgnoreCase::operator()(const std::string& str) const {
+void CWordDictionary::buildPerfectHash(const TStrUMap& words) {
+    using TSizeVec = std::vector<std::size_t>;
+    using TSizeVecVec = std::vector<TSizeVec>;
+
+    std::size_t numberWords{words.size()};
+    if (numberWords == 0) {
+        return;
+    }
+
+    // Hash the words into buckets, averaging two words per bucket.
+    std::size_t numberBuckets{std::max(numberWords / 2, std::size_t{1})};
+    TSizeVecVec buckets(numberBuckets);
+    std::vector<TStrUMap::const_iterator> wordsByIndex;
+    std::vector<std::uint64_t> hashes;
+    wordsByIndex.reserve(numberWords);
+    hashes.reserve(numberWords);
+    for (auto i = words.begin(); i != words.end(); ++i) {
+        wordsByIndex.push_back(i);
+        hashes.push_back(hashIgnoreCase(i->first));
+        buckets[mix(hashes.back(), 0) % numberBuckets].push_back(hashes.size() - 1);
+    }
+
+    m_Words.clear();
+    m_Entries.assign(numberWords, SEntry{0, 0, E_NotInDictionary});
+    m_Displacements.assign(numberBuckets, 0);
+    std::vector<bool> occupied(numberWords, false);
+
+    auto place = [&](std::size_t slot, std::size_t index) {
+        const auto& word = *wordsByIndex[index];
+        occupied[slot] = true;
+        m_Entries[slot] = SEntry{static_cast<std::uint32_t>(m_Words.length()),
+                                 static_cast<std::uint16_t>(word.first.length()),
+                                 static_cast<std::uint16_t>(word.second)};
+        m_Words += word.first;
+    };
+
+    // Place the largest buckets first, searching for a displacement which
+    // maps all their words to free slots.
+    TSizeVec order(numberBuckets);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    TSizeVec slots;
+    std::size_t i{0};
+    for (/**/; i < order.size() && buckets[order[i]].size() > 1; ++i) {
+        const TSizeVec& bucket{buckets[order[i]]};
+        std::int32_t displacement{1};
+        for (/**/; displacement < MAX_DISPLACEMENT; ++displacement) {
+            slots.clear();
+            for (auto index : bucket) {
+                std::size_t slot{mix(hashes[index], displacement) % numberWords};
+                if (occupied[slot] ||
+                    std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (slots.size() == bucket.size()) {
+                break;
+            }
+        }
+        if (displacement == MAX_DISPLACEMENT) {
+            LOG_ERROR(<< "Failed to build perfect hash for word dictionary");
+            m_Words.clear();
+            m_Entries.clear();
+            m_Displacements.clear();
+            return;
+        }
+        m_Displacements[order[i]] = displacement;
+        for (std::size_t j = 0; j < bucket.size(); ++j) {
+            place(slots[j], bucket[j]);
+        }
+    }
+
+    // Buckets with a single word can go in any free slot which we store
+    // directly.
+    std::size_t freeSlot{0};
+    for (/**/; i < order.size() && buckets[order[i]].size() == 1; ++i) {
+        while (occupied[freeSlot]) {
+            ++freeSlot;
+        }
+        m_Displacements[order[i]] = -static_cast<std::int32_t>(freeSlot) - 1;
+        place(freeSlot, buckets[order[i]][0]);
+    }
+
+    m_Words.shrink_to_fit();
+}
+
+std::size_t CWordDictionary::slot(std::string_view str) const {
+    std::uint64_t hash{hashIgnoreCase(str)};
+    std::int32_t displacement{m_Displacements[mix(hash, 0) % m_Displacements.size()]};
+    return displacement < 0 ? static_cast<std::size_t>(-(displacement + 1))
+                            : mix(hash, displacement) % m_Entries.size();
+}
+
+size_t CWordDictionary::CStrHashIgnoreCase::operator()(std::string_view str) const {
     size_t hash(0);
 
-    for (std::string::const_iterator iter = str.begin(); iter != str.end(); ++iter) {
+    for (const char c : str) {
         hash *= 17;
-        hash += ::tolower(*iter);
+        hash += ::tolower(c);
     }
 
     return hash;
 }
 
-bool CWordDictionary::CStrEqualIgnoreCase::operator()(const std::string& lhs,
-                                                      const std::string& rhs) const {
+bool CWordDictionary::CStrEqualIgnoreCase::operator()(std::string_view lhs,
+                                                      std::string_view rhs) const {
     return lhs.length() == rhs.length() &&
-           CStrCaseCmp::strCaseCmp(lhs.c_str(), rhs.c_str()) == 0;
+           CStrCaseCmp::strNCaseCmp(lhs.data(), rhs.data(), lhs.length()) == 0;
 }
 }
 }
@@ -0,0 +1,230 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#include <core/CZygote.h>
+
+#include <core/CLogger.h>
+#include <core/CStringUtils.h>
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef Linux
+#include <sys/prctl.h>
+#endif
+
+namespace ml {
+namespace core {
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS{MSG_NOSIGNAL};
+#else
+const int SEND_FLAGS{0};
+#endif
+
+//! Sanity limits on the size of a request.
+const std::uint32_t MAX_ARGS{1024};
+const std::uint32_t MAX_ARG_LENGTH{1024 * 1024};
+
+bool writeAll(int fd, const void* buffer, std::size_t length) {
+    const char* next{static_cast<const char*>(buffer)};
+    while (length > 0) {
+        ssize_t written{::send(fd, next, length, SEND_FLAGS)};
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        next += written;
+        length -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool readAll(int fd, void* buffer, std::size_t length) {
+    char* next{static_cast<char*>(buffer)};
+    while (length > 0) {
+        ssize_t bytesRead{::recv(fd, next, length, 0)};
+        if (bytesRead == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (bytesRead == 0) {
+            // The other end has been closed
+            return false;
+        }
+        next += bytesRead;
+        length -= static_cast<std::size_t>(bytesRead);
+    }
+    return true;
+}
+
+bool writeRequest(int fd, const CZygote::TStrVec& argv) {
+    std::uint32_t count{static_cast<std::uint32_t>(argv.size())};
+    if (writeAll(fd, &count, sizeof(count)) == false) {
+        return false;
+    }
+    for (const auto& arg : argv) {
+        std::uint32_t length{static_cast<std::uint32_t>(arg.length())};
+        if (writeAll(fd, &length, sizeof(length)) == false ||
+            writeAll(fd, arg.data(), arg.length()) == false) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readRequest(int fd, CZygote::TStrVec& argv) {
+    std::uint32_t count{0};
+    if (readAll(fd, &count, sizeof(count)) == false || count == 0 || count > MAX_ARGS) {
+        return false;
+    }
+    argv.resize(count);
+    for (auto& arg : argv) {
+        std::uint32_t length{0};
+        if (readAll(fd, &length, sizeof(length)) == false || length > MAX_ARG_LENGTH) {
+            return false;
+        }
+        arg.resize(length);
+        if (readAll(fd, &arg[0], length) == false) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! The command line of a child forked from the zygote. These must live for
+//! as long as the child.
+CZygote::TStrVec childArgs;
+std::vector<char*> childArgv;
+}
+
+const std::string CZygote::ZYGOTE_ARG_PREFIX{"--zygote="};
+
+bool CZygote::isSupported() {
+#ifdef Linux
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool CZygote::becomeSubreaper() {
+#ifdef Linux
+    if (::prctl(PR_SET_CHILD_SUBREAPER, 1) == -1) {
+        LOG_ERROR(<< "Failed to become a child subreaper: " << ::strerror(errno));
+        return false;
+    }
+    return true;
+#else
+    LOG_ERROR(<< "Child subreapers are not supported on this platform");
+    return false;
+#endif
+}
+
+void CZygote::serveIfRequested(int& argc, char**& argv, const TInitialiseFunc& initialise) {
+    if (argc != 2 || ::strncmp(argv[1], ZYGOTE_ARG_PREFIX.c_str(),
+                               ZYGOTE_ARG_PREFIX.length()) != 0) {
+        return;
+    }
+
+    int fd{-1};
+    if (CStringUtils::stringToType(argv[1] + ZYGOTE_ARG_PREFIX.length(), fd) == false) {
+        // Leave the command line parser to report the problem
+        return;
+    }
+
+    if (initialise) {
+        initialise();
+    }
+
+    for (;;) {
+        TStrVec args;
+        if (readRequest(fd, args) == false) {
+            // The spawner has gone away
+            std::exit(EXIT_SUCCESS);
+        }
+
+        CProcess::TPid intermediatePid{::fork()};
+        if (intermediatePid == -1) {
+            LOG_ERROR(<< "Failed to fork: " << ::strerror(errno));
+            writeAll(fd, &intermediatePid, sizeof(intermediatePid));
+            continue;
+        }
+
+        if (intermediatePid == 0) {
+            CProcess::TPid childPid{::fork()};
+            if (childPid == 0) {
+                ::close(fd);
+                // Match the process group of processes started directly
+                ::setpgid(0, 0);
+                childArgs = std::move(args);
+                childArgv.reserve(childArgs.size() + 1);
+                for (auto& arg : childArgs) {
+                    childArgv.push_back(&arg[0]);
+                }
+                childArgv.push_back(nullptr);
+                argc = static_cast<int>(childArgs.size());
+                argv = childArgv.data();
+                return;
+            }
+            // Exit straight away so the child is adopted by the spawner. If the
+            // spawner isn't told the child's PID it can't track it so kill it.
+            if (writeAll(fd, &childPid, sizeof(childPid)) == false) {
+                if (childPid > 0) {
+                    ::kill(childPid, SIGKILL);
+                }
+                ::_exit(EXIT_FAILURE);
+            }
+            ::_exit(EXIT_SUCCESS);
+        }
+
+        while (::waitpid(intermediatePid, nullptr, 0) == -1 && errno == EINTR) {
+        }
+    }
+}
+
+CZygote::ERequestResult
+CZygote::requestChild(int fd, const TStrVec& argv, CProcess::TPid& childPid) {
+    if (writeRequest(fd, argv) == false) {
+        // The zygote only acts on complete requests.
+        LOG_ERROR(<< "Failed to send request to zygote: " << ::strerror(errno));
+        return E_ChildNotStarted;
+    }
+    if (readAll(fd, &childPid, sizeof(childPid)) == false) {
+        // After the shutdown the zygote can't deliver the reply so kills the
+        // child. However, the reply may have arrived just before it.
+        ::shutdown(fd, SHUT_RDWR);
+        if (::recv(fd, &childPid, sizeof(childPid), MSG_DONTWAIT) !=
+            static_cast<ssize_t>(sizeof(childPid))) {
+            LOG_ERROR(<< "Failed to read response from zygote");
+            return E_NoReply;
+        }
+    }
+    if (childPid <= 0) {
+        LOG_ERROR(<< "Zygote failed to fork a child");
+        return E_ChildNotStarted;
+    }
+    return E_ChildStarted;
+}
+}
+}
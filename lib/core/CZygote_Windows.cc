@@ -0,0 +1,40 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#include <core/CZygote.h>
+
+#include <core/CLogger.h>
+
+namespace ml {
+namespace core {
+
+const std::string CZygote::ZYGOTE_ARG_PREFIX{"--zygote="};
+
+bool CZygote::isSupported() {
+    return false;
+}
+
+bool CZygote::becomeSubreaper() {
+    LOG_ERROR(<< "Child subreapers are not supported on Windows");
+    return false;
+}
+
+void CZygote::serveIfRequested(int& /*argc*/, char**& /*argv*/, const TInitialiseFunc& /*initialise*/) {
+    // Zygotes are not supported on Windows, so the command line parser will
+    // reject the zygote argument if it's present
+}
+
+CZygote::ERequestResult
+CZygote::requestChild(int /*fd*/, const TStrVec& /*argv*/, CProcess::TPid& /*childPid*/) {
+    LOG_ERROR(<< "Zygotes are not supported on Windows");
+    return E_ChildNotStarted;
+}
+}
+}
@@ -14,9 +14,13 @@
 #include <core/CLogger.h>
 #include <core/CStaticThreadPool.h>
 
+#include <chrono>
+#include <cmath>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <numeric>
+#include <string>
 #include <thread>
 
 namespace ml {
@@ -30,6 +34,8 @@ public:
     void busy(bool) override {}
     std::size_t numberThreadsInUse() const override { return 1; }
     void numberThreadsInUse(std::size_t) override {}
+    bool isWorkerThread() const override { return false; }
+    bool runPendingTask() override { return false; }
 };
 
 //! \brief Executes a function in a thread pool.
@@ -55,6 +61,11 @@ public:
         m_ThreadPool.numberThreadsInUse(threads);
     }
 
+    bool isWorkerThread() const override {
+        return m_ThreadPool.isWorkerThread();
+    }
+    bool runPendingTask() override { return m_ThreadPool.runPendingTask(); }
+
 private:
     CStaticThreadPool m_ThreadPool;
 };
@@ -106,6 +117,29 @@ private:
 };
 
 CExecutorHolder singletonExecutor;
+
+//! The name of the call site of parallel loops run by this thread.
+thread_local const char* parallelForEachCallSite{nullptr};
+
+//! The name used for parallel loops which run without a name.
+const char* const UNNAMED_CALL_SITE{"unnamed"};
+
+std::atomic_bool parallelForEachStatsEnabled{false};
+std::mutex parallelForEachStatsMutex;
+TStrParallelForEachStatsMap parallelForEachStatsByCallSite;
+
+//! The minimum time we aim for a task to spend on each chunk of a parallel
+//! loop. Claiming a chunk costs of order 100ns so this keeps the overhead
+//! of adaptive partitioning well below 1%.
+const double TARGET_SECONDS_PER_CHUNK{50e-6};
+
+//! The number of chunks each task gets for fixed partitioning.
+const std::size_t FIXED_CHUNKS_PER_TASK{4};
+
+std::uint64_t microseconds(std::chrono::steady_clock::duration duration) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
 }
 
 void startDefaultAsyncExecutor(std::size_t threadPoolSize,
@@ -134,6 +168,18 @@ CExecutor& defaultAsyncExecutor() {
 
 bool get_conjunction_of_all(std::vector<std::future<bool>>& futures) {
 
+    // Rather than blocking a worker in the pool, run pending tasks until there
+    // are none left. These include any scheduled by the caller which haven't
+    // been stolen by other workers, so this can't deadlock.
+    CExecutor& executor{defaultAsyncExecutor()};
+    if (executor.isWorkerThread()) {
+        for (auto& future : futures) {
+            while (future.wait_for(std::chrono::seconds{0}) != std::future_status::ready &&
+                   executor.runPendingTask()) {
+            }
+        }
+    }
+
     // This waits until results are present. If we get an exception we still want
     // to wait until all results are ready in case continuing destroys state access
     // which a worker thread reads. We just rethrow the _last_ exception we received.
@@ -157,7 +203,186 @@ bool get_conjunction_of_all(std::vector<std::future<bool>>& futures) {
     return result;
 }
 
+CScopedParallelForEachCallSite::CScopedParallelForEachCallSite(const char* name)
+    : m_PreviousName{parallelForEachCallSite} {
+    parallelForEachCallSite = name;
+}
+
+CScopedParallelForEachCallSite::~CScopedParallelForEachCallSite() {
+    parallelForEachCallSite = m_PreviousName;
+}
+
+void recordParallelForEachStats(bool enabled) {
+    parallelForEachStatsEnabled.store(enabled);
+}
+
+TStrParallelForEachStatsMap parallelForEachStats() {
+    std::scoped_lock<std::mutex> lock{parallelForEachStatsMutex};
+    return parallelForEachStatsByCallSite;
+}
+
+void resetParallelForEachStats() {
+    std::scoped_lock<std::mutex> lock{parallelForEachStatsMutex};
+    parallelForEachStatsByCallSite.clear();
+}
+
 namespace concurrency_detail {
+CPartitioner::CPartitioner(EPartition partition,
+                           std::size_t size,
+                           std::size_t numberTasks,
+                           const TProgressCallback& recordProgress)
+    : m_Partition{partition}, m_Size{size}, m_NumberTasks{std::max(numberTasks, std::size_t{1})},
+      m_ChunkSize{partition == EPartition::E_Fixed
+                      ? (m_Size + FIXED_CHUNKS_PER_TASK * m_NumberTasks - 1) /
+                            (FIXED_CHUNKS_PER_TASK * m_NumberTasks)
+                      : (m_Size + 2 * m_NumberTasks - 1) / (2 * m_NumberTasks)},
+      m_RecordProgress{recordProgress}, m_CallSite{parallelForEachCallSite},
+      m_RecordStats{parallelForEachStatsEnabled.load(std::memory_order_relaxed)},
+      m_Next{std::min(m_NumberTasks * m_ChunkSize, m_Size)} {
+    if (m_RecordStats) {
+        m_SchedulingThread = std::this_thread::get_id();
+        m_ScheduledByWorker = defaultAsyncExecutor().isWorkerThread();
+        m_Start = std::chrono::steady_clock::now();
+    }
+}
+
+CPartitioner::~CPartitioner() {
+    if (m_RecordStats == false) {
+        return;
+    }
+
+    std::uint64_t wallTime{microseconds(std::chrono::steady_clock::now() - m_Start)};
+    std::uint64_t availableTime{m_NumberTasks * wallTime};
+    std::uint64_t busyTime{std::min(m_BusyTime.load(), availableTime)};
+    std::string callSite{m_CallSite != nullptr ? m_CallSite : UNNAMED_CALL_SITE};
+
+    std::scoped_lock<std::mutex> lock{parallelForEachStatsMutex};
+    auto& stats = parallelForEachStatsByCallSite[callSite];
+    ++stats.s_Calls;
+    stats.s_Tasks += m_NumberTasks;
+    stats.s_StolenTasks += m_StolenTasks.load();
+    stats.s_Chunks += m_Chunks.load();
+    stats.s_WallTime += wallTime;
+    stats.s_BusyTime += busyTime;
+    stats.s_IdleTime += availableTime - busyTime;
+}
+
+bool CPartitioner::timed() const {
+    return m_RecordStats || m_Partition == EPartition::E_Adaptive;
+}
+
+bool CPartitioner::claim(std::size_t task,
+                         std::size_t numberClaims,
+                         double secondsPerIndex,
+                         std::size_t& begin,
+                         std::size_t& end) {
+
+    if (m_Stopped.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    // For fixed partitioning every chunk is assigned up front. For adaptive
+    // partitioning only each task's first chunk is.
+    if (m_Partition == EPartition::E_Fixed || numberClaims == 0) {
+        std::size_t chunk{m_Partition == EPartition::E_Fixed
+                              ? task + numberClaims * m_NumberTasks
+                              : task};
+        begin = chunk * m_ChunkSize;
+        end = std::min(begin + m_ChunkSize, m_Size);
+        if (begin < end) {
+            m_Chunks.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        if (m_Partition == EPartition::E_Fixed) {
+            return false;
+        }
+    }
+
+    std::size_t next{m_Next.load(std::memory_order_relaxed)};
+    if (next >= m_Size) {
+        return false;
+    }
+
+    // Take a fraction of what's left, as for guided self-scheduling, but never
+    // less than the grain needed to amortise the cost of claiming a chunk. We
+    // don't know the grain until we've timed at least one chunk.
+    std::size_t remaining{m_Size - next};
+    std::size_t grain{1};
+    if (secondsPerIndex > 0.0) {
+        grain = static_cast<std::size_t>(std::ceil(std::min(
+            TARGET_SECONDS_PER_CHUNK / secondsPerIndex, static_cast<double>(m_Size))));
+    }
+    std::size_t chunk{std::max(grain, (remaining + 2 * m_NumberTasks - 1) /
+                                          (2 * m_NumberTasks))};
+
+    begin = m_Next.fetch_add(chunk, std::memory_order_relaxed);
+    if (begin >= m_Size) {
+        return false;
+    }
+    end = std::min(begin + chunk, m_Size);
+    m_Chunks.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void CPartitioner::recordProgress(std::size_t processed) {
+    // Each task reports the steps it completes. Since the processed counts
+    // partition [0, m_Size) these always sum to exactly one.
+    std::size_t steps{std::min(m_Size, std::size_t{CLoopProgress::STEPS})};
+    std::size_t before{m_Processed.fetch_add(processed, std::memory_order_relaxed)};
+    std::size_t after{before + processed};
+    std::size_t completedSteps{steps * after / m_Size - steps * before / m_Size};
+    if (completedSteps > 0) {
+        m_RecordProgress(static_cast<double>(completedSteps) / static_cast<double>(steps));
+    }
+}
+
+CPartitioner::CTask::CTask(CPartitioner& partitioner, std::size_t task)
+    : m_Partitioner{partitioner}, m_PreviousCallSite{parallelForEachCallSite}, m_Task{task} {
+    // Loops run by this task are attributed to the same call site.
+    parallelForEachCallSite = partitioner.m_CallSite;
+    if (partitioner.m_RecordStats && partitioner.m_ScheduledByWorker &&
+        std::this_thread::get_id() != partitioner.m_SchedulingThread) {
+        partitioner.m_StolenTasks.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+CPartitioner::CTask::~CTask() {
+    if (m_Exhausted == false) {
+        // The loop body threw so there's no point in the other tasks carrying on.
+        m_Partitioner.m_Stopped.store(true);
+    }
+    if (m_Partitioner.m_RecordStats) {
+        m_Partitioner.m_BusyTime.fetch_add(m_BusyTime, std::memory_order_relaxed);
+    }
+    parallelForEachCallSite = m_PreviousCallSite;
+}
+
+bool CPartitioner::CTask::nextChunk(std::size_t& begin, std::size_t& end) {
+    bool timed{m_Partitioner.timed()};
+    auto now = timed ? std::chrono::steady_clock::now() : TTimePoint{};
+    if (m_ChunkSize > 0) {
+        if (timed) {
+            auto elapsed = now - m_ChunkStart;
+            m_BusyTime += microseconds(elapsed);
+            // Smooth the cost estimate since a single chunk can be unrepresentative.
+            double secondsPerIndex{std::chrono::duration<double>(elapsed).count() /
+                                   static_cast<double>(m_ChunkSize)};
+            m_SecondsPerIndex = m_SecondsPerIndex > 0.0
+                                    ? 0.5 * (m_SecondsPerIndex + secondsPerIndex)
+                                    : secondsPerIndex;
+        }
+        m_Partitioner.recordProgress(m_ChunkSize);
+    }
+    if (m_Partitioner.claim(m_Task, m_NumberClaims++, m_SecondsPerIndex, begin, end) == false) {
+        m_ChunkSize = 0;
+        m_Exhausted = true;
+        return false;
+    }
+    m_ChunkSize = end - begin;
+    m_ChunkStart = now;
+    return true;
+}
+
 CDefaultAsyncExecutorBusyForScope::CDefaultAsyncExecutorBusyForScope()
     : m_WasBusy{defaultAsyncExecutor().busy()} {
     if (m_WasBusy == false) {
@@ -175,6 +400,11 @@ bool CDefaultAsyncExecutorBusyForScope::wasBusy() const {
     return m_WasBusy;
 }
 
+bool CDefaultAsyncExecutorBusyForScope::runSequentially() const {
+    // Nested calls from the pool's workers are safe to run in parallel.
+    return m_WasBusy && defaultAsyncExecutor().isWorkerThread() == false;
+}
+
 void noop(double) {
 }
 }
@@ -10,16 +10,21 @@
  */
 
 #include <core/CConcurrentQueue.h>
+#include <core/CContainerPrinter.h>
 #include <core/CLogger.h>
 #include <core/Concurrency.h>
 
 #include <test/BoostTestCloseAbsolute.h>
+#include <test/CRandomNumbers.h>
 
 #include <boost/test/unit_test.hpp>
 
 #include <atomic>
+#include <chrono>
 #include <exception>
+#include <list>
 #include <numeric>
+#include <thread>
 #include <vector>
 
 BOOST_AUTO_TEST_SUITE(CConcurrencyTest)
@@ -29,6 +34,16 @@ using namespace ml;
 namespace {
 using TIntVec = std::vector<int>;
 using TIntVecVec = std::vector<TIntVec>;
+using TIntList = std::list<int>;
+using TSizeVec = std::vector<std::size_t>;
+using TSizeVecVec = std::vector<TSizeVec>;
+using TAtomicIntVec = std::vector<std::atomic_int>;
+
+struct SVisits {
+    std::size_t s_Count{0};
+    int s_Last{-1};
+    bool s_Increasing{true};
+};
 
 double throws() {
     throw std::runtime_error("don't run me");
@@ -408,4 +423,198 @@ BOOST_AUTO_TEST_CASE(testProgressMonitoring) {
     core::stopDefaultAsyncExecutor();
 }
 
+BOOST_AUTO_TEST_CASE(testParallelForEachUnevenCost) {
+
+    // Test that every index is visited exactly once and each function visits
+    // its indices in increasing order when the cost per index is very uneven,
+    // so the tasks must claim very different numbers of indices.
+
+    core::startDefaultAsyncExecutor(4);
+
+    std::size_t size{1000};
+    auto cost = [](int i) {
+        if (i < 20) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+    };
+
+    for (bool adaptive : {false, true}) {
+        LOG_DEBUG(<< "adaptive = " << adaptive);
+
+        TAtomicIntVec visited(size);
+        auto visit = [&] {
+            return core::bindRetrievableState(
+                [&](SVisits& visits, std::size_t i) {
+                    cost(static_cast<int>(i));
+                    ++visited[i];
+                    ++visits.s_Count;
+                    visits.s_Increasing &= (static_cast<int>(i) > visits.s_Last);
+                    visits.s_Last = static_cast<int>(i);
+                },
+                SVisits{});
+        };
+        auto results =
+            adaptive ? core::parallel_for_each_adaptively(std::size_t{0}, size, visit())
+                     : core::parallel_for_each(std::size_t{0}, size, visit());
+
+        BOOST_REQUIRE_EQUAL(4, results.size());
+        std::size_t count{0};
+        for (const auto& result : results) {
+            LOG_DEBUG(<< "visited " << result.s_FunctionState.s_Count);
+            BOOST_REQUIRE_EQUAL(true, result.s_FunctionState.s_Increasing);
+            count += result.s_FunctionState.s_Count;
+        }
+        BOOST_REQUIRE_EQUAL(size, count);
+        for (const auto& visits : visited) {
+            BOOST_REQUIRE_EQUAL(1, visits.load());
+        }
+    }
+
+    // Check a container whose iterators aren't random access.
+    {
+        TIntList values(size);
+        std::iota(values.begin(), values.end(), 0);
+        TAtomicIntVec visited(size);
+        auto results = core::parallel_for_each(
+            values.begin(), values.end(),
+            core::bindRetrievableState(
+                [&](SVisits& visits, int i) {
+                    cost(i);
+                    ++visited[i];
+                    ++visits.s_Count;
+                    visits.s_Increasing &= (i > visits.s_Last);
+                    visits.s_Last = i;
+                },
+                SVisits{}));
+
+        BOOST_REQUIRE_EQUAL(4, results.size());
+        std::size_t count{0};
+        for (const auto& result : results) {
+            BOOST_REQUIRE_EQUAL(true, result.s_FunctionState.s_Increasing);
+            count += result.s_FunctionState.s_Count;
+        }
+        BOOST_REQUIRE_EQUAL(size, count);
+        for (const auto& visits : visited) {
+            BOOST_REQUIRE_EQUAL(1, visits.load());
+        }
+    }
+
+    core::stopDefaultAsyncExecutor();
+}
+
+BOOST_AUTO_TEST_CASE(testParallelForEachReproducible) {
+
+    // Test that by default each function gets the same indices whatever the
+    // timing of the tasks, so order dependent reductions are reproducible, and
+    // that when partitioning adaptively every function gets a share of a small
+    // range.
+
+    core::startDefaultAsyncExecutor(4);
+
+    test::CRandomNumbers rng;
+
+    TSizeVec delays;
+    rng.generateUniformSamples(0, 3, 100, delays);
+
+    auto visit = [&] {
+        return core::bindRetrievableState(
+            [&](TSizeVec& indices, std::size_t i) {
+                std::this_thread::sleep_for(std::chrono::microseconds{100 * delays[i]});
+                indices.push_back(i);
+            },
+            TSizeVec{});
+    };
+
+    TSizeVecVec expectedIndices;
+    for (std::size_t t = 0; t < 5; ++t) {
+        rng.random_shuffle(delays.begin(), delays.end());
+        auto results = core::parallel_for_each(std::size_t{0}, delays.size(), visit());
+        TSizeVecVec indices;
+        for (const auto& result : results) {
+            indices.push_back(result.s_FunctionState);
+        }
+        if (t == 0) {
+            expectedIndices = std::move(indices);
+        } else {
+            BOOST_REQUIRE_EQUAL(core::CContainerPrinter::print(expectedIndices),
+                                core::CContainerPrinter::print(indices));
+        }
+    }
+
+    // Delay the start of the first task's first index so the other tasks
+    // would take all the work if they could.
+    for (std::size_t size : {4, 8, 20}) {
+        auto results = core::parallel_for_each_adaptively(
+            std::size_t{0}, size,
+            core::bindRetrievableState(
+                [](std::size_t& count, std::size_t i) {
+                    if (i == 0) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+                    }
+                    ++count;
+                },
+                std::size_t{0}));
+        BOOST_REQUIRE_EQUAL(4, results.size());
+        for (const auto& result : results) {
+            BOOST_TEST_REQUIRE(result.s_FunctionState > 0);
+        }
+    }
+
+    core::stopDefaultAsyncExecutor();
+}
+
+BOOST_AUTO_TEST_CASE(testParallelForEachStats) {
+
+    // Test that the statistics are recorded for the right call sites and
+    // that nested loops inherit the name of the loop which runs them.
+
+    core::startDefaultAsyncExecutor(4);
+    core::recordParallelForEachStats(true);
+    core::resetParallelForEachStats();
+
+    TIntVec values(100);
+    std::iota(values.begin(), values.end(), 0);
+
+    {
+        core::CScopedParallelForEachCallSite callSite{"outer"};
+        core::parallel_for_each(std::size_t{0}, std::size_t{4},
+                                [&](std::size_t) { parallelSum(values); });
+    }
+    parallelSum(values);
+
+    // Loops which run sequentially aren't recorded.
+    core::parallel_for_each(1, std::size_t{0}, values.size(), [](std::size_t) {});
+
+    auto stats = core::parallelForEachStats();
+    BOOST_REQUIRE_EQUAL(2, stats.size());
+    BOOST_REQUIRE_EQUAL(1, stats.count("outer"));
+    BOOST_REQUIRE_EQUAL(1, stats.count("unnamed"));
+
+    const auto& outer = stats["outer"];
+    const auto& unnamed = stats["unnamed"];
+    LOG_DEBUG(<< "outer: calls = " << outer.s_Calls << ", tasks = " << outer.s_Tasks
+              << ", stolen tasks = " << outer.s_StolenTasks << ", chunks = " << outer.s_Chunks
+              << ", wall time = " << outer.s_WallTime << ", busy time = "
+              << outer.s_BusyTime << ", idle time = " << outer.s_IdleTime);
+    BOOST_REQUIRE_EQUAL(5, outer.s_Calls);
+    BOOST_REQUIRE_EQUAL(20, outer.s_Tasks);
+    BOOST_TEST_REQUIRE(outer.s_StolenTasks <= 16);
+    BOOST_TEST_REQUIRE(outer.s_Chunks >= 5);
+    BOOST_REQUIRE_EQUAL(1, unnamed.s_Calls);
+    BOOST_REQUIRE_EQUAL(4, unnamed.s_Tasks);
+    BOOST_REQUIRE_EQUAL(0, unnamed.s_StolenTasks);
+    BOOST_TEST_REQUIRE(unnamed.s_Chunks >= 1);
+
+    core::resetParallelForEachStats();
+    BOOST_TEST_REQUIRE(core::parallelForEachStats().empty());
+
+    // Nothing is recorded if recording is off.
+    core::recordParallelForEachStats(false);
+    core::parallel_for_each(std::size_t{0}, std::size_t{4},
+                            [&](std::size_t) { parallelSum(values); });
+    BOOST_TEST_REQUIRE(core::parallelForEachStats().empty());
+
+    core::stopDefaultAsyncExecutor();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
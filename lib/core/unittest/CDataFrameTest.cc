@@ -15,6 +15,7 @@
 #include <core/CDataFrameRowSlice.h>
 #include <core/CFloatStorage.h>
 #include <core/CPackedBitVector.h>
+#include <core/CVectorRange.h>
 #include <core/Concurrency.h>
 
 #include <test/CRandomNumbers.h>
@@ -24,8 +25,13 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/unordered_map.hpp>
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <mutex>
+#include <string>
 #include <vector>
 
 BOOST_AUTO_TEST_SUITE(CDataFrameTest)
@@ -783,6 +789,113 @@ BOOST_FIXTURE_TEST_CASE(testDocHashes, CTestFixture) {
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(testParseRows, CTestFixture) {
+
+    // Test that parsing blocks of rows in parallel and then writing them gives
+    // the same data frame as parsing and writing one row at a time.
+
+    using TStrVec = std::vector<std::string>;
+    using TStrVecVec = std::vector<TStrVec>;
+    using TPtrdiffVec = std::vector<std::ptrdiff_t>;
+    using TInt32Vec = std::vector<std::int32_t>;
+
+    std::size_t rows{2000};
+    std::size_t cols{4};
+    std::size_t capacity{500};
+    std::size_t blockSize{300};
+
+    test::CRandomNumbers rng;
+
+    // The fields are the column values, followed by a document hash and a
+    // field we ignore. The second column is categorical.
+    TStrVecVec fieldValues(rows);
+    TDoubleVec uniform;
+    TSizeVec categories;
+    for (auto& fields : fieldValues) {
+        rng.generateUniformSamples(0.0, 1.0, cols + 1, uniform);
+        rng.generateUniformSamples(0, 5, 1, categories);
+        for (std::size_t i = 0; i < cols; ++i) {
+            if (uniform[i] < 0.05) {
+                fields.emplace_back(core::CDataFrame::DEFAULT_MISSING_STRING);
+            } else if (i == 1) {
+                fields.push_back(std::string(1, static_cast<char>('a' + categories[0])));
+            } else if (uniform[i] < 0.1) {
+                fields.emplace_back("bad");
+            } else {
+                fields.push_back(std::to_string(10.0 * uniform[i]));
+            }
+        }
+        fields.push_back(uniform[cols] < 0.05
+                             ? "bad"
+                             : std::to_string(static_cast<int>(1000.0 * uniform[cols])));
+        fields.emplace_back("ignored");
+    }
+
+    auto readRows = [](const core::CDataFrame& frame, TFloatVec& values, TInt32Vec& docHashes) {
+        frame.readRows(1, [&](const TRowItr& beginRows, const TRowItr& endRows) {
+            for (auto row = beginRows; row != endRows; ++row) {
+                for (std::size_t i = 0; i < row->numberColumns(); ++i) {
+                    values.push_back((*row)[i]);
+                }
+                docHashes.push_back(row->docHash());
+            }
+        });
+    };
+
+    TPtrdiffVec columnMap{3, 1, -1, 0};
+    for (const auto* map : {static_cast<TPtrdiffVec*>(nullptr), &columnMap}) {
+        LOG_DEBUG(<< "Testing with" << (map == nullptr ? "out" : "") << " column map");
+
+        auto expectedFrame = core::makeMainStorageDataFrame(cols, capacity).first;
+        auto frame = core::makeMainStorageDataFrame(cols, capacity).first;
+        expectedFrame->categoricalColumns(TBoolVec{false, true, false, false});
+        frame->categoricalColumns(TBoolVec{false, true, false, false});
+
+        for (const auto& fields : fieldValues) {
+            expectedFrame->parseAndWriteRow(core::make_const_range(fields, 0, cols),
+                                            map, &fields[cols]);
+        }
+        expectedFrame->finishWritingRows();
+
+        core::CDataFrame::SRowFieldLayout layout;
+        layout.s_BeginColumnValues = 0;
+        layout.s_EndColumnValues = cols;
+        layout.s_ColumnMap = map;
+        layout.s_DocHashField = static_cast<std::ptrdiff_t>(cols);
+        core::CDataFrame::SParsedRows parsed;
+        for (std::size_t i = 0; i < rows; i += blockSize) {
+            TStrVecVec block(fieldValues.begin() + i,
+                             fieldValues.begin() + std::min(i + blockSize, rows));
+            frame->parseRows(2, block, block.size(), layout, parsed);
+            frame->writeParsedRows(block, layout, parsed);
+        }
+        frame->finishWritingRows();
+
+        BOOST_REQUIRE_EQUAL(expectedFrame->numberRows(), frame->numberRows());
+        BOOST_REQUIRE_EQUAL(
+            core::CContainerPrinter::print(expectedFrame->categoricalColumnValues()),
+            core::CContainerPrinter::print(frame->categoricalColumnValues()));
+
+        TFloatVec expectedValues;
+        TFloatVec values;
+        TInt32Vec expectedDocHashes;
+        TInt32Vec docHashes;
+        readRows(*expectedFrame, expectedValues, expectedDocHashes);
+        readRows(*frame, values, docHashes);
+
+        BOOST_REQUIRE_EQUAL(expectedValues.size(), values.size());
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (core::CDataFrame::isMissing(expectedValues[i])) {
+                BOOST_TEST_REQUIRE(core::CDataFrame::isMissing(values[i]));
+            } else {
+                BOOST_REQUIRE_EQUAL(static_cast<double>(expectedValues[i]),
+                                    static_cast<double>(values[i]));
+            }
+        }
+        BOOST_TEST_REQUIRE(expectedDocHashes == docHashes);
+    }
+}
+
 BOOST_FIXTURE_TEST_CASE(testRowMask, CTestFixture) {
 
     // Test we read only the rows in a mask.
@@ -917,6 +1030,99 @@ BOOST_FIXTURE_TEST_CASE(testRowMask, CTestFixture) {
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(testRowMaskDensity, CTestFixture) {
+
+    // Test we read only the rows in dense and sparse masks. We index sparse
+    // masks and iterate dense masks' runs directly so this checks both.
+
+    std::size_t rows{10000};
+    std::size_t cols{5};
+    std::size_t capacity{500};
+    TFloatVec components{testData(rows, cols)};
+
+    auto frame = core::makeMainStorageDataFrame(cols, capacity).first;
+    for (std::size_t i = 0; i < components.size(); i += cols) {
+        frame->writeRow(makeWriter(components, cols, i));
+    }
+    frame->finishWritingRows();
+
+    test::CRandomNumbers rng;
+
+    TDoubleVec u01;
+    TSizeVec readRowsIndices;
+    TSizeVec rowMaskIndices;
+    for (auto density : {0.001, 0.01, 0.05, 0.2, 0.5, 0.9}) {
+        LOG_DEBUG(<< "density = " << density);
+
+        rng.generateUniformSamples(0.0, 1.0, rows, u01);
+        core::CPackedBitVector rowMask;
+        for (auto u : u01) {
+            rowMask.extend(u < density);
+        }
+        rowMaskIndices.assign(rowMask.beginOneBits(), rowMask.endOneBits());
+
+        core::data_frame_detail::CMaskedRows maskedRows{rowMask};
+        BOOST_REQUIRE_EQUAL(
+            density < core::data_frame_detail::CMaskedRows::MAXIMUM_FRACTION_TO_INDEX,
+            maskedRows.indexed());
+        BOOST_REQUIRE_EQUAL(core::CContainerPrinter::print(rowMaskIndices),
+                            core::CContainerPrinter::print(TSizeVec(
+                                maskedRows.begin(), maskedRows.end())));
+
+        for (auto numberThreads : {1, 4}) {
+            for (std::size_t beginRows : {0, 777}) {
+                std::size_t endRows{rows - beginRows};
+
+                auto results =
+                    frame
+                        ->readRows(
+                            numberThreads, beginRows, endRows,
+                            core::bindRetrievableState(
+                                [](TSizeVec& readerReadRowsIndices, const TRowItr& beginRows_,
+                                   const TRowItr& endRows_) mutable {
+                                    for (auto row = beginRows_; row != endRows_; ++row) {
+                                        readerReadRowsIndices.push_back(row->index());
+                                    }
+                                },
+                                TSizeVec{}),
+                            &rowMask)
+                        .first;
+
+                readRowsIndices.clear();
+                for (const auto& result : results) {
+                    readRowsIndices.insert(readRowsIndices.end(),
+                                           result.s_FunctionState.begin(),
+                                           result.s_FunctionState.end());
+                }
+                std::sort(readRowsIndices.begin(), readRowsIndices.end());
+
+                TSizeVec expectedIndices;
+                std::copy_if(rowMaskIndices.begin(), rowMaskIndices.end(),
+                             std::back_inserter(expectedIndices), [&](std::size_t i) {
+                                 return i >= beginRows && i < endRows;
+                             });
+
+                BOOST_REQUIRE_EQUAL(core::CContainerPrinter::print(expectedIndices),
+                                    core::CContainerPrinter::print(readRowsIndices));
+            }
+        }
+    }
+
+    // Check we don't index masks with row indices which don't fit in 32 bits.
+    core::CPackedBitVector rowMask;
+    rowMaskIndices.clear();
+    while (rowMask.size() <= std::numeric_limits<std::uint32_t>::max()) {
+        rowMask.extend(false, std::size_t{1} << 29);
+        rowMaskIndices.push_back(rowMask.size());
+        rowMask.extend(true);
+    }
+    core::data_frame_detail::CMaskedRows maskedRows{rowMask};
+    BOOST_REQUIRE_EQUAL(false, maskedRows.indexed());
+    BOOST_REQUIRE_EQUAL(core::CContainerPrinter::print(rowMaskIndices),
+                        core::CContainerPrinter::print(TSizeVec(maskedRows.begin(),
+                                                                maskedRows.end())));
+}
+
 BOOST_FIXTURE_TEST_CASE(testAlignment, CTestFixture) {
 
     // Test all the rows have the requested alignment.
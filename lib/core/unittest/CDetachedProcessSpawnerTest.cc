@@ -105,6 +105,30 @@ BOOST_AUTO_TEST_CASE(testKill) {
     BOOST_TEST_REQUIRE(!spawner.terminateChild(static_cast<ml::core::CProcess::TPid>(-1)));
 }
 
+BOOST_AUTO_TEST_CASE(testKillWithUnavailableZygote) {
+    // The process doesn't support running as a zygote, so the spawner should
+    // fall back to starting it from scratch and it should still be possible
+    // to kill it
+
+    ml::core::CDetachedProcessSpawner::TStrVec permittedPaths(1, PROCESS_PATH2);
+    ml::core::CDetachedProcessSpawner spawner(permittedPaths, permittedPaths);
+
+    ml::core::CDetachedProcessSpawner::TStrVec args(
+        PROCESS_ARGS2, PROCESS_ARGS2 + std::size(PROCESS_ARGS2));
+
+    for (std::size_t i = 0; i < 2; ++i) {
+        ml::core::CProcess::TPid childPid = 0;
+        BOOST_TEST_REQUIRE(spawner.spawn(PROCESS_PATH2, args, childPid));
+
+        BOOST_TEST_REQUIRE(spawner.hasChild(childPid));
+        BOOST_TEST_REQUIRE(spawner.terminateChild(childPid));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        BOOST_TEST_REQUIRE(!spawner.hasChild(childPid));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testPermitted) {
     ml::core::CDetachedProcessSpawner::TStrVec permittedPaths(1, PROCESS_PATH1);
     ml::core::CDetachedProcessSpawner spawner(permittedPaths);
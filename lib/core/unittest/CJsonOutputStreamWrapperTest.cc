@@ -69,6 +69,48 @@ BOOST_AUTO_TEST_CASE(testConcurrentWrites) {
     BOOST_REQUIRE_EQUAL(std::size_t(WRITERS * DOCUMENTS_PER_WRITER), allRecords.size());
 }
 
+BOOST_AUTO_TEST_CASE(testWriteAsync) {
+    // Check that objects formatted on the output thread are correctly delimited
+    // and ordered with respect to other writes.
+
+    std::ostringstream stringStream;
+    {
+        ml::core::CJsonOutputStreamWrapper wrapper(stringStream);
+        ml::core::CBoostJsonConcurrentLineWriter writer(wrapper);
+
+        writer.onObjectBegin();
+        writer.onKey("id");
+        writer.onInt(0);
+        writer.onObjectEnd();
+
+        auto written = wrapper.writeAsync([](ml::core::CStringBufWriter& asyncWriter) {
+            for (int i = 1; i < 4; ++i) {
+                asyncWriter.onObjectBegin();
+                asyncWriter.onKey("id");
+                asyncWriter.onInt(i);
+                asyncWriter.onObjectEnd();
+            }
+        });
+
+        writer.onObjectBegin();
+        writer.onKey("id");
+        writer.onInt(4);
+        writer.onObjectEnd();
+
+        written.wait();
+    }
+
+    json::error_code ec;
+    json::value doc = json::parse(stringStream.str(), ec);
+    BOOST_TEST_REQUIRE(ec.failed() == false);
+
+    const json::array& allRecords = doc.as_array();
+    BOOST_REQUIRE_EQUAL(std::size_t{5}, allRecords.size());
+    for (std::size_t i = 0; i < allRecords.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(i, allRecords[i].as_object().at("id").to_number<std::size_t>());
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testShrink) {
     std::ostringstream stringStream;
     ml::core::CJsonOutputStreamWrapper wrapper(stringStream);
@@ -12,6 +12,7 @@
 #include <core/CLogger.h>
 #include <core/CNamedPipeFactory.h>
 #include <core/COsFileFuncs.h>
+#include <core/CPipeReadBuffer.h>
 #include <core/CThread.h>
 
 #include <test/CThreadDataReader.h>
@@ -21,7 +22,9 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <cstdio>
+#include <iterator>
 #include <thread>
 
 #ifndef Windows
@@ -99,6 +102,34 @@ BOOST_AUTO_TEST_CASE(testServerIsCppReader) {
     strm.reset();
 }
 
+BOOST_AUTO_TEST_CASE(testReadBufferCapacity) {
+    // Check pipes get a small read buffer unless they ask for a larger one.
+
+    for (auto capacity : {std::size_t{0}, ml::core::CPipeReadBuffer::HUGE_PAGE_CAPACITY}) {
+        ml::test::CThreadDataWriter threadWriter{SLEEP_TIME_MS, TEST_PIPE_NAME,
+                                                 TEST_CHAR, TEST_SIZE};
+        BOOST_TEST_REQUIRE(threadWriter.start());
+
+        std::atomic_bool dummy{false};
+        ml::core::CNamedPipeFactory::TIStreamP strm{
+            capacity == 0
+                ? ml::core::CNamedPipeFactory::openPipeStreamRead(TEST_PIPE_NAME, dummy)
+                : ml::core::CNamedPipeFactory::openPipeStreamRead(TEST_PIPE_NAME, dummy, capacity)};
+        BOOST_TEST_REQUIRE(strm);
+
+        const auto* buffer = dynamic_cast<const ml::core::CPipeReadBuffer*>(strm->rdbuf());
+        BOOST_TEST_REQUIRE(buffer != nullptr);
+        BOOST_REQUIRE_EQUAL(capacity == 0 ? ml::core::CPipeReadBuffer::DEFAULT_CAPACITY : capacity,
+                            buffer->capacity());
+
+        std::string readData{std::istreambuf_iterator<char>{*strm},
+                             std::istreambuf_iterator<char>{}};
+        BOOST_REQUIRE_EQUAL(std::string(TEST_SIZE, TEST_CHAR), readData);
+
+        BOOST_TEST_REQUIRE(threadWriter.waitForFinish());
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testServerIsCReader) {
     ml::test::CThreadDataWriter threadWriter{SLEEP_TIME_MS, TEST_PIPE_NAME,
                                              TEST_CHAR, TEST_SIZE};
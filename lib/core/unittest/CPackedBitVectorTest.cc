@@ -598,6 +598,43 @@ BOOST_AUTO_TEST_CASE(testOneBitIterators) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testOneBitIteratorAdvanceTo) {
+
+    // Test advancing to the first one bit at or after an index matches
+    // incrementing there one bit at a time.
+
+    test::CRandomNumbers rng;
+
+    TSizeVec components;
+    TSizeVec indices;
+    for (std::size_t t = 0; t < 100; ++t) {
+        rng.generateUniformSamples(0, 2, 512, components);
+        TBoolVec bits(components.begin(), components.end());
+        // Add some long runs.
+        std::fill_n(bits.begin() + 100, 100, false);
+        std::fill_n(bits.begin() + 300, 100, true);
+        core::CPackedBitVector test{bits};
+
+        rng.generateUniformSamples(0, bits.size() + 10, 20, indices);
+        std::sort(indices.begin(), indices.end());
+
+        auto actual = test.beginOneBits();
+        for (auto index : indices) {
+            auto expected = test.beginOneBits();
+            while (expected != test.endOneBits() && *expected < index) {
+                ++expected;
+            }
+            actual.advanceTo(index);
+            BOOST_TEST_REQUIRE((actual == expected));
+            if (actual != test.endOneBits()) {
+                BOOST_REQUIRE_EQUAL(*expected, *actual);
+            }
+        }
+        actual.advanceTo(bits.size());
+        BOOST_TEST_REQUIRE((actual == test.endOneBits()));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testInnerProductBitwiseAnd) {
 
     core::CPackedBitVector test1(10, true);
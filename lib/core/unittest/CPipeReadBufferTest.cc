@@ -0,0 +1,170 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <core/CLogger.h>
+#include <core/CPipeReadBuffer.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef Windows
+#include <unistd.h>
+#endif
+
+BOOST_AUTO_TEST_SUITE(CPipeReadBufferTest)
+
+using namespace ml;
+
+namespace {
+using TStrVec = std::vector<std::string>;
+using TPipeHandle = core::CPipeReadBuffer::TPipeHandle;
+
+//! Create an anonymous pipe returning its read and write ends.
+void makePipe(TPipeHandle& readHandle, TPipeHandle& writeHandle) {
+#ifdef Windows
+    BOOST_TEST_REQUIRE(CreatePipe(&readHandle, &writeHandle, nullptr, 0) != FALSE);
+#else
+    int handles[2];
+    BOOST_TEST_REQUIRE(::pipe(handles) == 0);
+    readHandle = handles[0];
+    writeHandle = handles[1];
+#endif
+}
+
+void writePipe(TPipeHandle handle, const char* data, std::size_t size) {
+#ifdef Windows
+    DWORD written{0};
+    WriteFile(handle, data, static_cast<DWORD>(size), &written, nullptr);
+#else
+    while (size > 0) {
+        ssize_t written{::write(handle, data, size)};
+        if (written <= 0) {
+            return;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+#endif
+}
+
+void closePipe(TPipeHandle handle) {
+#ifdef Windows
+    CloseHandle(handle);
+#else
+    ::close(handle);
+#endif
+}
+
+TStrVec makeLines() {
+    // Include lines much longer than the test buffer capacity.
+    TStrVec lines;
+    for (std::size_t i = 0; i < 200; ++i) {
+        std::size_t length{i % 50 == 49 ? 1000 : i % 17};
+        lines.emplace_back(length, static_cast<char>('a' + i % 26));
+    }
+    return lines;
+}
+
+//! Write the lines to the pipe in small chunks, pausing now and then,
+//! so the reader sees the data arrive piecemeal.
+std::thread startWriter(const TStrVec& lines, TPipeHandle handle) {
+    return std::thread{[&lines, handle] {
+        std::string data;
+        for (const auto& line : lines) {
+            data += line + '\n';
+        }
+        for (std::size_t i = 0; i < data.size(); i += 37) {
+            writePipe(handle, data.data() + i, std::min(std::size_t{37}, data.size() - i));
+            if (i % 10 == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        closePipe(handle);
+    }};
+}
+}
+
+BOOST_AUTO_TEST_CASE(testInPlaceParsing) {
+
+    // Check we can tokenise the data in the buffer, consuming it as we go,
+    // and that the buffer grows for lines which don't fit.
+
+    TStrVec lines{makeLines()};
+    TPipeHandle readHandle;
+    TPipeHandle writeHandle;
+    makePipe(readHandle, writeHandle);
+    std::thread writer{startWriter(lines, writeHandle)};
+
+    core::CPipeReadBuffer buffer{readHandle, 64};
+
+    TStrVec read;
+    std::size_t numberFills{0};
+    for (;;) {
+        char* begin{buffer.unreadBegin()};
+        char* end{buffer.unreadEnd()};
+        char* delim{static_cast<char*>(std::memchr(begin, '\n', end - begin))};
+        if (delim != nullptr) {
+            read.emplace_back(begin, delim);
+            buffer.consume(delim + 1);
+        } else if (buffer.fill() == 0) {
+            break;
+        } else {
+            ++numberFills;
+        }
+    }
+    writer.join();
+
+    LOG_DEBUG(<< "fills = " << numberFills << ", capacity = " << buffer.capacity());
+
+    BOOST_TEST_REQUIRE(buffer.eof());
+    BOOST_TEST_REQUIRE(buffer.bad() == false);
+    BOOST_REQUIRE_EQUAL(0, buffer.unreadEnd() - buffer.unreadBegin());
+    BOOST_TEST_REQUIRE(buffer.capacity() >= 1001);
+    BOOST_REQUIRE_EQUAL(lines.size(), read.size());
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(lines[i], read[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testStreamInterface) {
+
+    // Check the buffer works with the standard stream functions.
+
+    TStrVec lines{makeLines()};
+    TPipeHandle readHandle;
+    TPipeHandle writeHandle;
+    makePipe(readHandle, writeHandle);
+    std::thread writer{startWriter(lines, writeHandle)};
+
+    core::CPipeReadStream strm{readHandle, 64};
+
+    TStrVec read;
+    std::string line;
+    while (std::getline(strm, line)) {
+        read.push_back(line);
+    }
+    writer.join();
+
+    BOOST_TEST_REQUIRE(strm.eof());
+    BOOST_TEST_REQUIRE(strm.bad() == false);
+    BOOST_REQUIRE_EQUAL(lines.size(), read.size());
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(lines[i], read[i]);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -21,6 +21,7 @@
 #include <atomic>
 #include <chrono>
 #include <mutex>
+#include <set>
 #include <thread>
 
 BOOST_AUTO_TEST_SUITE(CStaticThreadPoolTest)
@@ -262,4 +263,63 @@ BOOST_AUTO_TEST_CASE(testNumberThreadsInUse) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testNestedTasks) {
+
+    // Check that tasks which schedule and wait for other tasks don't deadlock,
+    // even when every worker is waiting, and that the nested tasks are stolen
+    // by the other workers.
+
+    using TThreadIdSet = std::set<std::thread::id>;
+
+    std::atomic_uint counter{0};
+    std::atomic_bool allOnWorkers{true};
+    std::mutex mutex;
+    TThreadIdSet nestedThreads;
+    std::size_t poolSize{0};
+    {
+        core::CStaticThreadPool pool{4};
+        poolSize = pool.numberThreadsInUse();
+        BOOST_REQUIRE_EQUAL(false, pool.isWorkerThread());
+        BOOST_REQUIRE_EQUAL(false, pool.runPendingTask());
+
+        for (std::size_t i = 0; i < 20; ++i) {
+            pool.schedule([&] {
+                if (pool.isWorkerThread() == false) {
+                    allOnWorkers.store(false);
+                }
+                std::atomic_uint nested{0};
+                for (std::size_t j = 0; j < 50; ++j) {
+                    pool.schedule([&] {
+                        {
+                            std::scoped_lock<std::mutex> lock{mutex};
+                            nestedThreads.insert(std::this_thread::get_id());
+                        }
+                        fastTask(nested);
+                    });
+                }
+                while (nested.load() < 50) {
+                    if (pool.runPendingTask() == false) {
+                        std::this_thread::yield();
+                    }
+                }
+                counter += nested.load();
+            });
+        }
+
+        // Wait rather than relying on the destructor, which runs any tasks
+        // left in the queues on this thread.
+        while (counter.load() < 1000) {
+            std::this_thread::yield();
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL(1000, counter.load());
+    BOOST_REQUIRE_EQUAL(true, allOnWorkers.load());
+    LOG_DEBUG(<< "nested tasks ran on " << nestedThreads.size() << " threads");
+    // The pool size is capped at the hardware concurrency.
+    if (poolSize > 1) {
+        BOOST_TEST_REQUIRE(nestedThreads.size() > 1);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -405,4 +405,148 @@ BOOST_AUTO_TEST_CASE(testPositionalWeightedEditDistance) {
     BOOST_REQUIRE_EQUAL(23, sst.weightedEditDistance(serviceStart, empty));
     BOOST_REQUIRE_EQUAL(23, sst.weightedEditDistance(empty, serviceStart));
 }
+
+BOOST_AUTO_TEST_CASE(testBoundedWeightedEditDistance) {
+    ml::core::CStringSimilarityTester sst;
+
+    using TStrSizePr = std::pair<std::string, size_t>;
+    using TStrSizePrVec = std::vector<TStrSizePr>;
+
+    TStrSizePrVec sourceShutDown1{
+        {"ml13", 1},   {"4608.1.p2ps", 1}, {"Info", 3},
+        {"Source", 3}, {"ML_SERVICE2", 1}, {"on", 3},
+        {"has", 3},    {"shut", 3},        {"down", 3}};
+    TStrSizePrVec serviceStart{
+        {"ml13", 1},    {"4606.1.p2ps", 1}, {"Info", 3},
+        {"Service", 3}, {"ML_FEED", 1},     {"id", 3},
+        {"of", 3},      {"has", 3},         {"started", 3}};
+    TStrSizePrVec empty;
+
+    // The distance is 17 so we should get it exactly for bounds of at least
+    // 17 and bound + 1 otherwise.
+    for (size_t bound = 0; bound < 50; ++bound) {
+        size_t expected(bound >= 17 ? 17 : bound + 1);
+        BOOST_REQUIRE_EQUAL(expected, sst.weightedEditDistance(sourceShutDown1,
+                                                               serviceStart, bound));
+        BOOST_REQUIRE_EQUAL(expected, sst.weightedEditDistance(serviceStart,
+                                                               sourceShutDown1, bound));
+    }
+
+    BOOST_REQUIRE_EQUAL(0, sst.weightedEditDistance(serviceStart, serviceStart, 0));
+    BOOST_REQUIRE_EQUAL(21, sst.weightedEditDistance(serviceStart, empty, 21));
+    BOOST_REQUIRE_EQUAL(21, sst.weightedEditDistance(empty, serviceStart, 20));
+    BOOST_REQUIRE_EQUAL(0, sst.weightedEditDistance(empty, empty, 0));
+
+    // Check against the unbounded calculation for random sequences.  Equal
+    // tokens can have different weights and weights can be zero, as they
+    // can be with positional weighting.
+    using TSizeSizePr = std::pair<size_t, size_t>;
+    using TSizeSizePrVec = std::vector<TSizeSizePr>;
+
+    for (size_t test = 0; test < 10000; ++test) {
+        TSizeSizePrVec first(::rand() % 15);
+        TSizeSizePrVec second(::rand() % 15);
+        for (auto& token : first) {
+            token = TSizeSizePr(::rand() % 6, ::rand() % 4);
+        }
+        for (auto& token : second) {
+            token = TSizeSizePr(::rand() % 6, ::rand() % 4);
+        }
+        size_t bound(::rand() % 30);
+
+        size_t distance(sst.weightedEditDistance(first, second));
+        size_t boundedDistance(sst.weightedEditDistance(first, second, bound));
+        if (distance <= bound) {
+            BOOST_REQUIRE_EQUAL(distance, boundedDistance);
+        } else {
+            BOOST_REQUIRE_EQUAL(bound + 1, boundedDistance);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testBoundedWeightedEditDistanceThroughput) {
+    ml::core::CStringSimilarityTester sst;
+
+    using TSizeSizePr = std::pair<size_t, size_t>;
+    using TSizeSizePrVec = std::vector<TSizeSizePr>;
+    using TSizeSizePrVecVec = std::vector<TSizeSizePrVec>;
+
+    // Simulate tokenised log messages: a handful of message templates made
+    // up of dictionary words, which have weight 3, each with a few variable
+    // tokens, which have weight 1.  This is the typical workload when a
+    // message is compared against existing categories.
+
+    static const size_t NUMBER_TEMPLATES(50);
+    static const size_t MESSAGES_PER_TEMPLATE(20);
+    static const size_t MAX_WORDS(25);
+    static const size_t NUMBER_WORDS(500);
+    static const double THRESHOLD(0.7);
+
+    TSizeSizePrVecVec messages;
+    for (size_t i = 0; i < NUMBER_TEMPLATES; ++i) {
+        TSizeSizePrVec words(5 + ::rand() % (MAX_WORDS - 5));
+        for (auto& word : words) {
+            word = TSizeSizePr(::rand() % NUMBER_WORDS, 3);
+        }
+        for (size_t j = 0; j < MESSAGES_PER_TEMPLATE; ++j) {
+            TSizeSizePrVec message;
+            for (const auto& word : words) {
+                message.push_back(word);
+                if (::rand() % 4 == 0) {
+                    message.emplace_back(NUMBER_WORDS + ::rand() % 10000, 1);
+                }
+            }
+            messages.push_back(std::move(message));
+        }
+    }
+
+    TSizeSizePrVec weights;
+    for (const auto& message : messages) {
+        size_t weight(0);
+        for (const auto& token : message) {
+            weight += token.second;
+        }
+        weights.emplace_back(weight, static_cast<size_t>((1.0 - THRESHOLD) * weight));
+    }
+
+    ml::core_t::TTime start(ml::core::CTimeUtils::now());
+    LOG_INFO(<< "Starting unbounded weighted edit distance throughput test at "
+             << ml::core::CTimeUtils::toTimeString(start));
+
+    size_t matches(0);
+    for (size_t i = 0; i < messages.size(); ++i) {
+        for (size_t j = 0; j < messages.size(); ++j) {
+            size_t bound(weights[i].second);
+            if (sst.weightedEditDistance(messages[i], messages[j]) <= bound) {
+                ++matches;
+            }
+        }
+    }
+
+    ml::core_t::TTime end(ml::core::CTimeUtils::now());
+    LOG_INFO(<< "Unbounded weighted edit distance throughput test for "
+             << messages.size() << " messages took " << (end - start) << " seconds");
+
+    start = ml::core::CTimeUtils::now();
+    LOG_INFO(<< "Starting bounded weighted edit distance throughput test at "
+             << ml::core::CTimeUtils::toTimeString(start));
+
+    size_t boundedMatches(0);
+    for (size_t i = 0; i < messages.size(); ++i) {
+        for (size_t j = 0; j < messages.size(); ++j) {
+            size_t bound(weights[i].second);
+            if (sst.weightedEditDistance(messages[i], messages[j], bound) <= bound) {
+                ++boundedMatches;
+            }
+        }
+    }
+
+    end = ml::core::CTimeUtils::now();
+    LOG_INFO(<< "Bounded weighted edit distance throughput test for "
+             << messages.size() << " messages took " << (end - start) << " seconds");
+
+    BOOST_REQUIRE_EQUAL(matches, boundedMatches);
+    BOOST_TEST_REQUIRE(matches >= messages.size());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -15,10 +15,13 @@
 #include <core/CStringUtils.h>
 
 #include <test/BoostTestCloseAbsolute.h>
+#include <test/CRandomNumbers.h>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <charconv>
+#include <cmath>
 #include <cstdint>
 #include <set>
 #include <vector>
@@ -30,6 +33,8 @@ BOOST_TEST_DONT_PRINT_LOG_VALUE(std::wstring)
 
 BOOST_AUTO_TEST_SUITE(CStringUtilsTest)
 
+using TDoubleVec = std::vector<double>;
+
 void testTokeniserHelper(const std::string& delim, const std::string& str) {
     // Tokenise using ml
     ml::core::CStringUtils::TStrVec tokens;
@@ -313,6 +318,50 @@ BOOST_AUTO_TEST_CASE(testTypeToStringPrecise) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testTypeToStringPreciseShortest) {
+
+    // Test double precision values are written using the shortest string which
+    // reads back to the same value and that writing to a buffer agrees with
+    // writing to a string.
+
+#if defined(__cpp_lib_to_chars)
+    BOOST_REQUIRE_EQUAL("0.1", ml::core::CStringUtils::typeToStringPrecise(
+                                   0.1, ml::core::CIEEE754::E_DoublePrecision));
+    BOOST_REQUIRE_EQUAL("1e-5", ml::core::CStringUtils::typeToStringPrecise(
+                                    1e-5, ml::core::CIEEE754::E_DoublePrecision));
+    BOOST_REQUIRE_EQUAL("1.5e-300", ml::core::CStringUtils::typeToStringPrecise(
+                                        1.5e-300, ml::core::CIEEE754::E_DoublePrecision));
+    BOOST_REQUIRE_EQUAL("123456.789", ml::core::CStringUtils::typeToStringPrecise(
+                                          123456.789, ml::core::CIEEE754::E_DoublePrecision));
+#endif
+
+    ml::test::CRandomNumbers rng;
+
+    TDoubleVec mantissas;
+    TDoubleVec exponents;
+    rng.generateUniformSamples(-1.0, 1.0, 10000, mantissas);
+    rng.generateUniformSamples(-300.0, 300.0, 10000, exponents);
+
+    char buffer[ml::core::CStringUtils::MAX_PRECISE_STRING_LENGTH];
+
+    for (std::size_t i = 0; i < mantissas.size(); ++i) {
+        double value{std::ldexp(mantissas[i], static_cast<int>(exponents[i]))};
+        for (auto precision : {ml::core::CIEEE754::E_HalfPrecision,
+                               ml::core::CIEEE754::E_SinglePrecision,
+                               ml::core::CIEEE754::E_DoublePrecision}) {
+            std::string string{ml::core::CStringUtils::typeToStringPrecise(value, precision)};
+            std::size_t length{ml::core::CStringUtils::typeToStringPrecise(
+                value, precision, buffer)};
+            BOOST_REQUIRE_EQUAL(string, std::string(buffer, length));
+
+            double restored;
+            BOOST_TEST_REQUIRE(ml::core::CStringUtils::stringToType(string, restored));
+            BOOST_REQUIRE_EQUAL(ml::core::CIEEE754::round(value, precision),
+                                ml::core::CIEEE754::round(restored, precision));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testTypeToStringPretty) {
     LOG_DEBUG(<< "1.0 -> " << ml::core::CStringUtils::typeToStringPretty(1.0));
     BOOST_TEST_REQUIRE(ml::core::CStringUtils::typeToStringPretty(1.0) == "1");
@@ -905,6 +954,40 @@ BOOST_AUTO_TEST_CASE(testPerformance, *boost::unit_test::disabled()) {
         LOG_DEBUG(<< "After boost::lexical_cast floating point test");
         LOG_DEBUG(<< "boost::lexical_cast floating point test took " << timeMs << "ms");
     }
+
+    stopWatch.reset();
+
+    {
+        LOG_DEBUG(<< "Before CStringUtils::typeToStringPrecise round trip test");
+        stopWatch.start();
+        for (double count = 0.0; count < TEST_SIZE_D; count += 1.41) {
+            double value{count / 3.0};
+            std::string result(ml::core::CStringUtils::typeToStringPrecise(
+                value, ml::core::CIEEE754::E_DoublePrecision));
+            ml::core::CStringUtils::stringToType(result, value);
+        }
+        std::uint64_t timeMs(stopWatch.stop());
+        LOG_DEBUG(<< "After CStringUtils::typeToStringPrecise round trip test");
+        LOG_DEBUG(<< "CStringUtils::typeToStringPrecise round trip test took "
+                  << timeMs << "ms");
+    }
+
+    stopWatch.reset();
+
+    {
+        LOG_DEBUG(<< "Before CStringUtils::typeToStringPrecise buffer test");
+        char buffer[ml::core::CStringUtils::MAX_PRECISE_STRING_LENGTH];
+        std::size_t length{0};
+        stopWatch.start();
+        for (double count = 0.0; count < TEST_SIZE_D; count += 1.41) {
+            length += ml::core::CStringUtils::typeToStringPrecise(
+                count / 3.0, ml::core::CIEEE754::E_DoublePrecision, buffer);
+        }
+        std::uint64_t timeMs(stopWatch.stop());
+        LOG_DEBUG(<< "After CStringUtils::typeToStringPrecise buffer test");
+        LOG_DEBUG(<< "CStringUtils::typeToStringPrecise buffer test took " << timeMs
+                  << "ms, total length " << length);
+    }
 }
 
 BOOST_AUTO_TEST_CASE(testUtf8ByteType) {
@@ -15,6 +15,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <string>
+#include <string_view>
+
 BOOST_AUTO_TEST_SUITE(CWordDictionaryTest)
 
 BOOST_AUTO_TEST_CASE(testLookups) {
@@ -34,6 +37,28 @@ BOOST_AUTO_TEST_CASE(testLookups) {
     BOOST_TEST_REQUIRE(!dict.isInDictionary("HELLO2"));
 }
 
+BOOST_AUTO_TEST_CASE(testLookupsFromViews) {
+    const ml::core::CWordDictionary& dict = ml::core::CWordDictionary::instance();
+
+    // Words which are prefixes or extensions of dictionary words must not be
+    // found and views into the middle of other strings must work.
+    std::string sentence{"helloq Service has hasq started startedzz hel hell"};
+    std::string_view view{sentence};
+    BOOST_TEST_REQUIRE(!dict.isInDictionary(view.substr(0, 6)));
+    BOOST_TEST_REQUIRE(dict.isInDictionary(view.substr(0, 5)));
+    BOOST_TEST_REQUIRE(dict.isInDictionary(view.substr(7, 7)));
+    BOOST_TEST_REQUIRE(!dict.isInDictionary(view.substr(7, 8)));
+    BOOST_TEST_REQUIRE(dict.isInDictionary(view.substr(15, 3)));
+    BOOST_TEST_REQUIRE(!dict.isInDictionary(view.substr(19, 4)));
+    BOOST_TEST_REQUIRE(!dict.isInDictionary(view.substr(15, 7)));
+    BOOST_TEST_REQUIRE(dict.isInDictionary(view.substr(24, 7)));
+    BOOST_TEST_REQUIRE(!dict.isInDictionary(view.substr(32, 9)));
+    BOOST_TEST_REQUIRE(!dict.isInDictionary(view.substr(42, 3)));
+    BOOST_TEST_REQUIRE(dict.isInDictionary(view.substr(46, 4)));
+    BOOST_REQUIRE_EQUAL(ml::core::CWordDictionary::E_Verb,
+                        dict.partOfSpeech(view.substr(24, 7)));
+}
+
 BOOST_AUTO_TEST_CASE(testPartOfSpeech) {
     const ml::core::CWordDictionary& dict = ml::core::CWordDictionary::instance();
 
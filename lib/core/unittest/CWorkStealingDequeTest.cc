@@ -0,0 +1,130 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <core/CLogger.h>
+#include <core/CWorkStealingDeque.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(CWorkStealingDequeTest)
+
+using namespace ml;
+
+namespace {
+using TIntVec = std::vector<int>;
+using TAtomicIntVec = std::vector<std::atomic_int>;
+using TThreadVec = std::vector<std::thread>;
+}
+
+BOOST_AUTO_TEST_CASE(testSingleThread) {
+
+    // Check the owner gets items back last in first out, thieves get them
+    // first in first out and the capacity is respected.
+
+    TIntVec items{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    core::CWorkStealingDeque<int> deque{5};
+    BOOST_REQUIRE_EQUAL(8, deque.capacity());
+    BOOST_TEST_REQUIRE(deque.empty());
+    BOOST_TEST_REQUIRE(deque.pop() == nullptr);
+    BOOST_TEST_REQUIRE(deque.steal() == nullptr);
+
+    for (std::size_t i = 0; i < 8; ++i) {
+        BOOST_TEST_REQUIRE(deque.push(&items[i]));
+    }
+    BOOST_TEST_REQUIRE(deque.push(&items[8]) == false);
+    BOOST_TEST_REQUIRE(deque.empty() == false);
+
+    BOOST_REQUIRE_EQUAL(7, *deque.pop());
+    BOOST_REQUIRE_EQUAL(0, *deque.steal());
+    BOOST_REQUIRE_EQUAL(1, *deque.steal());
+    BOOST_REQUIRE_EQUAL(6, *deque.pop());
+
+    // Check we can wrap around the buffer.
+    for (std::size_t i = 8; i < 10; ++i) {
+        BOOST_TEST_REQUIRE(deque.push(&items[i]));
+    }
+    BOOST_REQUIRE_EQUAL(9, *deque.pop());
+    BOOST_REQUIRE_EQUAL(2, *deque.steal());
+    BOOST_REQUIRE_EQUAL(8, *deque.pop());
+    BOOST_REQUIRE_EQUAL(5, *deque.pop());
+    BOOST_REQUIRE_EQUAL(4, *deque.pop());
+    BOOST_REQUIRE_EQUAL(3, *deque.steal());
+    BOOST_TEST_REQUIRE(deque.pop() == nullptr);
+    BOOST_TEST_REQUIRE(deque.steal() == nullptr);
+    BOOST_TEST_REQUIRE(deque.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testConcurrentSteal) {
+
+    // Check that with one owner pushing and popping and many thieves every
+    // item is taken exactly once.
+
+    const int numberItems{200000};
+    const std::size_t numberThieves{4};
+
+    TIntVec items(numberItems);
+    TAtomicIntVec taken(numberItems);
+    for (int i = 0; i < numberItems; ++i) {
+        items[i] = i;
+        taken[i].store(0);
+    }
+
+    core::CWorkStealingDeque<int> deque{64};
+    std::atomic_bool done{false};
+    std::atomic_int numberStolen{0};
+
+    auto take = [&](int* item) { ++taken[*item]; };
+
+    TThreadVec thieves;
+    for (std::size_t i = 0; i < numberThieves; ++i) {
+        thieves.emplace_back([&] {
+            while (done.load() == false || deque.empty() == false) {
+                if (int* item = deque.steal()) {
+                    take(item);
+                    ++numberStolen;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < numberItems; ++i) {
+        while (deque.push(&items[i]) == false) {
+            if (int* item = deque.pop()) {
+                take(item);
+            }
+        }
+        if (i % 3 == 0) {
+            if (int* item = deque.pop()) {
+                take(item);
+            }
+        }
+    }
+    while (int* item = deque.pop()) {
+        take(item);
+    }
+    done.store(true);
+
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+
+    LOG_DEBUG(<< "stolen = " << numberStolen.load());
+    for (int i = 0; i < numberItems; ++i) {
+        BOOST_REQUIRE_EQUAL(1, taken[i].load());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
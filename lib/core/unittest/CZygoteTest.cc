@@ -0,0 +1,168 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <core/CStringUtils.h>
+#include <core/CZygote.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <string>
+
+#ifndef Windows
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+BOOST_AUTO_TEST_SUITE(CZygoteTest)
+
+using namespace ml;
+
+BOOST_AUTO_TEST_CASE(testNotRequested) {
+    // The command line should be left alone if zygote mode isn't requested.
+
+    std::string prog{"prog"};
+    std::string arg{"--zygote"};
+    char* args[]{&prog[0], &arg[0], nullptr};
+    int argc{2};
+    char** argv{args};
+    bool initialised{false};
+
+    core::CZygote::serveIfRequested(argc, argv, [&] { initialised = true; });
+
+    BOOST_REQUIRE_EQUAL(2, argc);
+    BOOST_TEST_REQUIRE(argv == args);
+    BOOST_TEST_REQUIRE(initialised == false);
+}
+
+#ifndef Windows
+namespace {
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS{MSG_NOSIGNAL};
+#else
+const int SEND_FLAGS{0};
+#endif
+
+//! Run \p test in a forked child so only the child becomes a subreaper and
+//! check it succeeds. \p test can't use the Boost.Test macros, so it returns
+//! false on failure instead.
+template<typename TEST>
+void runInChild(const TEST& test) {
+    core::CProcess::TPid pid{::fork()};
+    BOOST_TEST_REQUIRE(pid != -1);
+    if (pid == 0) {
+        ::_exit(test() ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    int status{0};
+    BOOST_REQUIRE_EQUAL(pid, ::waitpid(pid, &status, 0));
+    BOOST_TEST_REQUIRE(WIFEXITED(status));
+    BOOST_REQUIRE_EQUAL(EXIT_SUCCESS, WEXITSTATUS(status));
+}
+}
+
+BOOST_AUTO_TEST_CASE(testRequestChild) {
+    // Check that children are started with the requested command line and
+    // that they're adopted by the process which requested them.
+
+    if (core::CZygote::isSupported() == false) {
+        return;
+    }
+
+    runInChild([] {
+        if (core::CZygote::becomeSubreaper() == false) {
+            return false;
+        }
+
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            return false;
+        }
+
+        core::CProcess::TPid zygotePid{::fork()};
+        if (zygotePid == -1) {
+            return false;
+        }
+        if (zygotePid == 0) {
+            ::close(fds[0]);
+            std::string prog{"zygote"};
+            std::string arg{core::CZygote::ZYGOTE_ARG_PREFIX +
+                            core::CStringUtils::typeToString(fds[1])};
+            char* args[]{&prog[0], &arg[0], nullptr};
+            int argc{2};
+            char** argv{args};
+            int initialised{0};
+            core::CZygote::serveIfRequested(argc, argv, [&] { ++initialised; });
+
+            // Only children get here: report what they were started with.
+            int status{initialised == 1 && argc == 3 && std::string{argv[0]} == "child" &&
+                               std::string{argv[2]} == "b" && argv[3] == nullptr
+                           ? std::atoi(argv[1])
+                           : 100};
+            ::_exit(status);
+        }
+        ::close(fds[1]);
+
+        for (int i = 1; i < 4; ++i) {
+            core::CProcess::TPid childPid{0};
+            if (core::CZygote::requestChild(fds[0], {"child", core::CStringUtils::typeToString(i), "b"},
+                                            childPid) != core::CZygote::E_ChildStarted ||
+                childPid == zygotePid) {
+                return false;
+            }
+
+            int status{0};
+            if (::waitpid(childPid, &status, 0) != childPid ||
+                WIFEXITED(status) == false || WEXITSTATUS(status) != i) {
+                return false;
+            }
+        }
+
+        // The zygote should exit when its socket is closed.
+        ::close(fds[0]);
+        int status{0};
+        return ::waitpid(zygotePid, &status, 0) == zygotePid &&
+               WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+    });
+}
+
+BOOST_AUTO_TEST_CASE(testNoReply) {
+    // Check that a request which is sent, but not replied to, is reported
+    // as such and that the socket is then shut down.
+
+    if (core::CZygote::isSupported() == false) {
+        return;
+    }
+
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    struct timeval timeout;
+    ::memset(&timeout, 0, sizeof(struct timeval));
+    timeout.tv_usec = 100000;
+    BOOST_REQUIRE_EQUAL(0, ::setsockopt(fds[0], SOL_SOCKET, SO_RCVTIMEO,
+                                        &timeout, sizeof(timeout)));
+
+    core::CProcess::TPid childPid{0};
+    BOOST_REQUIRE_EQUAL(core::CZygote::E_NoReply,
+                        core::CZygote::requestChild(fds[0], {"child"}, childPid));
+
+    // A late reply can't be delivered.
+    core::CProcess::TPid pid{1};
+    BOOST_REQUIRE_EQUAL(-1, ::send(fds[1], &pid, sizeof(pid), SEND_FLAGS));
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
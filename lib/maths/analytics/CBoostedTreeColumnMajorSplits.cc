@@ -0,0 +1,78 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <maths/analytics/CBoostedTreeColumnMajorSplits.h>
+
+#include <core/CDataFrame.h>
+#include <core/CMemoryDefStd.h>
+#include <core/CPackedBitVector.h>
+
+#include <maths/analytics/CBoostedTreeLeafNodeStatistics.h>
+#include <maths/analytics/CBoostedTreeUtils.h>
+
+#include <algorithm>
+
+namespace ml {
+namespace maths {
+namespace analytics {
+using namespace boosted_tree_detail;
+using TRowItr = core::CDataFrame::TRowItr;
+
+void CBoostedTreeColumnMajorSplits::refresh(std::size_t numberThreads,
+                                            const core::CDataFrame& frame,
+                                            const TSizeVec& extraColumns,
+                                            const TBoolVec& featureMask,
+                                            const core::CPackedBitVector& rowMask) {
+
+    std::size_t numberFeatures{featureMask.size()};
+
+    m_Columns.resize(numberFeatures);
+    for (std::size_t i = 0; i < numberFeatures; ++i) {
+        if (featureMask[i]) {
+            m_Columns[i].resize(frame.numberRows());
+        } else {
+            TUInt8Vec{}.swap(m_Columns[i]);
+        }
+    }
+
+    // Each row is read by exactly one thread so the threads write disjoint
+    // elements of each column.
+    frame.readRows(numberThreads, 0, frame.numberRows(),
+                   [&](const TRowItr& beginRows, const TRowItr& endRows) {
+                       for (auto row_ = beginRows; row_ != endRows; ++row_) {
+                           auto row = *row_;
+                           std::size_t index{row.index()};
+                           const auto* splits = beginSplits(row, extraColumns);
+                           for (std::size_t i = 0; i < numberFeatures; ++splits) {
+                               auto packedSplits = CPackedUInt8Decorator{*splits}.readBytes();
+                               for (std::size_t j = 0;
+                                    j < packedSplits.size() && i < numberFeatures; ++i, ++j) {
+                                   if (featureMask[i]) {
+                                       m_Columns[i][index] = packedSplits[j];
+                                   }
+                               }
+                           }
+                       }
+                   },
+                   &rowMask);
+}
+
+bool CBoostedTreeColumnMajorSplits::hasColumns(const TSizeVec& features) const {
+    return std::all_of(features.begin(), features.end(),
+                       [this](std::size_t feature) { return this->hasColumn(feature); });
+}
+
+std::size_t CBoostedTreeColumnMajorSplits::memoryUsage() const {
+    return core::memory::dynamicSize(m_Columns);
+}
+}
+}
+}
@@ -24,6 +24,7 @@
 #include <core/RestoreMacros.h>
 
 #include <maths/analytics/CBoostedTree.h>
+#include <maths/analytics/CBoostedTreeColumnMajorSplits.h>
 #include <maths/analytics/CBoostedTreeFactory.h>
 #include <maths/analytics/CBoostedTreeLeafNodeStatistics.h>
 #include <maths/analytics/CBoostedTreeLeafNodeStatisticsIncremental.h>
@@ -70,6 +71,8 @@ const std::string TRAIN_FINAL_FOREST{"train_final_forest"};
 const double BYTES_IN_MB{static_cast<double>(core::constants::BYTES_IN_MEGABYTES)};
 const double MAXIMUM_SAMPLE_SIZE_FOR_QUANTILES{50000.0};
 const std::size_t LOSS_ESTIMATION_BOOTSTRAP_SIZE{5};
+//! The largest feature bag fraction for which we use column major splits.
+const double MAXIMUM_FEATURE_BAG_FRACTION_FOR_COLUMN_MAJOR_SPLITS{0.5};
 CDataFrameTrainBoostedTreeInstrumentationStub INSTRUMENTATION_STUB;
 
 //! \brief Record the memory used by a supplied object using the RAII idiom.
@@ -709,6 +712,15 @@ std::size_t CBoostedTreeImpl::estimateMemoryUsageForTraining(std::size_t numberR
                                      maximumNumberFeatures, m_NumberSplitsPerFeature,
                                      m_Loss->dimensionGradient()) /
                                  2};
+    // If the feature bag is small we keep a column major copy of the rows' split
+    // indices which uses one byte per row for each feature. Unless the feature
+    // bag fraction is fixed it can be tuned to a value for which we do.
+    const auto& featureBagFraction = m_Hyperparameters.featureBagFraction();
+    std::size_t columnMajorSplitsMemoryUsage{
+        featureBagFraction.fixed() == false ||
+                featureBagFraction.value() <= MAXIMUM_FEATURE_BAG_FRACTION_FOR_COLUMN_MAJOR_SPLITS
+            ? numberRows * maximumNumberFeatures
+            : 0};
     std::size_t categoryEncoderMemoryUsage{sizeof(CDataFrameCategoryEncoder)};
     std::size_t dataTypeMemoryUsage{
         core::memory::dynamicSize(TDataTypeVec(maximumNumberFeatures))};
@@ -729,7 +741,8 @@ std::size_t CBoostedTreeImpl::estimateMemoryUsageForTraining(std::size_t numberR
 
     std::size_t worstCaseMemoryUsage{
         sizeof(*this) + forestMemoryUsage + foldRoundLossMemoryUsage +
-        hyperparametersMemoryUsage + leafNodeStatisticsMemoryUsage + categoryEncoderMemoryUsage +
+        hyperparametersMemoryUsage + leafNodeStatisticsMemoryUsage +
+        columnMajorSplitsMemoryUsage + categoryEncoderMemoryUsage +
         dataTypeMemoryUsage + featureSampleProbabilitiesMemoryUsage +
         fixedCandidateSplitsMemoryUsage + missingFeatureMaskMemoryUsage +
         newTrainingRowMaskMemoryUsage + trainTestMaskMemoryUsage};
@@ -1215,6 +1228,9 @@ CBoostedTreeImpl::trainForest(core::CDataFrame& frame,
     CTrainingLossCurveStats lossCurveStats{
         m_Hyperparameters.maximumNumberTrees().value(), minTestLoss};
     TWorkspace workspace{m_Loss->dimensionGradient()};
+    CBoostedTreeColumnMajorSplits columnMajorSplits;
+    this->refreshColumnMajorSplits(frame, trainingRowMask, columnMajorSplits, workspace);
+    scopeMemoryUsage.add(columnMajorSplits);
 
     // For each iteration:
     //  1. Periodically compute weighted quantiles for features F and candidate
@@ -1268,9 +1284,12 @@ CBoostedTreeImpl::trainForest(core::CDataFrame& frame,
 
         if (forceRefreshSplits || forest.size() == nextTreeCountToRefreshSplits) {
             scopeMemoryUsage.remove(candidateSplits);
+            scopeMemoryUsage.remove(columnMajorSplits);
             candidateSplits = this->candidateSplits(frame, downsampledRowMask);
             this->refreshSplitsCache(frame, candidateSplits, featuresToRefresh, trainingRowMask);
+            this->refreshColumnMajorSplits(frame, trainingRowMask, columnMajorSplits, workspace);
             scopeMemoryUsage.add(candidateSplits);
+            scopeMemoryUsage.add(columnMajorSplits);
             nextTreeCountToRefreshSplits += minimumSplitRefreshInterval(
                 eta, std::count_if(featuresToRefresh.begin(), featuresToRefresh.end(),
                                    [](auto refresh) { return refresh; }));
@@ -1359,6 +1378,7 @@ CBoostedTreeImpl::updateForest(core::CDataFrame& frame,
     scopeMemoryUsage.add(testLosses);
 
     TWorkspace workspace{m_Loss->dimensionGradient()};
+    CBoostedTreeColumnMajorSplits columnMajorSplits;
 
     // The exact sequence of operations in this loop is important. For each
     // iteration:
@@ -1401,9 +1421,12 @@ CBoostedTreeImpl::updateForest(core::CDataFrame& frame,
 
         if (retrainedTrees.size() == nextTreeCountToRefreshSplits) {
             scopeMemoryUsage.remove(candidateSplits);
+            scopeMemoryUsage.remove(columnMajorSplits);
             candidateSplits = this->candidateSplits(frame, downsampledRowMask);
             this->refreshSplitsCache(frame, candidateSplits, featuresToRefresh, trainingRowMask);
+            this->refreshColumnMajorSplits(frame, trainingRowMask, columnMajorSplits, workspace);
             scopeMemoryUsage.add(candidateSplits);
+            scopeMemoryUsage.add(columnMajorSplits);
             nextTreeCountToRefreshSplits += minimumSplitRefreshInterval(
                 eta, std::count_if(featuresToRefresh.begin(), featuresToRefresh.end(),
                                    [](auto refresh) { return refresh; }));
@@ -1694,6 +1717,28 @@ void CBoostedTreeImpl::refreshSplitsCache(core::CDataFrame& frame,
         &trainingRowMask);
 }
 
+void CBoostedTreeImpl::refreshColumnMajorSplits(const core::CDataFrame& frame,
+                                                const core::CPackedBitVector& trainingRowMask,
+                                                CBoostedTreeColumnMajorSplits& splits,
+                                                TWorkspace& workspace) const {
+    // Reading the split indices from the data frame touches the indices of
+    // every feature. If we only aggregate derivatives for a small fraction
+    // of the features it is much cheaper to stream their indices from a
+    // column major copy.
+    if (m_Hyperparameters.featureBagFraction().value() >
+        MAXIMUM_FEATURE_BAG_FRACTION_FOR_COLUMN_MAJOR_SPLITS) {
+        workspace.columnMajorSplits(nullptr);
+        return;
+    }
+
+    TBoolVec featureMask(m_FeatureSampleProbabilities.size());
+    for (std::size_t i = 0; i < featureMask.size(); ++i) {
+        featureMask[i] = m_FeatureSampleProbabilities[i] > 0.0;
+    }
+    splits.refresh(m_NumberThreads, frame, m_ExtraColumns, featureMask, trainingRowMask);
+    workspace.columnMajorSplits(&splits);
+}
+
 CBoostedTreeImpl::TNodeVec
 CBoostedTreeImpl::trainTree(core::CDataFrame& frame,
                             const core::CPackedBitVector& trainingRowMask,
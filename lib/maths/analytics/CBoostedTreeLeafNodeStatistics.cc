@@ -14,8 +14,10 @@
 #include <core/CDataFrame.h>
 #include <core/CLogger.h>
 #include <core/CMemoryDefStd.h>
+#include <core/Concurrency.h>
 
 #include <maths/analytics/CBoostedTree.h>
+#include <maths/analytics/CBoostedTreeColumnMajorSplits.h>
 #include <maths/analytics/CBoostedTreeUtils.h>
 #include <maths/analytics/CDataFrameCategoryEncoder.h>
 #include <maths/analytics/CDataFrameUtils.h>
@@ -34,6 +36,71 @@ namespace analytics {
 using namespace boosted_tree_detail;
 using TRowItr = core::CDataFrame::TRowItr;
 
+namespace {
+using TSplitsDerivatives = CBoostedTreeLeafNodeStatistics::CSplitsDerivatives;
+using TMemoryMappedFloatVector = CBoostedTreeLeafNodeStatistics::TMemoryMappedFloatVector;
+using TWorkspace = CBoostedTreeLeafNodeStatistics::CWorkspace;
+
+//! \brief A batch of rows whose loss derivatives are added to the split
+//! derivatives one feature at a time.
+//!
+//! DESCRIPTION:\n
+//! This reads the split indices from column major storage. Adding a feature
+//! at a time means we only touch the columns of features in the bag and we
+//! update one feature's derivatives buckets at a time. The batch is small
+//! enough that the rows' derivatives stay in cache between features.
+class CRowBatch {
+public:
+    static constexpr std::size_t CAPACITY{256};
+
+public:
+    CRowBatch() {
+        m_Indices.reserve(CAPACITY);
+        m_Derivatives.reserve(CAPACITY);
+    }
+
+    bool full() const { return m_Indices.size() == CAPACITY; }
+
+    void add(std::size_t index, core::CFloatStorage* derivatives) {
+        m_Indices.push_back(index);
+        m_Derivatives.push_back(derivatives);
+    }
+
+    //! Add the rows' derivatives to \p splitsDerivatives and clear the batch.
+    //!
+    //! \note This must be called before the rows' storage is released.
+    void flush(const TSizeVec& featureBag,
+               const CBoostedTreeColumnMajorSplits& splits,
+               int numberDerivatives,
+               TSplitsDerivatives& splitsDerivatives) {
+        for (auto feature : featureBag) {
+            const auto* column = splits.column(feature);
+            for (std::size_t i = 0; i < m_Indices.size(); ++i) {
+                splitsDerivatives.addDerivatives(
+                    feature, static_cast<std::size_t>(column[m_Indices[i]]),
+                    TMemoryMappedFloatVector{m_Derivatives[i], numberDerivatives});
+            }
+        }
+        m_Indices.clear();
+        m_Derivatives.clear();
+    }
+
+private:
+    using TFloatStoragePtrVec = std::vector<core::CFloatStorage*>;
+
+private:
+    TSizeVec m_Indices;
+    TFloatStoragePtrVec m_Derivatives;
+};
+
+//! Get the column major split indices to use for \p featureBag if any.
+const CBoostedTreeColumnMajorSplits*
+columnMajorSplitsFor(const TSizeVec& featureBag, const TWorkspace& workspace) {
+    const auto* splits = workspace.columnMajorSplits();
+    return splits != nullptr && splits->hasColumns(featureBag) ? splits : nullptr;
+}
+}
+
 bool CBoostedTreeLeafNodeStatistics::operator<(const CBoostedTreeLeafNodeStatistics& rhs) const {
     return common::COrderings::lexicographicalCompare(m_BestSplit, m_Id,
                                                       rhs.m_BestSplit, rhs.m_Id);
@@ -175,19 +242,43 @@ void CBoostedTreeLeafNodeStatistics::computeAggregateLossDerivativesWith(
 
     workspace.newLeaf(numberThreads);
 
+    const auto* columnMajorSplits = columnMajorSplitsFor(featureBag, workspace);
+    int numberDerivatives{static_cast<int>(
+        m_DimensionGradient + lossHessianUpperTriangleSize(m_DimensionGradient))};
+
     core::CDataFrame::TRowFuncVec aggregators;
     aggregators.reserve(numberThreads);
 
     for (std::size_t i = 0; i < numberThreads; ++i) {
         auto& splitsDerivatives = workspace.derivatives()[i];
         splitsDerivatives.zero();
-        aggregators.emplace_back([&](const TRowItr& beginRows, const TRowItr& endRows) {
-            for (auto row = beginRows; row != endRows; ++row) {
-                this->addRowDerivatives(bound, featureBag, *row, splitsDerivatives);
-            }
-        });
+        if (columnMajorSplits != nullptr) {
+            aggregators.emplace_back([&, batch = CRowBatch{}](
+                const TRowItr& beginRows, const TRowItr& endRows) mutable {
+                for (auto row_ = beginRows; row_ != endRows; ++row_) {
+                    auto row = *row_;
+                    auto derivatives = readLossDerivatives(row, m_ExtraColumns,
+                                                           m_DimensionGradient);
+                    addBoundDerivatives(bound, derivatives, splitsDerivatives);
+                    batch.add(row.index(), derivatives.data());
+                    if (batch.full()) {
+                        batch.flush(featureBag, *columnMajorSplits,
+                                    numberDerivatives, splitsDerivatives);
+                    }
+                }
+                batch.flush(featureBag, *columnMajorSplits, numberDerivatives,
+                            splitsDerivatives);
+            });
+        } else {
+            aggregators.emplace_back([&](const TRowItr& beginRows, const TRowItr& endRows) {
+                for (auto row = beginRows; row != endRows; ++row) {
+                    this->addRowDerivatives(bound, featureBag, *row, splitsDerivatives);
+                }
+            });
+        }
     }
 
+    core::CScopedParallelForEachCallSite callSite{"leaf_node_aggregate_loss_derivatives"};
     frame.readRows(0, frame.numberRows(), aggregators, &rowMask);
 }
 
@@ -204,6 +295,10 @@ void CBoostedTreeLeafNodeStatistics::computeRowMaskAndAggregateLossDerivativesWi
 
     workspace.newLeaf(numberThreads);
 
+    const auto* columnMajorSplits = columnMajorSplitsFor(featureBag, workspace);
+    int numberDerivatives{static_cast<int>(
+        m_DimensionGradient + lossHessianUpperTriangleSize(m_DimensionGradient))};
+
     core::CDataFrame::TRowFuncVec aggregators;
     aggregators.reserve(numberThreads);
 
@@ -212,19 +307,44 @@ void CBoostedTreeLeafNodeStatistics::computeRowMaskAndAggregateLossDerivativesWi
         auto& splitsDerivatives = workspace.derivatives()[i];
         mask.clear();
         splitsDerivatives.zero();
-        aggregators.emplace_back([&](const TRowItr& beginRows, const TRowItr& endRows) {
-            for (auto row_ = beginRows; row_ != endRows; ++row_) {
-                auto row = *row_;
-                if (split.assignToLeft(row, m_ExtraColumns) == isLeftChild) {
-                    std::size_t index{row.index()};
-                    mask.extend(false, index - mask.size());
-                    mask.extend(true);
-                    this->addRowDerivatives(bound, featureBag, row, splitsDerivatives);
+        if (columnMajorSplits != nullptr) {
+            aggregators.emplace_back([&, batch = CRowBatch{}](
+                const TRowItr& beginRows, const TRowItr& endRows) mutable {
+                for (auto row_ = beginRows; row_ != endRows; ++row_) {
+                    auto row = *row_;
+                    if (split.assignToLeft(row, m_ExtraColumns) == isLeftChild) {
+                        std::size_t index{row.index()};
+                        mask.extend(false, index - mask.size());
+                        mask.extend(true);
+                        auto derivatives = readLossDerivatives(row, m_ExtraColumns,
+                                                               m_DimensionGradient);
+                        addBoundDerivatives(bound, derivatives, splitsDerivatives);
+                        batch.add(index, derivatives.data());
+                        if (batch.full()) {
+                            batch.flush(featureBag, *columnMajorSplits,
+                                        numberDerivatives, splitsDerivatives);
+                        }
+                    }
                 }
-            }
-        });
+                batch.flush(featureBag, *columnMajorSplits, numberDerivatives,
+                            splitsDerivatives);
+            });
+        } else {
+            aggregators.emplace_back([&](const TRowItr& beginRows, const TRowItr& endRows) {
+                for (auto row_ = beginRows; row_ != endRows; ++row_) {
+                    auto row = *row_;
+                    if (split.assignToLeft(row, m_ExtraColumns) == isLeftChild) {
+                        std::size_t index{row.index()};
+                        mask.extend(false, index - mask.size());
+                        mask.extend(true);
+                        this->addRowDerivatives(bound, featureBag, row, splitsDerivatives);
+                    }
+                }
+            });
+        }
     }
 
+    core::CScopedParallelForEachCallSite callSite{"leaf_node_aggregate_loss_derivatives"};
     frame.readRows(0, frame.numberRows(), aggregators, &parentRowMask);
 }
 
@@ -235,13 +355,7 @@ void CBoostedTreeLeafNodeStatistics::addRowDerivatives(CLookAheadBound,
 
     auto derivatives = readLossDerivatives(row, m_ExtraColumns, m_DimensionGradient);
 
-    if (derivatives.size() == 2) {
-        if (derivatives(0) >= 0.0) {
-            splitsDerivatives.addPositiveDerivatives(derivatives);
-        } else {
-            splitsDerivatives.addNegativeDerivatives(derivatives);
-        }
-    }
+    addBoundDerivatives(CLookAheadBound{}, derivatives, splitsDerivatives);
 
     const auto* splits = beginSplits(row, m_ExtraColumns);
     for (auto feature : featureBag) {
@@ -266,6 +380,18 @@ void CBoostedTreeLeafNodeStatistics::addRowDerivatives(CNoLookAheadBound,
     }
 }
 
+void CBoostedTreeLeafNodeStatistics::addBoundDerivatives(CLookAheadBound,
+                                                         const TMemoryMappedFloatVector& derivatives,
+                                                         CSplitsDerivatives& splitsDerivatives) {
+    if (derivatives.size() == 2) {
+        if (derivatives(0) >= 0.0) {
+            splitsDerivatives.addPositiveDerivatives(derivatives);
+        } else {
+            splitsDerivatives.addNegativeDerivatives(derivatives);
+        }
+    }
+}
+
 CBoostedTreeLeafNodeStatistics::SSplitStatistics&
 CBoostedTreeLeafNodeStatistics::bestSplitStatistics() {
     return m_BestSplit;
@@ -238,7 +238,12 @@ CBoostedTreeLeafNodeStatisticsIncremental::computeBestSplitStatistics(
             this->featureBestSplitSearch(regularization, splitStats[i]));
     }
 
-    core::parallel_for_each(featureBag.begin(), featureBag.end(), featureBestSplitSearches);
+    // The cost of searching features varies a lot and the best split is the
+    // maximum with respect to a total order so it doesn't depend on which task
+    // searches which feature.
+    core::CScopedParallelForEachCallSite callSite{"leaf_node_best_split_search"};
+    core::parallel_for_each_adaptively(featureBag.begin(), featureBag.end(),
+                                       featureBestSplitSearches);
 
     SSplitStatistics result;
     for (std::size_t i = 0; i < numberThreads; ++i) {
@@ -262,18 +262,6 @@ TPackedBitVectorVec complementRowMasks(const TPackedBitVectorVec& foldRowMasks,
     return complementFoldRowMasks;
 }
 
-//! Get a row feature sampler.
-template<typename TARGET>
-auto rowFeatureSampler(std::size_t i, const TARGET& target, TFloatVecVec& samples) {
-    return [i, &target, &samples](std::size_t slot, const TRowRef& row) {
-        if (slot >= samples.size()) {
-            samples.resize(slot + 1, {0.0, 0.0});
-        }
-        samples[slot][0] = row[i];
-        samples[slot][1] = target(row);
-    };
-}
-
 //! Get a row sampler.
 auto rowSampler(TFloatVecVec& samples) {
     return [&samples](std::size_t slot, const TRowRef& row) {
@@ -288,7 +276,7 @@ template<typename TARGET>
 auto computeEncodedCategory(CMic& mic,
                             const TARGET& target,
                             TSizeEncoderPtrUMap& encoders,
-                            TFloatVecVec& samples) {
+                            const TFloatVecVec& samples) {
 
     CDataFrameUtils::TSizeDoublePrVec encodedMics;
     encodedMics.reserve(encoders.size());
@@ -883,153 +871,37 @@ CDataFrameUtils::categoricalMicWithColumn(const CColumnValue& target,
         return none;
     }
 
-    auto method = frame.inMainMemory() ? categoricalMicWithColumnDataFrameInMemory
-                                       : categoricalMicWithColumnDataFrameOnDisk;
-
     TDoubleVecVec frequencies(categoryFrequencies(numberThreads, frame, rowMask, columnMask));
     LOG_TRACE(<< "frequencies = " << frequencies);
 
-    TSizeDoublePrVecVecVec mics(
-        method(target, frame, rowMask, columnMask, encoderFactories, frequencies,
-               std::min(NUMBER_SAMPLES_TO_COMPUTE_MIC, frame.numberRows())));
-
-    for (auto& encoderMics : mics) {
-        for (auto& categoryMics : encoderMics) {
-            std::sort(categoryMics.begin(), categoryMics.end(),
-                      [](const TSizeDoublePr& lhs, const TSizeDoublePr& rhs) {
-                          return common::COrderings::lexicographicalCompare(
-                              -lhs.second, lhs.first, -rhs.second, rhs.first);
-                      });
-        }
-    }
-
-    return mics;
-}
-
-CDataFrameUtils::TDoubleVec
-CDataFrameUtils::metricMicWithColumn(const CColumnValue& target,
-                                     const core::CDataFrame& frame,
-                                     const core::CPackedBitVector& rowMask,
-                                     TSizeVec columnMask) {
-
-    TDoubleVec zeros(frame.numberColumns(), 0.0);
-
-    removeCategoricalColumns(frame, columnMask);
-    if (frame.numberRows() == 0 || columnMask.empty()) {
-        return zeros;
-    }
-
-    auto method = frame.inMainMemory() ? metricMicWithColumnDataFrameInMemory
-                                       : metricMicWithColumnDataFrameOnDisk;
-
-    return method(target, frame, rowMask, columnMask,
-                  std::min(NUMBER_SAMPLES_TO_COMPUTE_MIC, frame.numberRows()));
-}
-
-CDataFrameUtils::TDoubleVector
-CDataFrameUtils::maximumMinimumRecallClassWeights(std::size_t numberThreads,
-                                                  const core::CDataFrame& frame,
-                                                  const core::CPackedBitVector& rowMask,
-                                                  std::size_t numberClasses,
-                                                  std::size_t targetColumn,
-                                                  const TReadPredictionFunc& readPrediction) {
-
-    return numberClasses == 2
-               ? maximizeMinimumRecallForBinary(numberThreads, frame, rowMask,
-                                                targetColumn, readPrediction)
-               : maximizeMinimumRecallForMulticlass(numberThreads, frame, rowMask, numberClasses,
-                                                    targetColumn, readPrediction);
-}
-
-bool CDataFrameUtils::isMissing(double value) {
-    return core::CDataFrame::isMissing(value);
-}
-
-CDataFrameUtils::TSizeDoublePrVecVecVec CDataFrameUtils::categoricalMicWithColumnDataFrameInMemory(
-    const CColumnValue& target,
-    const core::CDataFrame& frame,
-    const core::CPackedBitVector& rowMask,
-    const TSizeVec& columnMask,
-    const TEncoderFactoryVec& encoderFactories,
-    const TDoubleVecVec& frequencies,
-    std::size_t numberSamples) {
-
-    TSizeDoublePrVecVecVec encoderMics;
-    encoderMics.reserve(encoderFactories.size());
+    // Sample
+    //
+    // We use one sample of the rows for all encoders and columns so we only
+    // need to read the frame once. The law of large numbers means we have a
+    // high probability of sampling each category provided minimumFrequency *
+    // NUMBER_SAMPLES_TO_COMPUTE_MIC is large (which we ensure it is).
 
+    std::size_t numberSamples{std::min(NUMBER_SAMPLES_TO_COMPUTE_MIC, frame.numberRows())};
     TFloatVecVec samples;
-    TSizeEncoderPtrUMap encoders;
-    CMic mic;
     samples.reserve(numberSamples);
-    mic.reserve(numberSamples);
-
-    for (const auto& encoderFactory : encoderFactories) {
-
-        TEncoderFactory makeEncoder;
-        double minimumFrequency;
-        std::tie(makeEncoder, minimumFrequency) = encoderFactory;
-
-        TSizeDoublePrVecVec mics(frame.numberColumns());
-
-        for (auto i : columnMask) {
-
-            // Sample
-
-            samples.clear();
-            TRowSampler sampler{numberSamples, rowFeatureSampler(i, target, samples)};
-            frame.readRows(
-                1, 0, frame.numberRows(),
-                [&](const TRowItr& beginRows, const TRowItr& endRows) {
-                    for (auto row = beginRows; row != endRows; ++row) {
-                        if (isMissing((*row)[i]) || isMissing(target(*row))) {
-                            continue;
-                        }
-                        std::size_t category{static_cast<std::size_t>((*row)[i])};
-                        if (frequencies[i][category] >= minimumFrequency) {
-                            sampler.sample(*row);
-                        }
-                    }
-                },
-                &rowMask);
-            LOG_TRACE(<< "# samples = " << samples.size());
-
-            // Setup encoders
-
-            encoders.clear();
-            for (const auto& sample : samples) {
-                std::size_t category{static_cast<std::size_t>(sample[0])};
-                auto encoder = makeEncoder(i, 0, category);
-                std::size_t hash{encoder->hash()};
-                encoders.emplace(hash, std::move(encoder));
-            }
-
-            auto target_ = [](const TFloatVec& sample) { return sample[1]; };
-            mics[i] = computeEncodedCategory(mic, target_, encoders, samples);
-        }
-
-        encoderMics.push_back(std::move(mics));
-    }
-
-    return encoderMics;
-}
-
-CDataFrameUtils::TSizeDoublePrVecVecVec CDataFrameUtils::categoricalMicWithColumnDataFrameOnDisk(
-    const CColumnValue& target,
-    const core::CDataFrame& frame,
-    const core::CPackedBitVector& rowMask,
-    const TSizeVec& columnMask,
-    const TEncoderFactoryVec& encoderFactories,
-    const TDoubleVecVec& frequencies,
-    std::size_t numberSamples) {
+    TRowSampler sampler{numberSamples, rowSampler(samples)};
+    frame.readRows(1, 0, frame.numberRows(),
+                   [&](const TRowItr& beginRows, const TRowItr& endRows) {
+                       for (auto row = beginRows; row != endRows; ++row) {
+                           if (isMissing(target(*row)) == false) {
+                               sampler.sample(*row);
+                           }
+                       }
+                   },
+                   &rowMask);
+    LOG_TRACE(<< "# samples = " << samples.size());
 
-    TSizeDoublePrVecVecVec encoderMics;
-    encoderMics.reserve(encoderFactories.size());
+    // Compute MICe
+    //
+    // The columns are independent given the sample so we compute them in parallel.
 
-    TFloatVecVec samples;
-    TSizeEncoderPtrUMap encoders;
-    CMic mic;
-    samples.reserve(numberSamples);
-    mic.reserve(numberSamples);
+    TSizeDoublePrVecVecVec mics;
+    mics.reserve(encoderFactories.size());
 
     for (const auto& encoderFactory : encoderFactories) {
 
@@ -1037,128 +909,73 @@ CDataFrameUtils::TSizeDoublePrVecVecVec CDataFrameUtils::categoricalMicWithColum
         double minimumFrequency;
         std::tie(makeEncoder, minimumFrequency) = encoderFactory;
 
-        TSizeDoublePrVecVec mics(frame.numberColumns());
-
-        // Sample
-        //
-        // The law of large numbers means we have a high probability of sampling
-        // each category provided minimumFrequency * NUMBER_SAMPLES_TO_COMPUTE_MIC
-        // is large (which we ensure it is).
+        TSizeDoublePrVecVec encoderMics(frame.numberColumns());
 
-        samples.clear();
-        TRowSampler sampler{numberSamples, rowSampler(samples)};
-        frame.readRows(1, 0, frame.numberRows(),
-                       [&](const TRowItr& beginRows, const TRowItr& endRows) {
-                           for (auto row = beginRows; row != endRows; ++row) {
-                               if (isMissing(target(*row)) == false) {
-                                   sampler.sample(*row);
-                               }
-                           }
-                       },
-                       &rowMask);
-        LOG_TRACE(<< "# samples = " << samples.size());
-
-        for (auto i : columnMask) {
-
-            // Setup encoders
-
-            encoders.clear();
-            for (const auto& sample : samples) {
-                if (isMissing(sample[i])) {
-                    continue;
-                }
-                std::size_t category{static_cast<std::size_t>(sample[i])};
-                if (frequencies[i][category] >= minimumFrequency) {
-                    auto encoder = makeEncoder(i, i, category);
-                    std::size_t hash{encoder->hash()};
-                    encoders.emplace(hash, std::move(encoder));
+        core::CScopedParallelForEachCallSite callSite{"categorical_mic"};
+        core::parallel_for_each_adaptively(
+            columnMask.begin(), columnMask.end(), [&, mic = CMic{}](std::size_t i) mutable {
+                TSizeEncoderPtrUMap encoders;
+                for (const auto& sample : samples) {
+                    if (isMissing(sample[i])) {
+                        continue;
+                    }
+                    std::size_t category{static_cast<std::size_t>(sample[i])};
+                    if (frequencies[i][category] >= minimumFrequency) {
+                        auto encoder = makeEncoder(i, i, category);
+                        std::size_t hash{encoder->hash()};
+                        encoders.emplace(hash, std::move(encoder));
+                    }
                 }
-            }
-
-            mics[i] = computeEncodedCategory(mic, target, encoders, samples);
-        }
+                mic.reserve(samples.size());
+                encoderMics[i] = computeEncodedCategory(mic, target, encoders, samples);
+            });
 
-        encoderMics.push_back(std::move(mics));
+        mics.push_back(std::move(encoderMics));
     }
 
-    return encoderMics;
-}
-
-CDataFrameUtils::TDoubleVec
-CDataFrameUtils::metricMicWithColumnDataFrameInMemory(const CColumnValue& target,
-                                                      const core::CDataFrame& frame,
-                                                      const core::CPackedBitVector& rowMask,
-                                                      const TSizeVec& columnMask,
-                                                      std::size_t numberSamples) {
-
-    TDoubleVec mics(frame.numberColumns(), 0.0);
-
-    TFloatVecVec samples;
-    samples.reserve(numberSamples);
-    double numberMaskedRows{rowMask.manhattan()};
-
-    for (auto i : columnMask) {
-
-        // Do sampling
-
-        TRowSampler sampler{numberSamples, rowFeatureSampler(i, target, samples)};
-        auto missingCount = frame.readRows(
-            1, 0, frame.numberRows(),
-            core::bindRetrievableState(
-                [&](std::size_t& missing, const TRowItr& beginRows, const TRowItr& endRows) {
-                    for (auto row = beginRows; row != endRows; ++row) {
-                        if (isMissing((*row)[i])) {
-                            ++missing;
-                        } else if (isMissing(target(*row)) == false) {
-                            sampler.sample(*row);
-                        }
-                    }
-                },
-                std::size_t{0}),
-            &rowMask);
-        LOG_TRACE(<< "# samples = " << samples.size());
-
-        double fractionMissing{static_cast<double>(missingCount.first[0].s_FunctionState) /
-                               numberMaskedRows};
-        LOG_TRACE(<< "feature = " << i << " fraction missing = " << fractionMissing);
-
-        // Compute MICe
-
-        CMic mic;
-        mic.reserve(samples.size());
-        for (const auto& sample : samples) {
-            mic.add(sample[0], sample[1]);
+    for (auto& encoderMics : mics) {
+        for (auto& categoryMics : encoderMics) {
+            std::sort(categoryMics.begin(), categoryMics.end(),
+                      [](const TSizeDoublePr& lhs, const TSizeDoublePr& rhs) {
+                          return common::COrderings::lexicographicalCompare(
+                              -lhs.second, lhs.first, -rhs.second, rhs.first);
+                      });
         }
-
-        mics[i] = (1.0 - fractionMissing) * mic.compute();
-        samples.clear();
     }
 
     return mics;
 }
 
 CDataFrameUtils::TDoubleVec
-CDataFrameUtils::metricMicWithColumnDataFrameOnDisk(const CColumnValue& target,
-                                                    const core::CDataFrame& frame,
-                                                    const core::CPackedBitVector& rowMask,
-                                                    const TSizeVec& columnMask,
-                                                    std::size_t numberSamples) {
+CDataFrameUtils::metricMicWithColumn(const CColumnValue& target,
+                                     const core::CDataFrame& frame,
+                                     const core::CPackedBitVector& rowMask,
+                                     TSizeVec columnMask) {
 
     TDoubleVec mics(frame.numberColumns(), 0.0);
 
+    removeCategoricalColumns(frame, columnMask);
+    if (frame.numberRows() == 0 || columnMask.empty()) {
+        return mics;
+    }
+
+    // Sample
+    //
+    // We sample the rows and count each column's missing values in a single
+    // pass over the frame.
+
+    std::size_t numberSamples{std::min(NUMBER_SAMPLES_TO_COMPUTE_MIC, frame.numberRows())};
     TFloatVecVec samples;
     samples.reserve(numberSamples);
     double numberMaskedRows{rowMask.manhattan()};
 
-    // Do sampling
-
     TRowSampler sampler{numberSamples, rowSampler(samples)};
     auto missingCounts = frame.readRows(
         1, 0, frame.numberRows(),
         core::bindRetrievableState(
             [&](TSizeVec& missing, const TRowItr& beginRows, const TRowItr& endRows) {
                 for (auto row = beginRows; row != endRows; ++row) {
-                    for (std::size_t i = 0; i < row->numberColumns(); ++i) {
+                    for (auto i : columnMask) {
                         missing[i] += isMissing((*row)[i]) ? 1 : 0;
                     }
                     if (isMissing(target(*row)) == false) {
@@ -1171,7 +988,7 @@ CDataFrameUtils::metricMicWithColumnDataFrameOnDisk(const CColumnValue& target,
     LOG_TRACE(<< "# samples = " << samples.size());
 
     TDoubleVec fractionMissing(frame.numberColumns());
-    for (std::size_t i = 0; i < fractionMissing.size(); ++i) {
+    for (auto i : columnMask) {
         for (const auto& missingCount : missingCounts.first) {
             fractionMissing[i] +=
                 static_cast<double>(missingCount.s_FunctionState[i]) / numberMaskedRows;
@@ -1180,21 +997,46 @@ CDataFrameUtils::metricMicWithColumnDataFrameOnDisk(const CColumnValue& target,
     LOG_TRACE(<< "Fraction missing = " << fractionMissing);
 
     // Compute MICe
-
-    for (auto i : columnMask) {
-        CMic mic;
-        mic.reserve(samples.size());
-        for (const auto& sample : samples) {
-            if (isMissing(sample[i]) == false) {
-                mic.add(sample[i], target(sample));
+    //
+    // The columns are independent given the sample so we compute them in parallel.
+    // Their costs differ with the number of missing values so we balance them
+    // adaptively.
+
+    core::CScopedParallelForEachCallSite callSite{"metric_mic"};
+    core::parallel_for_each_adaptively(
+        columnMask.begin(), columnMask.end(), [&, mic = CMic{}](std::size_t i) mutable {
+            mic.clear();
+            mic.reserve(samples.size());
+            for (const auto& sample : samples) {
+                if (isMissing(sample[i]) == false) {
+                    mic.add(sample[i], target(sample));
+                }
             }
-        }
-        mics[i] = (1.0 - fractionMissing[i]) * mic.compute();
-    }
+            mics[i] = (1.0 - fractionMissing[i]) * mic.compute();
+        });
 
     return mics;
 }
 
+CDataFrameUtils::TDoubleVector
+CDataFrameUtils::maximumMinimumRecallClassWeights(std::size_t numberThreads,
+                                                  const core::CDataFrame& frame,
+                                                  const core::CPackedBitVector& rowMask,
+                                                  std::size_t numberClasses,
+                                                  std::size_t targetColumn,
+                                                  const TReadPredictionFunc& readPrediction) {
+
+    return numberClasses == 2
+               ? maximizeMinimumRecallForBinary(numberThreads, frame, rowMask,
+                                                targetColumn, readPrediction)
+               : maximizeMinimumRecallForMulticlass(numberThreads, frame, rowMask, numberClasses,
+                                                    targetColumn, readPrediction);
+}
+
+bool CDataFrameUtils::isMissing(double value) {
+    return core::CDataFrame::isMissing(value);
+}
+
 CDataFrameUtils::TDoubleVector
 CDataFrameUtils::maximizeMinimumRecallForBinary(std::size_t numberThreads,
                                                 const core::CDataFrame& frame,
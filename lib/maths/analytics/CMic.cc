@@ -16,6 +16,7 @@
 #include <maths/common/CTools.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <limits>
 #include <numeric>
@@ -28,6 +29,14 @@ namespace {
 const std::size_t X{0};
 const std::size_t Y{1};
 const double INF{std::numeric_limits<double>::max()};
+
+double l1(const double* x, std::size_t n) {
+    double result{0.0};
+    for (std::size_t i = 0; i < n; ++i) {
+        result += std::fabs(x[i]);
+    }
+    return result;
+}
 }
 
 void CMic::reserve(std::size_t n) {
@@ -241,17 +250,39 @@ CMic::TDoubleVec CMic::optimizeXAxis(const TDoubleVec& q, std::size_t l, std::si
     double n{static_cast<double>(m_Samples.size())};
     double w{1.0 / n};
 
-    // Compute grid cell and row and column probabilities.
-    TVectorXdVec cump(ck, TVectorXd{l});
-    for (const auto& sample : m_Samples) {
-        std::ptrdiff_t i{std::lower_bound(pi.begin(), pi.end(), sample(X)) - pi.begin()};
-        std::ptrdiff_t j{std::lower_bound(q.begin(), q.end(), sample(Y)) - q.begin()};
-        cump[i](j) += w;
+    // Compute grid cell and row and column probabilities. These are stored in
+    // one buffer with the l probabilities for each X- cell contiguous so the
+    // loops below are over contiguous memory and don't need to allocate.
+    TDoubleVec cump(ck * l, 0.0);
+    auto column = [&cump, l](std::size_t i) { return &cump[i * l]; };
+
+    // Visiting the samples in order of their Y- and then X- values means the
+    // bin indices only ever increase so we can find them by a linear scan of
+    // the partition boundaries rather than a binary search per sample. Note
+    // that the last boundary is always the maximum value.
+    TSizeVec binsY(m_Samples.size());
+    for (std::size_t i = 0, j = 0; i < m_Order[Y].size(); ++i) {
+        std::size_t sample{m_Order[Y][i]};
+        while (q[j] < m_Samples[sample](Y)) {
+            ++j;
+        }
+        binsY[sample] = j;
+    }
+    for (std::size_t i = 0, j = 0; i < m_Order[X].size(); ++i) {
+        std::size_t sample{m_Order[X][i]};
+        while (pi[j] < m_Samples[sample](X)) {
+            ++j;
+        }
+        column(j)[binsY[sample]] += w;
     }
 
     // We need cumulative probabilities in each column for the dynamic program.
     for (std::size_t i = 1; i < ck; ++i) {
-        cump[i] += cump[i - 1];
+        const double* previous{column(i - 1)};
+        double* current{column(i)};
+        for (std::size_t j = 0; j < l; ++j) {
+            current[j] += previous[j];
+        }
     }
 
     TDoubleVecVec M(ck);
@@ -272,22 +303,26 @@ CMic::TDoubleVec CMic::optimizeXAxis(const TDoubleVec& q, std::size_t l, std::si
 
     TDoubleVec normalisation(ck);
     for (std::size_t t = 1; t < ck; ++t) {
-        normalisation[t] = cump[t].L1();
+        normalisation[t] = l1(column(t), l);
     }
 
+    TDoubleVec pq0(l);
+    TDoubleVec pq1(l);
     for (std::size_t t = 2; t <= ck; ++t) {
 
         double Fmax{-INF};
 
         double Z{normalisation[t - 1]};
 
-        TVectorXd p{2};
+        const double* cumpt{column(t - 1)};
         for (std::size_t s = 1; s < t; ++s) {
-            TVectorXd pq0{cump[s - 1] / Z};
-            TVectorXd pq1{(cump[t - 1] - cump[s - 1]) / Z};
-            p(0) = pq0.L1();
-            p(1) = pq1.L1();
-            double F{entropy(p) - entropy(pq0) - entropy(pq1)};
+            const double* cumps{column(s - 1)};
+            for (std::size_t j = 0; j < l; ++j) {
+                pq0[j] = cumps[j] / Z;
+                pq1[j] = (cumpt[j] - cumps[j]) / Z;
+            }
+            double p[]{l1(pq0.data(), l), l1(pq1.data(), l)};
+            double F{entropy(p, 2) - entropy(pq0.data(), l) - entropy(pq1.data(), l)};
             Fmax = std::max(Fmax, F);
         }
 
@@ -310,6 +345,27 @@ CMic::TDoubleVec CMic::optimizeXAxis(const TDoubleVec& q, std::size_t l, std::si
     //   for t = x to c k do
     //     Find s in {x-1,...,t} maximizing Z_s / Z_t M(s,x-1) + (Z_t-Z_s) / Z_t H_XY(s,t)
     //     M(t,x) <- Z_s / Z_t M(s,x-1) + (Z_t-Z_s) / Z_t H_XY(s,t)
+    //
+    // Note that H_XY(s,t) doesn't depend on x so we compute it once up front for
+    // each 2 <= s < t <= c k rather than for every x.
+
+    TDoubleVec Hst;
+    if (k >= 3) {
+        Hst.resize(ck * ck, 0.0);
+        TDoubleVec pst(l);
+        for (std::size_t t = 3; t <= ck; ++t) {
+            double Zt{normalisation[t - 1]};
+            const double* cumpt{column(t - 1)};
+            for (std::size_t s = 2; s < t; ++s) {
+                double Zs{normalisation[s - 1]};
+                const double* cumps{column(s - 1)};
+                for (std::size_t j = 0; j < l; ++j) {
+                    pst[j] = (cumpt[j] - cumps[j]) / (Zt - Zs);
+                }
+                Hst[(s - 1) * ck + t - 1] = entropy(pst.data(), l);
+            }
+        }
+    }
 
     for (std::size_t x = 3; x <= k; ++x) {
         for (std::size_t t = x; t <= ck; ++t) {
@@ -319,9 +375,8 @@ CMic::TDoubleVec CMic::optimizeXAxis(const TDoubleVec& q, std::size_t l, std::si
             double Zt{normalisation[t - 1]};
             for (std::size_t s = x - 1; s < t; ++s) {
                 double Zs{normalisation[s - 1]};
-                TVectorXd pst{cump[t - 1] - cump[s - 1]};
-                pst /= Zt - Zs;
-                double F{Zs / Zt * M[s - 1][x - 3] - (Zt - Zs) / Zt * entropy(pst)};
+                double F{Zs / Zt * M[s - 1][x - 3] -
+                         (Zt - Zs) / Zt * Hst[(s - 1) * ck + t - 1]};
                 Fmax = std::max(Fmax, F);
             }
 
@@ -331,8 +386,8 @@ CMic::TDoubleVec CMic::optimizeXAxis(const TDoubleVec& q, std::size_t l, std::si
 
     // Add H_Y to recover mutual information, which we need when comparing grids.
 
-    LOG_TRACE(<< "Z = " << cump.back().L1());
-    double Hq{entropy(cump.back())};
+    LOG_TRACE(<< "Z = " << l1(column(ck - 1), l));
+    double Hq{entropy(column(ck - 1), l)};
     TDoubleVec result(M.back());
     for (auto& r : result) {
         r += Hq;
@@ -343,11 +398,11 @@ CMic::TDoubleVec CMic::optimizeXAxis(const TDoubleVec& q, std::size_t l, std::si
     return result;
 }
 
-double CMic::entropy(const TVectorXd& dist) {
+double CMic::entropy(const double* dist, std::size_t n) {
     double result{0.0};
-    for (auto p : dist) {
-        if (p > 0.0) {
-            result -= p * common::CTools::fastLog(p);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (dist[i] > 0.0) {
+            result -= dist[i] * common::CTools::fastLog(dist[i]);
         }
     }
     return result;
@@ -107,6 +107,7 @@ public:
         CModelBuilder(common::CPRNG::CXorOShiro128Plus& rng,
                       TSizeSizePrVec&& methodsAndNumberNeighbours,
                       std::size_t sampleSize,
+                      double neighbourSearchApproximation,
                       TMatrix&& projection);
 
         //! Maybe sample the point.
@@ -124,6 +125,7 @@ public:
     private:
         TSizeSizePrVec m_MethodsAndNumberNeighbours;
         std::size_t m_SampleSize;
+        double m_NeighbourSearchApproximation;
         TSampler m_Sampler;
         TMatrix m_Projection;
         TPointVec m_SampledProjectedPoints;
@@ -192,6 +194,7 @@ public:
                  std::size_t numberPoints,
                  std::size_t dimension,
                  std::size_t numberNeighbours,
+                 double neighbourSearchApproximation,
                  common::CPRNG::CXorOShiro128Plus rng = common::CPRNG::CXorOShiro128Plus{});
 
     //! Compute the outlier scores for \p points.
@@ -217,6 +220,7 @@ private:
         CModel(const TMethodFactoryVec& methodFactories,
                TSizeSizePrVec methodsAndNumberNeighbours,
                TPointVec samples,
+               double neighbourSearchApproximation,
                TMatrix projection);
 
         std::size_t numberPoints() const { return m_Lookup->size(); }
@@ -340,6 +344,7 @@ CEnsemble<POINT>::makeBuilders(const TSizeVecVec& methods,
                                std::size_t numberPoints,
                                std::size_t dimension,
                                std::size_t numberNeighbours,
+                               double neighbourSearchApproximation,
                                common::CPRNG::CXorOShiro128Plus rng) {
     // Compute some constants of the ensemble:
     //   - The number of ensemble models, which is proportional n^(1/2),
@@ -376,8 +381,8 @@ CEnsemble<POINT>::makeBuilders(const TSizeVecVec& methods,
                                                  maxNumberNeighbours + 1));
         }
 
-        result.emplace_back(rng, std::move(methodsAndNumberNeighbours),
-                            sampleSize, std::move(projections[i]));
+        result.emplace_back(rng, std::move(methodsAndNumberNeighbours), sampleSize,
+                            neighbourSearchApproximation, std::move(projections[i]));
 
         rng.jump();
     }
@@ -515,9 +520,11 @@ template<typename POINT>
 CEnsemble<POINT>::CModelBuilder::CModelBuilder(common::CPRNG::CXorOShiro128Plus& rng,
                                                TSizeSizePrVec&& methodsAndNumberNeighbours,
                                                std::size_t sampleSize,
+                                               double neighbourSearchApproximation,
                                                TMatrix&& projection)
     : m_MethodsAndNumberNeighbours{std::forward<TSizeSizePrVec>(methodsAndNumberNeighbours)},
-      m_SampleSize{sampleSize}, m_Sampler{makeSampler(rng, sampleSize)},
+      m_SampleSize{sampleSize}, m_NeighbourSearchApproximation{neighbourSearchApproximation},
+      m_Sampler{makeSampler(rng, sampleSize)},
       m_Projection{std::forward<TMatrix>(projection)} {
 
     m_SampledProjectedPoints.reserve(m_Sampler.targetSampleSize());
@@ -541,7 +548,8 @@ CEnsemble<POINT>::CModelBuilder::make(const TMethodFactoryVec& methodFactories)
     }
 
     return {methodFactories, std::move(m_MethodsAndNumberNeighbours),
-            std::move(m_SampledProjectedPoints), std::move(m_Projection)};
+            std::move(m_SampledProjectedPoints), m_NeighbourSearchApproximation,
+            std::move(m_Projection)};
 }
 
 template<typename POINT>
@@ -700,11 +708,13 @@ template<typename POINT>
 CEnsemble<POINT>::CModel::CModel(const TMethodFactoryVec& methodFactories,
                                  TSizeSizePrVec methodsAndNumberNeighbours,
                                  TPointVec sample,
+                                 double neighbourSearchApproximation,
                                  TMatrix projection)
     : m_Lookup{std::make_unique<TKdTree>()}, m_Projection{std::move(projection)} {
 
     m_Lookup->reserve(sample.size());
     m_Lookup->build(sample);
+    m_Lookup->approximation(neighbourSearchApproximation);
 
     TMethodUPtrVec methods;
     methods.reserve(methodsAndNumberNeighbours.size());
@@ -753,13 +763,16 @@ void CEnsemble<POINT>::CModel::addOutlierScores(const std::vector<POINT>& points
     // it doesn't overlap the indices of any of the sampled model points.
     std::size_t index{this->numberPoints()};
 
-    TPointVec points_;
-    points_.reserve(points.size());
+    // The projections are independent so we compute them in parallel.
+    TPointVec points_(points.size());
+    core::parallel_for_each(0, points.size(), [&](std::size_t i) {
+        points_[i] = TPoint{m_Projection * points[i], index + i};
+    });
     TMeanAccumulator meanNorm;
-    for (std::size_t i = 0; i < points.size(); ++i, ++index) {
-        points_.emplace_back(m_Projection * points[i], index);
-        meanNorm.add(common::las::norm(points[i]));
+    for (const auto& point : points) {
+        meanNorm.add(common::las::norm(point));
     }
+    index += points.size();
     double eps{COutliers::EPS * common::CBasicStatistics::mean(meanNorm)};
     LOG_TRACE(<< "eps = " << eps);
 
@@ -779,15 +792,17 @@ void CEnsemble<POINT>::CModel::addOutlierScores(const std::vector<POINT>& points
     recordMemoryUsage(signedMemoryUsage(m_Method) - methodMemoryAfterRun);
     std::int64_t scoresMemoryBeforeAdd{signedMemoryUsage(scores)};
 
-    // Update the scores.
-    TDouble1Vec2Vec pointScores(methodScores.size());
-    for (std::size_t i = 0; i < points_.size(); ++i) {
-        index = points_[i].annotation();
-        for (std::size_t j = 0; j < methodScores.size(); ++j) {
-            pointScores[j] = std::move(methodScores[j][index]);
-        }
-        scores[i].add(m_LogScoreMoments, pointScores);
-    }
+    // Update the scores. Each point's scorer is only touched by one task so we
+    // can safely update them in parallel.
+    core::parallel_for_each(
+        0, points_.size(),
+        [&, pointScores = TDouble1Vec2Vec(methodScores.size()) ](std::size_t i) mutable {
+            std::size_t pointIndex{points_[i].annotation()};
+            for (std::size_t j = 0; j < methodScores.size(); ++j) {
+                pointScores[j] = std::move(methodScores[j][pointIndex]);
+            }
+            scores[i].add(m_LogScoreMoments, pointScores);
+        });
 
     recordMemoryUsage(signedMemoryUsage(scores) - scoresMemoryBeforeAdd - pointsMemory);
 }
@@ -864,7 +879,8 @@ CEnsemble<POINT> buildEnsemble(const COutliers::SComputeParameters& params,
     }
 
     auto builders = CEnsemble<POINT>::makeBuilders(
-        methods, frame.numberRows(), frame.numberColumns(), params.s_NumberNeighbours);
+        methods, frame.numberRows(), frame.numberColumns(), params.s_NumberNeighbours,
+        params.s_NeighbourSearchApproximation);
 
     frame.readRows(1, [&builders](const TRowItr& beginRows, const TRowItr& endRows) {
         for (auto row = beginRows; row != endRows; ++row) {
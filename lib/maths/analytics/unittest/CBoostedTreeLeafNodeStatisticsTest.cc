@@ -13,6 +13,7 @@
 #include <core/Concurrency.h>
 
 #include <maths/analytics/CBoostedTree.h>
+#include <maths/analytics/CBoostedTreeColumnMajorSplits.h>
 #include <maths/analytics/CBoostedTreeLeafNodeStatistics.h>
 #include <maths/analytics/CBoostedTreeLeafNodeStatisticsIncremental.h>
 #include <maths/analytics/CBoostedTreeLeafNodeStatisticsScratch.h>
@@ -501,6 +502,146 @@ BOOST_AUTO_TEST_CASE(testGainBoundComputation) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testColumnMajorSplits) {
+
+    // Check that we get identical leaf statistics whether we read the split
+    // indices from the data frame or from column major splits.
+
+    using TLeafNodeStatisticsPtr = maths::analytics::CBoostedTreeLeafNodeStatistics::TPtr;
+    using TNodeVec = maths::analytics::CBoostedTree::TNodeVec;
+    using TWorkspace = maths::analytics::CBoostedTreeLeafNodeStatistics::CWorkspace;
+
+    std::size_t features{10};
+    std::size_t cols{features + 1};
+    std::size_t rows{1000};
+    std::size_t numberThreads{1};
+    TSizeVec extraColumns{cols, cols + 1, cols + 2, cols + 3, 0, cols + 4};
+    std::size_t numberSplitsColumns{(features + 3) / 4};
+
+    test::CRandomNumbers rng;
+
+    auto frame = core::makeMainStorageDataFrame(cols, rows).first;
+    frame->categoricalColumns(TBoolVec(cols, false));
+    frame->resizeColumns(numberThreads, extraColumns.back() + numberSplitsColumns);
+
+    TDoubleVec values;
+    TDoubleVec targets;
+    rng.generateUniformSamples(0.0, 1.0, rows * features, values);
+    rng.generateUniformSamples(-1.0, 1.0, rows, targets);
+    for (std::size_t i = 0; i < rows; ++i) {
+        targets[i] += 10.0 * values[i * features + 1] - 5.0 * values[i * features + 7];
+    }
+    for (std::size_t i = 0; i < rows; ++i) {
+        frame->writeRow([&](core::CDataFrame::TFloatVecItr column, std::int32_t&) {
+            for (std::size_t j = 0; j < features; ++j, ++column) {
+                *column = values[i * features + j];
+            }
+            *column = targets[i];
+            *(++column) = 0.0;
+            *(++column) = targets[i];
+            *(++column) = 2.0;
+            *(++column) = 1.0;
+        });
+    }
+    frame->finishWritingRows();
+
+    TFloatVecVec featureSplits(features, TFloatVec{0.25, 0.5, 0.75});
+
+    frame->writeColumns(1, [&](core::CDataFrame::TRowItr beginRows,
+                               core::CDataFrame::TRowItr endRows) {
+        for (auto row = beginRows; row != endRows; ++row) {
+            auto* splits = maths::analytics::boosted_tree_detail::beginSplits(*row, extraColumns);
+            for (std::size_t i = 0; i < features; ++splits) {
+                maths::analytics::CPackedUInt8Decorator::TUInt8Ary packedSplits;
+                packedSplits.fill(0);
+                for (std::size_t j = 0; j < packedSplits.size() && i < features; ++i, ++j) {
+                    packedSplits[j] = static_cast<std::uint8_t>(
+                        std::upper_bound(featureSplits[i].begin(),
+                                         featureSplits[i].end(), (*row)[i]) -
+                        featureSplits[i].begin());
+                }
+                *splits = maths::analytics::CPackedUInt8Decorator{packedSplits};
+            }
+        }
+    });
+
+    TDoubleVec u01;
+    rng.generateUniformSamples(0.0, 1.0, rows, u01);
+    core::CPackedBitVector trainingRowMask;
+    for (std::size_t i = 0; i < rows; ++i) {
+        trainingRowMask.extend(u01[i] < 0.8);
+    }
+
+    maths::analytics::CBoostedTreeColumnMajorSplits columnMajorSplits;
+    columnMajorSplits.refresh(numberThreads, *frame, extraColumns,
+                              TBoolVec(features, true), trainingRowMask);
+
+    TWorkspace rowMajorWorkspace{1};
+    TWorkspace columnMajorWorkspace{1};
+    rowMajorWorkspace.reinitialize(numberThreads, featureSplits);
+    columnMajorWorkspace.reinitialize(numberThreads, featureSplits);
+    columnMajorWorkspace.columnMajorSplits(&columnMajorSplits);
+
+    TSizeVec treeFeatureBag{1, 4, 7, 8};
+    TSizeVec nodeFeatureBag{1, 7};
+
+    maths::analytics::CBoostedTreeHyperparameters parameters;
+    parameters.softTreeDepthLimit().set(1.0);
+    parameters.softTreeDepthTolerance().set(1.0);
+
+    auto assertEqual = [](const maths::analytics::CBoostedTreeLeafNodeStatistics& lhs,
+                          const maths::analytics::CBoostedTreeLeafNodeStatistics& rhs) {
+        BOOST_REQUIRE_EQUAL(lhs.print(), rhs.print());
+        BOOST_REQUIRE_EQUAL(lhs.gain(), rhs.gain());
+        BOOST_REQUIRE_EQUAL(lhs.curvature(), rhs.curvature());
+        BOOST_REQUIRE_EQUAL(lhs.leftChildMaxGain(), rhs.leftChildMaxGain());
+        BOOST_REQUIRE_EQUAL(lhs.rightChildMaxGain(), rhs.rightChildMaxGain());
+        BOOST_TEST_REQUIRE(lhs.rowMask() == rhs.rowMask());
+    };
+
+    TNodeVec rowMajorTree(1);
+    TNodeVec columnMajorTree(1);
+
+    auto rowMajorRoot = std::make_shared<maths::analytics::CBoostedTreeLeafNodeStatisticsScratch>(
+        0 /*root*/, extraColumns, 1, *frame, parameters, featureSplits,
+        treeFeatureBag, nodeFeatureBag, 0 /*depth*/, trainingRowMask, rowMajorWorkspace);
+    auto columnMajorRoot = std::make_shared<maths::analytics::CBoostedTreeLeafNodeStatisticsScratch>(
+        0 /*root*/, extraColumns, 1, *frame, parameters, featureSplits, treeFeatureBag,
+        nodeFeatureBag, 0 /*depth*/, trainingRowMask, columnMajorWorkspace);
+    LOG_DEBUG(<< "root = " << columnMajorRoot->print());
+    assertEqual(*rowMajorRoot, *columnMajorRoot);
+    BOOST_TEST_REQUIRE(rowMajorRoot->gain() > 0.0);
+
+    auto split = [&](maths::analytics::CBoostedTreeLeafNodeStatistics& leaf,
+                     TNodeVec& tree, TWorkspace& workspace) {
+        auto[splitFeature, splitValue] = leaf.bestSplit();
+        auto[leftChildId, rightChildId] = tree[leaf.id()].split(
+            splitFeature, splitValue, leaf.assignMissingToLeft(), leaf.gain(),
+            leaf.gainVariance(), leaf.curvature(), tree);
+        return leaf.split(leftChildId, rightChildId, 0.0, *frame, parameters,
+                          treeFeatureBag, nodeFeatureBag, tree[leaf.id()], workspace);
+    };
+
+    TLeafNodeStatisticsPtr rowMajorLeftChild;
+    TLeafNodeStatisticsPtr rowMajorRightChild;
+    TLeafNodeStatisticsPtr columnMajorLeftChild;
+    TLeafNodeStatisticsPtr columnMajorRightChild;
+    std::tie(rowMajorLeftChild, rowMajorRightChild) =
+        split(*rowMajorRoot, rowMajorTree, rowMajorWorkspace);
+    std::tie(columnMajorLeftChild, columnMajorRightChild) =
+        split(*columnMajorRoot, columnMajorTree, columnMajorWorkspace);
+
+    BOOST_REQUIRE_EQUAL(rowMajorLeftChild != nullptr, columnMajorLeftChild != nullptr);
+    BOOST_REQUIRE_EQUAL(rowMajorRightChild != nullptr, columnMajorRightChild != nullptr);
+    BOOST_TEST_REQUIRE((rowMajorLeftChild != nullptr || rowMajorRightChild != nullptr));
+    if (rowMajorLeftChild != nullptr) {
+        assertEqual(*rowMajorLeftChild, *columnMajorLeftChild);
+    }
+    if (rowMajorRightChild != nullptr) {
+        assertEqual(*rowMajorRightChild, *columnMajorRightChild);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testMaximumThroughputNumberThreads) {
 
     // Check that we find the correct minimum for different amounts of total
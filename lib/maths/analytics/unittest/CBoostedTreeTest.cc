@@ -3087,6 +3087,24 @@ BOOST_AUTO_TEST_CASE(testEstimateMemory) {
 
         BOOST_TEST_REQUIRE(predictInstrumentation.maxMemoryUsage() <= estimatedMemory);
     }
+
+    // Check we only account for the column major copy of the split indices,
+    // which uses one byte per row for each feature, if the feature bag fraction
+    // can be small enough for us to use it. Tuning the fraction also uses a
+    // little extra memory for the hyperparameter search.
+    auto estimateMemoryForFeatureBagFraction = [&](const TDoubleVec& fraction) {
+        return maths::analytics::CBoostedTreeFactory::constructFromParameters(
+                   1, std::make_unique<maths::analytics::boosted_tree::CMse>())
+            .featureBagFraction(fraction)
+            .estimateMemoryUsageForTrain(rows, cols);
+    };
+    std::size_t tunedEstimatedMemory{estimateMemoryForFeatureBagFraction({})};
+    std::size_t smallBagEstimatedMemory{estimateMemoryForFeatureBagFraction({0.4})};
+    std::size_t largeBagEstimatedMemory{estimateMemoryForFeatureBagFraction({0.8})};
+    LOG_DEBUG(<< "tuned = " << tunedEstimatedMemory << ", small bag = " << smallBagEstimatedMemory
+              << ", large bag = " << largeBagEstimatedMemory);
+    BOOST_REQUIRE_EQUAL(rows * (cols - 1), smallBagEstimatedMemory - largeBagEstimatedMemory);
+    BOOST_TEST_REQUIRE(tunedEstimatedMemory >= smallBagEstimatedMemory);
 }
 
 BOOST_AUTO_TEST_CASE(testDeployedMemoryLimiting) {
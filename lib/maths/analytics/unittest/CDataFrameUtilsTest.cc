@@ -1043,6 +1043,73 @@ BOOST_AUTO_TEST_CASE(testMicWithColumnWithMissing) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testMicWithColumnWithManyMissingSampled) {
+
+    // Test that sampling rows once for all columns, rather than sampling the
+    // rows with a value for each column separately, gives MICe values close
+    // to the MICe of all the rows with values when many values are missing.
+
+    test::CRandomNumbers rng;
+
+    std::size_t capacity{5000};
+    std::size_t numberRows{40000};
+    std::size_t numberCols{4};
+    TDoubleVec fractionsMissing{0.1, 0.4, 0.7};
+
+    auto frame = core::makeMainStorageDataFrame(numberCols, capacity).first;
+
+    TDoubleVecVec rows;
+    TSizeVec missing(numberCols, 0);
+
+    for (std::size_t i = 0; i < numberRows; ++i) {
+
+        TDoubleVec row;
+        rng.generateUniformSamples(-5.0, 5.0, 4, row);
+        row[3] = 2.0 * row[0] - 1.5 * row[1] + 4.0 * row[2];
+        for (std::size_t j = 0; j < fractionsMissing.size(); ++j) {
+            TDoubleVec u01;
+            rng.generateUniformSamples(0.0, 1.0, 1, u01);
+            if (u01[0] < fractionsMissing[j]) {
+                row[j] = core::CDataFrame::valueOfMissing();
+                ++missing[j];
+            }
+        }
+        rows.push_back(row);
+
+        frame->writeRow([&row, numberCols](core::CDataFrame::TFloatVecItr column,
+                                           std::int32_t&) {
+            for (std::size_t j = 0; j < numberCols; ++j, ++column) {
+                *column = row[j];
+            }
+        });
+    }
+    frame->finishWritingRows();
+
+    TDoubleVec expected(4, 0.0);
+    for (std::size_t j : {0, 1, 2}) {
+        maths::analytics::CMic mic;
+        for (const auto& row : rows) {
+            if (maths::analytics::CDataFrameUtils::isMissing(row[j]) == false) {
+                mic.add(row[j], row[3]);
+            }
+        }
+        expected[j] = (1.0 - static_cast<double>(missing[j]) /
+                                 static_cast<double>(rows.size())) *
+                      mic.compute();
+    }
+
+    TDoubleVec actual(maths::analytics::CDataFrameUtils::metricMicWithColumn(
+        maths::analytics::CDataFrameUtils::CMetricColumnValue{3}, *frame,
+        maskAll(numberRows), {0, 1, 2}));
+
+    LOG_DEBUG(<< "expected = " << expected);
+    LOG_DEBUG(<< "actual   = " << actual);
+    for (std::size_t j : {0, 1, 2}) {
+        BOOST_REQUIRE_CLOSE_ABSOLUTE(expected[j], actual[j], 0.02);
+    }
+    BOOST_REQUIRE_EQUAL(0.0, actual[3]);
+}
+
 BOOST_AUTO_TEST_CASE(testCategoryFrequencies) {
 
     // Test we get the correct frequencies for each category.
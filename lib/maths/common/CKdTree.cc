@@ -0,0 +1,99 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <maths/common/CKdTree.h>
+
+#include <cmath>
+
+#if defined(__SSE__)
+
+#include <xmmintrin.h>
+
+#define ml_zero_128 _mm_setzero_ps
+#define ml_broadcast_load_128 _mm_load_ps1
+#define ml_unaligned_load_128 _mm_loadu_ps
+#define ml_unaligned_store_128 _mm_storeu_ps
+#define ml_add_128 _mm_add_ps
+#define ml_subtract_128 _mm_sub_ps
+#define ml_multiply_128 _mm_mul_ps
+#define ml_sqrt_128 _mm_sqrt_ps
+
+#elif defined(__ARM_NEON__)
+
+#include <arm_neon.h>
+
+#define ml_zero_128() vdupq_n_f32(0.0F)
+#define ml_broadcast_load_128(x) vld1q_dup_f32(x)
+#define ml_unaligned_load_128(x) vld1q_f32(x)
+#define ml_unaligned_store_128(x, y) vst1q_f32(x, y)
+#define ml_add_128(x, y) vaddq_f32(x, y)
+#define ml_subtract_128(x, y) vsubq_f32(x, y)
+#define ml_multiply_128(x, y) vmulq_f32(x, y)
+#define ml_sqrt_128(x) vsqrtq_f32(x)
+
+#else
+
+#include <algorithm>
+#include <array>
+
+#define ml_zero_128()                                                          \
+    std::array<float, 4> { 0.0F, 0.0F, 0.0F, 0.0F }
+#define ml_broadcast_load_128(x)                                               \
+    std::array<float, 4> { *(x), *(x), *(x), *(x) }
+#define ml_unaligned_load_128(x)                                               \
+    std::array<float, 4> { (x)[0], (x)[1], (x)[2], (x)[3] }
+#define ml_unaligned_store_128(x, y) std::copy((y).begin(), (y).end(), x)
+#define ml_add_128(x, y)                                                       \
+    std::array<float, 4> { (x)[0] + (y)[0], (x)[1] + (y)[1],                   \
+                           (x)[2] + (y)[2], (x)[3] + (y)[3] }
+#define ml_subtract_128(x, y)                                                  \
+    std::array<float, 4> { (x)[0] - (y)[0], (x)[1] - (y)[1],                   \
+                           (x)[2] - (y)[2], (x)[3] - (y)[3] }
+#define ml_multiply_128(x, y)                                                  \
+    std::array<float, 4> { (x)[0] * (y)[0], (x)[1] * (y)[1],                   \
+                           (x)[2] * (y)[2], (x)[3] * (y)[3] }
+#define ml_sqrt_128(x)                                                         \
+    std::array<float, 4> { std::sqrt((x)[0]), std::sqrt((x)[1]),               \
+                           std::sqrt((x)[2]), std::sqrt((x)[3]) }
+
+#endif
+
+namespace ml {
+namespace maths {
+namespace common {
+namespace kdtree_detail {
+
+void blockDistances(const float* coordinates,
+                    std::size_t stride,
+                    std::size_t dimension,
+                    const float* point,
+                    std::size_t n,
+                    float* distances) {
+    // We accumulate the squared differences one coordinate at a time. The
+    // distances are identical to las::distance up to ties and rounding, so
+    // only neighbours which are equidistant to within rounding error can be
+    // ordered differently.
+    for (std::size_t i = 0; i < n; i += 4) {
+        auto squaredDistances = ml_zero_128();
+        for (std::size_t j = 0; j < dimension; ++j) {
+            auto x = ml_broadcast_load_128(point + j);
+            auto y = ml_unaligned_load_128(coordinates + j * stride + i);
+            auto difference = ml_subtract_128(y, x);
+            squaredDistances = ml_add_128(
+                squaredDistances, ml_multiply_128(difference, difference));
+        }
+        ml_unaligned_store_128(distances + i, ml_sqrt_128(squaredDistances));
+    }
+}
+}
+}
+}
+}
@@ -303,6 +303,24 @@ CModelParams& CModel::params() {
     return m_Params;
 }
 
+bool CModel::probabilities(const CModelProbabilityParams& params,
+                           const TTime2Vec1Vec& time,
+                           const TDouble2Vec1Vec& values,
+                           const TDouble2VecWeightsAry1Vec& weights,
+                           TDoubleVec& probabilities) const {
+    probabilities.resize(values.size());
+    CModelProbabilityParams params_{params};
+    SModelProbabilityResult result;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        params_.weights({weights[i]});
+        if (this->probability(params_, time, {values[i]}, result) == false) {
+            return false;
+        }
+        probabilities[i] = result.s_Probability;
+    }
+    return true;
+}
+
 bool CModel::shouldPersist() const {
     return true;
 }
@@ -404,6 +404,35 @@ void CQDigest::summary(TUInt32UInt64PrVec& result) const {
     }
 }
 
+void CQDigest::changePoints(TUInt32Vec& result) const {
+    result.clear();
+    result.push_back(0);
+
+    if (m_N == 0) {
+        return;
+    }
+
+    TNodePtrVec nodes;
+    m_Root->postOrder(nodes);
+
+    result.reserve(3 * nodes.size() + 1);
+
+    // The c.d.f. upper bound changes at each node's minimum, the c.d.f.
+    // lower bound and the sublevel set supremum change at each node's
+    // maximum and the superlevel set infimum changes immediately after
+    // each node's maximum.
+    for (const auto& node : nodes) {
+        result.push_back(node->min());
+        result.push_back(node->max());
+        if (node->max() < std::numeric_limits<std::uint32_t>::max()) {
+            result.push_back(node->max() + 1);
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
 std::uint64_t CQDigest::n() const {
     return m_N;
 }
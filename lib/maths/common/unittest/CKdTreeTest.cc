@@ -9,17 +9,21 @@
  * limitation.
  */
 
+#include <core/CFloatStorage.h>
 #include <core/CLogger.h>
 
+#include <maths/common/CAnnotatedVector.h>
 #include <maths/common/CBasicStatistics.h>
 #include <maths/common/CKdTree.h>
 #include <maths/common/CLinearAlgebra.h>
+#include <maths/common/CLinearAlgebraEigen.h>
 #include <maths/common/CLinearAlgebraTools.h>
 
 #include <test/CRandomNumbers.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <vector>
 
 BOOST_AUTO_TEST_SUITE(CKdTreeTest)
@@ -252,6 +256,132 @@ BOOST_AUTO_TEST_CASE(testNearestNeighbours) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testNearestNeighboursBlockSearch) {
+
+    // Test the block search we use for single precision dense vectors finds
+    // the same neighbours as brute force. We use a range of sizes so we get
+    // a mixture of searches which only see blocks and which are pruned above
+    // the blocks.
+
+    using TFloatVector = maths::common::CDenseVector<core::CFloatStorage>;
+    using TAnnotatedFloatVector = maths::common::CAnnotatedVector<TFloatVector, std::size_t>;
+    using TAnnotatedFloatVectorVec = std::vector<TAnnotatedFloatVector>;
+    using TDoubleSizePr = std::pair<double, std::size_t>;
+    using TDoubleSizePrVec = std::vector<TDoubleSizePr>;
+
+    BOOST_TEST_REQUIRE(maths::common::CKdTree<TAnnotatedFloatVector>::HAS_BLOCK_SEARCH);
+    BOOST_TEST_REQUIRE(maths::common::CKdTree<TVector5>::HAS_BLOCK_SEARCH == false);
+
+    test::CRandomNumbers rng;
+
+    TDoubleVec samples;
+    for (std::size_t dimension : {1, 3, 7}) {
+        for (std::size_t numberPoints : {10, 33, 100, 1000}) {
+            LOG_TRACE(<< "dimension = " << dimension << ", # points = " << numberPoints);
+
+            rng.generateUniformSamples(-100.0, 100.0, dimension * numberPoints, samples);
+
+            TAnnotatedFloatVectorVec points;
+            for (std::size_t i = 0; i < numberPoints; ++i) {
+                TFloatVector point(dimension);
+                for (std::size_t j = 0; j < dimension; ++j) {
+                    point(j) = samples[dimension * i + j];
+                }
+                points.emplace_back(point, i);
+            }
+
+            maths::common::CKdTree<TAnnotatedFloatVector> kdTree;
+            kdTree.build(points);
+            BOOST_TEST_REQUIRE(kdTree.checkInvariants());
+
+            rng.generateUniformSamples(-100.0, 100.0, dimension * 20, samples);
+
+            TAnnotatedFloatVectorVec neighbours;
+            for (std::size_t i = 0; i < 20; ++i) {
+                TFloatVector test(dimension);
+                for (std::size_t j = 0; j < dimension; ++j) {
+                    test(j) = samples[dimension * i + j];
+                }
+
+                TDoubleSizePrVec expectedNeighbours;
+                for (const auto& point : points) {
+                    expectedNeighbours.emplace_back(
+                        maths::common::las::distance(test, point), point.annotation());
+                }
+                std::sort(expectedNeighbours.begin(), expectedNeighbours.end());
+
+                TAnnotatedFloatVector test_{test};
+                const auto* nearest = kdTree.nearestNeighbour(test_);
+                BOOST_TEST_REQUIRE(nearest != nullptr);
+                BOOST_REQUIRE_EQUAL(expectedNeighbours[0].second, nearest->annotation());
+
+                std::size_t k{std::min(i + 1, numberPoints - 1)};
+                kdTree.nearestNeighbours(k, test_, neighbours);
+                BOOST_REQUIRE_EQUAL(k, neighbours.size());
+                for (std::size_t j = 0; j < k; ++j) {
+                    BOOST_REQUIRE_EQUAL(expectedNeighbours[j].second,
+                                        neighbours[j].annotation());
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testApproximateNearestNeighbours) {
+
+    // Test that the distances to the approximate neighbours are within the
+    // requested relative error of the distances to the true neighbours.
+
+    test::CRandomNumbers rng;
+
+    TDoubleVec samples;
+    rng.generateUniformSamples(-100.0, 100.0, 5 * 2000, samples);
+
+    TVector5Vec points;
+    for (std::size_t i = 0; i < samples.size(); i += 5) {
+        points.emplace_back(&samples[i], &samples[i + 5]);
+    }
+
+    rng.generateUniformSamples(-100.0, 100.0, 5 * 50, samples);
+
+    TVector5Vec tests;
+    for (std::size_t i = 0; i < samples.size(); i += 5) {
+        tests.emplace_back(&samples[i], &samples[i + 5]);
+    }
+
+    TDoubleVec approximations{0.0, 0.1, 0.5};
+    TDoubleVec errors;
+
+    for (auto approximation : approximations) {
+
+        maths::common::CKdTree<TVector5> kdTree;
+        kdTree.build(points);
+        kdTree.approximation(approximation);
+        BOOST_TEST_REQUIRE(kdTree.checkInvariants());
+
+        double error{0.0};
+        TDoubleVector5PrVec expectedNeighbours;
+        TVector5Vec neighbours;
+        for (const auto& test : tests) {
+            nearestNeightbours(10, points, test, expectedNeighbours);
+            kdTree.nearestNeighbours(10, test, neighbours);
+            BOOST_REQUIRE_EQUAL(expectedNeighbours.size(), neighbours.size());
+            for (std::size_t i = 0; i < neighbours.size(); ++i) {
+                double expectedDistance{expectedNeighbours[i].first};
+                double distance{(test - neighbours[i]).euclidean()};
+                BOOST_TEST_REQUIRE(distance <= (1.0 + approximation) * expectedDistance);
+                error += distance / expectedDistance - 1.0;
+            }
+        }
+        LOG_DEBUG(<< "approximation = " << approximation << ", mean error = "
+                  << error / static_cast<double>(10 * tests.size()));
+        errors.push_back(error);
+    }
+
+    BOOST_REQUIRE_EQUAL(0.0, errors[0]);
+    BOOST_TEST_REQUIRE(errors[1] <= errors[2]);
+}
+
 BOOST_AUTO_TEST_CASE(testRequestingEveryPoint) {
 
     test::CRandomNumbers rng;
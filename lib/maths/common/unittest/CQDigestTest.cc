@@ -23,6 +23,7 @@
 #include <boost/math/distributions/normal.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <set>
 
 BOOST_AUTO_TEST_SUITE(CQDigestTest)
@@ -276,6 +277,51 @@ BOOST_AUTO_TEST_CASE(testSummary) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testChangePoints) {
+    // Check that the c.d.f. and p.d.f. bounds are equal to their values at
+    // the largest change point less than or equal to each value.
+
+    CRandomNumbers generator;
+
+    for (std::uint64_t k : {5, 20, 50}) {
+        CQDigest qDigest(k);
+
+        CQDigest::TUInt32Vec changePoints;
+        qDigest.changePoints(changePoints);
+        BOOST_REQUIRE_EQUAL(std::string("[0]"), core::CContainerPrinter::print(changePoints));
+
+        TDoubleVec samples;
+        generator.generateGammaSamples(1.0, 100.0, 2000, samples);
+        for (auto sample : samples) {
+            qDigest.add(static_cast<std::uint32_t>(sample));
+        }
+
+        qDigest.changePoints(changePoints);
+        LOG_DEBUG(<< "# change points = " << changePoints.size());
+        BOOST_REQUIRE_EQUAL(0, changePoints[0]);
+        BOOST_TEST_REQUIRE(std::is_sorted(changePoints.begin(), changePoints.end()));
+
+        std::size_t i{0};
+        for (std::uint32_t x = 0; x < 2000; ++x) {
+            while (i + 1 < changePoints.size() && changePoints[i + 1] <= x) {
+                ++i;
+            }
+            double cdfLowerBound[2];
+            double cdfUpperBound[2];
+            double pdfLowerBound[2];
+            double pdfUpperBound[2];
+            qDigest.cdf(x, 0.0, cdfLowerBound[0], cdfUpperBound[0]);
+            qDigest.cdf(changePoints[i], 0.0, cdfLowerBound[1], cdfUpperBound[1]);
+            qDigest.pdf(x, 0.0, pdfLowerBound[0], pdfUpperBound[0]);
+            qDigest.pdf(changePoints[i], 0.0, pdfLowerBound[1], pdfUpperBound[1]);
+            BOOST_REQUIRE_EQUAL(cdfLowerBound[0], cdfLowerBound[1]);
+            BOOST_REQUIRE_EQUAL(cdfUpperBound[0], cdfUpperBound[1]);
+            BOOST_REQUIRE_EQUAL(pdfLowerBound[0], pdfLowerBound[1]);
+            BOOST_REQUIRE_EQUAL(pdfUpperBound[0], pdfUpperBound[1]);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testPropagateForwardByTime) {
     using TMeanAccumlator = CBasicStatistics::SSampleMean<double>::TAccumulator;
 
@@ -476,6 +476,25 @@ double CTimeSeriesDecomposition::detrend(core_t::TTime time,
     return std::min(value - interval(0), 0.0) + std::max(value - interval(1), 0.0);
 }
 
+void CTimeSeriesDecomposition::detrend(core_t::TTime time,
+                                       double confidence,
+                                       bool isNonNegative,
+                                       TDoubleVec& values) const {
+    if (this->initialized() == false) {
+        return;
+    }
+
+    TVector2x1 interval{this->value(time, confidence, E_All ^ E_Seasonal, true) +
+                        this->value(time, confidence, E_Seasonal, true)};
+    if (isNonNegative) {
+        interval = max(interval, 0.0);
+    }
+
+    for (auto& value : values) {
+        value = std::min(value - interval(0), 0.0) + std::max(value - interval(1), 0.0);
+    }
+}
+
 double CTimeSeriesDecomposition::meanVariance() const {
     return m_Components.meanVarianceScale() * m_Components.meanVariance();
 }
@@ -92,6 +92,12 @@ double CTimeSeriesDecompositionStub::detrend(core_t::TTime /*time*/,
     return value;
 }
 
+void CTimeSeriesDecompositionStub::detrend(core_t::TTime /*time*/,
+                                           double /*confidence*/,
+                                           bool /*isNonNegative*/,
+                                           TDoubleVec& /*values*/) const {
+}
+
 double CTimeSeriesDecompositionStub::meanVariance() const {
     return 0.0;
 }
@@ -960,6 +960,49 @@ bool CUnivariateTimeSeriesModel::probability(const common::CModelProbabilityPara
                : this->correlatedProbability(params, time, value, result);
 }
 
+bool CUnivariateTimeSeriesModel::probabilities(const common::CModelProbabilityParams& params,
+                                               const TTime2Vec1Vec& time,
+                                               const TDouble2Vec1Vec& values,
+                                               const TDouble2VecWeightsAry1Vec& weights,
+                                               TDoubleVec& probabilities) const {
+    if ((m_MultibucketFeatureModel != nullptr && params.useMultibucketFeatures()) ||
+        (m_AnomalyModel != nullptr && params.useAnomalyModel()) ||
+        std::any_of(values.begin(), values.end(),
+                    [](const auto& value) { return value.size() != 1; })) {
+        return this->CModel::probabilities(params, time, values, weights, probabilities);
+    }
+
+    maths_t::EProbabilityCalculation calculation{params.calculation(0)};
+
+    probabilities.resize(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        probabilities[i] = values[i][0];
+    }
+    m_TrendModel->detrend(time[0][0], params.seasonalConfidenceInterval(),
+                          m_IsNonNegative, probabilities);
+
+    // Declared outside the loop to minimize the number of times they are created.
+    TDouble1Vec sample(1);
+    maths_t::TDoubleWeightsAry1Vec weight(1);
+    double pl;
+    double pu;
+    maths_t::ETail tail;
+
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        sample[0] = probabilities[i];
+        weight[0] = unpack(weights[i]);
+        if (m_ResidualModel->probabilityOfLessLikelySamples(calculation, sample,
+                                                            weight, pl, pu, tail) == false) {
+            LOG_ERROR(<< "Failed to compute P(" << sample << " | weight = " << weight
+                      << ", time = " << time[0][0] << ")");
+            return false;
+        }
+        probabilities[i] = (pl + pu) / 2.0;
+    }
+
+    return true;
+}
+
 bool CUnivariateTimeSeriesModel::uncorrelatedProbability(
     const common::CModelProbabilityParams& params,
     const TTime2Vec1Vec& time_,
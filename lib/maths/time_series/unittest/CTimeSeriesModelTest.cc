@@ -1505,6 +1505,69 @@ BOOST_AUTO_TEST_CASE(testProbability) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testProbabilities) {
+    // Test the batch probability calculation matches computing the probability
+    // of each value in turn.
+
+    test::CRandomNumbers rng;
+
+    core_t::TTime bucketLength{600};
+
+    maths::time_series::CUnivariateTimeSeriesModel model{
+        modelParams(bucketLength),
+        1, // id
+        maths::time_series::CTimeSeriesDecomposition{24.0 * DECAY_RATE, bucketLength},
+        univariateNormal(),
+        nullptr, // no decay rate control
+        nullptr, // no multi-bucket
+        false};
+
+    TDoubleVec samples;
+    rng.generateNormalSamples(10.0, 4.0, 1000, samples);
+
+    core_t::TTime time{0};
+    const TDouble2VecWeightsAryVec unit{maths_t::CUnitWeights::unit<TDouble2Vec>(1)};
+    for (auto sample : samples) {
+        double trend{5.0 + 5.0 * std::sin(boost::math::double_constants::two_pi *
+                                          static_cast<double>(time) / 86400.0)};
+        model.addSamples(addSampleParams(unit),
+                         {core::make_triple(time, TDouble2Vec{trend + sample}, TAG)});
+        time += bucketLength;
+    }
+
+    TTime2Vec1Vec time_{{time}};
+    TDouble2Vec1Vec values;
+    maths_t::TDouble2VecWeightsAry1Vec weights;
+    for (std::size_t i = 0; i < 20; ++i) {
+        values.push_back({2.0 * static_cast<double>(i)});
+        weights.push_back(maths_t::CUnitWeights::unit<TDouble2Vec>(1));
+        maths_t::setCountVarianceScale(TDouble2Vec{1.0 + 0.1 * static_cast<double>(i % 3)},
+                                       weights.back());
+    }
+
+    for (auto calculation : {maths_t::E_TwoSided, maths_t::E_OneSidedAbove}) {
+        for (auto confidence : {0.0, 50.0}) {
+            maths::common::CModelProbabilityParams params;
+            params.addCalculation(calculation)
+                .seasonalConfidenceInterval(confidence)
+                .useMultibucketFeatures(false)
+                .useAnomalyModel(false);
+
+            TDoubleVec probabilities;
+            BOOST_TEST_REQUIRE(model.probabilities(params, time_, values,
+                                                   weights, probabilities));
+            BOOST_REQUIRE_EQUAL(values.size(), probabilities.size());
+
+            maths::common::SModelProbabilityResult result;
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                params.weights({weights[i]});
+                BOOST_TEST_REQUIRE(model.probability(params, time_, {values[i]}, result));
+                BOOST_REQUIRE_EQUAL(result.s_Probability, probabilities[i]);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testWeights) {
     // Check that the seasonal weight matches the value we expect given
     //   1) the trend and residual model
@@ -29,6 +29,8 @@
 #include <model/CModelFactory.h>
 #include <model/CSearchKey.h>
 
+#include <algorithm>
+#include <atomic>
 #include <sstream>
 #include <vector>
 
@@ -52,6 +54,9 @@ const std::string SIMPLE_COUNT_STATICS("f");
 const std::string PROGRAM_COUNTERS_TAG("b");
 const std::string SAMPLING_TAG("c");
 
+//! Whether to persist and restore the process wide statics.
+std::atomic_bool shouldPersistStatics{true};
+
 // tags for the parts that used to be in model ensemble.
 // !!! NOTE: Tags 'c' & 'e' were previously used for removed
 // state. If new state is added here, tags from `f` onwards
@@ -189,7 +194,7 @@ bool CAnomalyDetector::acceptRestoreTraverser(const std::string& partitionFieldV
                 LOG_ERROR(<< "Invalid model ensemble section in " << traverser.value());
                 return false;
             }
-        } else if (name == SIMPLE_COUNT_STATICS) {
+        } else if (name == SIMPLE_COUNT_STATICS && shouldPersistStatics.load()) {
             if (traverser.traverseSubLevel(std::bind(&CAnomalyDetector::staticsAcceptRestoreTraverser,
                                                      this, std::placeholders::_1)) == false) {
                 LOG_ERROR(<< "Invalid simple count statics in " << traverser.value());
@@ -262,6 +267,14 @@ bool CAnomalyDetector::staticsAcceptRestoreTraverser(core::CStateRestoreTraverse
     return true;
 }
 
+void CAnomalyDetector::persistStatics(bool enabled) {
+    shouldPersistStatics.store(enabled);
+}
+
+bool CAnomalyDetector::persistsStatics() {
+    return shouldPersistStatics.load();
+}
+
 bool CAnomalyDetector::partitionFieldAcceptRestoreTraverser(core::CStateRestoreTraverser& traverser,
                                                             std::string& partitionFieldValue) {
     do {
@@ -320,7 +333,7 @@ void CAnomalyDetector::acceptPersistInserter(core::CStatePersistInserter& insert
     // Persist static members only once within the simple count detector
     // and do this first so that other model components can use
     // static strings
-    if (this->isSimpleCount()) {
+    if (this->isSimpleCount() && shouldPersistStatics.load()) {
         inserter.insertLevel(SIMPLE_COUNT_STATICS,
                              std::bind(&CAnomalyDetector::staticsAcceptPersistInserter,
                                        this, std::placeholders::_1));
@@ -640,6 +653,14 @@ std::size_t CAnomalyDetector::memoryUsage() const {
     return core::memory::dynamicSize(m_DataGatherer) + core::memory::dynamicSize(m_Model);
 }
 
+bool CAnomalyDetector::supportsMemoryTracking() const {
+    return true;
+}
+
+std::size_t CAnomalyDetector::trackedMemoryUsage() const {
+    return m_DataGatherer->trackedMemoryUsage() + m_Model->trackedMemoryUsage();
+}
+
 std::size_t CAnomalyDetector::staticSize() const {
     return sizeof(*this);
 }
@@ -669,6 +690,10 @@ void CAnomalyDetector::updateModelSizeStats(CResourceMonitor::SModelSizeStats& m
     const auto& dataGatherer = m_Model->dataGatherer();
     modelSizeStats.s_OverFields += dataGatherer.numberOverFieldValues();
     modelSizeStats.s_ByFields += dataGatherer.numberByFieldValues();
+    modelSizeStats.s_MaximumMemoryUsagePerFieldValue =
+        std::max({modelSizeStats.s_MaximumMemoryUsagePerFieldValue,
+                  dataGatherer.memoryUsagePerPerson(),
+                  dataGatherer.memoryUsagePerAttribute()});
 }
 
 const core_t::TTime& CAnomalyDetector::lastBucketEndTime() const {
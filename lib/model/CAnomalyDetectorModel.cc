@@ -447,10 +447,17 @@ double CAnomalyDetectorModel::windowBucketCount() const {
     return m_BucketCount;
 }
 
+std::size_t CAnomalyDetectorModel::trackedMemoryUsage() const {
+    return m_TrackedMemoryUsage;
+}
+
 void CAnomalyDetectorModel::createNewModels(std::size_t n, std::size_t /*m*/) {
     if (n > 0) {
+        std::size_t previous{core::memory::dynamicSize(m_PersonBucketCounts)};
         n += m_PersonBucketCounts.size();
         core::CAllocationStrategy::resize(m_PersonBucketCounts, n, 0.0);
+        this->increaseTrackedMemoryUsage(
+            core::memory::dynamicSize(m_PersonBucketCounts) - previous);
     }
 }
 
@@ -663,6 +670,22 @@ bool CMemoryCircuitBreaker::areAllocationsAllowed() const {
     return m_ResourceMonitor->areAllocationsAllowed();
 }
 
+void CAnomalyDetectorModel::increaseTrackedMemoryUsage(std::size_t memory) {
+    m_TrackedMemoryUsage += memory;
+}
+
+void CAnomalyDetectorModel::decreaseTrackedMemoryUsage(std::size_t memory) {
+    // Models restored from state weren't counted when they were created.
+    // Their removal is picked up by the full calculation after pruning.
+    m_TrackedMemoryUsage -= std::min(m_TrackedMemoryUsage, memory);
+}
+
+void CAnomalyDetectorModel::replaceTrackedModel(std::size_t previous,
+                                                const maths::common::CModel& model) {
+    this->decreaseTrackedMemoryUsage(previous);
+    this->increaseTrackedMemoryUsage(core::memory::dynamicSize(&model));
+}
+
 CAnomalyDetectorModel::TUint64TTimePrVec& CAnomalyDetectorModel::appliedRuleChecksums() {
     return m_AppliedRuleChecksums;
 }
@@ -30,8 +30,11 @@
 
 #include <model/CAnomalyDetectorModelConfig.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <sstream>
+#include <tuple>
 #include <vector>
 
 namespace ml {
@@ -282,6 +285,57 @@ bool CAnomalyScore::CNormalizer::normalize(const CMaximumScoreScope& scope,
         return true;
     }
 
+    this->normalize(this->scoreIndependentTerms(), scope, score);
+    return true;
+}
+
+bool CAnomalyScore::CNormalizer::normalize(const TMaximumScoreScopeVec& scopes,
+                                           TDoubleVec& scores) const {
+    if (scopes.size() != scores.size()) {
+        LOG_ERROR(<< "Inconsistent scopes and scores: " << scopes.size()
+                  << " != " << scores.size());
+        return false;
+    }
+    if (m_RawScoreQuantileSummary.n() == 0) {
+        std::fill(scores.begin(), scores.end(), 0.0);
+        return true;
+    }
+
+    const SScoreIndependentTerms& terms{this->scoreIndependentTerms()};
+    for (std::size_t i = 0; i < scores.size(); ++i) {
+        if (scores[i] != 0.0) {
+            this->normalize(terms, scopes[i], scores[i]);
+        }
+    }
+    return true;
+}
+
+const CAnomalyScore::CNormalizer::SScoreIndependentTerms&
+CAnomalyScore::CNormalizer::scoreIndependentTerms() const {
+    if (m_PercentileLookup.s_ScoreIndependentTerms != std::nullopt) {
+        return *m_PercentileLookup.s_ScoreIndependentTerms;
+    }
+
+    SScoreIndependentTerms& result{m_PercentileLookup.s_ScoreIndependentTerms.emplace()};
+    m_RawScoreQuantileSummary.quantile(m_NoisePercentile / 100.0, result.s_NoiseScore);
+    result.s_NoiseKnotPoint = std::lower_bound(m_NormalizedScoreKnotPoints.begin(),
+                                               m_NormalizedScoreKnotPoints.end(),
+                                               TDoubleDoublePr(m_NoisePercentile, 0.0))
+                                  ->second;
+    double l0;
+    double u0;
+    m_RawScoreQuantileSummary.cdf(0, 0.0, l0, u0);
+    result.s_ZeroScoreCeiling =
+        m_MaximumNormalizedScore *
+        std::max(2.0 * std::min(50.0 * (l0 + u0) / m_NoisePercentile, 1.0) - 1.0, 0.0);
+    LOG_TRACE(<< "noiseScore = " << result.s_NoiseScore << ", knotPoint = "
+              << result.s_NoiseKnotPoint << ", l(0) = " << l0 << ", u(0) = " << u0);
+    return result;
+}
+
+void CAnomalyScore::CNormalizer::normalize(const SScoreIndependentTerms& terms,
+                                           const CMaximumScoreScope& scope,
+                                           double& score) const {
     LOG_TRACE(<< "Normalising " << score);
 
     double normalizedScores[]{m_MaximumNormalizedScore, m_MaximumNormalizedScore,
@@ -326,30 +380,19 @@ bool CAnomalyScore::CNormalizer::normalize(const CMaximumScoreScope& scope,
     // c.d.f. of the score and pn the noise percentile. We achieve
     // this by adding "max score" * min(F(0) / "noise percentile",
     // to the score.
-    std::uint32_t noiseScore;
-    m_RawScoreQuantileSummary.quantile(m_NoisePercentile / 100.0, noiseScore);
-    auto knotPoint = std::lower_bound(m_NormalizedScoreKnotPoints.begin(),
-                                      m_NormalizedScoreKnotPoints.end(),
-                                      TDoubleDoublePr(m_NoisePercentile, 0.0));
-    double signalStrength =
-        m_NoiseMultiplier * 10.0 / DISCRETIZATION_FACTOR *
-        (static_cast<double>(discreteScore) - static_cast<double>(noiseScore));
-    double l0;
-    double u0;
-    m_RawScoreQuantileSummary.cdf(0, 0.0, l0, u0);
-    normalizedScores[0] =
-        knotPoint->second * std::max(1.0 + signalStrength, 0.0) +
-        m_MaximumNormalizedScore *
-            std::max(2.0 * std::min(50.0 * (l0 + u0) / m_NoisePercentile, 1.0) - 1.0, 0.0);
+    double signalStrength = m_NoiseMultiplier * 10.0 / DISCRETIZATION_FACTOR *
+                            (static_cast<double>(discreteScore) -
+                             static_cast<double>(terms.s_NoiseScore));
+    normalizedScores[0] = terms.s_NoiseKnotPoint * std::max(1.0 + signalStrength, 0.0) +
+                          terms.s_ZeroScoreCeiling;
     LOG_TRACE(<< "normalizedScores[0] = " << normalizedScores[0]
-              << ", knotPoint = " << knotPoint->second << ", discreteScore = " << discreteScore
-              << ", noiseScore = " << noiseScore << ", l(0) = " << l0
-              << ", u(0) = " << u0 << ", signalStrength = " << signalStrength);
+              << ", discreteScore = " << discreteScore
+              << ", signalStrength = " << signalStrength);
 
     // Compute the raw normalized score percentile compared to historic values.
     double lowerPercentile;
     double upperPercentile;
-    this->quantile(score, 70.0 /*confidence interval*/, lowerPercentile, upperPercentile);
+    this->percentiles(discreteScore, lowerPercentile, upperPercentile);
     lowerPercentile *= 100.0;
     upperPercentile *= 100.0;
     if (lowerPercentile > upperPercentile) {
@@ -421,15 +464,19 @@ bool CAnomalyScore::CNormalizer::normalize(const CMaximumScoreScope& scope,
     score = std::min(*std::min_element(std::begin(normalizedScores), std::end(normalizedScores)),
                      m_MaximumNormalizedScore);
     LOG_TRACE(<< "normalizedScore = " << score << ", scope = " << scope.print());
-
-    return true;
 }
 
 void CAnomalyScore::CNormalizer::quantile(double score,
                                           double confidence,
                                           double& lowerBound,
                                           double& upperBound) const {
-    std::uint32_t discreteScore = this->discreteScore(score);
+    this->discreteScoreQuantile(this->discreteScore(score), confidence, lowerBound, upperBound);
+}
+
+void CAnomalyScore::CNormalizer::discreteScoreQuantile(std::uint32_t discreteScore,
+                                                       double confidence,
+                                                       double& lowerBound,
+                                                       double& upperBound) const {
     double n = static_cast<double>(m_RawScoreQuantileSummary.n());
     double lowerQuantile = (100.0 - confidence) / 200.0;
     double upperQuantile = (100.0 + confidence) / 200.0;
@@ -453,14 +500,15 @@ void CAnomalyScore::CNormalizer::quantile(double score,
         upperBound = maths::common::CTools::truncate(upperBound - pdfLowerBound, 0.0, fu);
         if (!(lowerBound >= 0.0 && lowerBound <= 1.0) ||
             !(upperBound >= 0.0 && upperBound <= 1.0)) {
-            LOG_ERROR(<< "score = " << score << ", cdf = [" << lowerBound << ","
-                      << upperBound << "]"
+            LOG_ERROR(<< "discreteScore = " << discreteScore << ", cdf = ["
+                      << lowerBound << "," << upperBound << "]"
                       << ", pdf = [" << pdfLowerBound << "," << pdfUpperBound << "]");
         }
         lowerBound = maths::common::CQDigest::cdfQuantile(n, lowerBound, lowerQuantile);
         upperBound = maths::common::CQDigest::cdfQuantile(n, upperBound, upperQuantile);
 
-        LOG_TRACE(<< "score = " << score << ", cdf = [" << lowerBound << "," << upperBound << "]"
+        LOG_TRACE(<< "discreteScore = " << discreteScore << ", cdf = [" << lowerBound
+                  << "," << upperBound << "]"
                   << ", pdf = [" << pdfLowerBound << "," << pdfUpperBound << "]");
 
         return;
@@ -492,7 +540,8 @@ void CAnomalyScore::CNormalizer::quantile(double score,
                                    std::numeric_limits<double>::epsilon());
     if (!(lowerBound >= 0.0 && lowerBound <= 1.0) ||
         !(upperBound >= 0.0 && upperBound <= 1.0)) {
-        LOG_ERROR(<< "score = " << score << ", cdf = [" << lowerBound << "," << upperBound << "]"
+        LOG_ERROR(<< "discreteScore = " << discreteScore << ", cdf = [" << lowerBound
+                  << "," << upperBound << "]"
                   << ", cutoff = [" << cutoffCdfLowerBound << "," << cutoffCdfUpperBound << "]"
                   << ", pdf = [" << pdfLowerBound << "," << pdfUpperBound << "]"
                   << ", f = " << f);
@@ -500,12 +549,57 @@ void CAnomalyScore::CNormalizer::quantile(double score,
     lowerBound = maths::common::CQDigest::cdfQuantile(n, lowerBound, lowerQuantile);
     upperBound = maths::common::CQDigest::cdfQuantile(n, upperBound, upperQuantile);
 
-    LOG_TRACE(<< "score = " << score << ", cdf = [" << lowerBound << "," << upperBound << "]"
+    LOG_TRACE(<< "discreteScore = " << discreteScore << ", cdf = [" << lowerBound
+              << "," << upperBound << "]"
               << ", cutoff = [" << cutoffCdfLowerBound << "," << cutoffCdfUpperBound << "]"
               << ", pdf = [" << pdfLowerBound << "," << pdfUpperBound << "]"
               << ", f = " << f);
 }
 
+void CAnomalyScore::CNormalizer::percentiles(std::uint32_t discreteScore,
+                                             double& lowerBound,
+                                             double& upperBound) const {
+    auto& lookup = m_PercentileLookup;
+
+    if (lookup.s_ChangePoints.empty()) {
+        if (++lookup.s_NumberQueries < MINIMUM_QUERIES_FOR_PERCENTILE_LOOKUP) {
+            this->discreteScoreQuantile(discreteScore, 70.0 /*confidence interval*/,
+                                        lowerBound, upperBound);
+            return;
+        }
+
+        // The percentile range is a piecewise constant function of the
+        // discrete score which can only change at the change points of
+        // either quantile summary or where we switch summary.
+        TUInt32Vec highChangePoints;
+        m_RawScoreQuantileSummary.changePoints(lookup.s_ChangePoints);
+        m_RawScoreHighQuantileSummary.changePoints(highChangePoints);
+        lookup.s_ChangePoints.insert(lookup.s_ChangePoints.end(),
+                                     highChangePoints.begin(), highChangePoints.end());
+        if (m_HighPercentileScore < std::numeric_limits<std::uint32_t>::max()) {
+            lookup.s_ChangePoints.push_back(m_HighPercentileScore + 1);
+        }
+        std::sort(lookup.s_ChangePoints.begin(), lookup.s_ChangePoints.end());
+        lookup.s_ChangePoints.erase(std::unique(lookup.s_ChangePoints.begin(),
+                                                lookup.s_ChangePoints.end()),
+                                    lookup.s_ChangePoints.end());
+        lookup.s_Percentiles.assign(lookup.s_ChangePoints.size(), std::nullopt);
+        LOG_TRACE(<< "# change points = " << lookup.s_ChangePoints.size());
+    }
+
+    // The first change point is always zero so this is never the start.
+    std::size_t i = std::upper_bound(lookup.s_ChangePoints.begin(),
+                                     lookup.s_ChangePoints.end(), discreteScore) -
+                    lookup.s_ChangePoints.begin() - 1;
+    auto& range = lookup.s_Percentiles[i];
+    if (range == std::nullopt) {
+        range.emplace();
+        this->discreteScoreQuantile(discreteScore, 70.0 /*confidence interval*/,
+                                    range->first, range->second);
+    }
+    std::tie(lowerBound, upperBound) = *range;
+}
+
 bool CAnomalyScore::CNormalizer::updateQuantiles(const CMaximumScoreScope& scope, double score) {
     using TUInt32UInt64Pr = std::pair<std::uint32_t, std::uint64_t>;
     using TUInt32UInt64PrVec = std::vector<TUInt32UInt64Pr>;
@@ -529,6 +623,7 @@ bool CAnomalyScore::CNormalizer::updateQuantiles(const CMaximumScoreScope& scope
 
     m_CountSinceLastSample = 0;
     m_Sample = 0.0;
+    m_PercentileLookup.clear();
 
     std::uint64_t n = m_RawScoreQuantileSummary.n();
     std::uint64_t k = m_RawScoreQuantileSummary.k();
@@ -692,6 +787,7 @@ void CAnomalyScore::CNormalizer::propagateForwardByTime(double time) {
         time = std::floor((QUANTILE_DECAY_TIME - m_TimeToQuantileDecay) / QUANTILE_DECAY_TIME);
 
         std::uint64_t n = m_RawScoreQuantileSummary.n();
+        m_PercentileLookup.clear();
         m_RawScoreQuantileSummary.propagateForwardsByTime(time);
         m_RawScoreHighQuantileSummary.propagateForwardsByTime(time);
         if (n > 0) {
@@ -759,6 +855,7 @@ bool CAnomalyScore::CNormalizer::upgrade(const std::string& loadedVersion,
         element.second.age(highScoreUpgradeFactor);
     }
 
+    m_PercentileLookup.clear();
     if (m_RawScoreQuantileSummary.scale(qDigestUpgradeFactor) == false) {
         LOG_ERROR(<< "Failed to scale raw score quantiles");
         return false;
@@ -782,6 +879,7 @@ void CAnomalyScore::CNormalizer::clear() {
     m_RawScoreQuantileSummary.clear();
     m_RawScoreHighQuantileSummary.clear();
     m_TimeToQuantileDecay = QUANTILE_DECAY_TIME;
+    m_PercentileLookup.clear();
 }
 
 void CAnomalyScore::CNormalizer::acceptPersistInserter(core::CStatePersistInserter& inserter) const {
@@ -804,6 +902,7 @@ void CAnomalyScore::CNormalizer::acceptPersistInserter(core::CStatePersistInsert
 }
 
 bool CAnomalyScore::CNormalizer::acceptRestoreTraverser(core::CStateRestoreTraverser& traverser) {
+    m_PercentileLookup.clear();
     do {
         const std::string& name = traverser.name();
         LOG_TRACE(<< "name: " << name);
@@ -913,6 +1012,13 @@ std::string CAnomalyScore::CNormalizer::CMaximumScoreScope::print() const {
            m_PersonFieldValue.get().value_or("") + "\"";
 }
 
+void CAnomalyScore::CNormalizer::SPercentileLookup::clear() {
+    s_NumberQueries = 0;
+    s_ChangePoints.clear();
+    s_Percentiles.clear();
+    s_ScoreIndependentTerms.reset();
+}
+
 void CAnomalyScore::CNormalizer::CMaxScore::add(double score) {
     m_Score.add(score);
     m_TimeSinceLastScore = 0.0;
@@ -24,8 +24,6 @@
 
 #include <model/CDataGatherer.h>
 
-#include <boost/tuple/tuple.hpp>
-
 #include <algorithm>
 #include <map>
 
@@ -195,6 +193,33 @@ struct SInfluencerCountsPersister {
     }
 };
 
+//! Get the memory allocated by an open addressing table which grew
+//! from \p capacity buckets.
+template<typename TABLE>
+std::size_t tableGrowth(const TABLE& table, std::size_t capacity) {
+    return (table.bucket_count() - capacity) * sizeof(typename TABLE::value_type);
+}
+
+//! \brief Clears a bucket's values retaining its storage for reuse.
+struct SClearBucket {
+    template<typename T>
+    void operator()(T& bucket) const {
+        bucket.clear();
+    }
+};
+
+//! \brief Clears a bucket's influencer values retaining their storage
+//! for reuse.
+struct SClearInfluencerBuckets {
+    void operator()(CBucketGatherer::TSizeSizePrOptionalStrPrUInt64UMapVec& buckets) const {
+        for (auto& bucket : buckets) {
+            bucket.clear();
+        }
+        buckets.resize(static_cast<std::size_t>(s_NumberInfluences));
+    }
+    std::ptrdiff_t s_NumberInfluences;
+};
+
 } // detail::
 } // unnamed::
 
@@ -224,7 +249,8 @@ CBucketGatherer::CBucketGatherer(bool isForPersistence, const CBucketGatherer& o
       m_EarliestTime(other.m_EarliestTime), m_BucketStart(other.m_BucketStart),
       m_PersonAttributeCounts(other.m_PersonAttributeCounts),
       m_PersonAttributeExplicitNulls(other.m_PersonAttributeExplicitNulls),
-      m_InfluencerCounts(other.m_InfluencerCounts) {
+      m_InfluencerCounts(other.m_InfluencerCounts),
+      m_TrackedMemoryUsage(other.m_TrackedMemoryUsage) {
     if (!isForPersistence) {
         LOG_ABORT(<< "This constructor only creates clones for persistence");
     }
@@ -269,13 +295,17 @@ bool CBucketGatherer::addEventData(CEventData& data) {
         if (data.isExplicitNull()) {
             TSizeSizePrUSet& bucketExplicitNulls =
                 m_PersonAttributeExplicitNulls.get(time);
+            std::size_t capacity{bucketExplicitNulls.bucket_count()};
             bucketExplicitNulls.insert(pidCid);
+            this->increaseTrackedMemoryUsage(detail::tableGrowth(bucketExplicitNulls, capacity));
             return true;
         }
 
         TSizeSizePrUInt64UMap& bucketCounts = m_PersonAttributeCounts.get(time);
         if (count > 0) {
+            std::size_t capacity{bucketCounts.bucket_count()};
             bucketCounts[pidCid] += count;
+            this->increaseTrackedMemoryUsage(detail::tableGrowth(bucketCounts, capacity));
         }
 
         const CEventData::TOptionalStrVec& influences = data.influences();
@@ -294,11 +324,10 @@ bool CBucketGatherer::addEventData(CEventData& data) {
                 const std::string& inf = *influence;
                 canonicalInfluences[i] = inf;
                 if (count > 0) {
-                    influencerCounts[i]
-                        .emplace(boost::unordered::piecewise_construct,
-                                 boost::make_tuple(pidCid, inf),
-                                 boost::make_tuple(std::uint64_t(0)))
-                        .first->second += count;
+                    std::size_t capacity{influencerCounts[i].bucket_count()};
+                    influencerCounts[i][{pidCid, inf}] += count;
+                    this->increaseTrackedMemoryUsage(
+                        detail::tableGrowth(influencerCounts[i], capacity));
                 }
             }
         }
@@ -326,10 +355,10 @@ void CBucketGatherer::hiddenTimeNow(core_t::TTime time, bool skipUpdates) {
         // after startNewBucket has been called.
         std::ptrdiff_t numberInfluences{this->endInfluencers() - this->beginInfluencers()};
         this->startNewBucket(newBucketStart, skipUpdates);
-        m_PersonAttributeCounts.push(TSizeSizePrUInt64UMap(1), newBucketStart);
-        m_PersonAttributeExplicitNulls.push(TSizeSizePrUSet(1), newBucketStart);
-        m_InfluencerCounts.push(TSizeSizePrOptionalStrPrUInt64UMapVec(numberInfluences),
-                                newBucketStart);
+        m_PersonAttributeCounts.recycle(detail::SClearBucket{}, newBucketStart);
+        m_PersonAttributeExplicitNulls.recycle(detail::SClearBucket{}, newBucketStart);
+        m_InfluencerCounts.recycle(detail::SClearInfluencerBuckets{numberInfluences},
+                                   newBucketStart);
         m_BucketStart = newBucketStart;
     }
 }
@@ -561,7 +590,20 @@ std::size_t CBucketGatherer::memoryUsage() const {
     return mem;
 }
 
+std::size_t CBucketGatherer::trackedMemoryUsage() const {
+    return m_TrackedMemoryUsage;
+}
+
+void CBucketGatherer::increaseTrackedMemoryUsage(std::size_t memory) {
+    m_TrackedMemoryUsage += memory;
+}
+
+void CBucketGatherer::decreaseTrackedMemoryUsage(std::size_t memory) {
+    m_TrackedMemoryUsage -= std::min(m_TrackedMemoryUsage, memory);
+}
+
 void CBucketGatherer::clear() {
+    m_TrackedMemoryUsage = 0;
     m_PersonAttributeCounts.clear(TSizeSizePrUInt64UMap(1));
     m_PersonAttributeExplicitNulls.clear(TSizeSizePrUSet(1));
     m_InfluencerCounts.clear(TSizeSizePrOptionalStrPrUInt64UMapVec(
@@ -583,9 +625,9 @@ bool CBucketGatherer::resetBucket(core_t::TTime bucketStart) {
 
     LOG_TRACE(<< "Resetting bucket starting at " << bucketStart);
     std::ptrdiff_t numberInfluences{this->endInfluencers() - this->beginInfluencers()};
-    m_PersonAttributeCounts.get(bucketStart).clear();
-    m_PersonAttributeExplicitNulls.get(bucketStart).clear();
-    m_InfluencerCounts.get(bucketStart) = TSizeSizePrOptionalStrPrUInt64UMapVec(numberInfluences);
+    detail::SClearBucket{}(m_PersonAttributeCounts.get(bucketStart));
+    detail::SClearBucket{}(m_PersonAttributeExplicitNulls.get(bucketStart));
+    detail::SClearInfluencerBuckets{numberInfluences}(m_InfluencerCounts.get(bucketStart));
     return true;
 }
 
@@ -637,6 +679,7 @@ bool CBucketGatherer::baseAcceptRestoreTraverser(core::CStateRestoreTraverser& t
                                          m_PersonAttributeExplicitNulls, traverser),
             /**/)
     } while (traverser.next());
+    m_TrackedMemoryUsage = this->CBucketGatherer::memoryUsage();
     return true;
 }
 }
@@ -408,7 +408,9 @@ void CCountingModel::createUpdateNewModels(core_t::TTime /*time*/,
 
 void CCountingModel::createNewModels(std::size_t n, std::size_t m) {
     if (n > 0) {
+        std::size_t previous{core::memory::dynamicSize(m_MeanCounts)};
         core::CAllocationStrategy::resize(m_MeanCounts, m_MeanCounts.size() + n);
+        this->increaseTrackedMemoryUsage(core::memory::dynamicSize(m_MeanCounts) - previous);
     }
     this->CAnomalyDetectorModel::createNewModels(n, m);
 }
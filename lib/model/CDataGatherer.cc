@@ -347,6 +347,10 @@ std::size_t CDataGatherer::numberActivePeople() const {
     return m_PeopleRegistry.numberActiveNames();
 }
 
+std::size_t CDataGatherer::memoryUsagePerPerson() const {
+    return m_PeopleRegistry.memoryUsagePerName();
+}
+
 std::size_t CDataGatherer::numberPeople() const {
     return m_PeopleRegistry.numberNames();
 }
@@ -420,6 +424,10 @@ std::size_t CDataGatherer::numberActiveAttributes() const {
     return m_AttributesRegistry.numberActiveNames();
 }
 
+std::size_t CDataGatherer::memoryUsagePerAttribute() const {
+    return m_AttributesRegistry.memoryUsagePerName();
+}
+
 std::size_t CDataGatherer::numberAttributes() const {
     return m_AttributesRegistry.numberNames();
 }
@@ -578,6 +586,15 @@ std::size_t CDataGatherer::memoryUsage() const {
     return mem;
 }
 
+std::size_t CDataGatherer::trackedMemoryUsage() const {
+    std::size_t mem{m_PeopleRegistry.trackedMemoryUsage() +
+                    m_AttributesRegistry.trackedMemoryUsage()};
+    if (m_BucketGatherer != nullptr) {
+        mem += m_BucketGatherer->trackedMemoryUsage();
+    }
+    return mem;
+}
+
 bool CDataGatherer::useNull() const {
     return m_UseNull;
 }
@@ -30,6 +30,17 @@ namespace {
 const std::string NAMES_TAG("a");
 const std::string FREE_NAMES_TAG("b");
 const std::string RECYCLED_NAMES_TAG("c");
+
+//! The memory used by an entry of the name to identifier map. This is
+//! one slot plus a byte of group metadata scaled up by the reciprocal of
+//! the open addressing table's maximum load factor of 0.875.
+const std::size_t UID_NODE_MEMORY_USAGE{
+    (8 * (sizeof(CDynamicStringIdRegistry::TWordSizeUMap::value_type) + 1) + 6) / 7};
+
+//! Get the memory used to store \p name.
+std::size_t nameMemoryUsage(const std::string& name) {
+    return sizeof(std::string) + core::memory::dynamicSize(name);
+}
 }
 
 CDynamicStringIdRegistry::CDynamicStringIdRegistry(const std::string& nameType,
@@ -47,7 +58,8 @@ CDynamicStringIdRegistry::CDynamicStringIdRegistry(bool isForPersistence,
       m_AddNotAllowedCounter(other.m_AddNotAllowedCounter),
       m_RecycledCounter(other.m_RecycledCounter), m_Dictionary(other.m_Dictionary),
       m_Uids(other.m_Uids), m_Names(other.m_Names),
-      m_FreeUids(other.m_FreeUids), m_RecycledUids(other.m_RecycledUids) {
+      m_FreeUids(other.m_FreeUids), m_RecycledUids(other.m_RecycledUids),
+      m_TrackedMemoryUsage(other.m_TrackedMemoryUsage) {
     if (!isForPersistence) {
         LOG_ABORT(<< "This constructor only creates clones for persistence");
     }
@@ -58,7 +70,7 @@ const std::string& CDynamicStringIdRegistry::name(std::size_t id,
     return id >= m_Names.size() ? fallback : m_Names[id];
 }
 
-bool CDynamicStringIdRegistry::id(const std::string& name, std::size_t& result) const {
+bool CDynamicStringIdRegistry::id(std::string_view name, std::size_t& result) const {
     TWordSizeUMapCItr itr = m_Uids.find(m_Dictionary.word(name));
     if (itr == m_Uids.end()) {
         result = INVALID_ID;
@@ -96,19 +108,21 @@ std::size_t CDynamicStringIdRegistry::addName(const std::string& name,
                                               CResourceMonitor& resourceMonitor,
                                               bool& addedPerson) {
     // Get the identifier or create one if this is the
-    // first time we've seen them. (Use emplace to avoid copying
-    // the string if it is already in the collection.)
+    // first time we've seen them. (The table is keyed by the
+    // name's dictionary word so the string is never copied
+    // if it is already in the collection.)
 
     std::size_t newId = m_FreeUids.empty() ? m_Names.size() : m_FreeUids.back();
 
     std::size_t id = 0;
+    TDictionary::CWord word{m_Dictionary.word(name)};
 
     // Is there any space in the system for us to expand the models?
     if (resourceMonitor.areAllocationsAllowed()) {
-        id = m_Uids.emplace(m_Dictionary.word(name), newId).first->second;
+        id = m_Uids.try_emplace(word, newId).first->second;
     } else {
         // In this case we can only deal with existing people
-        TWordSizeUMapCItr itr = m_Uids.find(m_Dictionary.word(name));
+        TWordSizeUMapCItr itr = m_Uids.find(word);
         if (itr == m_Uids.end()) {
             LOG_TRACE(<< "Can't add new " << m_NameType << " - allocations not allowed");
             resourceMonitor.acceptAllocationFailureResult(time);
@@ -120,10 +134,13 @@ std::size_t CDynamicStringIdRegistry::addName(const std::string& name,
 
     if (id >= m_Names.size()) {
         m_Names.emplace_back(name);
+        m_TrackedMemoryUsage += nameMemoryUsage(name) + UID_NODE_MEMORY_USAGE;
         addedPerson = true;
         ++core::CProgramCounters::counter(m_AddedCounter);
     } else if (id == newId) {
         LOG_TRACE(<< "Recycling " << id << " for " << m_NameType << " " << name);
+        m_TrackedMemoryUsage += nameMemoryUsage(name) + UID_NODE_MEMORY_USAGE;
+        m_TrackedMemoryUsage -= nameMemoryUsage(m_Names[id]);
         m_Names[id] = name;
         if (m_FreeUids.empty()) {
             LOG_ERROR(<< "Unexpectedly missing free " << m_NameType << " entry for " << id);
@@ -144,7 +161,8 @@ void CDynamicStringIdRegistry::removeNames(std::size_t lowestNameToRemove) {
     }
 
     for (std::size_t id = lowestNameToRemove; id < numberNames; ++id) {
-        m_Uids.erase(m_Dictionary.word(m_Names[id]));
+        std::size_t erased{m_Uids.erase(m_Dictionary.word(m_Names[id]))};
+        m_TrackedMemoryUsage -= nameMemoryUsage(m_Names[id]) + erased * UID_NODE_MEMORY_USAGE;
     }
     m_Names.erase(m_Names.begin() + lowestNameToRemove, m_Names.end());
 }
@@ -158,7 +176,9 @@ void CDynamicStringIdRegistry::recycleNames(const TSizeVec& namesToRemove,
             continue;
         }
         m_FreeUids.push_back(id);
-        m_Uids.erase(m_Dictionary.word(m_Names[id]));
+        std::size_t erased{m_Uids.erase(m_Dictionary.word(m_Names[id]))};
+        m_TrackedMemoryUsage += nameMemoryUsage(defaultName);
+        m_TrackedMemoryUsage -= nameMemoryUsage(m_Names[id]) + erased * UID_NODE_MEMORY_USAGE;
         m_Names[id] = defaultName;
     }
     std::sort(m_FreeUids.begin(), m_FreeUids.end(), std::greater<>());
@@ -201,6 +221,7 @@ void CDynamicStringIdRegistry::clear() {
     m_Names.clear();
     m_FreeUids.clear();
     m_RecycledUids.clear();
+    m_TrackedMemoryUsage = 0;
 }
 
 std::uint64_t CDynamicStringIdRegistry::checksum() const {
@@ -237,6 +258,15 @@ std::size_t CDynamicStringIdRegistry::memoryUsage() const {
     return mem;
 }
 
+std::size_t CDynamicStringIdRegistry::trackedMemoryUsage() const {
+    return m_TrackedMemoryUsage;
+}
+
+std::size_t CDynamicStringIdRegistry::memoryUsagePerName() const {
+    std::size_t numberActiveNames{this->numberActiveNames()};
+    return numberActiveNames == 0 ? 0 : m_TrackedMemoryUsage / numberActiveNames;
+}
+
 void CDynamicStringIdRegistry::acceptPersistInserter(core::CStatePersistInserter& inserter) const {
     // Explicity save all shared strings, on the understanding that any other
     // owners will also save their copies
@@ -266,12 +296,15 @@ bool CDynamicStringIdRegistry::acceptRestoreTraverser(core::CStateRestoreTravers
     // Some of the entries in m_Names may relate to IDs that are free to
     // reuse. We mustn't add these to the ID maps.
 
+    m_TrackedMemoryUsage = 0;
     for (std::size_t id = 0; id < m_Names.size(); ++id) {
+        m_TrackedMemoryUsage += nameMemoryUsage(m_Names[id]);
         if (std::binary_search(m_FreeUids.begin(), m_FreeUids.end(), id, std::greater<>())) {
             LOG_TRACE(<< "Restore ignoring free " << m_NameType << " name "
                       << m_Names[id] << " = id " << id);
         } else {
             m_Uids[m_Dictionary.word(m_Names[id])] = id;
+            m_TrackedMemoryUsage += UID_NODE_MEMORY_USAGE;
         }
     }
 
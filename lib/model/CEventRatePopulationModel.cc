@@ -962,9 +962,12 @@ CEventRatePopulationModel::currentBucketInterimCorrections() const {
 
 void CEventRatePopulationModel::createNewModels(std::size_t n, std::size_t m) {
     if (m > 0) {
+        std::size_t added{0};
         for (auto& feature : m_FeatureModels) {
             std::size_t newM = feature.s_Models.size() + m;
+            std::size_t capacity{feature.s_Models.capacity()};
             core::CAllocationStrategy::reserve(feature.s_Models, newM);
+            added += (feature.s_Models.capacity() - capacity) * sizeof(TMathsModelUPtr);
             for (std::size_t cid = feature.s_Models.size(); cid < newM; ++cid) {
                 feature.s_Models.emplace_back(feature.s_NewModel->clone(cid));
                 for (const auto& correlates : m_FeatureCorrelatesModels) {
@@ -972,8 +975,10 @@ void CEventRatePopulationModel::createNewModels(std::size_t n, std::size_t m) {
                         feature.s_Models.back()->modelCorrelations(*correlates.s_Models);
                     }
                 }
+                added += core::memory::dynamicSize(feature.s_Models.back());
             }
         }
+        this->increaseTrackedMemoryUsage(added);
     }
     this->CPopulationModel::createNewModels(n, m);
 }
@@ -983,12 +988,14 @@ void CEventRatePopulationModel::updateRecycledModels() {
     for (auto cid : gatherer.recycledAttributeIds()) {
         for (auto& feature : m_FeatureModels) {
             if (cid < feature.s_Models.size()) {
+                std::size_t previous{core::memory::dynamicSize(feature.s_Models[cid])};
                 feature.s_Models[cid].reset(feature.s_NewModel->clone(cid));
                 for (const auto& correlates : m_FeatureCorrelatesModels) {
                     if (feature.s_Feature == correlates.s_Feature) {
                         feature.s_Models.back()->modelCorrelations(*correlates.s_Models);
                     }
                 }
+                this->replaceTrackedModel(previous, *feature.s_Models[cid]);
             }
         }
     }
@@ -1016,7 +1023,9 @@ void CEventRatePopulationModel::clearPrunedResources(const TSizeVec& /*people*/,
     for (auto cid : attributes) {
         for (auto& feature : m_FeatureModels) {
             if (cid < feature.s_Models.size()) {
+                std::size_t previous{core::memory::dynamicSize(feature.s_Models[cid])};
                 feature.s_Models[cid].reset(this->tinyModel());
+                this->replaceTrackedModel(previous, *feature.s_Models[cid]);
             }
         }
     }
@@ -485,13 +485,19 @@ void CIndividualModel::createUpdateNewModels(core_t::TTime time,
 
 void CIndividualModel::createNewModels(std::size_t n, std::size_t m) {
     if (n > 0) {
+        std::size_t previous{core::memory::dynamicSize(m_FirstBucketTimes) +
+                             core::memory::dynamicSize(m_LastBucketTimes)};
         std::size_t newN = m_FirstBucketTimes.size() + n;
         core::CAllocationStrategy::resize(m_FirstBucketTimes, newN,
                                           CAnomalyDetectorModel::TIME_UNSET);
         core::CAllocationStrategy::resize(m_LastBucketTimes, newN,
                                           CAnomalyDetectorModel::TIME_UNSET);
+        std::size_t added{core::memory::dynamicSize(m_FirstBucketTimes) +
+                          core::memory::dynamicSize(m_LastBucketTimes) - previous};
         for (auto& feature : m_FeatureModels) {
+            std::size_t capacity{feature.s_Models.capacity()};
             core::CAllocationStrategy::reserve(feature.s_Models, newN);
+            added += (feature.s_Models.capacity() - capacity) * sizeof(TMathsModelUPtr);
             for (std::size_t pid = feature.s_Models.size(); pid < newN; ++pid) {
                 feature.s_Models.emplace_back(feature.s_NewModel->clone(pid));
                 for (const auto& correlates : m_FeatureCorrelatesModels) {
@@ -499,8 +505,10 @@ void CIndividualModel::createNewModels(std::size_t n, std::size_t m) {
                         feature.s_Models.back()->modelCorrelations(*correlates.s_Models);
                     }
                 }
+                added += core::memory::dynamicSize(feature.s_Models.back());
             }
         }
+        this->increaseTrackedMemoryUsage(added);
     }
     this->CAnomalyDetectorModel::createNewModels(n, m);
 }
@@ -511,12 +519,14 @@ void CIndividualModel::updateRecycledModels() {
             m_FirstBucketTimes[pid] = CAnomalyDetectorModel::TIME_UNSET;
             m_LastBucketTimes[pid] = CAnomalyDetectorModel::TIME_UNSET;
             for (auto& feature : m_FeatureModels) {
+                std::size_t previous{core::memory::dynamicSize(feature.s_Models[pid])};
                 feature.s_Models[pid].reset(feature.s_NewModel->clone(pid));
                 for (const auto& correlates : m_FeatureCorrelatesModels) {
                     if (feature.s_Feature == correlates.s_Feature) {
                         feature.s_Models.back()->modelCorrelations(*correlates.s_Models);
                     }
                 }
+                this->replaceTrackedModel(previous, *feature.s_Models[pid]);
             }
         }
     }
@@ -544,7 +554,9 @@ void CIndividualModel::clearPrunedResources(const TSizeVec& people,
     for (auto pid : people) {
         for (auto& feature : m_FeatureModels) {
             if (pid < feature.s_Models.size()) {
+                std::size_t previous{core::memory::dynamicSize(feature.s_Models[pid])};
                 feature.s_Models[pid].reset(this->tinyModel());
+                this->replaceTrackedModel(previous, *feature.s_Models[pid]);
             }
         }
     }
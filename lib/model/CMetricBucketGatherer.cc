@@ -607,10 +607,11 @@ public:
     void operator()(const TCategorySizePr& /*category*/,
                     TSizeSizeTUMapUMap<T>& data,
                     std::size_t begin,
-                    std::size_t end) const {
+                    std::size_t end,
+                    std::size_t& removedMemory) const {
         for (auto& cidEntry : data) {
             for (std::size_t pid = begin; pid < end; ++pid) {
-                cidEntry.second.erase(pid);
+                removedMemory += erase(cidEntry.second, pid);
             }
         }
     }
@@ -618,13 +619,26 @@ public:
     template<typename T>
     void operator()(const TCategorySizePr& /*category*/,
                     TSizeSizeTUMapUMap<T>& data,
-                    const TSizeVec& peopleToRemove) const {
+                    const TSizeVec& peopleToRemove,
+                    std::size_t& removedMemory) const {
         for (auto& cidEntry : data) {
             for (auto pid : peopleToRemove) {
-                cidEntry.second.erase(pid);
+                removedMemory += erase(cidEntry.second, pid);
             }
         }
     }
+
+    //! Erase \p pid from \p data and return the memory it used.
+    template<typename T>
+    static std::size_t erase(TSizeTUMap<T>& data, std::size_t pid) {
+        auto i = data.find(pid);
+        if (i == data.end()) {
+            return 0;
+        }
+        std::size_t memory{sizeof(*i) + core::memory::dynamicSize(i->second)};
+        data.erase(i);
+        return memory;
+    }
 };
 
 //! Removes attributes from the data gatherers.
@@ -632,9 +646,10 @@ struct SRemoveAttributes {
     template<typename T>
     void operator()(const TCategorySizePr& /*category*/,
                     TSizeSizeTUMapUMap<T>& data,
-                    const TSizeVec& attributesToRemove) const {
+                    const TSizeVec& attributesToRemove,
+                    std::size_t& removedMemory) const {
         for (auto cid : attributesToRemove) {
-            data.erase(cid);
+            removedMemory += erase(data, cid);
         }
     }
 
@@ -642,10 +657,23 @@ struct SRemoveAttributes {
     void operator()(const TCategorySizePr& /*category*/,
                     TSizeSizeTUMapUMap<T>& data,
                     std::size_t begin,
-                    std::size_t end) const {
+                    std::size_t end,
+                    std::size_t& removedMemory) const {
         for (std::size_t cid = begin; cid < end; ++cid) {
-            data.erase(cid);
+            removedMemory += erase(data, cid);
+        }
+    }
+
+    //! Erase \p cid from \p data and return the memory it used.
+    template<typename T>
+    static std::size_t erase(TSizeSizeTUMapUMap<T>& data, std::size_t cid) {
+        auto i = data.find(cid);
+        if (i == data.end()) {
+            return 0;
         }
+        std::size_t memory{core::memory::dynamicSize(i->second)};
+        data.erase(i);
+        return memory;
     }
 };
 
@@ -857,18 +885,20 @@ struct SAddValue {
                            std::size_t pid,
                            std::size_t cid,
                            const CMetricBucketGatherer& gatherer,
-                           const SStatistic& stat) const {
-        auto& entry =
-            data[cid]
-                .emplace(boost::unordered::piecewise_construct, boost::make_tuple(pid),
-                         boost::make_tuple(
-                             std::cref(gatherer.dataGatherer().params()),
-                             category.second, gatherer.currentBucketStartTime(),
-                             gatherer.bucketLength(), gatherer.beginInfluencers(),
-                             gatherer.endInfluencers()))
-                .first->second;
+                           const SStatistic& stat,
+                           std::size_t& addedMemory) const {
+        auto inserted = data[cid].emplace(
+            boost::unordered::piecewise_construct, boost::make_tuple(pid),
+            boost::make_tuple(std::cref(gatherer.dataGatherer().params()),
+                              category.second, gatherer.currentBucketStartTime(),
+                              gatherer.bucketLength(), gatherer.beginInfluencers(),
+                              gatherer.endInfluencers()));
+        auto& entry = inserted.first->second;
         entry.add(stat.s_Time, (*stat.s_Values)[category.first], stat.s_Count,
                   stat.s_SampleCount, *stat.s_Influences);
+        if (inserted.second) {
+            addedMemory += sizeof(*inserted.first) + core::memory::dynamicSize(entry);
+        }
     }
 };
 
@@ -1278,17 +1308,21 @@ void CMetricBucketGatherer::recyclePeople(const TSizeVec& peopleToRemove) {
         return;
     }
 
+    std::size_t removedMemory{0};
     applyFunc(m_FeatureData, [&, remove = SRemovePeople{} ](const auto& category, auto& data) {
-        remove(category, data, peopleToRemove);
+        remove(category, data, peopleToRemove, removedMemory);
     });
+    this->decreaseTrackedMemoryUsage(removedMemory);
 
     this->CBucketGatherer::recyclePeople(peopleToRemove);
 }
 
 void CMetricBucketGatherer::removePeople(std::size_t lowestPersonToRemove) {
+    std::size_t removedMemory{0};
     applyFunc(m_FeatureData, [&, remove = SRemovePeople{} ](const auto& category, auto& data) {
-        remove(category, data, lowestPersonToRemove, m_DataGatherer.numberPeople());
+        remove(category, data, lowestPersonToRemove, m_DataGatherer.numberPeople(), removedMemory);
     });
+    this->decreaseTrackedMemoryUsage(removedMemory);
 
     this->CBucketGatherer::removePeople(lowestPersonToRemove);
 }
@@ -1299,10 +1333,12 @@ void CMetricBucketGatherer::recycleAttributes(const TSizeVec& attributesToRemove
     }
 
     if (m_DataGatherer.isPopulation()) {
+        std::size_t removedMemory{0};
         applyFunc(m_FeatureData,
                   [&, remove = SRemoveAttributes{} ](const auto& category, auto& data) {
-                      remove(category, data, attributesToRemove);
+                      remove(category, data, attributesToRemove, removedMemory);
                   });
+        this->decreaseTrackedMemoryUsage(removedMemory);
     }
 
     this->CBucketGatherer::recycleAttributes(attributesToRemove);
@@ -1310,11 +1346,13 @@ void CMetricBucketGatherer::recycleAttributes(const TSizeVec& attributesToRemove
 
 void CMetricBucketGatherer::removeAttributes(std::size_t lowestAttributeToRemove) {
     if (m_DataGatherer.isPopulation()) {
+        std::size_t removedMemory{0};
         applyFunc(m_FeatureData,
                   [&, remove = SRemoveAttributes{} ](const auto& category, auto& data) {
                       remove(category, data, lowestAttributeToRemove,
-                             m_DataGatherer.numberAttributes());
+                             m_DataGatherer.numberAttributes(), removedMemory);
                   });
+        this->decreaseTrackedMemoryUsage(removedMemory);
     }
 
     this->CBucketGatherer::removeAttributes(lowestAttributeToRemove);
@@ -1455,9 +1493,11 @@ void CMetricBucketGatherer::addValue(std::size_t pid,
     }
 
     stat.s_Influences = &influences;
+    std::size_t addedMemory{0};
     applyFunc(m_FeatureData, [&, addValue = SAddValue{} ](const auto& category, auto& data) {
-        addValue(category, data, pid, cid, *this, stat);
+        addValue(category, data, pid, cid, *this, stat, addedMemory);
     });
+    this->increaseTrackedMemoryUsage(addedMemory);
 }
 
 void CMetricBucketGatherer::startNewBucket(core_t::TTime time, bool skipUpdates) {
@@ -11,6 +11,8 @@
 
 #include <model/CModelFactory.h>
 
+#include <core/CScopedFastLock.h>
+
 #include <maths/common/CModel.h>
 #include <maths/common/CMultimodalPrior.h>
 #include <maths/common/CMultinomialConjugate.h>
@@ -44,11 +46,23 @@ CModelFactory::CModelFactory(const SModelParams& params,
     : m_ModelParams(params), m_InterimBucketCorrector(interimBucketCorrector) {
 }
 
+CModelFactory::CModelFactory(const CModelFactory& other)
+    : m_ModelParams(other.m_ModelParams),
+      m_InterimBucketCorrector(other.m_InterimBucketCorrector) {
+    core::CScopedFastLock lock(other.m_CacheMutex);
+    m_MathsModelCache = other.m_MathsModelCache;
+    m_CorrelatePriorCache = other.m_CorrelatePriorCache;
+    m_InfluenceCalculatorCache = other.m_InfluenceCalculatorCache;
+}
+
 const CModelFactory::TFeatureMathsModelPtrPrVec&
 CModelFactory::defaultFeatureModels(const TFeatureVec& features,
                                     core_t::TTime bucketLength,
                                     double minimumSeasonalVarianceScale,
                                     bool modelAnomalies) const {
+    // The cached models are never modified once created and map elements
+    // are stable, so it's safe to use the result after releasing the lock.
+    core::CScopedFastLock lock(m_CacheMutex);
     auto result = m_MathsModelCache.emplace(features, TFeatureMathsModelPtrPrVec());
     if (result.second) {
         result.first->second.reserve(features.size());
@@ -118,6 +132,9 @@ CModelFactory::defaultFeatureModel(model_t::EFeature feature,
 
 const CModelFactory::TFeatureMultivariatePriorSPtrPrVec&
 CModelFactory::defaultCorrelatePriors(const TFeatureVec& features) const {
+    // See defaultFeatureModels for why it's safe to use the result after
+    // releasing the lock.
+    core::CScopedFastLock lock(m_CacheMutex);
     auto result = m_CorrelatePriorCache.emplace(features, TFeatureMultivariatePriorSPtrPrVec{});
     if (result.second) {
         result.first->second.reserve(features.size());
@@ -180,6 +197,7 @@ CModelFactory::defaultDecomposition(model_t::EFeature feature, core_t::TTime buc
 const CModelFactory::TFeatureInfluenceCalculatorCPtrPrVec&
 CModelFactory::defaultInfluenceCalculators(const std::string& influencerName,
                                            const TFeatureVec& features) const {
+    core::CScopedFastLock lock(m_CacheMutex);
     auto& result = m_InfluenceCalculatorCache[{influencerName, features}];
 
     if (result.empty()) {
@@ -13,6 +13,14 @@
 namespace ml {
 namespace model {
 
+bool CMonitoredResource::supportsMemoryTracking() const {
+    return false;
+}
+
+std::size_t CMonitoredResource::trackedMemoryUsage() const {
+    return this->memoryUsage();
+}
+
 bool CMonitoredResource::supportsPruning() const {
     return false;
 }
@@ -422,22 +422,39 @@ void CPopulationModel::createUpdateNewModels(core_t::TTime time,
 
 void CPopulationModel::createNewModels(std::size_t n, std::size_t m) {
     if (n > 0) {
+        std::size_t previous{core::memory::dynamicSize(m_PersonLastBucketTimes)};
         core::CAllocationStrategy::resize(m_PersonLastBucketTimes,
                                           n + m_PersonLastBucketTimes.size(),
                                           CAnomalyDetectorModel::TIME_UNSET);
+        this->increaseTrackedMemoryUsage(
+            core::memory::dynamicSize(m_PersonLastBucketTimes) - previous);
     }
 
     if (m > 0) {
+        // The distinct person counts and bucket counts are copies of their
+        // prototypes so we only need to count the heap memory of new copies
+        // in addition to the vectors' capacity.
+        auto vectorsMemory = [this] {
+            return core::memory::dynamicSize(m_AttributeFirstBucketTimes) +
+                   core::memory::dynamicSize(m_AttributeLastBucketTimes) +
+                   m_DistinctPersonCounts.capacity() * sizeof(TBjkstUniqueValuesVec::value_type) +
+                   m_PersonAttributeBucketCounts.capacity() *
+                       sizeof(TCountMinSketchVec::value_type);
+        };
+        std::size_t previous{vectorsMemory()};
         std::size_t newM = m + m_AttributeFirstBucketTimes.size();
         core::CAllocationStrategy::resize(m_AttributeFirstBucketTimes, newM,
                                           CAnomalyDetectorModel::TIME_UNSET);
         core::CAllocationStrategy::resize(m_AttributeLastBucketTimes, newM,
                                           CAnomalyDetectorModel::TIME_UNSET);
         core::CAllocationStrategy::resize(m_DistinctPersonCounts, newM, m_NewDistinctPersonCounts);
+        std::size_t added{m * core::memory::dynamicSize(m_NewDistinctPersonCounts)};
         if (m_NewPersonBucketCounts) {
             core::CAllocationStrategy::resize(m_PersonAttributeBucketCounts,
                                               newM, *m_NewPersonBucketCounts);
+            added += m * core::memory::dynamicSize(*m_NewPersonBucketCounts);
         }
+        this->increaseTrackedMemoryUsage(vectorsMemory() - previous + added);
     }
 
     this->CAnomalyDetectorModel::createNewModels(n, m);
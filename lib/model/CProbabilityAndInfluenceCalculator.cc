@@ -51,6 +51,14 @@ using TTail2Vec = core::CSmallVector<maths_t::ETail, 2>;
 using TProbabilityCalculation2Vec = core::CSmallVector<maths_t::EProbabilityCalculation, 2>;
 using TSizeDoublePr = std::pair<std::size_t, double>;
 using TSizeDoublePr1Vec = core::CSmallVector<TSizeDoublePr, 1>;
+using TDoubleVec = std::vector<double>;
+using TSizeVec = std::vector<std::size_t>;
+
+//! The number of influences for which to compute probabilities in the first
+//! batch if we can stop at the first influence below the cutoff.
+const std::size_t MINIMUM_INFLUENCE_BATCH_SIZE{4};
+//! The value used to flag a probability we failed to compute.
+const double FAILED_PROBABILITY{-1.0};
 
 //! \brief Orders two value influences by decreasing influence.
 class CDecreasingValueInfluence {
@@ -322,6 +330,37 @@ public:
     }
 };
 
+//! Compute the probabilities of \p values in the range [\p start, \p end)
+//! in a single batch.
+//!
+//! If the batch calculation fails this falls back to computing probabilities
+//! one at a time so only those which fail are lost. These are set to
+//! FAILED_PROBABILITY.
+void computeInfluenceProbabilities(const maths::common::CModel& model,
+                                   maths::common::CModelProbabilityParams& params,
+                                   const TTime2Vec1Vec& time,
+                                   const TDouble2Vec1Vec& values,
+                                   const maths_t::TDouble2VecWeightsAry1Vec& weights,
+                                   std::size_t start,
+                                   std::size_t end,
+                                   TDoubleVec& result) {
+    TDouble2Vec1Vec batchValues(values.begin() + start, values.begin() + end);
+    maths_t::TDouble2VecWeightsAry1Vec batchWeights(weights.begin() + start,
+                                                    weights.begin() + end);
+    if (model.probabilities(params, time, batchValues, batchWeights, result)) {
+        return;
+    }
+
+    result.assign(end - start, FAILED_PROBABILITY);
+    maths::common::SModelProbabilityResult probability;
+    for (std::size_t i = start; i < end; ++i) {
+        params.weights({weights[i]});
+        if (model.probability(params, time, {values[i]}, probability)) {
+            result[i - start] = probability.s_Probability;
+        }
+    }
+}
+
 //! Sets all influences to one.
 //!
 //! \param[in] influencerName The name of the influencer field.
@@ -383,8 +422,7 @@ void doComputeInfluences(model_t::EFeature feature,
         return;
     }
 
-    auto probability = [feature, elapsedTime](const maths::common::SModelProbabilityResult& r) {
-        double p{r.s_Probability};
+    auto probability = [feature, elapsedTime](double p) {
         p = maths::common::CTools::truncate(
             p, maths::common::CTools::smallestProbability(), 1.0);
         return model_t::adjustProbability(feature, elapsedTime, p);
@@ -395,7 +433,7 @@ void doComputeInfluences(model_t::EFeature feature,
     maths::common::SModelProbabilityResult overallResult;
     model.probability(computeProbabilityParams, time,
                       model_t::stripExtraStatistics(feature, {value}), overallResult);
-    double overallProbability{probability(overallResult)};
+    double overallProbability{probability(overallResult.s_Probability)};
 
     if (overallProbability == 1.0) {
         doComputeIndicatorInfluences(influencerName, influencerValues, result);
@@ -406,55 +444,79 @@ void doComputeInfluences(model_t::EFeature feature,
 
     double logOverallProbability{maths::common::CTools::fastLog(overallProbability)};
 
-    // Declared outside the loop to minimize the number of times they are created.
+    // Compute all the influenced values and weights up front so we can
+    // compute their probabilities in batches.
     std::size_t dimension = model_t::dimension(feature);
-    TDouble2Vec1Vec influencedValue{TDouble2Vec(dimension)};
-    maths::common::SModelProbabilityResult influenceResult;
-
-    for (auto i = influencerValues.begin(); i != influencerValues.end(); ++i) {
-        const auto& influenceValue = i->second.first;
-        const auto& influenceCount = i->second.second;
+    TSizeVec influencers;
+    TDouble2Vec1Vec influencedValues;
+    maths_t::TDouble2VecWeightsAry1Vec influencedWeights;
+    influencers.reserve(influencerValues.size());
+    influencedValues.reserve(influencerValues.size());
+    influencedWeights.reserve(influencerValues.size());
+    TDouble2Vec influencedValue(dimension);
+    for (std::size_t i = 0; i < influencerValues.size(); ++i) {
+        const auto& influenceValue = influencerValues[i].second.first;
+        const auto& influenceCount = influencerValues[i].second.second;
         computeProbabilityParams.weights(weights);
         if (computeInfluencedParamsAndValue(value, count, influenceValue,
                                             influenceCount, computeProbabilityParams,
-                                            influencedValue[0]) == false) {
+                                            influencedValue) == false) {
             LOG_ERROR(<< "Failed to compute influencer value (value = " << value
-                      << " , count = " << count
-                      << " , influencer value = " << i->second.first
-                      << " , influencer count = " << i->second.second << ")");
-            continue;
-        }
-
-        if (model.probability(computeProbabilityParams, time, influencedValue,
-                              influenceResult) == false) {
-            LOG_ERROR(<< "Failed to compute P(" << influencedValue[0]
-                      << " | influencer = " << *i << ")");
+                      << " , count = " << count << " , influencer value = " << influenceValue
+                      << " , influencer count = " << influenceCount << ")");
             continue;
         }
+        influencers.push_back(i);
+        influencedValues.push_back(influencedValue);
+        influencedWeights.push_back(computeProbabilityParams.weights()[0]);
+    }
 
-        double influenceProbability{probability(influenceResult)};
-        double logInfluenceProbability{maths::common::CTools::fastLog(influenceProbability)};
-        double influence{computeInfluence(logOverallProbability, logInfluenceProbability)};
+    // For univariate features the influencers are in decreasing order of
+    // influence so we can stop at the first influence below the cutoff. In
+    // this case we use batches of increasing size so we usually avoid the
+    // probability calculation for the influences we don't need.
+    TDoubleVec influenceProbabilities;
+    for (std::size_t start = 0, batchSize = dimension == 1 ? MINIMUM_INFLUENCE_BATCH_SIZE
+                                                           : influencers.size();
+         start < influencers.size(); start += batchSize, batchSize *= 2) {
+        std::size_t end{std::min(start + batchSize, influencers.size())};
+        computeInfluenceProbabilities(model, computeProbabilityParams, time,
+                                      influencedValues, influencedWeights,
+                                      start, end, influenceProbabilities);
+
+        for (std::size_t j = start; j < end; ++j) {
+            std::size_t i{influencers[j]};
+            if (influenceProbabilities[j - start] == FAILED_PROBABILITY) {
+                LOG_ERROR(<< "Failed to compute P(" << influencedValues[j]
+                          << " | influencer = " << influencerValues[i] << ")");
+                continue;
+            }
 
-        LOG_TRACE(<< "log(p) = " << logOverallProbability << ", v(i) = " << influencedValue
-                  << ", log(p(i)) = " << logInfluenceProbability
-                  << ", weight = " << weights << ", influence = " << influence
-                  << ", influencer field value = " << i->first.get());
-
-        if (dimension == 1 && influence >= cutoff) {
-            result.emplace_back(description(i->first), influence);
-        } else if (dimension == 1) {
-            if (includeCutoff) {
-                result.emplace_back(description(i->first), influence);
-                for (++i; i != influencerValues.end(); ++i) {
-                    result.emplace_back(description(i->first), 0.5 * influence);
+            double influenceProbability{probability(influenceProbabilities[j - start])};
+            double logInfluenceProbability{maths::common::CTools::fastLog(influenceProbability)};
+            double influence{computeInfluence(logOverallProbability, logInfluenceProbability)};
+
+            LOG_TRACE(<< "log(p) = " << logOverallProbability << ", v(i) = "
+                      << influencedValues[j] << ", log(p(i)) = " << logInfluenceProbability
+                      << ", weight = " << influencedWeights[j] << ", influence = " << influence
+                      << ", influencer field value = " << influencerValues[i].first.get());
+
+            if (dimension == 1 && influence >= cutoff) {
+                result.emplace_back(description(influencerValues[i].first), influence);
+            } else if (dimension == 1) {
+                if (includeCutoff) {
+                    result.emplace_back(description(influencerValues[i].first), influence);
+                    for (++i; i < influencerValues.size(); ++i) {
+                        result.emplace_back(description(influencerValues[i].first),
+                                            0.5 * influence);
+                    }
                 }
+                return;
+            } else if (influence >= cutoff) {
+                result.emplace_back(description(influencerValues[i].first), influence);
+            } else if (includeCutoff) {
+                result.emplace_back(description(influencerValues[i].first), 0.5 * influence);
             }
-            break;
-        } else if (influence >= cutoff) {
-            result.emplace_back(description(i->first), influence);
-        } else if (includeCutoff) {
-            result.emplace_back(description(i->first), 0.5 * influence);
         }
     }
 }
@@ -481,8 +543,7 @@ void doComputeCorrelateInfluences(model_t::EFeature feature,
     auto description = [&influencerName](const std::string& v) {
         return std::make_pair(influencerName, v);
     };
-    auto probability = [feature, elapsedTime](const maths::common::SModelProbabilityResult& r) {
-        double p{r.s_Probability};
+    auto probability = [feature, elapsedTime](double p) {
         p = maths::common::CTools::truncate(
             p, maths::common::CTools::smallestProbability(), 1.0);
         return model_t::adjustProbability(feature, elapsedTime, p);
@@ -498,7 +559,7 @@ void doComputeCorrelateInfluences(model_t::EFeature feature,
     maths::common::SModelProbabilityResult overallResult;
     model.probability(computeProbabilityParams, {time},
                       model_t::stripExtraStatistics(feature, {value}), overallResult);
-    double overallProbability{probability(overallResult)};
+    double overallProbability{probability(overallResult.s_Probability)};
 
     if (overallProbability == 1.0) {
         doComputeIndicatorInfluences(influencerName, influencerValues, result);
@@ -509,35 +570,41 @@ void doComputeCorrelateInfluences(model_t::EFeature feature,
 
     double logOverallProbability{maths::common::CTools::fastLog(overallProbability)};
 
-    // Declared outside the loop to minimize the number of times they are created.
-    TDouble2Vec1Vec influencedValue{TDouble2Vec(2)};
-    maths::common::SModelProbabilityResult influenceResult;
-
-    for (const auto& i : influencerValues) {
-        const auto& influenceValue = i.second.first;
-        const auto& influenceCount = i.second.second;
+    TDouble2Vec1Vec influencedValues(influencerValues.size(), TDouble2Vec(2));
+    maths_t::TDouble2VecWeightsAry1Vec influencedWeights;
+    influencedWeights.reserve(influencerValues.size());
+    for (std::size_t i = 0; i < influencerValues.size(); ++i) {
+        const auto& influenceValue = influencerValues[i].second.first;
+        const auto& influenceCount = influencerValues[i].second.second;
         computeProbabilityParams.weights(weights);
         computeInfluencedValue(value, count, influenceValue, influenceCount,
-                               computeProbabilityParams, influencedValue[0]);
+                               computeProbabilityParams, influencedValues[i]);
+        influencedWeights.push_back(computeProbabilityParams.weights()[0]);
+    }
+
+    TDoubleVec influenceProbabilities;
+    computeInfluenceProbabilities(model, computeProbabilityParams, {time},
+                                  influencedValues, influencedWeights, 0,
+                                  influencedValues.size(), influenceProbabilities);
 
-        if (model.probability(computeProbabilityParams, {time}, influencedValue,
-                              influenceResult) == false) {
-            LOG_ERROR(<< "Failed to compute P(" << influencedValue
-                      << " | influencer = " << i << ")");
+    for (std::size_t i = 0; i < influencerValues.size(); ++i) {
+        if (influenceProbabilities[i] == FAILED_PROBABILITY) {
+            LOG_ERROR(<< "Failed to compute P(" << influencedValues[i]
+                      << " | influencer = " << influencerValues[i] << ")");
             continue;
         }
 
-        double influenceProbability{probability(influenceResult)};
+        double influenceProbability{probability(influenceProbabilities[i])};
         double logInfluenceProbability{maths::common::CTools::fastLog(influenceProbability)};
         double influence{computeInfluence(logOverallProbability, logInfluenceProbability)};
 
-        LOG_TRACE(<< "log(p) = " << logOverallProbability << ", v(i) = " << influencedValue
-                  << ", log(p(i)) = " << logInfluenceProbability
-                  << ", weight = " << weights << ", influence = " << influence
-                  << ", influencer field value = " << i.first.get());
+        LOG_TRACE(<< "log(p) = " << logOverallProbability << ", v(i) = "
+                  << influencedValues[i] << ", log(p(i)) = " << logInfluenceProbability
+                  << ", weight = " << influencedWeights[i] << ", influence = " << influence
+                  << ", influencer field value = " << influencerValues[i].first.get());
 
         if (includeCutoff || influence >= cutoff) {
-            result.emplace_back(description(i.first), influence);
+            result.emplace_back(description(influencerValues[i].first), influence);
         }
     }
 }
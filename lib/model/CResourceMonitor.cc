@@ -38,6 +38,8 @@ const core_t::TTime CResourceMonitor::MINIMUM_PRUNE_FREQUENCY{60 * 60};
 const std::size_t CResourceMonitor::DEFAULT_MEMORY_LIMIT_MB{4096};
 const double CResourceMonitor::DEFAULT_BYTE_LIMIT_MARGIN{0.7};
 const core_t::TTime CResourceMonitor::MAXIMUM_BYTE_LIMIT_MARGIN_PERIOD{2 * core::constants::HOUR};
+const std::size_t CResourceMonitor::MAXIMUM_TRACKED_UPDATES{20};
+const double CResourceMonitor::MAXIMUM_UNTRACKED_MEMORY_FRACTION{0.01};
 
 CResourceMonitor::CResourceMonitor(bool persistenceInForeground, double byteLimitMargin)
     : m_ByteLimitMargin{byteLimitMargin}, m_PreviousTotal{this->totalMemory()},
@@ -54,7 +56,7 @@ void CResourceMonitor::memoryUsageReporter(const TMemoryUsageReporterFunc& repor
 
 void CResourceMonitor::registerComponent(CMonitoredResource& resource) {
     LOG_TRACE(<< "Registering component: " << &resource);
-    m_Resources.emplace(&resource, 0);
+    m_Resources.emplace(&resource, SResourceMemoryUsage{});
 }
 
 void CResourceMonitor::unRegisterComponent(CMonitoredResource& resource) {
@@ -65,7 +67,7 @@ void CResourceMonitor::unRegisterComponent(CMonitoredResource& resource) {
         return;
     }
 
-    m_MonitoredResourceCurrentMemory -= itr->second;
+    m_MonitoredResourceCurrentMemory -= itr->second.s_Usage;
     m_Resources.erase(itr);
     std::size_t total{this->totalMemory()};
     core::CProgramCounters::counter(counter_t::E_TSADMemoryUsage) = total;
@@ -122,18 +124,20 @@ void CResourceMonitor::refresh(CMonitoredResource& resource) {
     if (m_NoLimit) {
         return;
     }
-    this->forceRefresh(resource);
+    this->memUsage(&resource, false);
+
+    this->updateAllowAllocations();
 }
 
 void CResourceMonitor::forceRefresh(CMonitoredResource& resource) {
-    this->memUsage(&resource);
+    this->memUsage(&resource, true);
 
     this->updateAllowAllocations();
 }
 
 void CResourceMonitor::forceRefreshAll() {
     for (auto& resource : m_Resources) {
-        this->memUsage(resource.first);
+        this->memUsage(resource.first, true);
     }
 
     this->updateAllowAllocations();
@@ -147,6 +151,12 @@ void CResourceMonitor::updateAllowAllocations() {
         if (total > this->highLimit()) {
             LOG_INFO(<< "Over current allocation high limit. " << total
                      << " bytes used, the limit is " << this->highLimit());
+            SModelSizeStats modelSizeStats;
+            for (const auto& resource : m_Resources) {
+                resource.first->updateModelSizeStats(modelSizeStats);
+            }
+            LOG_INFO(<< "Registering a by or over field value uses up to "
+                     << modelSizeStats.s_MaximumMemoryUsagePerFieldValue << " bytes");
             m_AllowAllocations = false;
             std::size_t bytesExceeded{total - this->highLimit()};
             m_CurrentBytesExceeded = this->adjustedUsage(bytesExceeded);
@@ -201,9 +211,9 @@ bool CResourceMonitor::pruneIfRequired(core_t::TTime endTime) {
         for (auto& resource : m_Resources) {
             if (resource.first->supportsPruning()) {
                 resource.first->prune(m_PruneWindow);
-                resource.second = core::memory::dynamicSize(resource.first);
+                calculateMemUsage(*resource.first, resource.second);
             }
-            usageAfter += resource.second;
+            usageAfter += resource.second.s_Usage;
         }
         m_MonitoredResourceCurrentMemory = usageAfter;
         total = this->totalMemory();
@@ -251,16 +261,62 @@ std::size_t CResourceMonitor::allocationLimit() const {
     return this->highLimit() - std::min(this->highLimit(), this->totalMemory());
 }
 
-void CResourceMonitor::memUsage(CMonitoredResource* resource) {
+void CResourceMonitor::memUsage(CMonitoredResource* resource, bool calculate) {
     auto itr = m_Resources.find(resource);
     if (itr == m_Resources.end()) {
         LOG_ERROR(<< "Inconsistency - component has not been registered: " << resource);
         return;
     }
-    std::size_t modelPreviousUsage = itr->second;
-    std::size_t modelCurrentUsage = core::memory::dynamicSize(itr->first);
-    itr->second = modelCurrentUsage;
-    m_MonitoredResourceCurrentMemory += (modelCurrentUsage - modelPreviousUsage);
+    SResourceMemoryUsage& usage{itr->second};
+    std::size_t modelPreviousUsage = usage.s_Usage;
+    if (calculate || resource->supportsMemoryTracking() == false ||
+        usage.s_TrackedUpdates >= usage.s_MaximumTrackedUpdates) {
+        calculateMemUsage(*resource, usage);
+    } else {
+        // Apply the change in the tracked memory usage since the last full
+        // calculation, which absorbs anything the tracking doesn't count.
+        std::size_t trackedUsage{resource->trackedMemoryUsage()};
+        usage.s_Usage = trackedUsage > usage.s_TrackedUsage
+                            ? usage.s_CalculatedUsage + (trackedUsage - usage.s_TrackedUsage)
+                            : usage.s_CalculatedUsage -
+                                  std::min(usage.s_CalculatedUsage,
+                                           usage.s_TrackedUsage - trackedUsage);
+        ++usage.s_TrackedUpdates;
+    }
+    m_MonitoredResourceCurrentMemory += (usage.s_Usage - modelPreviousUsage);
+}
+
+void CResourceMonitor::calculateMemUsage(CMonitoredResource& resource,
+                                         SResourceMemoryUsage& usage) {
+    std::size_t calculatedUsage{core::memory::dynamicSize(&resource)};
+    std::size_t trackedUsage{resource.supportsMemoryTracking() ? resource.trackedMemoryUsage() : 0};
+
+    if (resource.supportsMemoryTracking()) {
+        // The error in the usage we'd have got from the tracked usage is the
+        // untracked growth over this and the preceding tracked updates. This
+        // overestimates the growth after the first calculation and pruning,
+        // but that just means the next calculation happens sooner.
+        double estimatedUsage{static_cast<double>(usage.s_CalculatedUsage) +
+                              static_cast<double>(trackedUsage) -
+                              static_cast<double>(usage.s_TrackedUsage)};
+        double untrackedGrowth{std::fabs(static_cast<double>(calculatedUsage) - estimatedUsage) /
+                               static_cast<double>(usage.s_TrackedUpdates + 1)};
+        double maximumUntrackedGrowth{MAXIMUM_UNTRACKED_MEMORY_FRACTION *
+                                      static_cast<double>(calculatedUsage)};
+        usage.s_MaximumTrackedUpdates =
+            untrackedGrowth * static_cast<double>(MAXIMUM_TRACKED_UPDATES) <= maximumUntrackedGrowth
+                ? MAXIMUM_TRACKED_UPDATES
+                : static_cast<std::size_t>(maximumUntrackedGrowth / untrackedGrowth);
+        LOG_TRACE(<< "Calculated memory usage " << calculatedUsage << ", estimated "
+                  << estimatedUsage << " after " << usage.s_TrackedUpdates
+                  << " updates, next calculation after "
+                  << usage.s_MaximumTrackedUpdates << " updates");
+    }
+
+    usage.s_Usage = calculatedUsage;
+    usage.s_CalculatedUsage = calculatedUsage;
+    usage.s_TrackedUsage = trackedUsage;
+    usage.s_TrackedUpdates = 0;
 }
 
 void CResourceMonitor::sendMemoryUsageReportIfSignificantlyChanged(core_t::TTime bucketStartTime,
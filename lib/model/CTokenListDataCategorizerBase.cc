@@ -23,6 +23,7 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <numeric>
 #include <ostream>
 #include <set>
 
@@ -91,10 +92,14 @@ CTokenListDataCategorizerBase::computeCategory(bool isDryRun,
         maxReweightedWorkWeight, m_LowerThreshold)};
 
     // We search previous categories in descending order of the number of matches
-    // we've seen for them
+    // we've seen for them.  If possible we only visit those categories which
+    // share a token with the current string, since no other category can match.
+    this->candidateCategories(m_WorkTokenUniqueIds, m_WorkCandidatePositions);
+
     auto bestSoFarIter = m_CategoriesByCount.end();
     double bestSoFarSimilarity{m_LowerThreshold};
-    for (auto iter = m_CategoriesByCount.begin(); iter != m_CategoriesByCount.end(); ++iter) {
+    for (auto position : m_WorkCandidatePositions) {
+        auto iter = m_CategoriesByCount.begin() + position;
         const CTokenListCategory& compCategory{m_Categories[iter->second]};
         const TSizeSizePrVec& baseTokenIds{compCategory.baseTokenIds()};
         std::size_t baseWeight{compCategory.baseWeight()};
@@ -129,7 +134,12 @@ CTokenListDataCategorizerBase::computeCategory(bool isDryRun,
             }
         }
 
-        double similarity{this->similarity(m_WorkTokenIds, workWeight, baseTokenIds, baseWeight)};
+        // We only need the exact similarity if it's high enough to be used,
+        // unless we're going to accept the category anyway
+        double minSimilarity{matchesSearch ? std::numeric_limits<double>::lowest()
+                                           : std::min(bestSoFarSimilarity, m_UpperThreshold)};
+        double similarity{this->similarity(m_WorkTokenIds, workWeight,
+                                           baseTokenIds, baseWeight, minSimilarity)};
 
         LOG_TRACE(<< similarity << '-' << compCategory.baseString() << '|' << str);
 
@@ -185,6 +195,7 @@ CTokenListDataCategorizerBase::computeCategory(bool isDryRun,
     }
 
     // If we get here we haven't matched, so create a new category
+    m_CategoryPositions.push_back(m_CategoriesByCount.size());
     m_CategoriesByCount.emplace_back(1, m_Categories.size());
     ++m_TotalCount;
     if (this->isCategoryCountRare(1)) {
@@ -192,6 +203,7 @@ CTokenListDataCategorizerBase::computeCategory(bool isDryRun,
     }
     m_Categories.emplace_back(isDryRun, str, rawStringLen, m_WorkTokenIds,
                               workWeight, m_WorkTokenUniqueIds);
+    this->indexCategory(m_Categories.size() - 1);
 
     // Increment the counts of categories that use a given token
     for (const auto& workTokenId : m_WorkTokenIds) {
@@ -330,6 +342,9 @@ bool CTokenListDataCategorizerBase::cacheReverseSearch(CLocalCategoryId category
 bool CTokenListDataCategorizerBase::acceptRestoreTraverser(core::CStateRestoreTraverser& traverser) {
     m_Categories.clear();
     m_CategoriesByCount.clear();
+    m_CategoryPositions.clear();
+    m_CategoriesByTokenId.clear();
+    m_UnindexedCategories.clear();
     m_TotalCount = 0;
     m_NumRareCategories = 0;
     m_TokenIdLookup.clear();
@@ -382,6 +397,7 @@ bool CTokenListDataCategorizerBase::acceptRestoreTraverser(core::CStateRestoreTr
     // sorted by descending count instead
     std::stable_sort(m_CategoriesByCount.begin(), m_CategoriesByCount.end(),
                      maths::common::COrderings::SFirstGreater{});
+    this->rebuildCategoryIndex();
 
     this->updateCategorizerStats(m_LastCategorizerStats);
 
@@ -437,7 +453,12 @@ void CTokenListDataCategorizerBase::addCategoryMatch(bool isDryRun,
                                                      const TSizeSizePrVec& tokenIds,
                                                      const TSizeSizeMap& tokenUniqueIds,
                                                      TSizeSizePrVecItr iter) {
-    m_Categories[iter->second].addString(isDryRun, str, rawStringLen, tokenIds, tokenUniqueIds);
+    CTokenListCategory& category{m_Categories[iter->second]};
+    bool wasIndexed{category.commonUniqueTokenWeight() > 0};
+    category.addString(isDryRun, str, rawStringLen, tokenIds, tokenUniqueIds);
+    if (wasIndexed && category.commonUniqueTokenWeight() == 0) {
+        m_UnindexedCategories.push_back(iter->second);
+    }
 
     std::size_t& count{iter->first};
     bool wasCountRare{this->isCategoryCountRare(count)};
@@ -469,9 +490,76 @@ void CTokenListDataCategorizerBase::addCategoryMatch(bool isDryRun,
     // deserves this
     if (swapIter != iter) {
         std::iter_swap(swapIter, iter);
+        std::swap(m_CategoryPositions[swapIter->second], m_CategoryPositions[iter->second]);
     }
 }
 
+void CTokenListDataCategorizerBase::indexCategory(std::size_t index) {
+    const CTokenListCategory& category{m_Categories[index]};
+    if (category.commonUniqueTokenWeight() == 0) {
+        m_UnindexedCategories.push_back(index);
+        return;
+    }
+    for (const auto& commonUniqueTokenId : category.commonUniqueTokenIds()) {
+        std::size_t tokenId{commonUniqueTokenId.first};
+        if (tokenId >= m_CategoriesByTokenId.size()) {
+            m_CategoriesByTokenId.resize(tokenId + 1);
+        }
+        m_CategoriesByTokenId[tokenId].push_back(index);
+    }
+}
+
+void CTokenListDataCategorizerBase::rebuildCategoryIndex() {
+    m_CategoryPositions.assign(m_Categories.size(), 0);
+    for (std::size_t i = 0; i < m_CategoriesByCount.size(); ++i) {
+        m_CategoryPositions[m_CategoriesByCount[i].second] = i;
+    }
+    m_CategoriesByTokenId.clear();
+    m_UnindexedCategories.clear();
+    for (std::size_t i = 0; i < m_Categories.size(); ++i) {
+        this->indexCategory(i);
+    }
+}
+
+void CTokenListDataCategorizerBase::candidateCategories(const TSizeSizeMap& tokenUniqueIds,
+                                                        TSizeVec& positions) const {
+    positions.clear();
+
+    // The index relies on a category which shares no common unique tokens
+    // with the string being rejected by the lower threshold, so it can't
+    // be used if the threshold would accept anything.  Also, if the index
+    // would visit as many entries as there are categories then it's faster
+    // to simply consider all the categories in order.
+    std::size_t numberCategories{m_CategoriesByCount.size()};
+    std::size_t numberCandidates{m_UnindexedCategories.size()};
+    if (m_LowerThreshold > 0.0) {
+        for (const auto& tokenUniqueId : tokenUniqueIds) {
+            if (tokenUniqueId.first < m_CategoriesByTokenId.size()) {
+                numberCandidates += m_CategoriesByTokenId[tokenUniqueId.first].size();
+            }
+        }
+    }
+    if (m_LowerThreshold <= 0.0 || numberCandidates >= numberCategories) {
+        positions.resize(numberCategories);
+        std::iota(positions.begin(), positions.end(), 0);
+        return;
+    }
+
+    positions.reserve(numberCandidates);
+    for (const auto& tokenUniqueId : tokenUniqueIds) {
+        if (tokenUniqueId.first < m_CategoriesByTokenId.size()) {
+            for (auto index : m_CategoriesByTokenId[tokenUniqueId.first]) {
+                positions.push_back(m_CategoryPositions[index]);
+            }
+        }
+    }
+    for (auto index : m_UnindexedCategories) {
+        positions.push_back(m_CategoryPositions[index]);
+    }
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+}
+
 void CTokenListDataCategorizerBase::discardLatestTokens(std::size_t previousTokenCount) {
     while (m_TokenIdLookup.size() > previousTokenCount) {
         m_TokenIdLookup.pop_back();
@@ -518,7 +606,7 @@ std::size_t CTokenListDataCategorizerBase::maxMatchingWeight(std::size_t weight,
            1;
 }
 
-std::size_t CTokenListDataCategorizerBase::idForToken(const std::string& token) {
+std::size_t CTokenListDataCategorizerBase::idForToken(std::string_view token) {
     auto iter = boost::multi_index::get<SToken>(m_TokenIdLookup).find(token);
     if (iter != boost::multi_index::get<SToken>(m_TokenIdLookup).end()) {
         return iter->index();
@@ -529,6 +617,11 @@ std::size_t CTokenListDataCategorizerBase::idForToken(const std::string& token)
     return nextIndex;
 }
 
+core::CWordDictionary::EPartOfSpeech
+CTokenListDataCategorizerBase::partOfSpeech(std::size_t tokenId) const {
+    return m_TokenIdLookup[tokenId].partOfSpeech();
+}
+
 bool CTokenListDataCategorizerBase::addPretokenisedTokens(const std::string& tokensCsv,
                                                           TSizeSizePrVec& tokenIds,
                                                           TSizeSizeMap& tokenUniqueIds,
@@ -565,9 +658,13 @@ void CTokenListDataCategorizerBase::debugMemoryUsage(const core::CMemoryUsage::T
     core::memory_debug::dynamicSize("m_ReverseSearchCreator", m_ReverseSearchCreator, mem);
     core::memory_debug::dynamicSize("m_Categories", m_Categories, mem);
     core::memory_debug::dynamicSize("m_CategoriesByCount", m_CategoriesByCount, mem);
+    core::memory_debug::dynamicSize("m_CategoryPositions", m_CategoryPositions, mem);
+    core::memory_debug::dynamicSize("m_CategoriesByTokenId", m_CategoriesByTokenId, mem);
+    core::memory_debug::dynamicSize("m_UnindexedCategories", m_UnindexedCategories, mem);
     core::memory_debug::dynamicSize("m_TokenIdLookup", m_TokenIdLookup, mem);
     core::memory_debug::dynamicSize("m_WorkTokenIds", m_WorkTokenIds, mem);
     core::memory_debug::dynamicSize("m_WorkTokenUniqueIds", m_WorkTokenUniqueIds, mem);
+    core::memory_debug::dynamicSize("m_WorkCandidatePositions", m_WorkCandidatePositions, mem);
     core::memory_debug::dynamicSize("m_CsvLineParser", m_CsvLineParser, mem);
 }
 
@@ -576,9 +673,13 @@ std::size_t CTokenListDataCategorizerBase::memoryUsage() const {
     mem += core::memory::dynamicSize(m_ReverseSearchCreator);
     mem += core::memory::dynamicSize(m_Categories);
     mem += core::memory::dynamicSize(m_CategoriesByCount);
+    mem += core::memory::dynamicSize(m_CategoryPositions);
+    mem += core::memory::dynamicSize(m_CategoriesByTokenId);
+    mem += core::memory::dynamicSize(m_UnindexedCategories);
     mem += core::memory::dynamicSize(m_TokenIdLookup);
     mem += core::memory::dynamicSize(m_WorkTokenIds);
     mem += core::memory::dynamicSize(m_WorkTokenUniqueIds);
+    mem += core::memory::dynamicSize(m_WorkCandidatePositions);
     mem += core::memory::dynamicSize(m_CsvLineParser);
     return mem;
 }
@@ -812,9 +913,10 @@ std::size_t CTokenListDataCategorizerBase::numCategories() const {
     return m_Categories.size();
 }
 
-CTokenListDataCategorizerBase::CTokenInfoItem::CTokenInfoItem(const std::string& str,
+CTokenListDataCategorizerBase::CTokenInfoItem::CTokenInfoItem(std::string_view str,
                                                               std::size_t index)
-    : m_Str{str}, m_Index{index}, m_CategoryCount{0} {
+    : m_Str{str}, m_Index{index},
+      m_PartOfSpeech{core::CWordDictionary::instance().partOfSpeech(str)}, m_CategoryCount{0} {
 }
 
 const std::string& CTokenListDataCategorizerBase::CTokenInfoItem::str() const {
@@ -835,6 +937,11 @@ std::size_t CTokenListDataCategorizerBase::CTokenInfoItem::index() const {
     return m_Index;
 }
 
+core::CWordDictionary::EPartOfSpeech
+CTokenListDataCategorizerBase::CTokenInfoItem::partOfSpeech() const {
+    return m_PartOfSpeech;
+}
+
 std::size_t CTokenListDataCategorizerBase::CTokenInfoItem::categoryCount() const {
     return m_CategoryCount;
 }
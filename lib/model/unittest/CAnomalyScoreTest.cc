@@ -32,6 +32,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <algorithm>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <stdio.h>
@@ -623,6 +624,73 @@ BOOST_AUTO_TEST_CASE(testNormalizeScoresOrdering) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testNormalizeScoresPercentileLookup) {
+    // Test that normalizing scores using the percentile lookup gives exactly
+    // the same results as querying the quantile summaries directly and that
+    // the lookup is invalidated when the quantiles change.
+
+    test::CRandomNumbers rng;
+
+    TDoubleVec samples;
+    rng.generateGammaSamples(1.0, 2.0, 4000, samples);
+    TSizeVec largeAnomalyTimes{500, 1500, 2500, 3500};
+    TDoubleVec largeAnomalies{50.0, 120.0, 30.0, 80.0};
+    for (std::size_t i = 0; i < largeAnomalyTimes.size(); ++i) {
+        samples[largeAnomalyTimes[i]] += largeAnomalies[i];
+    }
+
+    TDoubleVec scores;
+    rng.generateUniformSamples(0.0, 150.0, 200, scores);
+
+    model::CAnomalyDetectorModelConfig config =
+        model::CAnomalyDetectorModelConfig::defaultConfig(300);
+
+    auto persist = [](const model::CAnomalyScore::CNormalizer& normalizer) {
+        std::ostringstream state;
+        model::CAnomalyScore::normalizerToJson(normalizer, "test", "test", "test",
+                                               1234567890, state);
+        return state.str();
+    };
+    auto restore = [&](const std::string& state) {
+        auto normalizer = std::make_unique<model::CAnomalyScore::CNormalizer>(config);
+        BOOST_TEST_REQUIRE(model::CAnomalyScore::normalizerFromJson(state, *normalizer));
+        return normalizer;
+    };
+
+    // A restored normalizer hasn't normalized any scores so queries the
+    // quantile summaries directly.
+    auto testLookup = [&](const model::CAnomalyScore::CNormalizer& normalizer) {
+        std::string state{persist(normalizer)};
+        for (std::size_t pass = 0; pass < 2; ++pass) {
+            for (auto score : scores) {
+                double expected{score};
+                BOOST_TEST_REQUIRE(
+                    restore(state)->normalize({EMPTY, EMPTY, EMPTY, EMPTY}, expected));
+                double actual{score};
+                BOOST_TEST_REQUIRE(normalizer.normalize({EMPTY, EMPTY, EMPTY, EMPTY}, actual));
+                BOOST_REQUIRE_EQUAL(expected, actual);
+            }
+        }
+    };
+
+    std::unique_ptr<model::CAnomalyScore::CNormalizer> normalizer;
+    {
+        model::CAnomalyScore::CNormalizer original(config);
+        original.isForMembersOfPopulation(false);
+        for (std::size_t i = 0; i < samples.size() / 2; ++i) {
+            original.updateQuantiles({EMPTY, EMPTY, EMPTY, EMPTY}, samples[i]);
+        }
+        normalizer = restore(persist(original));
+    }
+    testLookup(*normalizer);
+
+    // Check the lookup is invalidated when the quantiles change.
+    for (std::size_t i = samples.size() / 2; i < samples.size(); ++i) {
+        normalizer->updateQuantiles({EMPTY, EMPTY, EMPTY, EMPTY}, samples[i]);
+    }
+    testLookup(*normalizer);
+}
+
 BOOST_AUTO_TEST_CASE(testNormalizerGetMaxScore) {
     test::CRandomNumbers rng;
 
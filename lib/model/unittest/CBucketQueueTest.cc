@@ -81,6 +81,36 @@ BOOST_AUTO_TEST_CASE(testGetGivenFullQueueAfterPop) {
     BOOST_REQUIRE_EQUAL(std::string("c"), queue.get(19));
 }
 
+BOOST_AUTO_TEST_CASE(testRecycle) {
+    using TIntVec = std::vector<int>;
+
+    auto reset = [](TIntVec& bucket) { bucket.clear(); };
+
+    CBucketQueue<TIntVec> queue(1, 5, 0);
+    queue.get(0).assign(100, 1);
+    queue.recycle(reset, 5);
+    queue.get(5).assign(10, 2);
+
+    // The earliest bucket has dropped out of the queue so the next bucket
+    // should reuse its storage.
+    const int* storage{queue.get(0).data()};
+    std::size_t capacity{queue.get(0).capacity()};
+    queue.recycle(reset, 10);
+
+    BOOST_REQUIRE_EQUAL(2, queue.size());
+    BOOST_REQUIRE(TIntVec(10, 2) == queue.get(5));
+    BOOST_REQUIRE(queue.get(10).empty());
+    BOOST_REQUIRE_EQUAL(storage, queue.get(10).data());
+    BOOST_REQUIRE_EQUAL(capacity, queue.get(10).capacity());
+
+    // Recycling at an earlier time should be ignored.
+    queue.get(10).push_back(3);
+    queue.recycle(reset, 7);
+    BOOST_REQUIRE_EQUAL(2, queue.size());
+    BOOST_REQUIRE(TIntVec(10, 2) == queue.get(5));
+    BOOST_REQUIRE(TIntVec{3} == queue.get(10));
+}
+
 BOOST_AUTO_TEST_CASE(testClear) {
     CBucketQueue<int> queue(2, 5, 0);
     BOOST_REQUIRE_EQUAL(3, queue.size());
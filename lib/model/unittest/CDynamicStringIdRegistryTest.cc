@@ -20,6 +20,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <string>
+#include <string_view>
 #include <vector>
 
 BOOST_AUTO_TEST_SUITE(CDynamicStringIdRegistryTest)
@@ -75,6 +77,73 @@ BOOST_AUTO_TEST_CASE(testAddName) {
     BOOST_TEST_REQUIRE(registry.isIdActive(2));
 }
 
+BOOST_AUTO_TEST_CASE(testId) {
+    CResourceMonitor resourceMonitor;
+    CDynamicStringIdRegistry registry("person", counter_t::E_TSADNumberNewPeople,
+                                      counter_t::E_TSADNumberNewPeopleNotAllowed,
+                                      counter_t::E_TSADNumberNewPeopleRecycled);
+
+    bool personAdded = false;
+    std::size_t numberPeople{1000};
+    for (std::size_t i = 0; i < numberPeople; ++i) {
+        registry.addName("person" + std::to_string(i), 0, resourceMonitor, personAdded);
+    }
+
+    // Check we can look up names from views into other strings.
+    std::string records{"person0 person17 person999 person1000"};
+    std::string_view view{records};
+    std::size_t id;
+    BOOST_TEST_REQUIRE(registry.id(view.substr(0, 7), id));
+    BOOST_REQUIRE_EQUAL(0, id);
+    BOOST_TEST_REQUIRE(registry.id(view.substr(8, 8), id));
+    BOOST_REQUIRE_EQUAL(17, id);
+    BOOST_TEST_REQUIRE(registry.id(view.substr(17, 9), id));
+    BOOST_REQUIRE_EQUAL(999, id);
+    BOOST_TEST_REQUIRE(registry.id(view.substr(27), id) == false);
+    BOOST_REQUIRE_EQUAL(CDynamicStringIdRegistry::INVALID_ID, id);
+
+    BOOST_REQUIRE_EQUAL(registry.trackedMemoryUsage() / numberPeople,
+                        registry.memoryUsagePerName());
+    registry.clear();
+    BOOST_REQUIRE_EQUAL(0, registry.memoryUsagePerName());
+}
+
+BOOST_AUTO_TEST_CASE(testTrackedMemoryUsage) {
+    CResourceMonitor resourceMonitor;
+    CDynamicStringIdRegistry registry("person", counter_t::E_TSADNumberNewPeople,
+                                      counter_t::E_TSADNumberNewPeopleNotAllowed,
+                                      counter_t::E_TSADNumberNewPeopleRecycled);
+    BOOST_REQUIRE_EQUAL(0, registry.trackedMemoryUsage());
+
+    bool addedPerson = false;
+    std::string person1("a person whose name is too long for the small string buffer");
+    std::string person2("bar");
+    registry.addName(person1, 0, resourceMonitor, addedPerson);
+    std::size_t memoryOnePerson{registry.trackedMemoryUsage()};
+    BOOST_TEST_REQUIRE(memoryOnePerson > person1.size());
+
+    registry.addName(person2, 0, resourceMonitor, addedPerson);
+    std::size_t memoryTwoPeople{registry.trackedMemoryUsage()};
+    BOOST_TEST_REQUIRE(memoryTwoPeople > memoryOnePerson);
+
+    // Adding an existing name doesn't use any more memory.
+    registry.addName(person1, 0, resourceMonitor, addedPerson);
+    BOOST_REQUIRE_EQUAL(memoryTwoPeople, registry.trackedMemoryUsage());
+
+    // Recycling a name frees its memory and reusing the identifier for the
+    // same name restores it.
+    registry.recycleNames({0}, "-");
+    BOOST_TEST_REQUIRE(registry.trackedMemoryUsage() < memoryTwoPeople);
+    registry.addName(person1, 0, resourceMonitor, addedPerson);
+    BOOST_REQUIRE_EQUAL(memoryTwoPeople, registry.trackedMemoryUsage());
+
+    registry.removeNames(1);
+    BOOST_REQUIRE_EQUAL(memoryOnePerson, registry.trackedMemoryUsage());
+
+    registry.clear();
+    BOOST_REQUIRE_EQUAL(0, registry.trackedMemoryUsage());
+}
+
 BOOST_AUTO_TEST_CASE(testPersist) {
     CResourceMonitor resourceMonitor;
     CDynamicStringIdRegistry registry("person", counter_t::E_TSADNumberNewPeople,
@@ -113,6 +182,7 @@ BOOST_AUTO_TEST_CASE(testPersist) {
     LOG_TRACE(<< "Restored XML:\n" << restoredXml);
 
     BOOST_REQUIRE_EQUAL(restoredXml, origXml);
+    BOOST_REQUIRE_EQUAL(registry.trackedMemoryUsage(), restoredRegistry.trackedMemoryUsage());
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -15,14 +15,19 @@
 #include <core/Constants.h>
 
 #include <model/CAnomalyDetector.h>
+#include <model/CAnomalyDetectorModel.h>
 #include <model/CAnomalyDetectorModelConfig.h>
+#include <model/CDataGatherer.h>
 #include <model/CHierarchicalResults.h>
 #include <model/CLimits.h>
+#include <model/CMonitoredResource.h>
 #include <model/CResourceMonitor.h>
 #include <model/CTokenListDataCategorizer.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 
 BOOST_AUTO_TEST_SUITE(CResourceMonitorTest)
@@ -496,6 +501,151 @@ BOOST_FIXTURE_TEST_CASE(testPruning, CTestFixture) {
     BOOST_REQUIRE_EQUAL(model_t::E_MemoryStatusOk, monitor.m_MemoryStatus);
 }
 
+BOOST_FIXTURE_TEST_CASE(testTrackedMemoryUsage, CTestFixture) {
+    static const std::string EMPTY_STRING;
+    static const core_t::TTime FIRST_TIME{358556400};
+    static const core_t::TTime BUCKET_LENGTH{3600};
+
+    CAnomalyDetectorModelConfig modelConfig =
+        CAnomalyDetectorModelConfig::defaultConfig(BUCKET_LENGTH);
+    CLimits limits;
+
+    CSearchKey key(1, // detectorIndex
+                   function_t::E_IndividualMetric, false, model_t::E_XF_None,
+                   "value", "colour");
+
+    CResourceMonitor& monitor = limits.resourceMonitor();
+
+    CAnomalyDetector detector(limits, modelConfig, EMPTY_STRING, FIRST_TIME,
+                              modelConfig.factory(key));
+
+    core_t::TTime bucket = FIRST_TIME;
+    std::size_t startOffset = 10;
+    this->addTestData(bucket, BUCKET_LENGTH, 5, 10, startOffset, detector, monitor);
+
+    monitor.forceRefresh(detector);
+    std::size_t previousCalculated{monitor.totalMemory()};
+
+    std::string numberValue("100");
+    for (std::size_t i = 0; i < 5; ++i) {
+        // Add new people without the monitor seeing them and check the
+        // tracked update follows the full calculation.
+        for (std::size_t j = 0; j < 10; ++j) {
+            std::string person{"person" + std::to_string(startOffset++)};
+            CAnomalyDetector::TStrCPtrVec fieldValues{&person, &numberValue};
+            detector.addRecord(bucket, fieldValues);
+        }
+
+        monitor.m_Resources[&detector].s_MaximumTrackedUpdates =
+            CResourceMonitor::MAXIMUM_TRACKED_UPDATES;
+        std::uint64_t estimates{core::CProgramCounters::counter(
+            counter_t::E_TSADNumberMemoryUsageEstimates)};
+        monitor.refresh(detector);
+        BOOST_REQUIRE_EQUAL(1, monitor.m_Resources[&detector].s_TrackedUpdates);
+        // The tracked update mustn't estimate the models' memory usage.
+        BOOST_REQUIRE_EQUAL(estimates, core::CProgramCounters::counter(
+                                           counter_t::E_TSADNumberMemoryUsageEstimates));
+        double tracked{static_cast<double>(monitor.totalMemory())};
+
+        monitor.forceRefresh(detector);
+        BOOST_REQUIRE_EQUAL(0, monitor.m_Resources[&detector].s_TrackedUpdates);
+        double calculated{static_cast<double>(monitor.totalMemory())};
+        LOG_DEBUG(<< "tracked = " << tracked << ", calculated = " << calculated);
+
+        BOOST_TEST_REQUIRE(tracked > static_cast<double>(previousCalculated));
+        BOOST_TEST_REQUIRE(std::fabs(tracked - calculated) < 0.2 * calculated);
+        previousCalculated = static_cast<std::size_t>(calculated);
+    }
+
+    // Check we periodically do a full calculation and, since nothing grows
+    // untracked, we then do the maximum number of tracked updates.
+    for (std::size_t maximumTrackedUpdates :
+         {monitor.m_Resources[&detector].s_MaximumTrackedUpdates,
+          CResourceMonitor::MAXIMUM_TRACKED_UPDATES}) {
+        for (std::size_t i = 0; i < maximumTrackedUpdates; ++i) {
+            monitor.refresh(detector);
+            BOOST_REQUIRE_EQUAL(i + 1, monitor.m_Resources[&detector].s_TrackedUpdates);
+        }
+        monitor.refresh(detector);
+        BOOST_REQUIRE_EQUAL(0, monitor.m_Resources[&detector].s_TrackedUpdates);
+        BOOST_REQUIRE_EQUAL(CResourceMonitor::MAXIMUM_TRACKED_UPDATES,
+                            monitor.m_Resources[&detector].s_MaximumTrackedUpdates);
+    }
+
+    // Check the memory used per field value is reported.
+    const auto& gatherer = detector.model()->dataGatherer();
+    auto modelSizeStats = monitor.createMemoryUsageReport(bucket);
+    LOG_DEBUG(<< "memory usage per person = " << gatherer.memoryUsagePerPerson());
+    BOOST_TEST_REQUIRE(gatherer.memoryUsagePerPerson() > 0);
+    BOOST_REQUIRE_EQUAL(std::max(gatherer.memoryUsagePerPerson(),
+                                 gatherer.memoryUsagePerAttribute()),
+                        modelSizeStats.s_MaximumMemoryUsagePerFieldValue);
+}
+
+BOOST_AUTO_TEST_CASE(testUntrackedMemoryGrowthBound) {
+    // Test the error in the memory usage due to growth which isn't tracked
+    // is bounded between full calculations.
+
+    class CGrowingResource : public CMonitoredResource {
+    public:
+        void grow(std::size_t tracked, std::size_t untracked) {
+            m_Tracked += tracked;
+            m_Untracked += untracked;
+        }
+        void debugMemoryUsage(const core::CMemoryUsage::TMemoryUsagePtr& mem) const override {
+            mem->setName("CGrowingResource");
+        }
+        std::size_t memoryUsage() const override {
+            return m_Tracked + m_Untracked;
+        }
+        std::size_t staticSize() const override { return sizeof(*this); }
+        bool supportsMemoryTracking() const override { return true; }
+        std::size_t trackedMemoryUsage() const override { return m_Tracked; }
+        void updateModelSizeStats(CResourceMonitor::SModelSizeStats&) const override {}
+
+    private:
+        std::size_t m_Tracked{100000};
+        std::size_t m_Untracked{100000};
+    };
+
+    std::size_t previousCalculations{0};
+    for (std::size_t untrackedGrowth : {0, 10, 100, 1000, 10000}) {
+        LOG_DEBUG(<< "untracked growth = " << untrackedGrowth);
+
+        CResourceMonitor monitor;
+        CGrowingResource resource;
+        monitor.registerComponent(resource);
+
+        std::size_t calculations{0};
+        for (std::size_t i = 0; i < 200; ++i) {
+            resource.grow(500, untrackedGrowth);
+            monitor.refresh(resource);
+            calculations += monitor.m_Resources[&resource].s_TrackedUpdates == 0 ? 1 : 0;
+
+            double actual{static_cast<double>(core::memory::dynamicSize(&resource))};
+            double reported{static_cast<double>(monitor.m_Resources[&resource].s_Usage)};
+            BOOST_TEST_REQUIRE(std::fabs(reported - actual) <=
+                               CResourceMonitor::MAXIMUM_UNTRACKED_MEMORY_FRACTION * actual);
+        }
+        LOG_DEBUG(<< "full calculations = " << calculations);
+
+        // Check we only do as many full calculations as we need. Since the
+        // bound is relative to the memory usage, faster untracked growth
+        // means more frequent full calculations.
+        if (untrackedGrowth == 0) {
+            BOOST_TEST_REQUIRE(calculations <= 2 + 200 / CResourceMonitor::MAXIMUM_TRACKED_UPDATES);
+        } else {
+            BOOST_TEST_REQUIRE(calculations >= previousCalculations);
+        }
+        if (untrackedGrowth == 10000) {
+            BOOST_TEST_REQUIRE(calculations > 100);
+        }
+        previousCalculations = calculations;
+
+        monitor.unRegisterComponent(resource);
+    }
+}
+
 BOOST_FIXTURE_TEST_CASE(testExtraMemory, CTestFixture) {
     static const std::string EMPTY_STRING;
     static const core_t::TTime FIRST_TIME{358556400};
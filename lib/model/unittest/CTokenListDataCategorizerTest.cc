@@ -15,6 +15,7 @@
 #include <core/CRapidXmlParser.h>
 #include <core/CRapidXmlStatePersistInserter.h>
 #include <core/CRapidXmlStateRestoreTraverser.h>
+#include <core/CStopWatch.h>
 #include <core/CWordDictionary.h>
 
 #include <model/CLimits.h>
@@ -817,6 +818,43 @@ BOOST_FIXTURE_TEST_CASE(testManyUniqueTokens, CTestFixture) {
     BOOST_TEST_REQUIRE(ml::core::memory::dynamicSize(&categorizer) < 20000);
 }
 
+BOOST_FIXTURE_TEST_CASE(testManyCategories, CTestFixture) {
+
+    TTokenListDataCategorizerKeepsFields categorizer{
+        m_Limits, NO_REVERSE_SEARCH_CREATOR, 0.7, "whatever"};
+
+    // Create enough categories with no tokens in common that we only
+    // compare each message with the categories it shares tokens with.
+    using TStrVec = std::vector<std::string>;
+    TStrVec messages(2000);
+    std::generate(messages.begin(), messages.end(),
+                  [this]() { return makeUniqueMessage(5); });
+
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(ml::model::CLocalCategoryId{i},
+                            categorizer.computeCategory(false, messages[i],
+                                                        messages[i].length()));
+    }
+
+    // Changing a single token should still match the original category and
+    // matches should be unaffected by the categories being reordered.
+    for (std::size_t i = messages.size(); i > 0; --i) {
+        const std::string& original{messages[i - 1]};
+        std::string message{original.substr(0, original.rfind(' ') + 1) +
+                            makeUniqueToken()};
+        BOOST_REQUIRE_EQUAL(ml::model::CLocalCategoryId{i - 1},
+                            categorizer.computeCategory(false, message, message.length()));
+    }
+
+    // A message with tokens from two categories should match neither.
+    std::string mixed{messages[10].substr(0, messages[10].find(' ')) + ' ' +
+                      messages[20].substr(0, messages[20].find(' '))};
+    BOOST_REQUIRE_EQUAL(ml::model::CLocalCategoryId{messages.size()},
+                        categorizer.computeCategory(false, mixed, mixed.length()));
+
+    checkMemoryUsageInstrumentation(categorizer);
+}
+
 BOOST_FIXTURE_TEST_CASE(testStatsWriteUrgentDueToRareCategories, CTestFixture) {
 
     TTokenListDataCategorizerKeepsFields categorizer{
@@ -955,4 +993,53 @@ BOOST_FIXTURE_TEST_CASE(testReverseSearchImpossibleDueToLongToken, CTestFixture)
         false, categorizer.cacheReverseSearch(ml::model::CLocalCategoryId{1}));
 }
 
+BOOST_FIXTURE_TEST_CASE(testSlashOnlyTokens, CTestFixture) {
+    TTokenListDataCategorizerKeepsFields categorizer{
+        m_Limits, NO_REVERSE_SEARCH_CREATOR, 0.7, "whatever"};
+
+    // Tokens consisting only of forward slashes should be discarded.
+    BOOST_REQUIRE_EQUAL(ml::model::CLocalCategoryId{1},
+                        categorizer.computeCategory(false, "service / started ok", 20));
+    BOOST_REQUIRE_EQUAL(ml::model::CLocalCategoryId{1},
+                        categorizer.computeCategory(false, "service // started ok /", 23));
+    BOOST_REQUIRE_EQUAL(ml::model::CLocalCategoryId{1},
+                        categorizer.computeCategory(false, "service started ok", 18));
+
+    checkMemoryUsageInstrumentation(categorizer);
+}
+
+BOOST_FIXTURE_TEST_CASE(testTokenisationThroughput, CTestFixture, *boost::unit_test::disabled()) {
+
+    TTokenListDataCategorizerKeepsFields categorizer{
+        m_Limits, NO_REVERSE_SEARCH_CREATOR, 0.7, "whatever"};
+
+    // Messages with a mixture of dictionary words, hex numbers, paths, dates
+    // and unique identifiers, most of which repeat so the cost is dominated
+    // by tokenisation and token lookup rather than creating new categories.
+    using TStrVec = std::vector<std::string>;
+    TStrVec messages;
+    for (std::size_t i = 0; i < 100; ++i) {
+        messages.push_back("Mon Jan 23 10:15:" + std::to_string(10 + i % 50) +
+                           " host-" + std::to_string(i % 7) +
+                           " kernel: [0x7fff5fbff8c8] Process " + makeUniqueToken() +
+                           " completed request for /var/log/messages in 12.5ms");
+        messages.push_back("user_" + std::to_string(i % 13) +
+                           " failed to open connection to server.example.com; "
+                           "retrying after deadbeef error code " +
+                           std::to_string(i));
+    }
+
+    ml::core::CStopWatch stopWatch{true};
+    for (std::size_t i = 0; i < 200; ++i) {
+        for (const auto& message : messages) {
+            categorizer.computeCategory(false, message, message.length());
+        }
+    }
+    std::uint64_t elapsed{stopWatch.stop()};
+
+    LOG_INFO(<< "Categorizing " << 200 * messages.size() << " messages took "
+             << elapsed << "ms");
+    BOOST_REQUIRE_EQUAL(2, categorizer.numCategories());
+}
+
 BOOST_AUTO_TEST_SUITE_END()